@@ -0,0 +1,348 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory_resource>
+#include <vector>
+
+#include <libhal-actuator/dynamixel_servo.hpp>
+#include <libhal-actuator/smart_servo/rmd/mc_x_v2.hpp>
+#include <libhal-actuator/telemetry_log.hpp>
+#include <libhal/pointers.hpp>
+#include <libhal/units.hpp>
+
+#include "replay.hpp"
+#include "simulated_bus.hpp"
+
+/**
+ * Host side benchmarks of the smart servo drivers over simulated buses
+ *
+ * Each scenario is run against a bus that models wire time at the baud rate
+ * and the reply latency of the devices. Two numbers are reported per
+ * operation:
+ *
+ *   - bus time: simulated time the operation holds the bus, which sets the
+ *     highest control loop frequency the operation allows
+ *   - host time: CPU time spent on this machine, including the simulation,
+ *     which shows regressions in the drivers' hot paths
+ *
+ * Usage: benchmarks [dynamixel baud] [dynamixel return delay us]
+ *                   [can baud] [rmd reply latency us]
+ *
+ * Replay mode feeds a trace of telemetry records, as drained from a
+ * telemetry_log on the device, back into the drivers' decoders. It reports
+ * the host time per response and checks every decoded value against the
+ * recorded bytes, exiting with 1 on any mismatch. Without a trace file, a
+ * trace recorded from the simulated buses is replayed.
+ *
+ * Usage: benchmarks replay [trace file] [speed, 0 is unpaced]
+ *                          [trace clock Hz]
+ */
+namespace hal::actuator::benchmark {
+namespace {
+using namespace std::chrono_literals;
+using namespace hal::literals;
+
+struct options
+{
+  hal::hertz dynamixel_baud_rate = 1'000'000.0f;
+  hal::time_duration return_delay = 500us;
+  hal::u32 can_baud_rate = 1'000'000;
+  hal::time_duration rmd_latency = 100us;
+};
+
+constexpr int iterations = 1000;
+constexpr std::size_t group_size = 8;
+
+template<class operation_t>
+void run(char const* p_name,
+         virtual_clock& p_clock,
+         int p_iterations,
+         operation_t&& p_operation)
+{
+  auto const bus_start = p_clock.now();
+  auto const host_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < p_iterations; i++) {
+    p_operation(i);
+  }
+  auto const host_end = std::chrono::steady_clock::now();
+  auto const bus_ns =
+    static_cast<double>(p_clock.now() - bus_start) / p_iterations;
+  auto const host_ns =
+    std::chrono::duration<double, std::nano>(host_end - host_start).count() /
+    p_iterations;
+
+  std::printf("%-36s %12.1f %12.1f %12.1f\n",
+              p_name,
+              bus_ns / 1000.0,
+              bus_ns > 0 ? 1e9 / bus_ns : 0.0,
+              host_ns);
+}
+
+auto* memory()
+{
+  return std::pmr::new_delete_resource();
+}
+
+struct dynamixel_bench
+{
+  explicit dynamixel_bench(options const& p_options)
+    : clock(hal::make_strong_ptr<virtual_clock>(memory()))
+    , bus(hal::make_strong_ptr<simulated_dynamixel_bus>(
+        memory(),
+        *clock,
+        p_options.dynamixel_baud_rate,
+        p_options.return_delay))
+  {
+    for (hal::byte id = 1; id <= group_size; id++) {
+      bus->add_servo(id);
+      ids[id - 1] = id;
+      servos.emplace_back(bus,
+                          dynamixel_mx_64,
+                          dynamixel_servo::config{
+                            .baud_rate = p_options.dynamixel_baud_rate,
+                            .id = id,
+                            .deferred_setup = true,
+                          },
+                          clock);
+    }
+    for (auto& servo : servos) {
+      pointers.push_back(&servo);
+    }
+  }
+
+  hal::strong_ptr<virtual_clock> clock;
+  hal::strong_ptr<simulated_dynamixel_bus> bus;
+  std::deque<dynamixel_servo> servos{};
+  std::vector<dynamixel_servo*> pointers{};
+  std::array<hal::u8, group_size> ids{};
+};
+
+void dynamixel_scenarios(options const& p_options)
+{
+  dynamixel_bench bench(p_options);
+  auto& first = bench.servos.front();
+
+  run("dynamixel read position", *bench.clock, iterations, [&](int) {
+    (void)first.position();
+  });
+
+  run("dynamixel write goal position", *bench.clock, iterations, [&](int p_i) {
+    first.position(static_cast<float>(p_i % 300) * 1.0_deg);
+  });
+
+  run("dynamixel read telemetry", *bench.clock, iterations, [&](int) {
+    (void)first.read_telemetry();
+  });
+
+  std::array<hal::degrees, group_size> angles{};
+  run("dynamixel sync write x8", *bench.clock, iterations, [&](int p_i) {
+    angles.fill(static_cast<float>(p_i % 300) * 1.0_deg);
+    dynamixel_servo::sync_position(
+      bench.bus, dynamixel_mx_64, bench.ids, angles);
+  });
+
+  run("dynamixel bulk read telemetry x8", *bench.clock, iterations, [&](int) {
+    (void)dynamixel_servo::read_telemetry(bench.pointers);
+  });
+
+  std::array<hal::u8, group_size> found{};
+  run("dynamixel scan of every ID", *bench.clock, 10, [&](int) {
+    (void)dynamixel_servo::scan(
+      bench.bus,
+      bench.clock,
+      found,
+      {
+        .baud_rate = p_options.dynamixel_baud_rate,
+        .return_delay = std::chrono::duration_cast<std::chrono::microseconds>(
+          p_options.return_delay),
+      });
+  });
+}
+
+void rmd_scenarios(options const& p_options)
+{
+  constexpr std::size_t motor_count = 4;
+  constexpr hal::u32 first_motor = 0x141;
+  constexpr hal::u32 response_offset = 0x100;
+
+  virtual_clock clock;
+  simulated_can_bus bus(
+    clock, p_options.can_baud_rate, p_options.rmd_latency, response_offset);
+  open_can_filter filter;
+
+  std::deque<rmd_mc_x_v2> motors;
+  for (hal::u32 i = 0; i < motor_count; i++) {
+    bus.add_motor(first_motor + i);
+    motors.emplace_back(bus, filter, clock, 36.0f, first_motor + i);
+  }
+
+  run("rmd velocity x4, one at a time", clock, iterations, [&](int p_i) {
+    for (auto& motor : motors) {
+      (void)motor.velocity_control(static_cast<float>(p_i % 100) * 1.0_rpm);
+    }
+  });
+
+  std::array<rmd_mc_x_v2::velocity_setpoint, motor_count> setpoints{};
+  run("rmd velocity x4, group update", clock, iterations, [&](int p_i) {
+    for (std::size_t m = 0; m < motor_count; m++) {
+      setpoints[m] = { .motor = &motors[m],
+                       .speed = static_cast<float>(p_i % 100) * 1.0_rpm };
+    }
+    (void)rmd_mc_x_v2::group_velocity_control(setpoints);
+  });
+
+  run("rmd status_2 feedback x1", clock, iterations, [&](int) {
+    (void)motors[0].feedback_request(rmd_mc_x_v2::read::status_2);
+  });
+}
+
+/// Record the responses of a short session on the simulated buses
+std::vector<telemetry_record> capture_trace(options const& p_options)
+{
+  constexpr int requests = 256;
+  constexpr hal::u32 first_motor = 0x141;
+
+  std::vector<telemetry_record> storage(4096);
+  telemetry_log log(storage);
+
+  dynamixel_bench bench(p_options);
+  for (auto& servo : bench.servos) {
+    servo.log_telemetry(&log);
+  }
+  for (int i = 0; i < requests; i++) {
+    auto& servo = bench.servos[i % group_size];
+    servo.position(static_cast<float>(i % 300) * 1.0_deg);
+    (void)servo.read_telemetry();
+  }
+
+  virtual_clock clock;
+  simulated_can_bus bus(
+    clock, p_options.can_baud_rate, p_options.rmd_latency, 0x100);
+  open_can_filter filter;
+  bus.add_motor(first_motor);
+  rmd_mc_x_v2 motor(bus, filter, clock, 36.0f, first_motor);
+  motor.log_telemetry(&log);
+  for (int i = 0; i < requests; i++) {
+    (void)motor.velocity_control(static_cast<float>(i % 100) * 1.0_rpm);
+    (void)motor.feedback_request(rmd_mc_x_v2::read::status_2);
+  }
+
+  std::vector<telemetry_record> trace(log.size());
+  trace.resize(log.drain(trace));
+  return trace;
+}
+
+int replay_main(int p_argc, char** p_argv, options const& p_options)
+{
+  replay_settings settings{};
+  std::vector<telemetry_record> trace;
+  if (p_argc > 1 && std::strcmp(p_argv[1], "-") != 0) {
+    trace = load_trace(p_argv[1]);
+    if (trace.empty()) {
+      std::printf("could not read a trace from %s\n", p_argv[1]);
+      return 1;
+    }
+  } else {
+    trace = capture_trace(p_options);
+    settings.trace_frequency = 1'000'000'000.0f;
+  }
+  if (p_argc > 2) {
+    settings.speed = std::strtod(p_argv[2], nullptr);
+  }
+  if (p_argc > 3) {
+    settings.trace_frequency = std::strtof(p_argv[3], nullptr);
+  }
+
+  auto const result = replay(trace, settings);
+  auto const decoded = result.rmd + result.dynamixel;
+  auto const per_response =
+    decoded > 0 ? static_cast<double>(result.decode_time.count()) /
+                    static_cast<double>(decoded)
+                : 0.0;
+
+  std::printf("%zu records, %zu responses: %zu rmd, %zu dynamixel, "
+              "%zu not checked\n",
+              trace.size(),
+              result.responses,
+              result.rmd,
+              result.dynamixel,
+              result.ignored);
+  std::printf("recorded over %.3f ms, replayed in %.3f ms\n",
+              static_cast<double>(result.recorded_span.count()) / 1e6,
+              static_cast<double>(result.wall_time.count()) / 1e6);
+  std::printf("%-36s %12.1f %12.0f\n",
+              "decode",
+              per_response,
+              per_response > 0 ? 1e9 / per_response : 0.0);
+  std::printf("%zu mismatches\n", result.mismatches);
+  return result.mismatches == 0 ? 0 : 1;
+}
+
+float argument(int p_argc, char** p_argv, int p_index, float p_default)
+{
+  if (p_index < p_argc) {
+    return std::strtof(p_argv[p_index], nullptr);
+  }
+  return p_default;
+}
+}  // namespace
+}  // namespace hal::actuator::benchmark
+
+int main(int p_argc, char** p_argv)
+{
+  using namespace hal::actuator::benchmark;
+  using std::chrono::microseconds;
+
+  if (p_argc > 1 && std::strcmp(p_argv[1], "replay") == 0) {
+    return replay_main(p_argc - 1, p_argv + 1, options{});
+  }
+
+  options const defaults{};
+  options const settings{
+    .dynamixel_baud_rate =
+      argument(p_argc, p_argv, 1, defaults.dynamixel_baud_rate),
+    .return_delay =
+      microseconds(static_cast<int>(argument(p_argc, p_argv, 2, 500))),
+    .can_baud_rate = static_cast<hal::u32>(
+      argument(p_argc, p_argv, 3, static_cast<float>(defaults.can_baud_rate))),
+    .rmd_latency =
+      microseconds(static_cast<int>(argument(p_argc, p_argv, 4, 100))),
+  };
+
+  std::printf("dynamixel %.0f baud, %lld us return delay; "
+              "can %u baud, %lld us rmd latency\n\n",
+              settings.dynamixel_baud_rate,
+              static_cast<long long>(
+                std::chrono::duration_cast<microseconds>(settings.return_delay)
+                  .count()),
+              settings.can_baud_rate,
+              static_cast<long long>(
+                std::chrono::duration_cast<microseconds>(settings.rmd_latency)
+                  .count()));
+  std::printf("%-36s %12s %12s %12s\n",
+              "scenario",
+              "bus us/op",
+              "max loop Hz",
+              "host ns/op");
+
+  dynamixel_scenarios(settings);
+  rmd_scenarios(settings);
+  return 0;
+}
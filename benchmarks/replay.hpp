@@ -0,0 +1,408 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <libhal-actuator/dynamixel_servo.hpp>
+#include <libhal-actuator/smart_servo/rmd/mc_x_v2.hpp>
+#include <libhal-actuator/telemetry_log.hpp>
+#include <libhal-util/enum.hpp>
+#include <libhal/can.hpp>
+#include <libhal/pointers.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/units.hpp>
+
+#include "simulated_bus.hpp"
+
+namespace hal::actuator::benchmark {
+/**
+ * @brief Read a trace of telemetry records from a file
+ *
+ * The file holds records back to back, exactly as drained from a
+ * telemetry_log and written out by the device, so a trace captured in the
+ * field can be replayed on the host without conversion.
+ *
+ * @param p_path - path of the trace
+ * @return std::vector<telemetry_record> - records of the trace, empty if the
+ * file could not be read
+ */
+inline std::vector<telemetry_record> load_trace(char const* p_path)
+{
+  std::vector<telemetry_record> records;
+  auto* const file = std::fopen(p_path, "rb");
+  if (file == nullptr) {
+    return records;
+  }
+  telemetry_record record{};
+  while (std::fread(&record, sizeof(record), 1, file) == 1) {
+    records.push_back(record);
+  }
+  std::fclose(file);
+  return records;
+}
+
+/// @brief One response, put back together from its telemetry records
+struct recorded_response
+{
+  hal::u64 timestamp = 0;
+  hal::u16 device_id = 0;
+  telemetry_source source = telemetry_source::rmd;
+  hal::byte opcode = 0;
+  hal::usize length = 0;
+  std::array<hal::byte, 256> bytes{};
+
+  [[nodiscard]] std::span<hal::byte const> payload() const
+  {
+    return std::span(bytes).first(length);
+  }
+};
+
+/**
+ * @brief Join the records of each response of a trace
+ *
+ * A record at offset 0 starts a response, and records that follow it with
+ * consecutive offsets continue it. Records whose first part was dropped by a
+ * full log are skipped.
+ *
+ * @param p_records - records of the trace, in the order they were logged
+ * @return std::vector<recorded_response> - responses of the trace
+ */
+inline std::vector<recorded_response> assemble(
+  std::span<telemetry_record const> p_records)
+{
+  std::vector<recorded_response> responses;
+  bool open = false;
+  for (auto const& record : p_records) {
+    if (record.offset == 0) {
+      responses.push_back({
+        .timestamp = record.timestamp,
+        .device_id = record.device_id,
+        .source = record.source,
+        .opcode = record.opcode,
+      });
+      open = true;
+    } else if (not open || record.offset != responses.back().length) {
+      open = false;
+      continue;
+    }
+
+    auto& response = responses.back();
+    auto const length = std::min<hal::usize>(
+      record.length, response.bytes.size() - response.length);
+    std::copy_n(
+      record.payload.begin(), length, response.bytes.begin() + response.length);
+    response.length += length;
+  }
+  return responses;
+}
+
+/**
+ * @brief Serial port that answers the next request with a recorded packet
+ */
+class replay_serial : public hal::serial
+{
+public:
+  /// @brief Queue the status packet sent back after the next write
+  void respond_with(recorded_response const& p_response)
+  {
+    auto const parameters = p_response.payload();
+    auto const length = static_cast<hal::byte>(parameters.size() + 2);
+    auto const id = static_cast<hal::byte>(p_response.device_id);
+    hal::byte sum = id + length + p_response.opcode;
+    m_next.assign({ 0xFF, 0xFF, id, length, p_response.opcode });
+    for (auto const parameter : parameters) {
+      sum += parameter;
+      m_next.push_back(parameter);
+    }
+    m_next.push_back(static_cast<hal::byte>(~sum));
+  }
+
+private:
+  void driver_configure(settings const&) override
+  {
+  }
+
+  write_t driver_write(std::span<hal::byte const> p_data) override
+  {
+    m_rx.swap(m_next);
+    m_next.clear();
+    m_position = 0;
+    return { .data = p_data };
+  }
+
+  read_t driver_read(std::span<hal::byte> p_data) override
+  {
+    auto const count = std::min(p_data.size(), m_rx.size() - m_position);
+    std::copy_n(m_rx.begin() + m_position, count, p_data.begin());
+    m_position += count;
+    return {
+      .data = p_data.first(count),
+      .available = m_rx.size() - m_position,
+      .capacity = 1024,
+    };
+  }
+
+  void driver_flush() override
+  {
+    m_rx.clear();
+    m_position = 0;
+  }
+
+  std::vector<hal::byte> m_next{};
+  std::vector<hal::byte> m_rx{};
+  std::size_t m_position = 0;
+};
+
+/// @brief How a trace is replayed
+struct replay_settings
+{
+  /// @brief Frequency of the clock that stamped the records
+  hal::hertz trace_frequency = 1'000'000.0f;
+  /// @brief Replay rate relative to the recording, 0 replays as fast as the
+  /// host allows
+  double speed = 0.0;
+  /// @brief Dynamixel model of every servo in the trace
+  dynamixel_model const* model = &dynamixel_mx_64;
+};
+
+/// @brief Outcome of a replay
+struct replay_result
+{
+  hal::usize responses = 0;
+  hal::usize rmd = 0;
+  hal::usize dynamixel = 0;
+  /// @brief Responses the harness has no driver call or reference for
+  hal::usize ignored = 0;
+  /// @brief Responses whose decoded values differ from the recorded bytes
+  hal::usize mismatches = 0;
+  /// @brief Host time spent in the drivers, not counting the checks
+  std::chrono::nanoseconds decode_time{};
+  /// @brief Host time of the whole replay, including pacing
+  std::chrono::nanoseconds wall_time{};
+  /// @brief Time between the first and last response of the recording
+  std::chrono::nanoseconds recorded_span{};
+};
+
+namespace replay_detail {
+inline hal::i16 le16(std::span<hal::byte const> p_bytes, hal::usize p_offset)
+{
+  return static_cast<hal::i16>(p_bytes[p_offset] |
+                               (p_bytes[p_offset + 1] << 8));
+}
+
+inline bool near(float p_actual, float p_expected)
+{
+  return std::fabs(p_actual - p_expected) <=
+         1e-3f * std::max(1.0f, std::fabs(p_expected));
+}
+
+/**
+ * @brief Compare decoded MC-X feedback against the bytes of its response
+ *
+ * Decodes the response independently of the driver's layout tables, from
+ * the field offsets in the MC-X protocol manual.
+ *
+ * @return std::optional<bool> - whether the feedback matches, or nullopt if
+ * the command has no fields to compare
+ */
+inline std::optional<bool> check_mc_x(rmd_mc_x_v2::feedback_t const& p_feedback,
+                                      recorded_response const& p_response)
+{
+  auto const bytes = p_response.payload();
+  if (bytes.size() != 8) {
+    return std::nullopt;
+  }
+  auto const temperature = static_cast<hal::i8>(bytes[1]);
+  switch (bytes[0]) {
+    case hal::value(rmd_mc_x_v2::read::status_2):
+    case hal::value(rmd_mc_x_v2::actuate::torque):
+    case hal::value(rmd_mc_x_v2::actuate::speed):
+    case hal::value(rmd_mc_x_v2::actuate::position):
+      return p_feedback.raw_motor_temperature == temperature &&
+             p_feedback.raw_current == le16(bytes, 2) &&
+             p_feedback.raw_speed == le16(bytes, 4) &&
+             p_feedback.encoder == le16(bytes, 6);
+    case hal::value(rmd_mc_x_v2::read::status_1_and_error_flags):
+      return p_feedback.raw_motor_temperature == temperature &&
+             p_feedback.raw_volts == le16(bytes, 4) &&
+             p_feedback.raw_error_state ==
+               static_cast<hal::u16>(le16(bytes, 6));
+    case hal::value(rmd_mc_x_v2::read::multi_turns_angle):
+      return p_feedback.raw_multi_turn_angle ==
+             static_cast<hal::i32>(bytes[4] | (bytes[5] << 8) |
+                                   (bytes[6] << 16) | (bytes[7] << 24));
+    default:
+      return std::nullopt;
+  }
+}
+
+/**
+ * @brief Compare decoded Dynamixel telemetry against its status packet
+ *
+ * Decodes the present_* block from the register encodings in the protocol
+ * 1.0 control table, independently of the driver.
+ */
+inline bool check_dynamixel(dynamixel_model const& p_model,
+                            dynamixel_servo::telemetry const& p_telemetry,
+                            recorded_response const& p_response)
+{
+  auto const bytes = p_response.payload();
+  auto const signed_magnitude = [&bytes](hal::usize p_offset, float p_max) {
+    auto const raw = static_cast<hal::u16>(le16(bytes, p_offset));
+    auto const magnitude = static_cast<float>(raw & 0x3FF) * p_max / 1023.0f;
+    return (raw & 0x400) ? magnitude : -magnitude;
+  };
+  auto const position = static_cast<float>(le16(bytes, 0) & 0xFFFF) *
+                        p_model.angle_max / p_model.position_max;
+
+  return near(p_telemetry.position, position) &&
+         near(p_telemetry.speed, signed_magnitude(2, p_model.speed_max)) &&
+         near(p_telemetry.load, signed_magnitude(4, 100.0f)) &&
+         near(p_telemetry.voltage, static_cast<float>(bytes[6]) / 10.0f) &&
+         p_telemetry.temperature == bytes[7];
+}
+}  // namespace replay_detail
+
+/**
+ * @brief Feed the responses of a trace back into the drivers
+ *
+ * RMD frames go to rmd_mc_x_v2::handle_message() of a motor per CAN ID, and
+ * Dynamixel present_* blocks are answered to dynamixel_servo::read_telemetry()
+ * of a servo per ID, so the decoders run exactly as they do on the device.
+ * Each decoded value is then checked against an independent decode of the
+ * recorded bytes.
+ *
+ * @param p_records - records of the trace
+ * @param p_settings - pacing and models of the replay
+ * @return replay_result - throughput and mismatches of the replay
+ */
+inline replay_result replay(std::span<telemetry_record const> p_records,
+                            replay_settings const& p_settings)
+{
+  using namespace std::chrono_literals;
+  constexpr hal::u32 response_offset = 0x100;
+
+  auto const responses = assemble(p_records);
+  replay_result result{ .responses = responses.size() };
+  if (responses.empty()) {
+    return result;
+  }
+
+  // Build a driver for every device of the trace before the clock starts
+  auto* const memory = std::pmr::new_delete_resource();
+  auto clock = hal::make_strong_ptr<virtual_clock>(memory);
+  simulated_can_bus can(*clock, 1'000'000, 0us, response_offset);
+  open_can_filter filter;
+  auto serial = hal::make_strong_ptr<replay_serial>(memory);
+  std::deque<rmd_mc_x_v2> motor_storage;
+  std::deque<dynamixel_servo> servo_storage;
+  std::map<hal::u16, rmd_mc_x_v2*> motors;
+  std::map<hal::u16, dynamixel_servo*> servos;
+  for (auto const& response : responses) {
+    auto const id = response.device_id;
+    if (response.source == telemetry_source::rmd && not motors.contains(id)) {
+      auto const motor_id = id - response_offset;
+      can.add_motor(motor_id);
+      motors[id] =
+        &motor_storage.emplace_back(can, filter, *clock, 1.0f, motor_id);
+    } else if (response.source == telemetry_source::dynamixel &&
+               not servos.contains(id)) {
+      servos[id] = &servo_storage.emplace_back(
+        serial,
+        *p_settings.model,
+        dynamixel_servo::config{ .id = static_cast<hal::u8>(id),
+                                 .deferred_setup = true },
+        clock);
+    }
+  }
+
+  auto const first = responses.front().timestamp;
+  auto const to_nanoseconds = [&p_settings, first](hal::u64 p_timestamp) {
+    return std::chrono::nanoseconds(static_cast<std::int64_t>(
+      static_cast<double>(p_timestamp - first) * 1e9 /
+      p_settings.trace_frequency));
+  };
+  result.recorded_span = to_nanoseconds(responses.back().timestamp);
+
+  auto const host_start = std::chrono::steady_clock::now();
+  for (auto const& response : responses) {
+    auto const at = to_nanoseconds(response.timestamp);
+    if (p_settings.speed > 0.0) {
+      std::this_thread::sleep_until(
+        host_start + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       at / p_settings.speed));
+    }
+    clock->advance_to(static_cast<hal::u64>(at.count()));
+
+    if (response.source == telemetry_source::rmd) {
+      auto const length = std::min<hal::usize>(response.length, 8);
+      hal::can_message message{
+        .id = response.device_id,
+        .length = static_cast<hal::u8>(length),
+      };
+      std::copy_n(
+        response.bytes.begin(), message.length, message.payload.begin());
+      auto& motor = *motors[response.device_id];
+
+      auto const begin = std::chrono::steady_clock::now();
+      motor.handle_message(message);
+      result.decode_time += std::chrono::steady_clock::now() - begin;
+
+      result.rmd++;
+      auto const matches =
+        replay_detail::check_mc_x(motor.feedback(), response);
+      if (not matches) {
+        result.ignored++;
+      } else if (not *matches) {
+        result.mismatches++;
+      }
+      continue;
+    }
+
+    if (response.length != 8) {
+      result.ignored++;
+      continue;
+    }
+    auto& servo = *servos[response.device_id];
+    serial->respond_with(response);
+
+    auto const begin = std::chrono::steady_clock::now();
+    auto const& telemetry = servo.read_telemetry();
+    result.decode_time += std::chrono::steady_clock::now() - begin;
+
+    result.dynamixel++;
+    if (servo.last_error_code() != response.opcode ||
+        not replay_detail::check_dynamixel(
+          *p_settings.model, telemetry, response)) {
+      result.mismatches++;
+    }
+  }
+  result.wall_time = std::chrono::steady_clock::now() - host_start;
+  return result;
+}
+}  // namespace hal::actuator::benchmark
@@ -0,0 +1,376 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <libhal/can.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator::benchmark {
+/**
+ * @brief Clock of the simulation, counting nanoseconds
+ *
+ * Time only moves forward when a simulated bus spends time on the wire or
+ * when the clock is read. Each read stands in for the CPU time of one pass
+ * through a driver's polling loop, so polling loops always make progress.
+ */
+class virtual_clock : public hal::steady_clock
+{
+public:
+  /// @brief Simulated CPU time spent per read of the clock
+  hal::time_duration poll_cost = std::chrono::nanoseconds(200);
+
+  [[nodiscard]] hal::u64 now() const
+  {
+    return m_now;
+  }
+
+  void advance_to(hal::u64 p_ticks)
+  {
+    m_now = std::max(m_now, p_ticks);
+  }
+
+  [[nodiscard]] static hal::u64 ticks(hal::time_duration p_duration)
+  {
+    return static_cast<hal::u64>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(p_duration).count());
+  }
+
+private:
+  hal::hertz driver_frequency() override
+  {
+    return 1'000'000'000.0f;
+  }
+
+  hal::u64 driver_uptime() override
+  {
+    auto const now = m_now;
+    m_now += ticks(poll_cost);
+    return now;
+  }
+
+  hal::u64 m_now = 0;
+};
+
+/**
+ * @brief Half duplex Dynamixel protocol 1.0 bus with servos on it
+ *
+ * Writes take the wire time of their bytes at the baud rate. Every servo
+ * addressed by its own ID answers after the reply latency, one byte per
+ * byte time, so a driver reading the status packet waits exactly as long as
+ * it would on hardware. Servos keep a control table that READ, WRITE,
+ * SYNC_WRITE and BULK_READ act on.
+ */
+class simulated_dynamixel_bus : public hal::serial
+{
+public:
+  simulated_dynamixel_bus(virtual_clock& p_clock,
+                          hal::hertz p_baud_rate,
+                          hal::time_duration p_reply_latency)
+    : m_clock(&p_clock)
+    , m_byte_ticks(static_cast<hal::u64>(10.0e9 / p_baud_rate))
+    , m_latency_ticks(virtual_clock::ticks(p_reply_latency))
+  {
+  }
+
+  /// @brief Put a servo with a zeroed control table on the bus
+  void add_servo(hal::byte p_id)
+  {
+    m_servos[p_id] = {};
+  }
+
+private:
+  static constexpr hal::byte broadcast_id = 0xFE;
+
+  struct pending_byte
+  {
+    hal::u64 arrival;
+    hal::byte value;
+  };
+
+  void driver_configure(settings const&) override
+  {
+  }
+
+  write_t driver_write(std::span<hal::byte const> p_data) override
+  {
+    auto const start = std::max(m_clock->now(), m_line_free);
+    auto const end = start + m_byte_ticks * p_data.size();
+    m_clock->advance_to(end);
+    m_line_free = end;
+
+    m_parse.insert(m_parse.end(), p_data.begin(), p_data.end());
+    parse_packets();
+    return { .data = p_data };
+  }
+
+  read_t driver_read(std::span<hal::byte> p_data) override
+  {
+    std::size_t count = 0;
+    while (count < p_data.size() && not m_rx.empty() &&
+           m_rx.front().arrival <= m_clock->now()) {
+      p_data[count++] = m_rx.front().value;
+      m_rx.pop_front();
+    }
+    return {
+      .data = p_data.first(count),
+      .available = 0,
+      .capacity = 1024,
+    };
+  }
+
+  void driver_flush() override
+  {
+    while (not m_rx.empty() && m_rx.front().arrival <= m_clock->now()) {
+      m_rx.pop_front();
+    }
+  }
+
+  void parse_packets()
+  {
+    // FF FF ID LENGTH INSTRUCTION ... CHECKSUM
+    while (m_parse.size() >= 4) {
+      if (m_parse[0] != 0xFF || m_parse[1] != 0xFF) {
+        m_parse.erase(m_parse.begin());
+        continue;
+      }
+      auto const size = std::size_t{ m_parse[3] } + 4;
+      if (m_parse.size() < size) {
+        return;
+      }
+      std::vector<hal::byte> const packet(m_parse.begin(),
+                                          m_parse.begin() + size);
+      m_parse.erase(m_parse.begin(), m_parse.begin() + size);
+      execute(packet);
+    }
+  }
+
+  void execute(std::span<hal::byte const> p_packet)
+  {
+    auto const id = p_packet[2];
+    auto const instruction = p_packet[4];
+    auto const parameters = p_packet.subspan(5, p_packet.size() - 6);
+
+    switch (instruction) {
+      case 0x03:  // WRITE
+        for (auto servo_id : targets(id)) {
+          auto& table = m_servos[servo_id];
+          std::ranges::copy(parameters.subspan(1),
+                            table.begin() + parameters[0]);
+        }
+        reply(id, {});
+        break;
+      case 0x02: {  // READ
+        auto const address = parameters[0];
+        auto const length = parameters[1];
+        if (auto servo = m_servos.find(id); servo != m_servos.end()) {
+          reply(id, std::span(servo->second).subspan(address, length));
+        }
+        break;
+      }
+      case 0x01:  // PING
+      case 0x04:  // REG_WRITE
+        reply(id, {});
+        break;
+      case 0x83: {  // SYNC_WRITE
+        auto const address = parameters[0];
+        auto const length = parameters[1];
+        for (std::size_t i = 2; i + length < parameters.size();
+             i += length + 1) {
+          if (auto servo = m_servos.find(parameters[i]);
+              servo != m_servos.end()) {
+            std::ranges::copy(parameters.subspan(i + 1, length),
+                              servo->second.begin() + address);
+          }
+        }
+        break;
+      }
+      case 0x92:  // BULK_READ
+        for (std::size_t i = 1; i + 2 < parameters.size(); i += 3) {
+          auto const length = parameters[i];
+          auto const servo_id = parameters[i + 1];
+          auto const address = parameters[i + 2];
+          auto servo = m_servos.find(servo_id);
+          if (servo == m_servos.end()) {
+            // Servos after a missing servo never get their turn
+            break;
+          }
+          reply(servo_id, std::span(servo->second).subspan(address, length));
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  std::vector<hal::byte> targets(hal::byte p_id)
+  {
+    std::vector<hal::byte> ids;
+    for (auto const& [id, table] : m_servos) {
+      if (p_id == broadcast_id || p_id == id) {
+        ids.push_back(id);
+      }
+    }
+    return ids;
+  }
+
+  void reply(hal::byte p_id, std::span<hal::byte const> p_parameters)
+  {
+    if (p_id == broadcast_id || not m_servos.contains(p_id)) {
+      return;
+    }
+
+    std::vector<hal::byte> packet{
+      0xFF, 0xFF, p_id, static_cast<hal::byte>(p_parameters.size() + 2), 0x00
+    };
+    packet.insert(packet.end(), p_parameters.begin(), p_parameters.end());
+    hal::byte sum = 0;
+    for (std::size_t i = 2; i < packet.size(); i++) {
+      sum += packet[i];
+    }
+    packet.push_back(static_cast<hal::byte>(~sum));
+
+    // Each servo answers once the line is quiet for its return delay
+    auto arrival = m_line_free + m_latency_ticks;
+    for (auto const value : packet) {
+      arrival += m_byte_ticks;
+      m_rx.push_back({ .arrival = arrival, .value = value });
+    }
+    m_line_free = arrival;
+  }
+
+  virtual_clock* m_clock;
+  hal::u64 m_byte_ticks;
+  hal::u64 m_latency_ticks;
+  hal::u64 m_line_free = 0;
+  std::map<hal::byte, std::array<hal::byte, 0x50>> m_servos{};
+  std::vector<hal::byte> m_parse{};
+  std::deque<pending_byte> m_rx{};
+};
+
+/**
+ * @brief CAN bus with RMD motors that answer each command with an echo
+ *
+ * Each frame occupies the bus for the time of a worst case stuffed 8 byte
+ * frame. A motor's answer is put on the bus once the command has been
+ * received and the reply latency has passed, and only appears in the receive
+ * buffer once it has been fully transmitted. Commands have lower IDs than
+ * answers and so win arbitration: answers only go out once the bus is free of
+ * queued commands.
+ */
+class simulated_can_bus : public hal::can_transceiver
+{
+public:
+  /// Bits in a standard frame with 8 data bytes, including worst case stuffing
+  static constexpr hal::u32 frame_bits = 135;
+
+  simulated_can_bus(virtual_clock& p_clock,
+                    hal::u32 p_baud_rate,
+                    hal::time_duration p_reply_latency,
+                    hal::u32 p_response_offset)
+    : m_clock(&p_clock)
+    , m_baud_rate(p_baud_rate)
+    , m_frame_ticks(frame_bits * 1'000'000'000ULL / p_baud_rate)
+    , m_latency_ticks(virtual_clock::ticks(p_reply_latency))
+    , m_response_offset(p_response_offset)
+  {
+  }
+
+  /// @brief Put a motor on the bus that answers commands sent to p_id
+  void add_motor(hal::u32 p_id)
+  {
+    m_motors.push_back(p_id);
+  }
+
+private:
+  struct pending_frame
+  {
+    /// Time the motor is ready to put its answer on the bus
+    hal::u64 ready;
+    hal::can_message message;
+  };
+
+  hal::u32 driver_baud_rate() override
+  {
+    return m_baud_rate;
+  }
+
+  void driver_send(hal::can_message const& p_message) override
+  {
+    auto const sent = std::max(m_clock->now(), m_bus_free) + m_frame_ticks;
+    m_bus_free = sent;
+    if (std::ranges::find(m_motors, p_message.id) == m_motors.end()) {
+      return;
+    }
+
+    auto response = p_message;
+    response.id += m_response_offset;
+    m_pending.push_back(
+      { .ready = sent + m_latency_ticks, .message = response });
+  }
+
+  std::span<hal::can_message const> driver_receive_buffer() override
+  {
+    return m_buffer;
+  }
+
+  std::size_t driver_receive_cursor() override
+  {
+    auto const now = m_clock->now();
+    while (not m_pending.empty()) {
+      auto const& next = m_pending.front();
+      auto const arrival = std::max(next.ready, m_bus_free) + m_frame_ticks;
+      if (arrival > now) {
+        break;
+      }
+      m_bus_free = arrival;
+      m_buffer[m_cursor] = next.message;
+      m_cursor = (m_cursor + 1) % m_buffer.size();
+      m_pending.pop_front();
+    }
+    return m_cursor;
+  }
+
+  virtual_clock* m_clock;
+  hal::u32 m_baud_rate;
+  hal::u64 m_frame_ticks;
+  hal::u64 m_latency_ticks;
+  hal::u32 m_response_offset;
+  hal::u64 m_bus_free = 0;
+  std::vector<hal::u32> m_motors{};
+  std::deque<pending_frame> m_pending{};
+  std::array<hal::can_message, 64> m_buffer{};
+  std::size_t m_cursor = 0;
+};
+
+/// @brief Identifier filter that lets every message through
+class open_can_filter : public hal::can_identifier_filter
+{
+private:
+  void driver_allow(std::optional<hal::u16>) override
+  {
+  }
+};
+}  // namespace hal::actuator::benchmark
@@ -32,31 +32,22 @@ void application()
   auto uart = resources::uart2();
 
   hal::print(*console, "Dynamixel Scan Application Starting...\n");
-  hal::actuator::rx_64::config servo_config = {
-    .baud_rate = 57600, .id = 4, .min_angle = 0, .max_angle = 300
-  };
-  auto servo = hal::actuator::rx_64(uart, servo_config, clock);
 
   std::array<hal::hertz, 9> available_bauds = { 9600,   19200,  57600,
                                                 115200, 200000, 250000,
                                                 400000, 500000, 1000000 };
-  bool baud_rate_found = false;
-  bool device_found = false;
+  std::array<hal::u8, 254> found_ids{};
   // loop through bauds
   for (auto current_baud : available_bauds) {
     uart->configure({ .baud_rate = current_baud });
     hal::print<48>(*console, "\nSending Pings on baud %f : ", current_baud);
-    for (uint8_t i = 0; i < 254; i++) {
-      hal::print(*console, ".");
-      device_found = hal::actuator::rx_64::ping_id(i, uart, clock);
-      if (device_found) {
-        hal::print<64>(*console, "\nID found: %d \n", i);
-
-        baud_rate_found = true;
-      }
+    auto const ids = hal::actuator::rx_64::scan(
+      uart, clock, found_ids, { .baud_rate = current_baud });
+    for (auto const id : ids) {
+      hal::print<64>(*console, "\nID found: %d \n", id);
     }
 
-    if (baud_rate_found) {
+    if (not ids.empty()) {
       break;
     }
   }
@@ -32,9 +32,11 @@ void application()
 
   hal::print(*console, "Dynamixel Dual Demo Starting...\n");
 
-  hal::actuator::rx_64::config servo1_config = {
-    .baud_rate = 57600, .id = 4, .min_angle = 0, .max_angle = 230
-  };
+  hal::actuator::rx_64::config servo1_config = { .baud_rate = 57600,
+                                                  .id = 4,
+                                                  .min_angle = 0,
+                                                  .max_angle = 230,
+                                                  .cache_control_table = true };
 
   hal::actuator::rx_64::config servo2_config = {
     .baud_rate = 57600, .id = 2, .min_angle = 70, .max_angle = 230
@@ -45,43 +47,33 @@ void application()
 
   auto min_angle = servo1.min_angle();
   hal::print<32>(*console, "\nMin Angle: %.2f", min_angle);
-  hal::delay(*clock, 10ms);
 
   auto max_angle = servo1.max_angle();
   hal::print<32>(*console, "\nMax Angle: %.2f", max_angle);
-  hal::delay(*clock, 10ms);
 
   auto torque_limit = servo1.torque_limit();
   hal::print<32>(*console, "\nTorque Limit: %.2f", torque_limit);
-  hal::delay(*clock, 10ms);
 
   auto temp_limit = servo1.temperature_limit();
   hal::print<32>(*console, "\nTemp Limit: %d", temp_limit);
-  hal::delay(*clock, 10ms);
 
   auto min_voltage = servo1.min_voltage();
   hal::print<32>(*console, "\nMin Volt: %.2f", min_voltage);
-  hal::delay(*clock, 10ms);
 
   auto max_voltage = servo1.max_voltage();
   hal::print<32>(*console, "\nMax Volt: %.2f", max_voltage);
-  hal::delay(*clock, 10ms);
 
   auto return_delay = servo1.return_delay_time();
   hal::print<32>(*console, "\nReturn Delay: %d", return_delay);
-  hal::delay(*clock, 10ms);
 
   auto punch = servo1.punch();
   hal::print<32>(*console, "\nPunch: %d", punch);
-  hal::delay(*clock, 10ms);
 
   auto torque_enable = servo1.torque_enable();
   hal::print<32>(*console, "\nTorque Enable: %d", torque_enable);
-  hal::delay(*clock, 10ms);
 
   auto moving_speed = servo1.moving_speed();
   hal::print<32>(*console, "\nRPMs: %.2f", moving_speed);
-  hal::delay(*clock, 10ms);
 
   // loop and move servo
   while (true) {
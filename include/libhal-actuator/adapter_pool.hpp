@@ -0,0 +1,138 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+#include <libhal/error.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+namespace detail {
+/// Bytes a strong_ptr is expected to allocate in front of the object it
+/// owns: an allocator, a destroy function and the strong and weak reference
+/// counts. libhal does not expose its control block, so this is an estimate
+/// that the adapter_pool tests check against the allocations
+/// make_strong_ptr actually makes.
+constexpr hal::usize strong_ptr_bookkeeping =
+  sizeof(std::pmr::polymorphic_allocator<>) + sizeof(void (*)(void*)) +
+  2 * sizeof(hal::u32);
+
+/// Bytes reserved in each slot for the bookkeeping, padded so that the
+/// object after it is aligned for any adapter
+constexpr hal::usize adapter_pool_overhead =
+  (strong_ptr_bookkeeping + alignof(std::max_align_t) - 1) /
+  alignof(std::max_align_t) * alignof(std::max_align_t);
+}  // namespace detail
+
+/// Slot size that fits a strong_ptr to any of the adapter types
+template<class... adapter_t>
+constexpr hal::usize adapter_slot_size =
+  std::max({ sizeof(adapter_t)... }) + detail::adapter_pool_overhead;
+
+/**
+ * @brief Fixed block memory resource for driver adapters
+ *
+ * Holds slot_count blocks of slot_size bytes inline, with no upstream
+ * resource. Each allocation takes one block and each deallocation returns
+ * it, so adapters can be acquired and released any number of times without
+ * touching the heap and with a constant time cost. Pass the pool to a
+ * driver's acquire_*2() functions:
+ *
+ *     hal::actuator::rmd_drc_v2::adapter_pool<2> pool;
+ *     auto motor = drc.acquire_motor2(&pool, 100.0_rpm);
+ *     auto angle = drc.acquire_rotation_sensor2(&pool);
+ *
+ * The pool is not thread safe, and its lifetime must exceed the lifetime of
+ * every pointer allocated from it.
+ *
+ * @tparam slot_size - bytes in each block
+ * @tparam slot_count - most allocations alive at once
+ */
+template<hal::usize slot_size, hal::usize slot_count>
+class adapter_pool : public std::pmr::memory_resource
+{
+public:
+  static_assert(slot_count > 0, "A pool needs at least one slot");
+
+  adapter_pool()
+  {
+    for (hal::usize i = 0; i + 1 < slot_count; i++) {
+      m_slots[i].next = &m_slots[i + 1];
+    }
+    m_slots.back().next = nullptr;
+    m_free = m_slots.data();
+  }
+
+  adapter_pool(adapter_pool&) = delete;
+  adapter_pool& operator=(adapter_pool&) = delete;
+  adapter_pool(adapter_pool&&) noexcept = delete;
+  adapter_pool& operator=(adapter_pool&&) noexcept = delete;
+  ~adapter_pool() override = default;
+
+  /**
+   * @brief Number of slots that are not allocated
+   *
+   * @return hal::usize - allocations that can be made before the pool is
+   * exhausted
+   */
+  [[nodiscard]] hal::usize available() const
+  {
+    return m_available;
+  }
+
+private:
+  union slot
+  {
+    slot* next;
+    alignas(std::max_align_t) std::array<std::byte, slot_size> storage;
+  };
+
+  void* do_allocate(std::size_t p_bytes, std::size_t p_alignment) override
+  {
+    if (p_bytes > slot_size || p_alignment > alignof(std::max_align_t)) {
+      hal::safe_throw(hal::argument_out_of_domain(this));
+    }
+    if (m_free == nullptr) {
+      hal::safe_throw(hal::resource_unavailable_try_again(this));
+    }
+    auto* const block = m_free;
+    m_free = block->next;
+    m_available--;
+    return block;
+  }
+
+  void do_deallocate(void* p_block, std::size_t, std::size_t) override
+  {
+    auto* const block = static_cast<slot*>(p_block);
+    block->next = m_free;
+    m_free = block;
+    m_available++;
+  }
+
+  [[nodiscard]] bool do_is_equal(
+    std::pmr::memory_resource const& p_other) const noexcept override
+  {
+    return this == &p_other;
+  }
+
+  std::array<slot, slot_count> m_slots{};
+  slot* m_free = nullptr;
+  hal::usize m_available = slot_count;
+};
+}  // namespace hal::actuator
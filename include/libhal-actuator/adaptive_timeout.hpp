@@ -0,0 +1,151 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief Response timeout that tracks the measured round trip time of a device
+ *
+ * Follows the retransmission timer of TCP (RFC 6298): a smoothed round trip
+ * time and its mean deviation are updated from every response, and the
+ * timeout is the smoothed round trip time plus four deviations. Until the
+ * first response is measured, and after every timeout, the timeout backs off
+ * towards the ceiling, so a slow bus or host is never cut short for long.
+ *
+ * Round trip times passed to this class should not include the time taken to
+ * put the request and response on the wire, the caller adds that per
+ * transaction, so that a mix of short and long transactions does not widen
+ * the estimate.
+ */
+class adaptive_timeout
+{
+public:
+  /// @brief Limits of the timeout
+  struct settings
+  {
+    /// @brief Timeout returned before any response has been measured and the
+    /// most that timeout() will ever return
+    hal::time_duration ceiling = std::chrono::milliseconds(10);
+    /// @brief Least amount of slack allowed above the smoothed round trip
+    /// time, which covers jitter that the deviation has not seen yet
+    hal::time_duration margin = std::chrono::microseconds(200);
+    /// @brief If false, timeout() always returns the ceiling. Round trip
+    /// statistics are still gathered.
+    bool adapt = true;
+  };
+
+  /// @brief Measurements of the responses seen so far
+  struct statistics
+  {
+    /// @brief Number of round trips measured
+    hal::u32 samples = 0;
+    /// @brief Number of requests that timed out
+    hal::u32 timeouts = 0;
+    /// @brief Shortest round trip measured
+    hal::time_duration min = hal::time_duration::max();
+    /// @brief Longest round trip measured
+    hal::time_duration max = hal::time_duration::zero();
+    /// @brief Smoothed round trip time
+    hal::time_duration smoothed = hal::time_duration::zero();
+    /// @brief Smoothed mean deviation of the round trip time
+    hal::time_duration deviation = hal::time_duration::zero();
+  };
+
+  /**
+   * @brief Construct a new adaptive timeout
+   *
+   * @param p_settings - limits of the timeout
+   */
+  explicit adaptive_timeout(settings const& p_settings);
+
+  /**
+   * @brief Update the estimate with a measured round trip
+   *
+   * @param p_round_trip - time between sending a request and receiving its
+   * response, not counting time on the wire
+   */
+  void record(hal::time_duration p_round_trip);
+
+  /**
+   * @brief Note that a request received no response in time
+   *
+   * Doubles the timeout, up to the ceiling, until the next response arrives.
+   */
+  void record_timeout();
+
+  /**
+   * @brief Time to wait for a response, not counting time on the wire
+   *
+   * @return hal::time_duration - timeout between the margin and the ceiling
+   */
+  [[nodiscard]] hal::time_duration timeout() const;
+
+  /**
+   * @brief Change the limits of the timeout
+   *
+   * Gathered statistics are kept.
+   *
+   * @param p_settings - new limits of the timeout
+   */
+  void configure(settings const& p_settings);
+
+  /**
+   * @brief Get the limits of the timeout
+   *
+   * @return settings const& - limits of the timeout
+   */
+  [[nodiscard]] settings const& configuration() const
+  {
+    return m_settings;
+  }
+
+  /**
+   * @brief Get the measurements of the responses seen so far
+   *
+   * @return statistics const& - round trip statistics
+   */
+  [[nodiscard]] statistics const& stats() const
+  {
+    return m_statistics;
+  }
+
+  /**
+   * @brief Forget all measurements and go back to the ceiling
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Time elapsed since a reading of a clock's uptime
+   *
+   * @param p_clock - clock that p_start_ticks was read from
+   * @param p_start_ticks - previous uptime of p_clock
+   * @return hal::time_duration - time elapsed since p_start_ticks
+   */
+  static hal::time_duration elapsed(hal::steady_clock& p_clock,
+                                    hal::u64 p_start_ticks);
+
+private:
+  settings m_settings;
+  statistics m_statistics{};
+  /// Multiplier applied after consecutive timeouts
+  hal::u32 m_backoff = 1;
+};
+}  // namespace hal::actuator
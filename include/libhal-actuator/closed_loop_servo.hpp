@@ -0,0 +1,157 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+
+#include <libhal/rotation_sensor.hpp>
+#include <libhal/servo.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief Closes the loop around an open loop servo with a rotation sensor
+ *
+ * Wraps a position servo, such as an rc_servo, and reports when the shaft
+ * has actually reached its target instead of leaving the application to
+ * sleep for a worst case settling time. With a rotation sensor, the sensor
+ * is compared against the target on every update() and, once the shaft has
+ * come to rest, the error is integrated into the command, which takes out
+ * the servo's calibration error and load droop. The target is reached once
+ * the sensor has been within tolerance for a number of updates in a row.
+ * Without a sensor, the target counts as reached once the configured
+ * settling time has passed.
+ *
+ *     hal::actuator::closed_loop_servo gripper(
+ *       rc_servo, *clock, { .min_angle = 0, .max_angle = 90 }, &encoder);
+ *     gripper.position(45.0f);
+ *     while (not gripper.update()) {
+ *       hal::delay(*clock, 2ms);
+ *     }
+ *
+ * update() never blocks, so it can be called from a control loop that
+ * services other devices.
+ */
+class closed_loop_servo : public hal::servo
+{
+public:
+  /// @brief How the servo is corrected and when it counts as reached
+  struct settings
+  {
+    /// @brief Smallest position the wrapped servo accepts
+    hal::degrees min_angle = 0.0f;
+    /// @brief Largest position the wrapped servo accepts
+    hal::degrees max_angle = 90.0f;
+    /// @brief Largest error between target and sensor that counts as reached
+    hal::degrees tolerance = 1.0f;
+    /// @brief Updates in a row the sensor must be within tolerance. 0 is
+    /// treated as 1.
+    hal::u8 settle_updates = 3;
+    /// @brief Fraction of the error added to the correction on each update
+    /// outside of tolerance
+    float gain = 0.5f;
+    /// @brief Largest change of the sensor reading between two updates at
+    /// which the shaft counts as at rest. The error is only integrated while
+    /// at rest, so a servo that is still slewing to its target does not wind
+    /// up the correction. After each command the shaft must have moved before
+    /// a still reading counts, as the servo reads still until it starts.
+    hal::degrees settle_rate = 0.5f;
+    /// @brief Largest correction applied on top of the target
+    hal::degrees max_correction = 10.0f;
+    /// @brief Time after a position command at which the target counts as
+    /// reached when there is no sensor. With a sensor, a shaft that reads
+    /// still for this long after a command counts as at rest without having
+    /// moved, for commands too small for the servo to act on.
+    hal::time_duration open_loop_settle_time = std::chrono::milliseconds(400);
+  };
+
+  /**
+   * @brief Create a closed loop servo
+   *
+   * @param p_servo - servo to command
+   * @param p_clock - clock used for the open loop settling time
+   * @param p_settings - correction and settling settings
+   * @param p_sensor - sensor measuring the servo's shaft in the same degrees
+   * as the servo's positions, or nullptr to run open loop
+   * @throws hal::argument_out_of_domain - if min_angle is not below max_angle
+   * or tolerance, gain, settle_rate or max_correction is negative.
+   */
+  closed_loop_servo(hal::servo& p_servo,
+                    hal::steady_clock& p_clock,
+                    settings const& p_settings,
+                    hal::rotation_sensor* p_sensor = nullptr);
+
+  /**
+   * @brief Run one step of the correction loop
+   *
+   * Reads the sensor, if there is one, and adjusts the command sent to the
+   * servo when the shaft is at rest outside of tolerance. The first update
+   * after each command only takes a reading, as there is none yet to tell
+   * whether the shaft is moving.
+   *
+   * @return true - the target has been reached
+   * @return false - the servo is still moving towards the target
+   */
+  bool update();
+
+  /**
+   * @brief Whether the most recent update() found the target reached
+   *
+   * @return true - the target has been reached
+   * @return false - the servo is still moving towards the target
+   */
+  [[nodiscard]] bool reached() const;
+
+  /**
+   * @brief Target minus the most recent sensor reading
+   *
+   * @return hal::degrees - position error, 0 without a sensor
+   */
+  [[nodiscard]] hal::degrees error() const;
+
+  /**
+   * @brief Correction currently added to the target
+   *
+   * The correction carries over to the next target since most of it comes
+   * from the servo's calibration rather than from the move itself.
+   *
+   * @return hal::degrees - command sent to the servo minus the target
+   */
+  [[nodiscard]] hal::degrees correction() const;
+
+private:
+  void driver_position(hal::degrees p_position) override;
+  void command();
+
+  hal::servo* m_servo;
+  hal::steady_clock* m_clock;
+  hal::rotation_sensor* m_sensor;
+  settings m_settings;
+  hal::degrees m_target = 0.0f;
+  hal::degrees m_correction = 0.0f;
+  hal::degrees m_error = 0.0f;
+  /// Sensor reading of the previous update since the last command, valid once
+  /// m_have_reading is set
+  hal::degrees m_last_reading = 0.0f;
+  /// Uptime when the servo was last commanded
+  hal::u64 m_commanded_at = 0;
+  hal::u8 m_updates_within = 0;
+  bool m_reached = false;
+  bool m_have_reading = false;
+  /// The reading has changed since the last command
+  bool m_moved = false;
+};
+}  // namespace hal::actuator
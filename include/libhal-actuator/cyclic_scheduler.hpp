@@ -0,0 +1,191 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <span>
+
+#include <libhal/functional.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief Fixed period executive for the read and write tasks of many drivers
+ *
+ * Each task belongs to a lane, which stands for one bus such as a CAN bus or a
+ * Dynamixel serial port. Tasks of a lane run one at a time, in priority order,
+ * while tasks of different lanes run side by side: a task given a poll
+ * handler is started, then polled until it completes, and the other lanes
+ * start and poll their own tasks in the meantime. Pairing the `*_async()`
+ * and `poll()` functions of the RMD and Dynamixel drivers this way overlaps a
+ * CAN round trip with a UART transfer instead of waiting for each in turn.
+ * Tasks without a poll handler, such as an rc_servo16 position, complete as
+ * soon as they are started.
+ *
+ *     std::array<hal::actuator::cyclic_scheduler::task, 8> tasks;
+ *     hal::actuator::cyclic_scheduler loop(clock, 2ms, tasks);
+ *     loop.add({ .lane = can_lane },
+ *              [&] { joint.feedback_request_async(read::status_2); },
+ *              [&] { return joint.poll() != rmd_request_status::pending; });
+ *     loop.add({ .lane = serial_lane, .period = 5 },
+ *              [&] { gripper.read_register_async(address, buffer); },
+ *              [&] {
+ *                return gripper.poll() != rx_64::request_status::pending;
+ *              });
+ *     loop.add({ .lane = pwm_lane }, [&] { pan.position(angle); });
+ *     while (true) {
+ *       auto const report = loop.run_cycle();
+ *     }
+ *
+ * Due tasks are only started before the end of the cycle. Those left over are
+ * skipped for that cycle, and tasks already started are polled until they
+ * complete, which overruns the cycle. The next cycle then starts once the
+ * overrun cycle ends, rather than running late cycles back to back.
+ */
+class cyclic_scheduler
+{
+public:
+  /// @brief Number of lanes, and so buses, a scheduler can drive
+  static constexpr hal::usize max_lanes = 4;
+
+  /// @brief Begins the work of a task, such as sending a request
+  using start_handler = hal::callback<void()>;
+  /// @brief Continues the work of a task, returns true once it is complete
+  using poll_handler = hal::callback<bool()>;
+
+  /// @brief When and where a task runs
+  struct task_settings
+  {
+    /// @brief Bus used by the task, below max_lanes
+    hal::u8 lane = 0;
+    /// @brief Tasks of a lane start in ascending order of priority, tasks of
+    /// equal priority in the order they were added
+    hal::u8 priority = 0;
+    /// @brief Number of cycles between runs of the task, at least 1
+    hal::u16 period = 1;
+    /// @brief Cycle, counted modulo period, that the task runs in
+    hal::u16 offset = 0;
+  };
+
+  /// @brief A task added to the scheduler, the storage for one is provided by
+  /// the caller
+  struct task
+  {
+    start_handler start{};
+    poll_handler poll{};
+    task_settings settings{};
+  };
+
+  /// @brief Result of one cycle
+  struct cycle_report
+  {
+    /// @brief Number of the cycle, starting at 0
+    hal::u32 cycle = 0;
+    /// @brief Number of due tasks that ran to completion
+    hal::u16 completed = 0;
+    /// @brief Number of due tasks not started before the cycle ended
+    hal::u16 skipped = 0;
+    /// @brief Time from the start of the cycle to the completion of its last
+    /// task
+    hal::time_duration busy = hal::time_duration::zero();
+    /// @brief The tasks of the cycle took longer than the cycle's period
+    bool overrun = false;
+  };
+
+  /// @brief Totals over every cycle run so far
+  struct statistics
+  {
+    hal::u32 cycles = 0;
+    hal::u32 overruns = 0;
+    hal::u32 skipped = 0;
+    /// @brief Longest busy time of any cycle
+    hal::time_duration worst_busy = hal::time_duration::zero();
+  };
+
+  /**
+   * @brief Create a scheduler over caller provided task storage
+   *
+   * @param p_clock - clock used to time the cycles, its lifetime must exceed
+   * the lifetime of this object.
+   * @param p_period - time between the starts of two cycles
+   * @param p_storage - storage for the tasks, its size is the most tasks that
+   * can be added. Its lifetime must exceed the lifetime of this object.
+   * @throws hal::argument_out_of_domain - if p_period is not positive.
+   */
+  cyclic_scheduler(hal::steady_clock& p_clock,
+                   hal::time_duration p_period,
+                   std::span<task> p_storage);
+
+  cyclic_scheduler(cyclic_scheduler&) = delete;
+  cyclic_scheduler& operator=(cyclic_scheduler&) = delete;
+  cyclic_scheduler(cyclic_scheduler&&) noexcept = delete;
+  cyclic_scheduler& operator=(cyclic_scheduler&&) noexcept = delete;
+
+  /**
+   * @brief Add a task
+   *
+   * @param p_settings - lane, priority and period of the task
+   * @param p_start - called to begin the task in each cycle it is due
+   * @param p_poll - called after p_start until it returns true. If empty, the
+   * task is complete once p_start returns.
+   * @throws hal::argument_out_of_domain - if the lane is not below max_lanes,
+   * the period is 0 or the offset is not below the period.
+   * @throws hal::resource_unavailable_try_again - if the task storage is full.
+   */
+  void add(task_settings const& p_settings,
+           start_handler p_start,
+           poll_handler p_poll = {});
+
+  /**
+   * @brief Wait for the start of the next cycle and run its due tasks
+   *
+   * The first call starts the first cycle at once.
+   *
+   * @return cycle_report - what happened in the cycle
+   */
+  cycle_report run_cycle();
+
+  /**
+   * @brief Get the totals over every cycle run so far
+   *
+   * @return statistics const& - cycle, overrun and skip counts
+   */
+  [[nodiscard]] statistics const& stats() const
+  {
+    return m_statistics;
+  }
+
+  /// @return hal::usize - number of tasks added
+  [[nodiscard]] hal::usize size() const
+  {
+    return m_count;
+  }
+
+private:
+  /// Index of the next task of p_lane due in the current cycle, starting the
+  /// search at p_from, or m_count if there is none
+  [[nodiscard]] hal::usize next_due(hal::u8 p_lane, hal::usize p_from) const;
+
+  hal::steady_clock* m_clock;
+  std::span<task> m_storage;
+  hal::usize m_count = 0;
+  hal::u64 m_period_ticks;
+  /// Uptime when the next cycle starts, valid once m_running is set
+  hal::u64 m_next_start = 0;
+  hal::u32 m_cycle = 0;
+  bool m_running = false;
+  statistics m_statistics{};
+};
+}  // namespace hal::actuator
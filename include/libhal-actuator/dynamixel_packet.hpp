@@ -0,0 +1,237 @@
+// Copyright 2026 Malia Labor and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <span>
+
+#include <libhal/error.hpp>
+#include <libhal/units.hpp>
+
+/**
+ * Builders for Dynamixel protocol 1.0 instruction packets.
+ *
+ * Packets are written into a caller provided buffer, so several instructions
+ * can be placed back to back and sent with a single serial write:
+ *
+ *     constexpr auto size = dynamixel::instruction_packet_size(3);
+ *     std::array<hal::byte, 2 * size> buffer{};
+ *     auto const first = dynamixel::build_write(buffer, 1, 0x1E, goal_1);
+ *     auto const second = dynamixel::build_write(
+ *       std::span(buffer).subspan(first.size()), 2, 0x1E, goal_2);
+ *     auto const used = first.size() + second.size();
+ *     hal::write(serial, std::span(buffer).first(used), hal::never_timeout());
+ *
+ * Every servo that is addressed by its own ID answers with a status packet,
+ * which must be read before the next servo's answer arrives.
+ */
+namespace hal::actuator::dynamixel {
+/// ID that addresses every servo on the bus. Servos do not respond to
+/// instructions sent to this ID.
+constexpr hal::byte broadcast_id = 0xFE;
+
+/// Instructions of the Dynamixel protocol 1.0
+enum class instruction : hal::byte
+{
+  ping = 0x01,
+  read = 0x02,
+  write = 0x03,
+  reg_write = 0x04,
+  action = 0x05,
+  sync_write = 0x83,
+  bulk_read = 0x92,
+};
+
+/// Most parameter bytes an instruction packet can carry, limited by its one
+/// byte length field
+constexpr usize max_parameters = 0xFF - 2;
+
+/**
+ * @brief Number of bytes in an instruction packet
+ *
+ * @param p_parameters - number of parameter bytes of the instruction
+ * @return constexpr usize - size of the packet including header and checksum
+ */
+constexpr usize instruction_packet_size(usize p_parameters)
+{
+  // FF FF ID LENGTH INSTRUCTION ... CHECKSUM
+  return p_parameters + 6;
+}
+
+/**
+ * @brief Build an instruction packet into a buffer
+ *
+ * @param p_buffer - buffer to build the packet into
+ * @param p_id - ID of the servo, or broadcast_id
+ * @param p_instruction - instruction to send
+ * @param p_parameters - parameter bytes of the instruction
+ * @return constexpr std::span<hal::byte> - the front of p_buffer holding the
+ * finished packet
+ * @throws hal::argument_out_of_domain - if p_buffer is too small for the
+ * packet or there are more than max_parameters parameter bytes.
+ */
+constexpr std::span<hal::byte> build_instruction(
+  std::span<hal::byte> p_buffer,
+  hal::byte p_id,
+  instruction p_instruction,
+  std::span<hal::byte const> p_parameters)
+{
+  auto const size = instruction_packet_size(p_parameters.size());
+  if (p_parameters.size() > max_parameters || p_buffer.size() < size) {
+    hal::safe_throw(hal::argument_out_of_domain(p_buffer.data()));
+  }
+
+  p_buffer[0] = 0xFF;
+  p_buffer[1] = 0xFF;
+  p_buffer[2] = p_id;
+  p_buffer[3] = static_cast<hal::byte>(p_parameters.size() + 2);
+  p_buffer[4] = static_cast<hal::byte>(p_instruction);
+  hal::byte sum = p_buffer[2] + p_buffer[3] + p_buffer[4];
+  for (usize i = 0; i < p_parameters.size(); i++) {
+    p_buffer[5 + i] = p_parameters[i];
+    sum += p_parameters[i];
+  }
+  p_buffer[size - 1] = static_cast<hal::byte>(~sum);
+
+  return p_buffer.first(size);
+}
+
+/**
+ * @brief Build a packet of an instruction that takes an address and data
+ *
+ * @param p_buffer - buffer to build the packet into, at least
+ * instruction_packet_size(1 + p_data.size()) bytes
+ * @param p_id - ID of the servo, or broadcast_id
+ * @param p_instruction - instruction::write or instruction::reg_write
+ * @param p_address - control table address of the first byte to write
+ * @param p_data - register contents to write
+ * @return constexpr std::span<hal::byte> - the front of p_buffer holding the
+ * finished packet
+ * @throws hal::argument_out_of_domain - if p_buffer is too small for the
+ * packet or p_data does not fit in one packet.
+ */
+constexpr std::span<hal::byte> build_register_instruction(
+  std::span<hal::byte> p_buffer,
+  hal::byte p_id,
+  instruction p_instruction,
+  hal::byte p_address,
+  std::span<hal::byte const> p_data)
+{
+  auto const parameters = p_data.size() + 1;
+  auto const size = instruction_packet_size(parameters);
+  if (parameters > max_parameters || p_buffer.size() < size) {
+    hal::safe_throw(hal::argument_out_of_domain(p_buffer.data()));
+  }
+
+  p_buffer[0] = 0xFF;
+  p_buffer[1] = 0xFF;
+  p_buffer[2] = p_id;
+  p_buffer[3] = static_cast<hal::byte>(parameters + 2);
+  p_buffer[4] = static_cast<hal::byte>(p_instruction);
+  p_buffer[5] = p_address;
+  hal::byte sum = p_buffer[2] + p_buffer[3] + p_buffer[4] + p_buffer[5];
+  for (usize i = 0; i < p_data.size(); i++) {
+    p_buffer[6 + i] = p_data[i];
+    sum += p_data[i];
+  }
+  p_buffer[size - 1] = static_cast<hal::byte>(~sum);
+
+  return p_buffer.first(size);
+}
+
+/**
+ * @brief Build a WRITE packet without staging its parameters first
+ *
+ * @param p_buffer - buffer to build the packet into, at least
+ * instruction_packet_size(1 + p_data.size()) bytes
+ * @param p_id - ID of the servo, or broadcast_id
+ * @param p_address - control table address of the first byte to write
+ * @param p_data - register contents to write
+ * @return constexpr std::span<hal::byte> - the front of p_buffer holding the
+ * finished packet
+ * @throws hal::argument_out_of_domain - if p_buffer is too small for the
+ * packet or p_data does not fit in one packet.
+ */
+constexpr std::span<hal::byte> build_write(std::span<hal::byte> p_buffer,
+                                           hal::byte p_id,
+                                           hal::byte p_address,
+                                           std::span<hal::byte const> p_data)
+{
+  return build_register_instruction(
+    p_buffer, p_id, instruction::write, p_address, p_data);
+}
+
+/**
+ * @brief Build a REG_WRITE packet, held by the servo until an ACTION
+ *
+ * @param p_buffer - buffer to build the packet into, at least
+ * instruction_packet_size(1 + p_data.size()) bytes
+ * @param p_id - ID of the servo, or broadcast_id
+ * @param p_address - control table address of the first byte to write
+ * @param p_data - register contents to write
+ * @return constexpr std::span<hal::byte> - the front of p_buffer holding the
+ * finished packet
+ * @throws hal::argument_out_of_domain - if p_buffer is too small for the
+ * packet or p_data does not fit in one packet.
+ */
+constexpr std::span<hal::byte> build_reg_write(
+  std::span<hal::byte> p_buffer,
+  hal::byte p_id,
+  hal::byte p_address,
+  std::span<hal::byte const> p_data)
+{
+  return build_register_instruction(
+    p_buffer, p_id, instruction::reg_write, p_address, p_data);
+}
+
+/**
+ * @brief Build an ACTION packet, applying every registered REG_WRITE
+ *
+ * @param p_buffer - buffer to build the packet into, at least
+ * instruction_packet_size(0) bytes
+ * @param p_id - ID of the servo, or broadcast_id to act on every servo at
+ * the same instant
+ * @return constexpr std::span<hal::byte> - the front of p_buffer holding the
+ * finished packet
+ * @throws hal::argument_out_of_domain - if p_buffer is too small for the
+ * packet.
+ */
+constexpr std::span<hal::byte> build_action(std::span<hal::byte> p_buffer,
+                                            hal::byte p_id = broadcast_id)
+{
+  return build_instruction(p_buffer, p_id, instruction::action, {});
+}
+
+/**
+ * @brief Build a READ packet for a block of the control table
+ *
+ * @param p_buffer - buffer to build the packet into, at least
+ * instruction_packet_size(2) bytes
+ * @param p_id - ID of the servo to read from
+ * @param p_address - control table address of the first byte to read
+ * @param p_length - number of bytes to read
+ * @return constexpr std::span<hal::byte> - the front of p_buffer holding the
+ * finished packet
+ * @throws hal::argument_out_of_domain - if p_buffer is too small for the
+ * packet.
+ */
+constexpr std::span<hal::byte> build_read(std::span<hal::byte> p_buffer,
+                                          hal::byte p_id,
+                                          hal::byte p_address,
+                                          hal::byte p_length)
+{
+  hal::byte const parameters[] = { p_address, p_length };
+  return build_instruction(p_buffer, p_id, instruction::read, parameters);
+}
+}  // namespace hal::actuator::dynamixel
@@ -0,0 +1,1304 @@
+// Copyright 2026 Malia Labor and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <array>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include <libhal-actuator/adaptive_timeout.hpp>
+#include <libhal-actuator/dynamixel_packet.hpp>
+#include <libhal-actuator/retry_policy.hpp>
+#include <libhal-actuator/telemetry_log.hpp>
+#include <libhal-actuator/transaction_recorder.hpp>
+#include <libhal/functional.hpp>
+#include <libhal/pointers.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+namespace dynamixel {
+struct status;
+}  // namespace dynamixel
+
+/**
+ * @brief Traits describing a Dynamixel protocol 1.0 servo model
+ *
+ * Every model shares the protocol 1.0 control table layout below
+ * present_temp, so a model only differs in the scaling and limits of its
+ * registers. Supporting a new model only needs one of these.
+ */
+struct dynamixel_model
+{
+  /// @brief Raw goal and present position at the end of the range of motion
+  hal::u16 position_max;
+  /// @brief Range of motion in degrees, reached at position_max
+  hal::degrees angle_max;
+  /// @brief Speed at a raw moving_speed of 1023
+  hal::rpm speed_max;
+  /// @brief Lowest value accepted by the min and max voltage limit registers
+  hal::volts voltage_limit_min;
+  /// @brief Highest value accepted by the min and max voltage limit registers
+  hal::volts voltage_limit_max;
+  /// @brief Model supports the BULK_READ instruction
+  bool bulk_read;
+};
+
+/// @brief Dynamixel AX-12 and AX-12A
+inline constexpr dynamixel_model dynamixel_ax_12{ .position_max = 1023,
+                                                  .angle_max = 300.0f,
+                                                  .speed_max = 114.0f,
+                                                  .voltage_limit_min = 5.0f,
+                                                  .voltage_limit_max = 25.0f,
+                                                  .bulk_read = false };
+/// @brief Dynamixel RX-28
+inline constexpr dynamixel_model dynamixel_rx_28{ .position_max = 1023,
+                                                  .angle_max = 300.0f,
+                                                  .speed_max = 114.0f,
+                                                  .voltage_limit_min = 5.0f,
+                                                  .voltage_limit_max = 25.0f,
+                                                  .bulk_read = false };
+/// @brief Dynamixel RX-64
+inline constexpr dynamixel_model dynamixel_rx_64{ .position_max = 1023,
+                                                  .angle_max = 300.0f,
+                                                  .speed_max = 114.0f,
+                                                  .voltage_limit_min = 5.0f,
+                                                  .voltage_limit_max = 25.0f,
+                                                  .bulk_read = false };
+/// @brief Dynamixel MX-28 running protocol 1.0
+inline constexpr dynamixel_model dynamixel_mx_28{ .position_max = 4095,
+                                                  .angle_max = 360.0f,
+                                                  .speed_max = 114.0f,
+                                                  .voltage_limit_min = 5.0f,
+                                                  .voltage_limit_max = 16.0f,
+                                                  .bulk_read = true };
+/// @brief Dynamixel MX-64 running protocol 1.0
+inline constexpr dynamixel_model dynamixel_mx_64{ .position_max = 4095,
+                                                  .angle_max = 360.0f,
+                                                  .speed_max = 114.0f,
+                                                  .voltage_limit_min = 5.0f,
+                                                  .voltage_limit_max = 16.0f,
+                                                  .bulk_read = true };
+/// @brief Dynamixel MX-106 running protocol 1.0
+inline constexpr dynamixel_model dynamixel_mx_106{ .position_max = 4095,
+                                                   .angle_max = 360.0f,
+                                                   .speed_max = 114.0f,
+                                                   .voltage_limit_min = 5.0f,
+                                                   .voltage_limit_max = 16.0f,
+                                                   .bulk_read = true };
+
+/**
+ * @brief Driver for any Dynamixel servo speaking protocol 1.0
+ *
+ * The register access, packet framing and status parsing are shared by all
+ * models; the differences between models come from a dynamixel_model. Use
+ * this class directly for models without a dedicated driver, for example:
+ *
+ *     hal::actuator::dynamixel_servo ax_12(
+ *       uart, hal::actuator::dynamixel_ax_12, { .id = 1 }, clock);
+ *
+ * Protocol 1.0 reference:
+ * https://docs.robotis.com/docs/dxl/protocol/protocol1/
+ */
+class dynamixel_servo
+{
+public:
+  /**
+   * @brief Control table addresses shared by every protocol 1.0 model
+   *
+   */
+  enum class common_register : hal::byte
+  {
+    /// @brief Unique ID
+    id = 0x03,
+    /// @brief Baud rate of serial communication
+    baud_rate = 0x04,
+    /// @brief Time between sending an instruction and receiveing a status
+    /// packet
+    return_delay = 0x05,
+    /// @brief Clockwise limit or minimum angle
+    cw_limit = 0x06,
+    /// @brief Counter clockwise limit or maximum angle
+    ccw_limit = 0x08,
+    /// @brief Temperature limit
+    temp_limit = 0x0B,
+    /// @brief Minimum voltage needed for operation
+    min_voltage = 0x0C,
+    /// @brief Maximum voltage needed for operation
+    max_voltage = 0x0D,
+    /// @brief Enable torque usage
+    torque_enable = 0x18,
+    /// @brief Toggle LED
+    led_toggle = 0x19,
+    /// @brief Position to move to
+    goal_position = 0x1E,
+    /// @brief Moving speed to goal position
+    moving_speed = 0x20,
+    /// @brief Torque Limit, value of max_torque as default
+    torque_limit = 0x22,
+    /// @brief Present position
+    present_position = 0x24,
+    /// @brief Present moving speed
+    present_speed = 0x26,
+    /// @brief Present voltage supplied
+    present_voltage = 0x2A,
+    /// @brief Internal temperature in Celsius
+    present_temp = 0x2B,
+    /// @brief Set while a REG_WRITE is waiting for an ACTION
+    instruction_registered = 0x2C,
+    /// @brief Moving status
+    moving_status = 0x2E,
+    /// @brief Minimum current needed for operating
+    punch = 0x30
+  };
+
+  /**
+   * @brief Configuration object containing settings to use when constructing
+   * a Dynamixel servo
+   *
+   */
+  struct config
+  {
+    /// @brief Baud rate to communicate with the servo over serial
+    hertz baud_rate = 57600;
+    /// @brief Id of the servo
+    uint8_t id;
+    /// @brief Minimum angle to limit movement to
+    hal::degrees min_angle = 0;
+    /// @brief Maximum angle to limit movement to, clamped to the range of
+    /// motion of the model
+    hal::degrees max_angle = 360;
+    /// @brief Enable torque on setup
+    bool torque_enable = true;
+    /// @brief Keep a copy of the EEPROM area of the control table, the
+    /// registers below torque_enable, in the driver. Getters for those
+    /// registers are then served without bus traffic and acknowledged writes
+    /// keep the copy up to date. RAM registers are always read from the servo,
+    /// as the servo changes them by itself.
+    bool cache_control_table = false;
+    /// @brief Skip all bus traffic in the constructor. The settings are sent
+    /// later, to every deferred servo at once, by setup().
+    bool deferred_setup = false;
+    /// @brief Longest time to wait for a response from the servo. Once a
+    /// response has been measured, the driver only waits for the time on the
+    /// wire, the return delay and the measured latency of the host, see
+    /// round_trip_statistics().
+    hal::time_duration response_timeout = std::chrono::milliseconds(50);
+    /// @brief Shrink the time waited for responses to what was measured. If
+    /// false, every response is waited for up to response_timeout.
+    bool adapt_response_timeout = true;
+  };
+
+  /**
+   * @brief Snapshot of the present position, speed, load, voltage and
+   * temperature registers of a servo
+   *
+   */
+  struct telemetry
+  {
+    /// @brief Present position in degrees
+    hal::degrees position = 0.0f;
+    /// @brief Present speed in RPMs, positive values are clockwise
+    rpm speed = 0.0f;
+    /// @brief Present load as a percentage of max torque, positive values are
+    /// clockwise
+    float load = 0.0f;
+    /// @brief Present voltage supplied
+    volts voltage = 0.0f;
+    /// @brief Internal temperature in Celsius
+    uint8_t temperature = 0;
+  };
+
+  /**
+   * @brief Faults reported by the servo and the health of its link
+   *
+   * Updated from every status packet the servo sends, so checking it costs
+   * no bus traffic.
+   *
+   * See https://docs.robotis.com/docs/dxl/protocol/protocol1/#error for error
+   * code information.
+   */
+  struct health
+  {
+    /// Error byte of the last valid status packet received from the servo
+    uint8_t raw_error = 0;
+    /// Number of valid status packets received
+    uint32_t replies = 0;
+    /// Number of requests that got no status packet in time
+    uint32_t timeouts = 0;
+    /// Number of status packets dropped for a bad header, ID, length or
+    /// checksum
+    uint32_t corrupted = 0;
+
+    [[nodiscard]] bool input_voltage_error() const noexcept;
+    [[nodiscard]] bool angle_limit_error() const noexcept;
+    [[nodiscard]] bool overheating_error() const noexcept;
+    [[nodiscard]] bool range_error() const noexcept;
+    [[nodiscard]] bool checksum_error() const noexcept;
+    [[nodiscard]] bool overload_error() const noexcept;
+    [[nodiscard]] bool instruction_error() const noexcept;
+    /// @brief No error bits set in the last status packet
+    [[nodiscard]] bool healthy() const noexcept;
+  };
+
+  /**
+   * @brief Timing used by scan() to decide that an ID is not present
+   *
+   */
+  struct scan_settings
+  {
+    /// @brief Baud rate the serial bus is configured to
+    hertz baud_rate = 57600;
+    /// @brief Return delay time configured in the servos, 500us by default
+    std::chrono::microseconds return_delay = std::chrono::microseconds(500);
+    /// @brief Extra time allowed per ID for latency in the receive path
+    std::chrono::microseconds margin = std::chrono::microseconds(200);
+    /// @brief First ID to ping
+    uint8_t first_id = 0;
+    /// @brief Last ID to ping, inclusive. IDs above 253 are not pinged.
+    uint8_t last_id = 253;
+  };
+
+  /**
+   * @brief Construct a new Dynamixel servo object
+   *
+   * @param p_serial Serial to use to communicate with the servo
+   * @param p_model Traits of the servo model, must outlive this object
+   * @param p_settings Configuration object containing settings to use
+   * @param p_clock A steady clock used to time out responses
+   */
+  dynamixel_servo(hal::strong_ptr<hal::serial> const& p_serial,
+                  dynamixel_model const& p_model,
+                  config const& p_settings,
+                  hal::strong_ptr<hal::steady_clock> const& p_clock);
+
+  /**
+   * @brief Send the configuration of servos constructed with deferred_setup
+   *
+   * The angle limits and torque enable settings of every servo are sent with
+   * one SYNC_WRITE each. Servos do not answer a SYNC_WRITE, so each servo's
+   * control table is then read back in one block read to confirm the
+   * settings. Servos constructed with cache_control_table keep that read as
+   * their cache. All servos must be on the same serial bus.
+   *
+   * @param p_servos - Servos to configure
+   * @return usize - Number of servos that confirmed their settings
+   * @throws hal::argument_out_of_domain - if more servos are given than fit in
+   * a single SYNC_WRITE packet (50 servos).
+   */
+  static usize setup(std::span<dynamixel_servo* const> p_servos);
+
+  /**
+   * @brief Check if an ID is in use.
+   *
+   * @param p_id - ID to check.
+   * @param p_serial - Serial to use to communicate with the servo
+   * @param p_clock - A steady clock used to add delays for communication
+   * @return true - Servo using this ID is present on bus.
+   * @return false - No connected servos using this ID.
+   */
+  static bool ping_id(uint8_t p_id,
+                      hal::strong_ptr<hal::serial> const& p_serial,
+                      hal::strong_ptr<hal::steady_clock> const& p_clock);
+
+  /**
+   * @brief Iterate through all valid IDs and return the first ID that is
+   * present. If none are found, 254 (the broadcast ID) will be returned.
+   *
+   * @param p_serial - Serial to use to communicate with the servo
+   * @param p_clock - A steady clock used to add delays for communication
+   * @return u8 - ID of present servo or 254 if none found
+   */
+  static u8 scan_for_id(hal::strong_ptr<hal::serial> const& p_serial,
+                        hal::strong_ptr<hal::steady_clock> const& p_clock);
+
+  /**
+   * @brief Find every servo on the bus
+   *
+   * Each ID is pinged in turn and given only as long as a status packet takes
+   * at the configured baud rate and return delay, instead of the fixed 500ms
+   * used by ping_id(). At 1Mbps with the default return delay, a scan of every
+   * ID takes about 210ms. Protocol 1.0 servos do not answer a broadcast ping,
+   * so the IDs are still pinged one at a time.
+   *
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_clock - A steady clock used to time out each ping
+   * @param p_found - Buffer to fill with the IDs that responded. The scan
+   * stops early once it is full.
+   * @param p_settings - Timing and range of IDs to scan
+   * @return std::span<u8> - The part of p_found holding responding IDs, in
+   * ascending order.
+   */
+  static std::span<u8> scan(hal::strong_ptr<hal::serial> const& p_serial,
+                            hal::strong_ptr<hal::steady_clock> const& p_clock,
+                            std::span<u8> p_found,
+                            scan_settings const& p_settings);
+
+  /**
+   * @brief Get the traits of the servo model
+   *
+   * @return dynamixel_model const& - traits of the servo model
+   */
+  [[nodiscard]] dynamixel_model const& model() const
+  {
+    return *m_model;
+  }
+
+  /**
+   * @brief Toggle LED on or off.
+   *
+   * @param p_on On status of LED to set.
+   */
+  void led(bool p_on);
+
+  /**
+   * @brief Moving status of the servo.
+   *
+   * @return true - servo is moving.
+   * @return false - servo is not moving.
+   */
+  [[nodiscard]] bool is_moving();
+
+  /**
+   * @brief Get current speed in RPMs. Positive values indicate spinning
+   * clockwise. Negative values indicate spinning counter clockwise.
+   *
+   * If the servo does not send a valid response, the value from the last
+   * successful read is returned instead.
+   *
+   * @return rpm - Current moving speed in RPMs.
+   */
+  rpm speed();
+
+  /**
+   * @brief Get current voltage supplied.
+   *
+   * If the servo does not send a valid response, the value from the last
+   * successful read is returned instead.
+   *
+   * @return volts - Current voltage supplied.
+   */
+  volts voltage();
+
+  /**
+   * @brief Get the internal temperature.
+   *
+   * If the servo does not send a valid response, the value from the last
+   * successful read is returned instead.
+   *
+   * @return uint8_t - Temperature in Celsius.
+   */
+  uint8_t temperature();
+
+  /**
+   * @brief Read the present_* registers in a single transaction
+   *
+   * Position, speed, load, voltage and temperature are read as one block from
+   * the control table and cached. If the servo does not respond, the cached
+   * telemetry is left unchanged.
+   *
+   * @return telemetry const& - The cached telemetry
+   */
+  telemetry const& read_telemetry();
+
+  /**
+   * @brief Re-read the cached control table from the servo in one block read
+   *
+   * Caching is turned off by a write to the EEPROM area that the servo does
+   * not cleanly acknowledge, as the servo may or may not have applied it.
+   * Call this to turn it back on. If the servo does not respond, caching is
+   * turned off and getters go back to reading from the servo.
+   *
+   * @return true - the control table was read and is now cached
+   * @return false - the servo did not respond
+   */
+  bool refresh_control_table();
+
+  /**
+   * @brief Check if getters below torque_enable are served from the cache
+   *
+   * @return true - the control table is cached
+   * @return false - every getter reads from the servo
+   */
+  [[nodiscard]] bool control_table_cached() const
+  {
+    return m_control_table_cached;
+  }
+
+  /**
+   * @brief Get the telemetry cached by the last read, without bus traffic
+   *
+   * @return telemetry const& - The cached telemetry
+   */
+  [[nodiscard]] telemetry const& last_telemetry() const
+  {
+    return m_telemetry;
+  }
+
+  /**
+   * @brief Read the telemetry of many servos
+   *
+   * When the first servo's model supports BULK_READ, every servo is read with
+   * a single BULK_READ packet. A servo only answers once the servo before it
+   * has, so reading stops at the first servo that fails to respond.
+   * Otherwise each servo is sent its own READ of the present_* block, and
+   * servos that fail to respond keep their previous telemetry. All servos must
+   * be on the same serial bus.
+   *
+   * @param p_servos - Servos to read, in the order they should respond
+   * @return usize - Number of servos whose telemetry was updated.
+   * @throws hal::argument_out_of_domain - if BULK_READ is used and more
+   * servos are given than fit in a single packet (84 servos).
+   */
+  static usize read_telemetry(std::span<dynamixel_servo* const> p_servos);
+
+  /**
+   * @brief Get the maximum torque available.
+   *
+   * @return float - Maximum torque available as a percentage.
+   */
+  float torque_limit();
+
+  /**
+   * @brief Get the torque enabled flag.
+   *
+   * @return true - Torque usage enabled.
+   * @return false - Torque usage disabled.
+   */
+  bool torque_enable();
+
+  /**
+   * @brief Get the temperature limit before the Overheating Error flag is set
+   * to true.
+   *
+   * @return uint8_t - Temperature limit in Celsius.
+   */
+  uint8_t temperature_limit();
+
+  /**
+   * @brief Get the minimum operating voltage.
+   *
+   * @return volts - Minimum usable operating voltage.
+   */
+  volts min_voltage();
+
+  /**
+   * @brief Get the maximum operating voltage.
+   *
+   * @return volts - Maximum usable operating voltage.
+   */
+  volts max_voltage();
+
+  /**
+   * @brief Get the baud rate used for serial communication.
+   *
+   * @return hertz - Baud rate in Hertz.
+   */
+  hertz baud_rate();
+
+  /**
+   * @brief Get the time between sending an instruction and receiveing a status
+   * packet.
+   *
+   * @return std::chrono::microseconds - Time in microseconds to wait
+   * before sending status packet.
+   */
+  std::chrono::microseconds return_delay_time();
+
+  /**
+   * @brief Get the unique ID.
+   *
+   * @return uint8_t - ID of the servo
+   */
+  uint8_t id();
+
+  /**
+   * @brief Get the minimum angle to restrain motion to.
+   *
+   * @return hal::degrees - Minimum angle in degrees.
+   */
+  hal::degrees min_angle();
+
+  /**
+   * @brief Get the maximum angle to restrain motion to.
+   *
+   * @return hal::degrees - Maximum angle in degrees.
+   */
+  hal::degrees max_angle();
+
+  /**
+   * @brief Get the current position.
+   *
+   * If the servo does not send a valid response, the value from the last
+   * successful read is returned instead.
+   *
+   * @return hal::degrees - Current position in degrees.
+   */
+  hal::degrees position();
+
+  /**
+   * @brief Get the punch, or minimum current needed to operate.
+   *
+   * @return uint16_t - Minimum current needed to operate.
+   */
+  uint16_t punch();
+
+  /**
+   * @brief Get the current speed in RPMs.
+   *
+   * @return float - Current speed in RPMs.
+   */
+  rpm moving_speed();
+
+  /**
+   * @brief Move to position.
+   *
+   * Angle to move to must be within range of min and max angle.
+   *
+   * @param p_angle - Angle to move to.
+   */
+  void position(hal::degrees p_angle);
+
+  /**
+   * @brief Enable or disable torque usage.
+   *
+   * @param p_enable - Set to true to enable torque usage.
+   */
+  void torque_enable(bool p_enable);
+
+  /**
+   * @brief Set the maximum torque available to use.
+   *
+   * Range is 0.0 - 100.0, Values exceeding these bounds will be clamped to be
+   * 0.0 when lower and 100.0 when higher. Example: if 50% torque limit is
+   * desired, p_percent = 50.0
+   *
+   * @param p_percent - Percentage to set max torque to
+   */
+  void torque_limit(float p_percent);
+
+  /**
+   * @brief Set the maximum temperature.
+   *
+   * If internal temperature goes beyond this number, the Overheating Error flag
+   * is set to true. Range is 0.0 - 100.0, Values exceeding these bounds will be
+   * clamped to be 0.0 when lower and 100.0 when higher.
+   *
+   * @param p_temperature - Temperature in Celsius.
+   */
+  void temperature_limit(uint8_t p_temperature);
+
+  /**
+   * @brief Set the minimum operating voltage.
+   *
+   * If the input voltage is below this number, the Voltage Range Error flag is
+   * set to true. Values outside of the model's voltage limit range are clamped
+   * to it.
+   *
+   * @param p_voltage - Minimum operating voltage.
+   */
+  void min_voltage(volts p_voltage);
+
+  /**
+   * @brief Set the maximum operating voltage.
+   *
+   * If the input voltage is above this number, the Voltage Range Error flag is
+   * set to true. Values outside of the model's voltage limit range are clamped
+   * to it.
+   *
+   * @param p_voltage - Maximum operating voltage.
+   */
+  void max_voltage(volts p_voltage);
+
+  /**
+   * @brief Set the baud rate used for serial communication. Serial used to
+   * communicate will also be changed to match the baud rate.
+   *
+   * Available baud rates are: 57600, 9600, 19200, 115200, 200000, 250000,
+   * 400000, 500000, and 1000000. If an invalid baud rate is given, the default
+   * baud rate of 57600 is used.
+   *
+   * @param p_baud - Baud rate used for serial communication
+   */
+  void baud_rate(hertz p_baud);
+
+  /**
+   * @brief Set the time between sending an instruction and receiveing a status
+   * packet.
+   *
+   * Range is 0 - 508 microseconds. Values exceeding these bounds will be
+   * clamped to be 0 when lower and 508 when higher.
+   *
+   * @param p_microseconds - Time in microseconds to wait
+   */
+  void return_delay_time(std::chrono::microseconds p_microseconds);
+
+  /**
+   * @brief Reassign the ID to use when communicating.
+   *
+   * Range is 0 - 253. ID 254 is reserved as the broadcast ID.
+   *
+   * @param p_id - ID to use.
+   */
+  void reassign_id(uint8_t p_id);
+
+  /**
+   * @brief Set the minimum angle to restrain motion to.
+   *
+   * Range of motion is 0.0 up to the model's angle_max. Values exceeding
+   * these bounds will be clamped to them.
+   *
+   * @param p_angle - Minimum angle used to restrain motion to.
+   */
+  void min_angle(hal::degrees p_angle);
+
+  /**
+   * @brief Set the maximum angle to restrain motion to.
+   *
+   * Range of motion is 0.0 up to the model's angle_max. Values exceeding
+   * these bounds will be clamped to them.
+   *
+   * @param p_angle - Maximum angle used to restrain motion to.
+   */
+  void max_angle(hal::degrees p_angle);
+
+  /**
+   * @brief Set the minimum and maximum angles with a single register write.
+   *
+   * Equivalent to calling min_angle() and max_angle(), but both limits are
+   * sent in one packet.
+   *
+   * @param p_min - Minimum angle used to restrain motion to.
+   * @param p_max - Maximum angle used to restrain motion to.
+   */
+  void angle_limits(hal::degrees p_min, hal::degrees p_max);
+
+  /**
+   * @brief Set the speed to use when moving.
+   *
+   * Range is 0 up to the model's speed_max. Values exceeding these bounds
+   * will be clamped to them.
+   *
+   * @param p_rpms - Speed in RPM to use when moving
+   */
+  void speed(rpm p_rpms);
+
+  /**
+   * @brief Move attached opposing servos together.
+   *
+   * Range of motion must be within min and max angles. Both servos must be
+   * the same model.
+   *
+   * @param p_angle - Angle to set the leading servo to.
+   * @param p_opposing_servo - Opposing servo to send reversed angles to.
+   */
+  void sync_position(hal::degrees p_angle, dynamixel_servo& p_opposing_servo);
+
+  /**
+   * @brief Send a goal position that the servo holds until commit()
+   *
+   * Sent with REG_WRITE, so the bus traffic happens now and the servo only
+   * moves when commit() broadcasts ACTION. A servo holds one staged write, a
+   * second one replaces the first.
+   *
+   * @param p_angle - Angle to move to once committed, clamped like
+   * position()
+   */
+  void stage_position(hal::degrees p_angle);
+
+  /**
+   * @brief Check if this driver staged a write that was not yet committed
+   *
+   * @return true - the servo acknowledged a staged write and commit() has
+   * not been called since
+   */
+  [[nodiscard]] bool staged() const
+  {
+    return m_staged.pending;
+  }
+
+  /**
+   * @brief Ask the servo whether it holds a staged write
+   *
+   * @return true - the servo's instruction_registered flag is set
+   */
+  bool instruction_registered();
+
+  /**
+   * @brief Apply the staged writes of many servos at the same instant
+   *
+   * Broadcasts one ACTION packet, which servos do not answer. Every servo on
+   * the bus that holds a staged write applies it, including servos missing
+   * from p_servos. All servos must be on the same serial bus.
+   *
+   * @param p_servos - Servos whose staged writes are committed
+   */
+  static void commit(std::span<dynamixel_servo* const> p_servos);
+
+  /**
+   * @brief Move a chain of servos and the host serial to a new baud rate
+   *
+   * The new rate is broadcast in one WRITE at the current rate, which servos
+   * do not answer. Once the packet has left the wire the host serial is
+   * reconfigured and every servo is pinged at the new rate. If any servo does
+   * not answer, the old rate is broadcast at the new rate, so servos that did
+   * switch move back, and the host serial returns to the old rate. Either
+   * way the chain and the host are left talking at the same rate.
+   *
+   * Factory servos run at 57600, so migrating to 1000000 once after power up
+   * cuts the time of every later transaction by about 17x. The change is
+   * stored in EEPROM and kept over power cycles.
+   *
+   * All servos must be on the same serial bus and at the same baud rate, and
+   * every servo on the bus should be in p_servos. A servo missing from
+   * p_servos still changes rate but is not verified.
+   *
+   * @param p_servos - Servos of the chain
+   * @param p_baud - Baud rate to move to, one of those listed for baud_rate()
+   * @return true - every servo answered at p_baud, which is now used to
+   * communicate with them
+   * @return false - a servo did not answer at p_baud, the chain is back at
+   * its previous rate
+   * @throws hal::argument_out_of_domain - if p_baud is not a rate the servos
+   * support.
+   */
+  static bool migrate_baud_rate(std::span<dynamixel_servo* const> p_servos,
+                                hertz p_baud);
+
+  /**
+   * @brief Write a 2-byte register on many servos with one SYNC_WRITE packet
+   *
+   * Intended for registers such as goal_position, moving_speed and
+   * torque_limit. Servos do not send a status packet for SYNC_WRITE, so this
+   * returns as soon as the packet has been written.
+   *
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_address - Address of the register to write
+   * @param p_ids - IDs of the servos to write
+   * @param p_values - Raw register value for each servo in p_ids
+   * @throws hal::argument_out_of_domain - if p_ids and p_values differ in size
+   * or there are too many servos to fit in a single packet (83 servos).
+   */
+  static void sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                         hal::byte p_address,
+                         std::span<hal::u8 const> p_ids,
+                         std::span<hal::u16 const> p_values);
+
+  /**
+   * @brief Write a 1-byte register on many servos with one SYNC_WRITE packet
+   *
+   * Intended for registers such as torque_enable and led_toggle.
+   *
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_address - Address of the register to write
+   * @param p_ids - IDs of the servos to write
+   * @param p_values - Raw register value for each servo in p_ids
+   * @throws hal::argument_out_of_domain - if p_ids and p_values differ in size
+   * or there are too many servos to fit in a single packet (125 servos).
+   */
+  static void sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                         hal::byte p_address,
+                         std::span<hal::u8 const> p_ids,
+                         std::span<hal::byte const> p_values);
+
+  /**
+   * @brief Move many servos of the same model with a single SYNC_WRITE packet
+   *
+   * Angles are clamped to the full range of motion of the model. Per servo
+   * angle limits are still enforced by the servos themselves.
+   *
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_model - Model of the servos
+   * @param p_ids - IDs of the servos to move
+   * @param p_angles - Angle to move each servo in p_ids to
+   * @throws hal::argument_out_of_domain - if p_ids and p_angles differ in size
+   * or there are too many servos to fit in a single packet.
+   */
+  static void sync_position(hal::strong_ptr<hal::serial> const& p_serial,
+                            dynamixel_model const& p_model,
+                            std::span<hal::u8 const> p_ids,
+                            std::span<hal::degrees const> p_angles);
+
+  /**
+   * @brief Turn off the torque of every servo on a bus at once
+   *
+   * Broadcasts one WRITE of 0 to torque_enable, which servos do not answer,
+   * so the call returns once the 8 byte packet is written and every servo on
+   * the bus is limp 80 bits of wire time later: 80us at 1Mbps, 1.4ms at
+   * 57600.
+   *
+   * @param p_serial - Serial to use to communicate with the servos
+   */
+  static void emergency_stop(hal::strong_ptr<hal::serial> const& p_serial);
+
+  /**
+   * @brief Returns the last error code retrieved from the servo motor
+   *
+   * See https://docs.robotis.com/docs/dxl/protocol/protocol1/#error for error
+   * code information.
+   *
+   * @return auto - error code byte
+   */
+  [[nodiscard]] auto last_error_code() const
+  {
+    return m_health.raw_error;
+  }
+
+  /**
+   * @brief Faults and link statistics gathered from previous transactions
+   *
+   * Does not communicate with the servo.
+   *
+   * @return health const& - decoded error byte and reply counters
+   */
+  [[nodiscard]] health const& last_health() const
+  {
+    return m_health;
+  }
+
+  /**
+   * @brief Round trip times measured from this servo's responses
+   *
+   * Round trip times exclude time on the wire and the return delay, so they
+   * are the latency added by the host and servo.
+   *
+   * @return adaptive_timeout::statistics const& - round trip statistics
+   */
+  [[nodiscard]] adaptive_timeout::statistics const& round_trip_statistics()
+    const
+  {
+    return m_response_timer.stats();
+  }
+
+  /**
+   * @brief Change how long responses from this servo are waited for
+   *
+   * @param p_settings - ceiling, margin and whether the timeout adapts
+   */
+  void tune_response_timeout(adaptive_timeout::settings const& p_settings)
+  {
+    m_response_timer.configure(p_settings);
+  }
+
+  /**
+   * @brief Set how requests that receive no valid response are recovered from
+   *
+   * Reads and writes are sent again while the policy allows, when no status
+   * packet arrives in time or it arrives corrupted. Failed requests never
+   * throw; they are counted in last_health(), so throw_on_failure has no
+   * effect. BULK_READ group reads are not retried.
+   *
+   * @param p_policy - number of attempts and latency budget
+   */
+  void retry(retry_policy const& p_policy)
+  {
+    m_retry = p_policy;
+  }
+
+  /**
+   * @brief Get the retry policy
+   *
+   * @return retry_policy const& - the retry policy in use
+   */
+  [[nodiscard]] retry_policy const& retry() const
+  {
+    return m_retry;
+  }
+
+  /**
+   * @brief Record the timing of every transaction with this servo
+   *
+   * Every read and write, including each servo's part of a BULK_READ, is
+   * recorded as one transaction once its retries are done. Instructions that
+   * receive no status packet, such as SYNC_WRITE, are not recorded.
+   *
+   * @param p_recorder - recorder to add transactions to, or nullptr to stop
+   * recording. Its lifetime must exceed the lifetime of this object or the
+   * next call to this function.
+   */
+  void instrument(transaction_recorder* p_recorder)
+  {
+    m_recorder = p_recorder;
+  }
+
+  /**
+   * @brief Append every status packet received from this servo to a log
+   *
+   * The parameters of each valid status packet are appended raw, with the
+   * error byte as the opcode, including this servo's part of a BULK_READ.
+   * Corrupted packets and timeouts are not logged.
+   *
+   * @param p_log - log to append packets to, or nullptr to stop logging. Its
+   * lifetime must exceed the lifetime of this object or the next call to this
+   * function.
+   */
+  void log_telemetry(telemetry_log* p_log)
+  {
+    m_telemetry_log = p_log;
+  }
+
+  /**
+   * @brief Reset the error byte and reply counters of last_health()
+   *
+   */
+  void clear_health()
+  {
+    m_health = {};
+  }
+
+  /// State of the request started by an *_register_async() function
+  enum class request_status : hal::byte
+  {
+    /// No request is in flight and the last one received its status packet
+    complete,
+    /// A request is waiting for its status packet
+    pending,
+    /// The last request received no valid status packet
+    timed_out,
+  };
+
+  /// Called once with whether a valid status packet was received
+  using completion_handler = hal::callback<void(bool)>;
+
+  /// Most bytes read_register_async() reads in one request
+  static constexpr usize max_async_read = 32;
+
+  /// Most bytes a WRITE or REG_WRITE writes in one request
+  static constexpr usize max_write = 7;
+
+  /**
+   * @brief Start reading a block of registers without blocking
+   *
+   * Sends the request and returns. Call poll() from the event loop until it
+   * stops returning request_status::pending; p_data is filled, and
+   * p_on_complete called, when the status packet arrives or the retry policy
+   * gives up. Reads served from the cached control table complete before this
+   * function returns.
+   *
+   * Only one request per serial port may be in flight, as every servo on a
+   * bus answers on the same wire. The blocking functions must not be called
+   * while a request is pending.
+   *
+   * @param p_address - Address of the first register to read
+   * @param p_data - Filled with the register contents, or zeroed if the servo
+   * does not respond. Its lifetime must exceed the request.
+   * @param p_on_complete - called when the request completes
+   * @throws hal::argument_out_of_domain - if p_data is longer than
+   * max_async_read.
+   * @throws hal::device_or_resource_busy - if a request is already pending.
+   */
+  void read_register_async(hal::byte p_address,
+                           std::span<hal::byte> p_data,
+                           completion_handler p_on_complete = {});
+
+  /**
+   * @brief Start writing a block of registers without blocking
+   *
+   * Like write_register(), the write is sent again if the servo reports that
+   * it received a corrupted packet. See read_register_async() for how the
+   * request completes.
+   *
+   * @param p_address - Address of the first register to write
+   * @param p_data - Register contents to write, at most max_write bytes.
+   * Copied, so it may be released when this function returns.
+   * @param p_on_complete - called when the request completes
+   * @throws hal::argument_out_of_domain - if p_data is longer than max_write.
+   * @throws hal::device_or_resource_busy - if a request is already pending.
+   */
+  void write_register_async(hal::byte p_address,
+                            std::span<hal::byte const> p_data,
+                            completion_handler p_on_complete = {});
+
+  /**
+   * @brief Read what has arrived for the pending request
+   *
+   * This function never blocks. Once the deadline of an attempt passes, the
+   * request is sent again if the retry policy allows it.
+   *
+   * @return request_status - state of the most recent request, timed_out is
+   * returned until the next request is started
+   */
+  [[nodiscard]] request_status poll();
+
+protected:
+  /// @brief Returns the servo at an index of a group of servos
+  using servo_at = hal::callback<dynamixel_servo&(usize)>;
+
+  /**
+   * @brief setup() for a group of servos given by index
+   *
+   * Lets drivers for a specific model accept spans of their own type.
+   *
+   * @param p_count - Number of servos in the group
+   * @param p_servo - Returns the servo at an index of the group
+   * @return usize - Number of servos that confirmed their settings
+   */
+  static usize setup_group(usize p_count, servo_at p_servo);
+
+  /**
+   * @brief read_telemetry() for a group of servos given by index
+   *
+   * @param p_count - Number of servos in the group
+   * @param p_servo - Returns the servo at an index of the group
+   * @return usize - Number of servos whose telemetry was updated.
+   */
+  static usize read_telemetry_group(usize p_count, servo_at p_servo);
+
+  /**
+   * @brief commit() for a group of servos given by index
+   *
+   * @param p_count - Number of servos in the group
+   * @param p_servo - Returns the servo at an index of the group
+   */
+  static void commit_group(usize p_count, servo_at p_servo);
+
+  /**
+   * @brief migrate_baud_rate() for a group of servos given by index
+   *
+   * @param p_count - Number of servos in the group
+   * @param p_servo - Returns the servo at an index of the group
+   * @param p_baud - Baud rate to move to
+   * @return true - every servo answered at p_baud
+   */
+  static bool migrate_baud_rate_group(usize p_count,
+                                      servo_at p_servo,
+                                      hertz p_baud);
+
+  /**
+   * @brief Read a block of registers from the servo
+   *
+   * Served from the cached control table when it is enabled and covers the
+   * block. On a missing or corrupt response, p_data is zeroed and the failure
+   * is counted in last_health().
+   *
+   * @param p_address - Address of the first register to read
+   * @param p_data - Filled with the register contents
+   * @return true - p_data holds the register contents
+   * @return false - the servo did not send a valid response
+   */
+  bool read_register(hal::byte p_address, std::span<hal::byte> p_data);
+
+  /**
+   * @brief Write a block of registers and wait for the status packet
+   *
+   * Writes are sent again, up to three times in total, when the servo reports
+   * that it received a corrupted packet.
+   *
+   * @param p_address - Address of the first register to write
+   * @param p_data - Register contents to write, at most max_write bytes
+   * @throws hal::argument_out_of_domain - if p_data is longer than max_write.
+   */
+  void write_register(hal::byte p_address, std::span<hal::byte const> p_data);
+
+  /**
+   * @brief Write a block of registers with REG_WRITE, applied by commit()
+   *
+   * Resent like write_register() when the servo reports a corrupted packet.
+   *
+   * @param p_address - Address of the first register to write
+   * @param p_data - Register contents to write, at most max_write bytes
+   * @throws hal::argument_out_of_domain - if p_data is longer than max_write.
+   */
+  void stage_register(hal::byte p_address, std::span<hal::byte const> p_data);
+
+  /**
+   * @brief Bring the cached control table in line with a finished write
+   *
+   * A write acknowledged with a clear error byte is copied into the cache.
+   * Any other outcome turns caching off if the write touched the cache, as
+   * the servo may or may not have applied it.
+   *
+   * @param p_address - Address of the first register written
+   * @param p_data - Register contents written
+   * @param p_acknowledged - a valid status packet answered the write
+   */
+  void cache_write(hal::byte p_address,
+                   std::span<hal::byte const> p_data,
+                   bool p_acknowledged);
+
+  /**
+   * @brief Convert an angle to a raw position of this model
+   *
+   * @param p_angle - angle, clamped to the model's range of motion
+   * @return u16 - raw position
+   */
+  [[nodiscard]] u16 angle_to_raw(hal::degrees p_angle) const;
+
+  /**
+   * @brief Convert a raw position of this model to an angle
+   *
+   * @param p_raw - raw position
+   * @return hal::degrees - angle
+   */
+  [[nodiscard]] hal::degrees raw_to_angle(u16 p_raw) const;
+
+private:
+  u16 read_u16(common_register p_register);
+  u8 read_u8(common_register p_register);
+  void write_u16(common_register p_register, u16 p_value);
+  void write_u8(common_register p_register, u8 p_value);
+
+  /**
+   * @brief Read the present_* block into the cached telemetry
+   *
+   * @return true - the servo responded and the cache was updated
+   * @return false - no valid response, the cache was left unchanged
+   */
+  bool update_telemetry();
+
+  /**
+   * @brief Read the control table from model_number up to present_position
+   *
+   * @return std::optional<std::array<hal::byte, 0x24>> - the control table, or
+   * std::nullopt if the servo did not respond.
+   */
+  std::optional<std::array<hal::byte, 0x24>> read_control_table();
+
+  /**
+   * @brief Read back the settings sent by setup() and check them
+   *
+   * @return true - the servo holds the settings it was constructed with
+   * @return false - the servo did not respond or holds other settings
+   */
+  bool confirm_setup();
+
+  /**
+   * @brief Time to wait for the status packet of a request
+   *
+   * @param p_request_bytes - bytes in the instruction packet
+   * @param p_response_parameters - parameter bytes in the status packet
+   * @return hal::time_duration - wire time, return delay and the adaptive
+   * timeout
+   */
+  [[nodiscard]] hal::time_duration response_timeout(
+    usize p_request_bytes,
+    usize p_response_parameters) const;
+
+  /**
+   * @brief Send an instruction packet and read its status packet, following
+   * the retry policy
+   *
+   * Every reply is recorded in last_health() and its round trip time in
+   * round_trip_statistics().
+   *
+   * @param p_request - the instruction packet
+   * @param p_response - filled with the parameter bytes of the status packet
+   * @return true - a valid status packet was received
+   * @return false - no valid status packet was received in time
+   */
+  bool transact(std::span<hal::byte const> p_request,
+                std::span<hal::byte> p_response);
+
+  /**
+   * @brief A single attempt of transact()
+   *
+   * @param p_request - the instruction packet
+   * @param p_response - filled with the parameter bytes of the status packet
+   * @param p_transaction - updated with the timing of this attempt
+   * @return true - a valid status packet was received
+   * @return false - no valid status packet was received in time
+   */
+  bool exchange(std::span<hal::byte const> p_request,
+                std::span<hal::byte> p_response,
+                transaction& p_transaction);
+
+  /**
+   * @brief Account for the status packet, or its absence, of one attempt
+   *
+   * @param p_request_bytes - bytes in the instruction packet
+   * @param p_response - parameter bytes of the status packet
+   * @param p_status - outcome of reading the status packet
+   * @param p_start - uptime when the instruction packet was sent
+   * @param p_transaction - updated with the timing of this attempt
+   * @return true - a valid status packet was received
+   */
+  bool finish_exchange(usize p_request_bytes,
+                       std::span<hal::byte const> p_response,
+                       dynamixel::status const& p_status,
+                       hal::u64 p_start,
+                       transaction& p_transaction);
+
+  /**
+   * @brief Send the pending asynchronous request, again if it was sent
+   *
+   */
+  void send_async();
+
+  /**
+   * @brief End the pending asynchronous request and report its outcome
+   *
+   * @param p_received - a valid status packet was received
+   */
+  void complete_async(bool p_received);
+
+  /// A request started by read_register_async() or write_register_async()
+  struct async_request
+  {
+    /// Instruction packet, resent on each attempt
+    std::array<hal::byte, dynamixel::instruction_packet_size(8)> request{};
+    /// Status packet as it arrives
+    std::array<hal::byte, max_async_read + 6> status{};
+    std::span<hal::byte> data{};
+    completion_handler on_complete{};
+    transaction record{};
+    /// Uptime when the latest attempt was sent
+    hal::u64 start = 0;
+    hal::u64 deadline = 0;
+    usize request_size = 0;
+    usize status_size = 0;
+    usize received = 0;
+    hal::u8 writes = 0;
+    bool is_write = false;
+    bool pending = false;
+    bool timed_out = false;
+  };
+
+  hal::strong_ptr<hal::serial> m_serial;
+  hal::strong_ptr<hal::steady_clock> m_clock;
+  dynamixel_model const* m_model;
+  std::pair<hal::degrees, hal::degrees> m_range;
+  telemetry m_telemetry{};
+  /// EEPROM area of the control table, from model_number up to, but not
+  /// including, torque_enable
+  std::array<hal::byte, 0x18> m_control_table{};
+  bool m_control_table_cached = false;
+  adaptive_timeout m_response_timer;
+  retry_policy m_retry{};
+  hertz m_baud_rate;
+  /// Return delay time of the servo, 500us unless changed
+  hal::time_duration m_return_delay = std::chrono::microseconds(500);
+  hal::byte m_id;
+  health m_health{};
+  transaction_recorder* m_recorder = nullptr;
+  telemetry_log* m_telemetry_log = nullptr;
+  async_request m_async{};
+  /// Registers staged with REG_WRITE, applied to the cache on commit()
+  struct staged_write
+  {
+    std::array<hal::byte, max_write> data{};
+    hal::byte address = 0;
+    hal::u8 size = 0;
+    bool pending = false;
+  };
+  staged_write m_staged{};
+  bool m_setup_torque_enable = true;
+  bool m_setup_cache_control_table = false;
+};
+}  // namespace hal::actuator
@@ -17,16 +17,12 @@
 // only once, no matter how many times it is included.
 #pragma once
 
-#include <cstdint>
+#include <span>
 
-#include <array>
-#include <numeric>
-#include <utility>
-
-#include <libhal-util/serial.hpp>
-#include <libhal-util/steady_clock.hpp>
+#include <libhal-actuator/dynamixel_servo.hpp>
 #include <libhal/pointers.hpp>
 #include <libhal/serial.hpp>
+#include <libhal/steady_clock.hpp>
 #include <libhal/units.hpp>
 
 namespace hal::actuator {
@@ -39,487 +35,330 @@ namespace hal::actuator {
  * https://docs.robotis.com/docs/dxl/model_reference/mx_series/mx-64
  *
  */
-class mx_64
+class mx_64 : public dynamixel_servo
 {
 public:
   /**
-   * @brief Configuration object containing settings to use when constructing
-   * mx_64 object
+   * @brief Addresses for registers of mx_64
    *
    */
-  struct config
+  enum class register_byte : hal::byte
   {
-    /// @brief Baud rate to communicate with mx_64 over serial
-    hertz baud_rate = 57600;
-    /// @brief Id of mx_64
-    uint8_t id;
-    /// @brief Minimum angle to limit movement to
-    hal::degrees min_angle = 0;
-    /// @brief Maximum angle to limit movement to
-    hal::degrees max_angle = 360;
-    /// @brief Enable torque on setup
-    bool torque_enable = true;
+    /// @brief Model number
+    model_number = 0x00,
+    /// @brief Firmware version
+    firmware_ver = 0x02,
+    /// @brief Unique ID
+    id = 0x03,
+    /// @brief Baud rate of serial communication between controller and mx_64
+    baud_rate = 0x04,
+    /// @brief Time between sending an instruction and receiveing a status
+    /// packet
+    return_delay = 0x05,
+    /// @brief Clockwise limit or minimum angle
+    cw_limit = 0x06,
+    /// @brief Counter clockwise limit or maximum angle
+    ccw_limit = 0x08,
+    /// @brief Temperature limit
+    temp_limit = 0x0B,
+    /// @brief Minimum voltage needed for operation
+    min_voltage = 0x0C,
+    /// @brief Maximum voltage needed for operation
+    max_voltage = 0x0D,
+    /// @brief Maximum torque
+    max_torque = 0x0E,
+    /// @brief Status return level, what situations to send status packets
+    status_return = 0x10,
+    /// @brief Which errors cause LED to blink
+    alarm_led = 0x11,
+    /// @brief Which errors cause mx_64 to shutdown
+    shutdown = 0x12,
+    /// @brief Steps added to present_position in multi-turn mode
+    multi_turn_offset = 0x14,
+    /// @brief Steps per turn are 4096 divided by this value
+    resolution_divider = 0x16,
+    /// @brief Enable torque usage
+    torque_enable = 0x18,
+    /// @brief Toggle LED
+    led_toggle = 0x19,
+    /// @brief Derivative gain value of PID
+    d_gain = 0x1A,
+    /// @brief Integral gain value of PID
+    i_gain = 0x1B,
+    /// @brief Proportional band gain value of PID
+    p_gain = 0x1C,
+    /// @brief Position to move to
+    goal_position = 0x1E,
+    /// @brief Moving speed to goal position
+    moving_speed = 0x20,
+    /// @brief Torque Limit, value of max_torque as default
+    torque_limit = 0x22,
+    /// @brief Present position
+    present_position = 0x24,
+    /// @brief Present moving speed
+    present_speed = 0x26,
+    /// @brief Currently applied load
+    present_load = 0x28,
+    /// @brief Present voltage supplied
+    present_voltage = 0x2A,
+    /// @brief Internal temperature in Celsius
+    present_temp = 0x2B,
+    /// @brief Flag for if an instruction is registered for standy execution
+    instruction_registered = 0x2C,
+    /// @brief Is mx_64 moving
+    moving_status = 0x2E,
+    /// @brief Lock EEPROM from modification
+    lock_eeprom = 0x2F,
+    /// @brief Minimum current to drive motor
+    punch = 0x30,
+    /// @brief Realtime clock of MX-64
+    realtime_tick = 0x32,
+    /// @brief Consuming current
+    current = 0x44,
+    /// @brief Torque control mode enable
+    torque_ctrl_mode_enable = 0x46,
+    /// @brief Goal torque applied before stopping
+    goal_torque = 0x47,
+    /// @brief Goal acceleration
+    goal_accel = 0x49
   };
 
+  /// @brief Configuration object containing settings to use when constructing
+  /// mx_64 object
+  using config = dynamixel_servo::config;
+
   /**
    * @brief Construct a new mx_64 object
    *
    * @param p_serial Serial to use to communicate with mx_64
    * @param p_settings Configuration object containing settings to use
-   * @param p_clock A steady clock used to add delays for communication
+   * @param p_clock A steady clock used to time out responses
    */
   mx_64(hal::strong_ptr<hal::serial> const& p_serial,
         config const& p_settings,
         hal::strong_ptr<hal::steady_clock> const& p_clock);
 
-  /**
-   * @brief Check if an ID is in use.
-   *
-   * @param p_id - ID to check.
-   * @param p_serial - Serial to use to communicate with mx_64
-   * @param p_clock - A steady clock used to add delays for communication
-   * @return true - Servo using this ID is present on bus.
-   * @return false - No connected servos using this ID.
-   */
-  static bool ping_id(uint8_t p_id,
-                      hal::strong_ptr<hal::serial> const& p_serial,
-                      hal::strong_ptr<hal::steady_clock> const& p_clock);
-
-  /**
-   * @brief Iterate through all valid IDs and return the first ID that is
-   * present. If none are found, 254 (the broadcast ID) will be returned.
-   *
-   * @param p_serial - Serial to use to communicate with mx_64
-   * @param p_clock - A steady clock used to add delays for communication
-   * @return u8 - ID of present servo or 254 if none found
-   */
-  static u8 scan_for_id(hal::strong_ptr<hal::serial> const& p_serial,
-                        hal::strong_ptr<hal::steady_clock> const& p_clock);
-
-  /**
-   * @brief Toggle LED on or off.
-   *
-   * @param p_on On status of LED to set.
-   */
-  void led(bool p_on);
-
-  /**
-   * @brief Moving status of mx_64.
-   *
-   * @return true - mx_64 is moving.
-   * @return false - mx_64 is not moving.
-   */
-  [[nodiscard]] bool is_moving();
-
-  /**
-   * @brief Get current speed in RPMs. Positive values indicate spinning
-   * clockwise. Negative values indicate spinning counter clockwise.
-   *
-   * @return rpm - Current moving speed in RPMs.
-   */
-  rpm speed();
-
-  /**
-   * @brief Get current voltage supplied.
-   *
-   * @return volts - Current voltage supplied.
-   */
-  volts voltage();
-
-  /**
-   * @brief Get the internal temperature.
-   *
-   * @return uint8_t - Temperature in Celsius.
-   */
-  uint8_t temperature();
-
-  /**
-   * @brief Get the maximum torque available.
-   *
-   * @return float - Maximum torque available as a percentage.
-   */
-  float torque_limit();
-
-  /**
-   * @brief Get the torque enabled flag.
-   *
-   * @return true - Torque usage enabled.
-   * @return false - Torque usage disabled.
-   */
-  bool torque_enable();
-
-  /**
-   * @brief Get the temperature limit before the Overheating Error flag is set
-   * to true.
-   *
-   * @return uint8_t - Temperature limit in Celsius.
-   */
-  uint8_t temperature_limit();
-
-  /**
-   * @brief Get the minimum operating voltage.
-   *
-   * @return volts - Minimum usable operating voltage.
-   */
-  volts min_voltage();
-
-  /**
-   * @brief Get the maximum operating voltage.
-   *
-   * @return volts - Maximum usable operating voltage.
-   */
-  volts max_voltage();
+  /// @brief Settings of the extended position mode
+  struct extended_settings
+  {
+    /// @brief Divides the 4096 steps per turn, extending the range of the
+    /// servo to +/-7 turns times this value. From 1 to 4.
+    hal::u8 resolution_divider = 1;
+    /// @brief Steps the servo adds to its position, from -24576 to 24576
+    hal::i16 multi_turn_offset = 0;
+  };
 
   /**
-   * @brief Get the baud rate used for serial communication.
+   * @brief Switch the servo to multi-turn mode and start counting turns
    *
-   * @return hertz - Baud rate in Hertz.
-   */
-  hertz baud_rate();
-
-  /**
-   * @brief Get the time between sending an instruction and receiveing a status
-   * packet.
+   * Writes the resolution divider and offset, sets both angle limits to 4095
+   * which selects multi-turn mode, then reads the position to seed the turn
+   * counter. From then on extended_position() tracks the position across any
+   * number of turns, as long as it is read at least once per 7 turns times
+   * the resolution divider of motion.
    *
-   * @return std::chrono::microseconds - Time in microseconds to wait
-   * before sending status packet.
+   * @param p_settings - resolution divider and offset to use
+   * @throws hal::argument_out_of_domain - if a setting is out of range.
    */
-  std::chrono::microseconds return_delay_time();
+  void extended_position_mode(extended_settings const& p_settings);
 
   /**
-   * @brief Get the unique ID.
+   * @brief Read the position, counting every turn since the mode was set
    *
-   * @return uint8_t - ID of the servo
-   */
-  uint8_t id();
-
-  /**
-   * @brief Get the minimum angle to restrain motion to.
+   * Only valid after extended_position_mode(). The servo reports a signed
+   * position within +/-7 turns times the resolution divider; a jump of more
+   * than half that window between two reads is counted as a wrap.
    *
-   * @return hal::degrees - Minimum angle in degrees.
+   * @return hal::degrees - accumulated position, zero where the servo reads
+   * zero when the mode was set
    */
-  hal::degrees min_angle();
+  hal::degrees extended_position();
 
   /**
-   * @brief Get the maximum angle to restrain motion to.
+   * @brief Move to an accumulated position
    *
-   * @return hal::degrees - Maximum angle in degrees.
-   */
-  hal::degrees max_angle();
-
-  /**
-   * @brief Get the current position.
+   * Only valid after extended_position_mode().
    *
-   * @return hal::degrees - Current position in degrees.
+   * @param p_angle - position in the frame of extended_position(), clamped to
+   * the window of the servo around its current wrap
    */
-  hal::degrees position();
+  void extended_position(hal::degrees p_angle);
 
   /**
-   * @brief Get the punch, or minimum current needed to operate.
+   * @brief Number of whole turns of the accumulated position
    *
-   * @return uint16_t - Minimum current needed to operate.
-   */
-  uint16_t punch();
-
-  /**
-   * @brief Get the current speed in RPMs.
+   * Updated by extended_position() without a request.
    *
-   * @return float - Current speed in RPMs.
+   * @return hal::i32 - turns, rounded toward negative infinity
    */
-  rpm moving_speed();
+  [[nodiscard]] hal::i32 turns() const;
 
   /**
-   * @brief Move to position.
+   * @brief Set the acceleration the servo uses to reach each goal position
    *
-   * Angle to move to must be within range of min and max angle.
+   * The servo ramps its speed up and down itself, so a single goal_position
+   * write replaces a ramp of intermediate goals sent by the host.
    *
-   * @param p_angle - Angle to move to.
+   * @param p_acceleration - acceleration in degrees per second squared,
+   * rounded to steps of 8.583 and clamped to 2180. Zero disables the ramp and
+   * the servo accelerates as fast as it can.
    */
-  void position(hal::degrees p_angle);
+  void goal_acceleration(float p_acceleration);
 
   /**
-   * @brief Enable or disable torque usage.
+   * @brief Read the acceleration used to reach each goal position
    *
-   * @param p_enable - Set to true to enable torque usage.
+   * @return float - acceleration in degrees per second squared, zero if the
+   * ramp is disabled
    */
-  void torque_enable(bool p_enable);
+  float goal_acceleration();
 
   /**
-   * @brief Set the maximum torque available to use.
+   * @brief Switch between torque control and position control
    *
-   * Range is 0.0 - 100.0, Values exceeding these bounds will be clamped to be
-   * 0.0 when lower and 100.0 when higher. Example: if 50% torque limit is
-   * desired, p_percent = 50.0
+   * In torque control mode the servo ignores goal_position and drives the
+   * current set by goal_torque().
    *
-   * @param p_percent - Percentage to set max torque to
+   * @param p_enable - true for torque control, false for position control
    */
-  void torque_limit(float p_percent);
+  void torque_mode(bool p_enable);
 
   /**
-   * @brief Set the maximum temperature.
-   *
-   * If internal temperature goes beyond this number, the Overheating Error flag
-   * is set to true. Range is 0.0 - 100.0, Values exceeding these bounds will be
-   * clamped to be 0.0 when lower and 100.0 when higher.
+   * @brief Set the current driven in torque control mode
    *
-   * @param p_temperature - Temperature in Celsius.
+   * @param p_current - current of the motor, positive for counter clockwise,
+   * rounded to steps of 4.5mA and clamped to +/-4.6A
    */
-  void temperature_limit(uint8_t p_temperature);
+  void goal_torque(hal::ampere p_current);
 
   /**
-   * @brief Set the minimum operating voltage.
+   * @brief Read the current consumed by the servo
    *
-   * If the input voltage is below this number, the Voltage Range Error flag is
-   * set to true. Range is 5.0 - 16.0, Values exceeding these bounds will be
-   * clamped to be 5.0 when lower and 16.0 when higher.
-   *
-   * @param p_voltage - Minimum operating voltage.
+   * @return hal::ampere - current in steps of 4.5mA, positive for counter
+   * clockwise
    */
-  void min_voltage(volts p_voltage);
+  hal::ampere current();
 
-  /**
-   * @brief Set the maximum operating voltage.
-   *
-   * If the input voltage is above this number, the Voltage Range Error flag is
-   * set to true. Range is 5.0 - 16.0, Values exceeding these bounds will be
-   * clamped to be 5.0 when lower and 16.0 when higher.
-   *
-   * @param p_voltage - Maximum operating voltage.
-   */
-  void max_voltage(volts p_voltage);
+  using dynamixel_servo::read_telemetry;
+  using dynamixel_servo::sync_position;
+  using dynamixel_servo::sync_write;
 
   /**
-   * @brief Set the baud rate used for serial communication. Serial used to
-   * communicate will also be changed to match the baud rate.
+   * @brief Send the configuration of mx_64 servos constructed with
+   * deferred_setup
    *
-   * Available baud rates are: 57600, 9600, 19200, 115200, 200000, 250000,
-   * 400000, 500000, and 1000000. If an invalid baud rate is given, the default
-   * baud rate of 57600 is used.
+   * See dynamixel_servo::setup().
    *
-   * @param p_baud - Baud rate used for serial communication
+   * @param p_servos - Servos to configure
+   * @return usize - Number of servos that confirmed their settings
+   * @throws hal::argument_out_of_domain - if more servos are given than fit in
+   * a single SYNC_WRITE packet (50 servos).
    */
-  void baud_rate(hertz p_baud);
+  static usize setup(std::span<mx_64* const> p_servos);
 
   /**
-   * @brief Set the time between sending an instruction and receiveing a status
-   * packet.
+   * @brief Read the telemetry of many servos with a single BULK_READ packet
    *
-   * Range is 0 - 508 microseconds. Values exceeding these bounds will be
-   * clamped to be 0 when lower and 508 when higher.
+   * Every servo answers in turn with its present_* block, which is decoded
+   * into that servo's cached telemetry. A servo only answers once the servo
+   * before it has, so reading stops at the first servo that fails to respond.
+   * All servos must be on the same serial bus.
    *
-   * @param p_microseconds - Time in microseconds to wait
+   * @param p_servos - Servos to read, in the order they should respond
+   * @return usize - Number of servos, from the front of p_servos, whose
+   * telemetry was updated.
+   * @throws hal::argument_out_of_domain - if more servos are given than fit in
+   * a single BULK_READ packet (84 servos).
    */
-  void return_delay_time(std::chrono::microseconds p_microseconds);
+  static usize read_telemetry(std::span<mx_64* const> p_servos);
 
   /**
-   * @brief Reassign the ID to use when communicating.
+   * @brief Apply the staged writes of many mx_64 servos at the same instant
    *
-   * Range is 0 - 253. ID 254 is reserved as the broadcast ID.
+   * See dynamixel_servo::commit().
    *
-   * @param p_id - ID to use.
+   * @param p_servos - Servos whose staged writes are committed
    */
-  void reassign_id(uint8_t p_id);
+  static void commit(std::span<mx_64* const> p_servos);
 
   /**
-   * @brief Set the minimum angle to restrain motion to.
+   * @brief Move a chain of mx_64 servos and the host serial to a new baud rate
    *
-   * Range of motion is 0.0 - 360.0, Values exceeding these bounds will be
-   * clamped to be 0.0 when lower and 360.0 when higher.
+   * See dynamixel_servo::migrate_baud_rate().
    *
-   * @param p_angle - Minimum angle used to restrain motion to.
+   * @param p_servos - Servos of the chain
+   * @param p_baud - Baud rate to move to
+   * @return true - every servo answered at p_baud
+   * @return false - a servo did not answer, the chain is back at its previous
+   * rate
+   * @throws hal::argument_out_of_domain - if p_baud is not supported.
    */
-  void min_angle(hal::degrees p_angle);
+  static bool migrate_baud_rate(std::span<mx_64* const> p_servos, hertz p_baud);
 
   /**
-   * @brief Set the maximum angle to restrain motion to.
+   * @brief Write a 2-byte register on many servos with one SYNC_WRITE packet
    *
-   * Range of motion is 0.0 - 360.0, Values exceeding these bounds will be
-   * clamped to be 0.0 when lower and 360.0 when higher.
+   * Intended for registers such as goal_position, moving_speed and
+   * torque_limit. Servos do not send a status packet for SYNC_WRITE, so this
+   * returns as soon as the packet has been written.
    *
-   * @param p_angle - Maximum angle used to restrain motion to.
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_register - Address of the register to write
+   * @param p_ids - IDs of the servos to write
+   * @param p_values - Raw register value for each servo in p_ids
+   * @throws hal::argument_out_of_domain - if p_ids and p_values differ in size
+   * or there are too many servos to fit in a single packet (83 servos).
    */
-  void max_angle(hal::degrees p_angle);
+  static void sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                         register_byte p_register,
+                         std::span<hal::u8 const> p_ids,
+                         std::span<hal::u16 const> p_values);
 
   /**
-   * @brief Set the speed to use when moving.
+   * @brief Write a 1-byte register on many servos with one SYNC_WRITE packet
    *
-   * Range is 0 - 114 RPM. Values exceeding these bounds will be clamped to be 0
-   * when lower and 114 when higher.
+   * Intended for registers such as torque_enable and led_toggle.
    *
-   * @param p_rpms - Speed in RPM to use when moving
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_register - Address of the register to write
+   * @param p_ids - IDs of the servos to write
+   * @param p_values - Raw register value for each servo in p_ids
+   * @throws hal::argument_out_of_domain - if p_ids and p_values differ in size
+   * or there are too many servos to fit in a single packet (125 servos).
    */
-  void speed(rpm p_rpms);
+  static void sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                         register_byte p_register,
+                         std::span<hal::u8 const> p_ids,
+                         std::span<hal::byte const> p_values);
 
   /**
-   * @brief Move attached opposing servos together.
+   * @brief Move many servos with a single SYNC_WRITE packet
    *
-   * Range of motion must be within min and max angles.
+   * Angles are clamped to the full range of motion of the servo. Per servo
+   * angle limits are still enforced by the servos themselves.
    *
-   * @param p_angle - Angle to set the leading servo to.
-   * @param p_opposing_servo - Opposing servo to send reversed angles to.
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_ids - IDs of the servos to move
+   * @param p_angles - Angle to move each servo in p_ids to
+   * @throws hal::argument_out_of_domain - if p_ids and p_angles differ in size
+   * or there are too many servos to fit in a single packet.
    */
-  void sync_position(hal::degrees p_angle, mx_64 p_opposing_servo);
+  static void sync_position(hal::strong_ptr<hal::serial> const& p_serial,
+                            std::span<hal::u8 const> p_ids,
+                            std::span<hal::degrees const> p_angles);
 
 private:
   /**
-   * @brief Addresses for registers of mx_64
+   * @brief Add a raw present_position to the accumulated position
    *
+   * @param p_raw - signed position read from the servo
    */
-  enum class register_byte : hal::byte
-  {
-    /// @brief Model number
-    model_number = 0x00,
-    /// @brief Firmware version
-    firmware_ver = 0x02,
-    /// @brief Unique ID
-    id = 0x03,
-    /// @brief Baud rate of serial communication between controller and mx_64
-    baud_rate = 0x04,
-    /// @brief Time between sending an instruction and receiveing a status
-    /// packet
-    return_delay = 0x05,
-    /// @brief Clockwise limit or minimum angle
-    cw_limit = 0x06,
-    /// @brief Counter clockwise limit or maximum angle
-    ccw_limit = 0x08,
-    /// @brief Temperature limit
-    temp_limit = 0x0B,
-    /// @brief Minimum voltage needed for operation
-    min_voltage = 0x0C,
-    /// @brief Maximum voltage needed for operation
-    max_voltage = 0x0D,
-    /// @brief Maximum torque
-    max_torque = 0x0E,
-    /// @brief Status return level, what situations to send status packets
-    status_return = 0x10,
-    /// @brief Which errors cause LED to blink
-    alarm_led = 0x11,
-    /// @brief Which errors cause mx_64 to shutdown
-    shutdown = 0x12,
-    multi_turn_offset = 0x14,
-    resolution_divider = 0x16,
-    /// @brief Enable torque usage
-    torque_enable = 0x18,
-    /// @brief Toggle LED
-    led_toggle = 0x19,
-    /// @brief Derivative gain value of PID
-    d_gain = 0x1A,
-    /// @brief Integral gain value of PID
-    i_gain = 0x1B,
-    /// @brief Proportional band gain value of PID
-    p_gain = 0x1C,
-    /// @brief Position to move to
-    goal_position = 0x1E,
-    /// @brief Moving speed to goal position
-    moving_speed = 0x20,
-    /// @brief Torque Limit, value of max_torque as default
-    torque_limit = 0x22,
-    /// @brief Present position
-    present_position = 0x24,
-    /// @brief Present moving speed
-    present_speed = 0x26,
-    /// @brief Currently applied load
-    present_load = 0x28,
-    /// @brief Present voltage supplied
-    present_voltage = 0x2A,
-    /// @brief Internal temperature in Celsius
-    present_temp = 0x2B,
-    /// @brief Flag for if an instruction is registered for standy execution
-    instruction_registered = 0x2C,
-    /// @brief Is mx_64 moving
-    moving_status = 0x2E,
-    /// @brief Lock EEPROM from modification
-    lock_eeprom = 0x2F,
-    /// @brief Minimum current to drive motor
-    punch = 0x30,
-    /// @brief Realtime clock of MX-64
-    realtime_tick = 0x32,
-    /// @brief Consuming current
-    current = 0x44,
-    /// @brief Torque control mode enable
-    torque_ctrl_mode_enable = 0x46,
-    /// @brief Goal torque applied before stopping
-    goal_torque = 0x47,
-    /// @brief Goal acceleration
-    goal_accel = 0x49
-  };
-
-  template<usize Size>
-  auto read_register(register_byte p_register_address)
-  {
-    using namespace std::chrono_literals;
-
-    auto const address = static_cast<hal::byte>(p_register_address);
-    auto const size_byte = static_cast<hal::byte>(Size);
-
-    std::array<hal::byte, 8> send_bytes = { 0xFF, 0xFF,    m_id,      0x04,
-                                            0x02, address, size_byte, 0x00 };
-    hal::byte const checksum =
-      std::accumulate(&send_bytes[2], &send_bytes[7], 0);
-    send_bytes[7] = ~checksum;
-    hal::write(*m_serial, send_bytes, hal::never_timeout());
-    std::array<hal::byte, Size> return_array{};
-
-    try {
-      auto constexpr read_size = 6 + Size;
-
-      auto const response =
-        hal::read<read_size>(*m_serial, hal::create_timeout(*m_clock, 500ms));
-      if (response[0] == 0xFF && response[1] == 0xFF) {
-        // device responded
-        // TODO(#47): check for errors
-        // TODO(#48): check checksum
-        for (usize i = 0; i < Size; i++) {
-          return_array[i] = response[5 + i];
-        }
-        return return_array;
-      }
-    } catch (hal::timed_out const&) {
-      return return_array;
-    }
-    return return_array;
-  }
-
-  template<usize Size>
-  void write_register(register_byte p_register_address,
-                      std::array<hal::byte, Size> p_data)
-  {
-    constexpr hal::byte packet_length = 0x03 + Size;
-    auto const address = static_cast<hal::byte>(p_register_address);
-    std::array<hal::byte, 6> header_bytes = { 0xFF,          0xFF, m_id,
-                                              packet_length, 0x03, address };
-
-    hal::byte checksum =
-      std::accumulate(header_bytes.begin() + 2, header_bytes.end(), 0);
-    checksum = std::accumulate(p_data.begin(), p_data.end(), checksum);
-    checksum = ~checksum;
-
-    hal::write(*m_serial, header_bytes, hal::never_timeout());
-    hal::write(*m_serial, p_data, hal::never_timeout());
-    hal::write(*m_serial, std::array{ checksum }, hal::never_timeout());
-
-    try {
-      using namespace std::chrono_literals;
-      auto const response =
-        hal::read<6>(*m_serial, hal::create_timeout(*m_clock, 50ms));
-      if (response[0] == 0xFF && response[1] == 0xFF) {
-        // device responded
-        hal::byte received_chksm =
-          std::accumulate(&response[2], &response[4], 0);
-        received_chksm = ~received_chksm;
-        if (received_chksm == response[5]) {
-          // checksum match
-          // TODO(#47): check for errors
-        }
-      }
-    } catch (hal::timed_out const&) {
-      return;
-    }
-  }
+  void accumulate(hal::i16 p_raw);
 
-  hal::strong_ptr<hal::serial> m_serial;
-  hal::strong_ptr<hal::steady_clock> m_clock;
-  std::pair<hal::degrees, hal::degrees> m_range;
-  hal::byte m_id;
+  /// Position when last read, in steps of the current resolution
+  hal::i16 m_last_raw = 0;
+  /// Times the position wrapped around the window of the servo
+  hal::i32 m_wraps = 0;
+  hal::u8 m_resolution_divider = 1;
 };
 }  // namespace hal::actuator
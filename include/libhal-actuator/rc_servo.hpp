@@ -17,6 +17,12 @@
 // only once, no matter how many times it is included.
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <ratio>
+#include <utility>
+
+#include <libhal/error.hpp>
 #include <libhal/pointers.hpp>
 #include <libhal/pwm.hpp>
 #include <libhal/servo.hpp>
@@ -77,8 +83,131 @@ private:
 };
 
 /**
- * @brief Generic RC servo driver.
+ * @brief RC servo driver whose settings are known at compile time
+ *
+ * Behaves like rc_servo, but the mapping from angle to duty cycle is worked
+ * out by the compiler, so a position update is a range check against two
+ * constants and one multiply-add. Use it wherever the servo's frequency and
+ * pulse limits are fixed by the board:
+ *
+ *     hal::actuator::static_rc_servo<{
+ *       .frequency = 100,
+ *       .min_angle = 0,
+ *       .max_angle = 180,
+ *       .min_microseconds = 500,
+ *       .max_microseconds = 2500,
+ *     }> servo(pwm);
+ *
+ * @tparam config - RC servo settings
+ */
+template<rc_servo::settings config>
+class static_rc_servo : public hal::servo
+{
+public:
+  static_assert(config.frequency > 0, "Frequency must be above zero");
+  static_assert(config.min_angle < config.max_angle,
+                "Minimum angle must be below the maximum angle");
+
+  /**
+   * @brief Duty cycle of a position
+   *
+   * @param p_position - position within the servo's angles
+   * @return constexpr float - duty cycle between 0.0 and 1.0
+   */
+  static constexpr float duty_cycle(hal::degrees p_position)
+  {
+    return offset + slope * p_position;
+  }
+
+  /**
+   * @brief Create a static_rc_servo object.
+   *
+   * @param p_pwm - pwm signal connected to the RC servo
+   */
+  explicit static_rc_servo(hal::pwm& p_pwm)
+    : m_pwm(&p_pwm)
+  {
+    p_pwm.frequency(config.frequency);
+  }
+
+private:
+  // Calculate the wavelength in microseconds.
+  static constexpr float wavelength = std::micro::den / config.frequency;
+  static constexpr float min_percent = config.min_microseconds / wavelength;
+  static constexpr float max_percent = config.max_microseconds / wavelength;
+  static constexpr float slope =
+    (max_percent - min_percent) / (config.max_angle - config.min_angle);
+  static constexpr float offset = min_percent - slope * config.min_angle;
+
+  void driver_position(hal::degrees p_position) override
+  {
+    if (p_position < config.min_angle || p_position > config.max_angle) {
+      hal::safe_throw(hal::argument_out_of_domain(this));
+    }
+    m_pwm->duty_cycle(duty_cycle(p_position));
+  }
+
+  hal::pwm* m_pwm;
+};
+
+/**
+ * Fixed point math shared by rc_servo16 and rc_servo_group
+ */
+namespace rc_servo_fixed_point {
+/// Fractional bits of angles in Q16.16 degrees
+constexpr int angle_fraction_bits = 16;
+/// Fractional bits of the duty per angle slope
+constexpr int slope_fraction_bits = 32;
+/// Fractional bits of the duty per microsecond factor
+constexpr int pulse_fraction_bits = 16;
+
+/**
+ * @brief Convert an angle to Q16.16 degrees
  *
+ * Angles that do not fit in Q16.16 land on its limits, which are outside of
+ * any servo's range anyway.
+ *
+ * @param p_angle - angle to convert
+ * @return constexpr i32 - angle in Q16.16 degrees
+ */
+constexpr i32 to_angle(hal::degrees p_angle)
+{
+  constexpr float limit = 32767.0f;
+  auto const angle = std::clamp(static_cast<float>(p_angle), -limit, limit);
+  return static_cast<i32>(angle * (1 << angle_fraction_bits));
+}
+
+/**
+ * @brief Duty cycle of an angle, rounded to the nearest tick
+ *
+ * @param p_angle - angle in Q16.16 degrees
+ * @param p_min_angle - minimum angle of the servo in Q16.16 degrees
+ * @param p_min_duty - duty cycle of the minimum angle
+ * @param p_duty_per_angle - slope in Q32.32 duty per Q16.16 degree
+ * @return constexpr i64 - duty cycle, which rounding may put one tick
+ * outside of the servo's duty cycles
+ */
+constexpr i64 duty_of(i32 p_angle,
+                      i32 p_min_angle,
+                      u16 p_min_duty,
+                      i64 p_duty_per_angle)
+{
+  constexpr i64 half = i64{ 1 } << (slope_fraction_bits - 1);
+  auto const offset = static_cast<i64>(p_angle) - p_min_angle;
+  return p_min_duty +
+         ((offset * p_duty_per_angle + half) >> slope_fraction_bits);
+}
+}  // namespace rc_servo_fixed_point
+
+/**
+ * @brief Generic RC servo driver for 16-bit PWM channels.
+ *
+ * The mapping from angle to duty cycle is worked out once on construction as
+ * fixed point constants, so updating the position takes a few integer
+ * operations rather than a chain of float operations. This matters on
+ * targets without an FPU, where every float operation is a library call.
+ * Callers that already work in pulse widths or duty cycles can skip the
+ * angle conversion completely with pulse_width() and raw_duty_cycle().
  */
 class rc_servo16 : public hal::servo
 {
@@ -104,6 +233,33 @@ public:
     std::uint32_t max_microseconds = 2000;
   };
 
+  /// Fixed point constants that map positions to duty cycles
+  struct calibration
+  {
+    /// Limits of the servo's angle in Q16.16 degrees
+    std::pair<i32, i32> angle{};
+    /// Shortest and longest pulse widths in microseconds
+    std::pair<u32, u32> microseconds{};
+    /// Duty cycles of min_microseconds and max_microseconds
+    std::pair<u16, u16> duty{};
+    /// Change in duty cycle per Q16.16 degree above the minimum angle, in
+    /// Q32.32
+    i64 duty_per_angle = 0;
+    /// Duty cycle per microsecond of pulse width, in Q16.16
+    u32 duty_per_microsecond = 0;
+  };
+
+  /**
+   * @brief Work out the fixed point constants for a servo
+   *
+   * @param p_frequency - frequency of the PWM channel driving the servo
+   * @param p_settings - RC servo settings, the frequency is ignored
+   * @return calibration - constants for the servo
+   * @throws hal::argument_out_of_domain - if the minimum angle is not below
+   * the maximum angle.
+   */
+  static calibration calibrate(u32 p_frequency, settings const& p_settings);
+
   /**
    * @brief Create a rc_servo object.
    *
@@ -126,14 +282,28 @@ public:
              hal::strong_ptr<hal::pwm16_channel> const& p_pwm,
              settings const& p_settings);
 
+  /**
+   * @brief Move the servo by setting its pulse width directly
+   *
+   * @param p_width - width of the pulse sent to the servo
+   * @throws hal::argument_out_of_domain - if p_width is outside of the
+   * min_microseconds and max_microseconds of the settings.
+   */
+  void pulse_width(std::chrono::microseconds p_width);
+
+  /**
+   * @brief Write a duty cycle to the PWM channel without any conversion
+   *
+   * @param p_duty_cycle - duty cycle where 65535 is 100%
+   * @throws hal::argument_out_of_domain - if p_duty_cycle is outside of the
+   * duty cycles of min_microseconds and max_microseconds.
+   */
+  void raw_duty_cycle(u16 p_duty_cycle);
+
 private:
   void setup(hal::pwm16_channel& p_pwm, settings const& p_settings);
 
-  struct ranges
-  {
-    std::pair<u16, u16> percent{};
-    std::pair<float, float> angle{};
-  };
+  u16 clamp_duty(i64 p_duty) const;
 
   // Use override keyword to make it clear that this api is for virtual
   // functions
@@ -143,6 +313,6 @@ private:
   // Use a pointer here rather than a reference, because member references
   // implicitly delete move constructors
   hal::strong_ptr<hal::pwm16_channel> m_pwm;
-  ranges m_ranges{};
+  calibration m_calibration{};
 };
 }  // namespace hal::actuator
@@ -0,0 +1,217 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <span>
+
+#include <libhal-actuator/rc_servo.hpp>
+#include <libhal/error.hpp>
+#include <libhal/pointers.hpp>
+#include <libhal/pwm.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief RC servos on the channels of one PWM group, updated a frame at a time
+ *
+ * Each update takes one value per channel. Every value is checked and turned
+ * into a duty cycle before any channel is written, so a bad value leaves the
+ * whole frame unapplied, and the channels are then written back to back so
+ * they all change within the same PWM period. The calibrations are kept as
+ * one array per constant, which keeps each pass over the channels to a tight
+ * loop of integer math.
+ *
+ *     hal::actuator::rc_servo_group<16> gimbal(
+ *       manager, 50, channels, settings);
+ *     while (true) {
+ *       gimbal.position(next_frame());
+ *     }
+ *
+ * @tparam channel_count - number of servos in the group
+ */
+template<usize channel_count>
+class rc_servo_group
+{
+public:
+  static_assert(channel_count > 0, "A group needs at least one servo");
+
+  using settings = rc_servo16::settings;
+  using channels = std::array<hal::strong_ptr<hal::pwm16_channel>,
+                              channel_count>;
+
+  /**
+   * @brief Create a group and set the PWM group's frequency
+   *
+   * @param p_pwm_manager - pwm group manager of every channel in p_channels
+   * @param p_frequency - frequency to set the pwm group to
+   * @param p_channels - pwm channel of each servo
+   * @param p_settings - settings of each servo, their frequency is ignored
+   * @throws hal::argument_out_of_domain - if any servo's minimum angle is not
+   * below its maximum angle.
+   */
+  rc_servo_group(hal::pwm_group_manager& p_pwm_manager,
+                 u32 p_frequency,
+                 channels const& p_channels,
+                 std::span<settings const, channel_count> p_settings)
+    : m_channels(p_channels)
+  {
+    p_pwm_manager.frequency(p_frequency);
+    setup(p_settings);
+  }
+
+  /**
+   * @brief Create a group on channels whose frequency is already set
+   *
+   * @param p_channels - pwm channel of each servo
+   * @param p_settings - settings of each servo, their frequency is ignored
+   * @throws hal::argument_out_of_domain - if any servo's minimum angle is not
+   * below its maximum angle.
+   */
+  rc_servo_group(channels const& p_channels,
+                 std::span<settings const, channel_count> p_settings)
+    : m_channels(p_channels)
+  {
+    setup(p_settings);
+  }
+
+  /**
+   * @brief Move every servo to a new position
+   *
+   * @param p_positions - position of each servo
+   * @throws hal::argument_out_of_domain - if a position is outside of its
+   * servo's range. No channel is written.
+   */
+  void position(std::span<hal::degrees const, channel_count> p_positions)
+  {
+    std::array<u16, channel_count> frame{};
+    for (usize i = 0; i < channel_count; i++) {
+      auto const angle = rc_servo_fixed_point::to_angle(p_positions[i]);
+      if (angle < m_min_angle[i] || angle > m_max_angle[i]) {
+        hal::safe_throw(hal::argument_out_of_domain(this));
+      }
+      auto const duty = rc_servo_fixed_point::duty_of(
+        angle, m_min_angle[i], m_min_duty[i], m_duty_per_angle[i]);
+      frame[i] = clamp_duty(i, duty);
+    }
+    apply(frame);
+  }
+
+  /**
+   * @brief Set the pulse width of every servo directly
+   *
+   * @param p_widths - pulse width of each servo
+   * @throws hal::argument_out_of_domain - if a width is outside of its servo's
+   * min_microseconds and max_microseconds. No channel is written.
+   */
+  void pulse_width(std::span<std::chrono::microseconds const, channel_count>
+                     p_widths)
+  {
+    std::array<u16, channel_count> frame{};
+    for (usize i = 0; i < channel_count; i++) {
+      auto const width = p_widths[i].count();
+      if (width < m_shortest_pulse[i] || width > m_longest_pulse[i]) {
+        hal::safe_throw(hal::argument_out_of_domain(this));
+      }
+      auto const duty =
+        (static_cast<i64>(width) * m_duty_per_microsecond[i]) >>
+        rc_servo_fixed_point::pulse_fraction_bits;
+      frame[i] = clamp_duty(i, duty);
+    }
+    apply(frame);
+  }
+
+  /**
+   * @brief Write a duty cycle to every channel without any conversion
+   *
+   * @param p_duty_cycles - duty cycle of each servo where 65535 is 100%
+   * @throws hal::argument_out_of_domain - if a duty cycle is outside of the
+   * duty cycles of its servo's min_microseconds and max_microseconds. No
+   * channel is written.
+   */
+  void raw_duty_cycle(std::span<u16 const, channel_count> p_duty_cycles)
+  {
+    std::array<u16, channel_count> frame{};
+    for (usize i = 0; i < channel_count; i++) {
+      if (p_duty_cycles[i] < m_lowest_duty[i] ||
+          p_duty_cycles[i] > m_highest_duty[i]) {
+        hal::safe_throw(hal::argument_out_of_domain(this));
+      }
+      frame[i] = p_duty_cycles[i];
+    }
+    apply(frame);
+  }
+
+  /**
+   * @brief Duty cycles of the most recent frame
+   *
+   * @return std::span<u16 const, channel_count> - duty cycle of each servo
+   */
+  [[nodiscard]] std::span<u16 const, channel_count> frame() const
+  {
+    return m_frame;
+  }
+
+private:
+  void setup(std::span<settings const, channel_count> p_settings)
+  {
+    for (usize i = 0; i < channel_count; i++) {
+      auto const calibration =
+        rc_servo16::calibrate(m_channels[i]->frequency(), p_settings[i]);
+      m_min_angle[i] = calibration.angle.first;
+      m_max_angle[i] = calibration.angle.second;
+      m_shortest_pulse[i] = calibration.microseconds.first;
+      m_longest_pulse[i] = calibration.microseconds.second;
+      m_min_duty[i] = calibration.duty.first;
+      m_lowest_duty[i] =
+        std::min(calibration.duty.first, calibration.duty.second);
+      m_highest_duty[i] =
+        std::max(calibration.duty.first, calibration.duty.second);
+      m_duty_per_angle[i] = calibration.duty_per_angle;
+      m_duty_per_microsecond[i] = calibration.duty_per_microsecond;
+    }
+  }
+
+  u16 clamp_duty(usize p_channel, i64 p_duty) const
+  {
+    return static_cast<u16>(std::clamp<i64>(
+      p_duty, m_lowest_duty[p_channel], m_highest_duty[p_channel]));
+  }
+
+  /// Takes the frame only once every channel of it has been checked, so a
+  /// frame that throws leaves frame() unchanged
+  void apply(std::array<u16, channel_count> const& p_frame)
+  {
+    m_frame = p_frame;
+    for (usize i = 0; i < channel_count; i++) {
+      m_channels[i]->duty_cycle(m_frame[i]);
+    }
+  }
+
+  channels m_channels;
+  std::array<i32, channel_count> m_min_angle{};
+  std::array<i32, channel_count> m_max_angle{};
+  std::array<u32, channel_count> m_shortest_pulse{};
+  std::array<u32, channel_count> m_longest_pulse{};
+  std::array<u16, channel_count> m_min_duty{};
+  std::array<u16, channel_count> m_lowest_duty{};
+  std::array<u16, channel_count> m_highest_duty{};
+  std::array<i64, channel_count> m_duty_per_angle{};
+  std::array<u32, channel_count> m_duty_per_microsecond{};
+  std::array<u16, channel_count> m_frame{};
+};
+}  // namespace hal::actuator
@@ -0,0 +1,41 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief How a driver recovers from a request that received no response
+ *
+ * A request that times out is sent again until it has been sent `attempts`
+ * times or `budget` has passed since it was first sent, whichever comes
+ * first. The default sends every request once and throws if it is not
+ * answered, which is how the drivers behave without a policy.
+ */
+struct retry_policy
+{
+  /// @brief Number of times a request is sent before giving up, including the
+  /// first. 0 is treated as 1.
+  hal::u8 attempts = 1;
+  /// @brief Longest time spent on a request, including every retry. A retry
+  /// is not started once this has passed.
+  hal::time_duration budget = hal::time_duration::max();
+  /// @brief Throw hal::timed_out once every attempt has failed. If false, the
+  /// blocking APIs return a status instead. Drivers whose APIs never throw on
+  /// a missing response ignore this.
+  bool throw_on_failure = true;
+};
+}  // namespace hal::actuator
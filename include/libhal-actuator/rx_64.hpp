@@ -17,17 +17,12 @@
 // only once, no matter how many times it is included.
 #pragma once
 
-#include <chrono>
-#include <cstdint>
+#include <span>
 
-#include <array>
-#include <numeric>
-#include <utility>
-
-#include <libhal-util/serial.hpp>
-#include <libhal-util/steady_clock.hpp>
+#include <libhal-actuator/dynamixel_servo.hpp>
 #include <libhal/pointers.hpp>
 #include <libhal/serial.hpp>
+#include <libhal/steady_clock.hpp>
 #include <libhal/units.hpp>
 
 namespace hal::actuator {
@@ -41,344 +36,9 @@ namespace hal::actuator {
  * https://docs.robotis.com/docs/dxl/model_reference/rx_series/rx-64/
  *
  */
-class rx_64
+class rx_64 : public dynamixel_servo
 {
 public:
-  /**
-   * @brief Configuration object containing settings to use when constructing
-   * rx_64 object
-   *
-   */
-  struct config
-  {
-    /// @brief Baud rate to communicate with rx_64 over serial
-    hertz baud_rate = 57600;
-    /// @brief Id of rx_64
-    uint8_t id;
-    /// @brief Minimum angle to limit movement to
-    hal::degrees min_angle = 0;
-    /// @brief Maximum angle to limit movement to
-    hal::degrees max_angle = 300;
-    /// @brief Enable torque on setup
-    bool torque_enable = true;
-    /// @brief Time before assuming that there was an error response from the
-    /// motor
-    hal::time_duration response_timeout = std::chrono::milliseconds(50);
-  };
-
-  /**
-   * @brief Construct a new rx_64 object
-   *
-   * @param p_serial Serial to use to communicate with rx_64
-   * @param p_settings Configuration object containing settings to use
-   * @param p_clock A steady clock used to add delays for communication
-   */
-  rx_64(hal::strong_ptr<hal::serial> const& p_serial,
-        config const& p_settings,
-        hal::strong_ptr<hal::steady_clock> const& p_clock);
-
-  /**
-   * @brief Check if an ID is in use.
-   *
-   * @param p_id - ID to check.
-   * @param p_serial - Serial to use to communicate with rx_64
-   * @param p_clock - A steady clock used to add delays for communication
-   * @return true - Servo using this ID is present on bus.
-   * @return false - No connected servos using this ID.
-   */
-  static bool ping_id(uint8_t p_id,
-                      hal::strong_ptr<hal::serial> const& p_serial,
-                      hal::strong_ptr<hal::steady_clock> const& p_clock);
-
-  /**
-   * @brief Iterate through all valid IDs and return the first ID that is
-   * present. If none are found, 254 (the broadcast ID) will be returned.
-   *
-   * @param p_serial - Serial to use to communicate with rx_64
-   * @param p_clock - A steady clock used to add delays for communication
-   * @return u8 - ID of present servo or 254 if none found
-   */
-  static u8 scan_for_id(hal::strong_ptr<hal::serial> const& p_serial,
-                        hal::strong_ptr<hal::steady_clock> const& p_clock);
-
-  /**
-   * @brief Toggle LED on or off.
-   *
-   * @param p_on On status of LED to set.
-   */
-  void led(bool p_on);
-
-  /**
-   * @brief Moving status of rx_64.
-   *
-   * @return true - rx_64 is moving.
-   * @return false - rx_64 is not moving.
-   */
-  [[nodiscard]] bool is_moving();
-
-  /**
-   * @brief Get current speed in RPMs. Positive values indicate spinning
-   * clockwise. Negative values indicate spinning counter clockwise.
-   *
-   * @return rpm - Current moving speed in RPMs.
-   */
-  rpm speed();
-
-  /**
-   * @brief Get current voltage supplied.
-   *
-   * @return volts - Current voltage supplied.
-   */
-  volts voltage();
-
-  /**
-   * @brief Get the internal temperature.
-   *
-   * @return uint8_t - Temperature in Celsius.
-   */
-  uint8_t temperature();
-
-  /**
-   * @brief Get the maximum torque available.
-   *
-   * @return float - Maximum torque available as a percentage.
-   */
-  float torque_limit();
-
-  /**
-   * @brief Get the torque enabled flag.
-   *
-   * @return true - Torque usage enabled.
-   * @return false - Torque usage disabled.
-   */
-  bool torque_enable();
-
-  /**
-   * @brief Get the temperature limit before the Overheating Error flag is set
-   * to true.
-   *
-   * @return uint8_t - Temperature limit in Celsius.
-   */
-  uint8_t temperature_limit();
-
-  /**
-   * @brief Get the minimum operating voltage.
-   *
-   * @return volts - Minimum usable operating voltage.
-   */
-  volts min_voltage();
-
-  /**
-   * @brief Get the maximum operating voltage.
-   *
-   * @return volts - Maximum usable operating voltage.
-   */
-  volts max_voltage();
-
-  /**
-   * @brief Get the baud rate used for serial communication.
-   *
-   * @return hertz - Baud rate in Hertz.
-   */
-  hertz baud_rate();
-
-  /**
-   * @brief Get the time between sending an instruction and receiveing a status
-   * packet.
-   *
-   * @return std::chrono::microseconds - Time in microseconds to wait
-   * before sending status packet.
-   */
-  std::chrono::microseconds return_delay_time();
-
-  /**
-   * @brief Get the unique ID.
-   *
-   * @return uint8_t - ID of the servo
-   */
-  uint8_t id();
-
-  /**
-   * @brief Get the minimum angle to restrain motion to.
-   *
-   * @return hal::degrees - Minimum angle in degrees.
-   */
-  hal::degrees min_angle();
-
-  /**
-   * @brief Get the maximum angle to restrain motion to.
-   *
-   * @return hal::degrees - Maximum angle in degrees.
-   */
-  hal::degrees max_angle();
-
-  /**
-   * @brief Get the current position.
-   *
-   * @return hal::degrees - Current position in degrees.
-   */
-  hal::degrees position();
-
-  /**
-   * @brief Get the punch, or minimum current needed to operate.
-   *
-   * @return uint16_t - Minimum current needed to operate.
-   */
-  uint16_t punch();
-
-  /**
-   * @brief Get the current speed in RPMs.
-   *
-   * @return float - Current speed in RPMs.
-   */
-  rpm moving_speed();
-
-  /**
-   * @brief Move to position.
-   *
-   * Angle to move to must be within range of min and max angle.
-   *
-   * @param p_angle - Angle to move to.
-   */
-  void position(hal::degrees p_angle);
-
-  /**
-   * @brief Enable or disable torque usage.
-   *
-   * @param p_enable - Set to true to enable torque usage.
-   */
-  void torque_enable(bool p_enable);
-
-  /**
-   * @brief Set the maximum torque available to use.
-   *
-   * Range is 0.0 - 100.0, Values exceeding these bounds will be clamped to be
-   * 0.0 when lower and 100.0 when higher. Example: if 50% torque limit is
-   * desired, p_percent = 50.0
-   *
-   * @param p_percent - Percentage to set max torque to
-   */
-  void torque_limit(float p_percent);
-
-  /**
-   * @brief Set the maximum temperature.
-   *
-   * If internal temperature goes beyond this number, the Overheating Error flag
-   * is set to true. Range is 0.0 - 100.0, Values exceeding these bounds will be
-   * clamped to be 0.0 when lower and 100.0 when higher.
-   *
-   * @param p_temperature - Temperature in Celsius.
-   */
-  void temperature_limit(uint8_t p_temperature);
-
-  /**
-   * @brief Set the minimum operating voltage.
-   *
-   * If the input voltage is below this number, the Voltage Range Error flag is
-   * set to true. Range is 5.0 - 25.0, Values exceeding these bounds will be
-   * clamped to be 5.0 when lower and 25.0 when higher.
-   *
-   * @param p_voltage - Minimum operating voltage.
-   */
-  void min_voltage(volts p_voltage);
-
-  /**
-   * @brief Set the maximum operating voltage.
-   *
-   * If the input voltage is above this number, the Voltage Range Error flag is
-   * set to true. Range is 5.0 - 25.0, Values exceeding these bounds will be
-   * clamped to be 5.0 when lower and 25.0 when higher.
-   *
-   * @param p_voltage - Maximum operating voltage.
-   */
-  void max_voltage(volts p_voltage);
-
-  /**
-   * @brief Set the baud rate used for serial communication. Serial used to
-   * communicate will also be changed to match the baud rate.
-   *
-   * Available baud rates are: 57600, 9600, 19200, 115200, 200000, 250000,
-   * 400000, 500000, and 1000000. If an invalid baud rate is given, the default
-   * baud rate of 57600 is used.
-   *
-   * @param p_baud - Baud rate used for serial communication
-   */
-  void baud_rate(hertz p_baud);
-
-  /**
-   * @brief Set the time between sending an instruction and receiveing a status
-   * packet.
-   *
-   * Range is 0 - 508 microseconds. Values exceeding these bounds will be
-   * clamped to be 0 when lower and 508 when higher.
-   *
-   * @param p_microseconds - Time in microseconds to wait
-   */
-  void return_delay_time(std::chrono::microseconds p_microseconds);
-
-  /**
-   * @brief Reassign the ID to use when communicating.
-   *
-   * Range is 0 - 253. ID 254 is reserved as the broadcast ID.
-   *
-   * @param p_id - ID to use.
-   */
-  void reassign_id(uint8_t p_id);
-
-  /**
-   * @brief Set the minimum angle to restrain motion to.
-   *
-   * Range of motion is 0.0 - 300.0, Values exceeding these bounds will be
-   * clamped to be 0.0 when lower and 300.0 when higher.
-   *
-   * @param p_angle - Minimum angle used to restrain motion to.
-   */
-  void min_angle(hal::degrees p_angle);
-
-  /**
-   * @brief Set the maximum angle to restrain motion to.
-   *
-   * Range of motion is 0.0 - 300.0, Values exceeding these bounds will be
-   * clamped to be 0.0 when lower and 300.0 when higher.
-   *
-   * @param p_angle - Maximum angle used to restrain motion to.
-   */
-  void max_angle(hal::degrees p_angle);
-
-  /**
-   * @brief Set the speed to use when moving.
-   *
-   * Range is 0 - 114 RPM. Values exceeding these bounds will be clamped to be 0
-   * when lower and 114 when higher.
-   *
-   * @param p_rpms - Speed in RPM to use when moving
-   */
-  void speed(rpm p_rpms);
-
-  /**
-   * @brief Move attached opposing servos together.
-   *
-   * Range of motion must be within min and max angles.
-   *
-   * @param p_angle - Angle to set the leading servo to.
-   * @param p_opposing_servo - Opposing servo to send reversed angles to.
-   */
-  void sync_position(hal::degrees p_angle, rx_64 p_opposing_servo);
-
-  /**
-   * @brief Returns the last error code retrieved from the servo motor
-   *
-   * See https://docs.robotis.com/docs/dxl/protocol/protocol1/#error for error
-   * code information.
-   *
-   * @return auto - error code byte
-   */
-  [[nodiscard]] auto last_error_code() const
-  {
-    return m_last_error;
-  }
-
-private:
   /**
    * @brief Addresses for registers of rx_64
    *
@@ -455,88 +115,123 @@ private:
     punch = 0x30
   };
 
-  template<usize Size>
-  auto read_register(register_byte p_register_address)
-  {
-    using namespace std::chrono_literals;
+  /// @brief Configuration object containing settings to use when constructing
+  /// rx_64 object
+  using config = dynamixel_servo::config;
 
-    auto const address = static_cast<hal::byte>(p_register_address);
-    auto const size_byte = static_cast<hal::byte>(Size);
+  /**
+   * @brief Construct a new rx_64 object
+   *
+   * @param p_serial Serial to use to communicate with rx_64
+   * @param p_settings Configuration object containing settings to use
+   * @param p_clock A steady clock used to time out responses
+   */
+  rx_64(hal::strong_ptr<hal::serial> const& p_serial,
+        config const& p_settings,
+        hal::strong_ptr<hal::steady_clock> const& p_clock);
 
-    std::array<hal::byte, 8> send_bytes = { 0xFF, 0xFF,    m_id,      0x04,
-                                            0x02, address, size_byte, 0x00 };
-    hal::byte const checksum =
-      std::accumulate(&send_bytes[2], &send_bytes[7], 0);
-    send_bytes[7] = ~checksum;
-    hal::write(*m_serial, send_bytes, hal::never_timeout());
-    std::array<hal::byte, Size> return_array{};
+  using dynamixel_servo::read_telemetry;
+  using dynamixel_servo::sync_position;
+  using dynamixel_servo::sync_write;
 
-    try {
-      auto constexpr read_size = 6 + Size;
+  /**
+   * @brief Send the configuration of rx_64 servos constructed with
+   * deferred_setup
+   *
+   * See dynamixel_servo::setup().
+   *
+   * @param p_servos - Servos to configure
+   * @return usize - Number of servos that confirmed their settings
+   * @throws hal::argument_out_of_domain - if more servos are given than fit in
+   * a single SYNC_WRITE packet (50 servos).
+   */
+  static usize setup(std::span<rx_64* const> p_servos);
 
-      auto const response = hal::read<read_size>(
-        *m_serial, hal::create_timeout(*m_clock, m_response_timeout));
-      if (response[0] == 0xFF && response[1] == 0xFF) {
-        // device responded
-        // TODO(#47): check for errors
-        // TODO(#48): check checksum
-        for (usize i = 0; i < Size; i++) {
-          return_array[i] = response[5 + i];
-        }
-        return return_array;
-      }
-    } catch (hal::timed_out const&) {
-      return return_array;
-    }
-    return return_array;
-  }
+  /**
+   * @brief Read the telemetry of many servos, one block read each
+   *
+   * The rx_64 does not support BULK_READ, so each servo is sent a single READ
+   * of its present_* block, which replaces four single register reads. Servos
+   * that fail to respond keep their previous telemetry.
+   *
+   * @param p_servos - Servos to read
+   * @return usize - Number of servos whose telemetry was updated.
+   */
+  static usize read_telemetry(std::span<rx_64* const> p_servos);
 
-  template<usize Size>
-  void write_register(register_byte p_register_address,
-                      std::array<hal::byte, Size> p_data)
-  {
-    constexpr hal::byte packet_length = 0x03 + Size;
-    auto const address = static_cast<hal::byte>(p_register_address);
-    std::array<hal::byte, 6> header_bytes = { 0xFF,          0xFF, m_id,
-                                              packet_length, 0x03, address };
+  /**
+   * @brief Apply the staged writes of many rx_64 servos at the same instant
+   *
+   * See dynamixel_servo::commit().
+   *
+   * @param p_servos - Servos whose staged writes are committed
+   */
+  static void commit(std::span<rx_64* const> p_servos);
 
-    hal::byte checksum =
-      std::accumulate(header_bytes.begin() + 2, header_bytes.end(), 0);
-    checksum = std::accumulate(p_data.begin(), p_data.end(), checksum);
-    checksum = ~checksum;
+  /**
+   * @brief Move a chain of rx_64 servos and the host serial to a new baud rate
+   *
+   * See dynamixel_servo::migrate_baud_rate().
+   *
+   * @param p_servos - Servos of the chain
+   * @param p_baud - Baud rate to move to
+   * @return true - every servo answered at p_baud
+   * @return false - a servo did not answer, the chain is back at its previous
+   * rate
+   * @throws hal::argument_out_of_domain - if p_baud is not supported.
+   */
+  static bool migrate_baud_rate(std::span<rx_64* const> p_servos, hertz p_baud);
 
-    m_last_error = 0;
-    try {
-      do {
-        hal::write(*m_serial, header_bytes, hal::never_timeout());
-        hal::write(*m_serial, p_data, hal::never_timeout());
-        hal::write(*m_serial, std::array{ checksum }, hal::never_timeout());
+  /**
+   * @brief Write a 2-byte register on many servos with one SYNC_WRITE packet
+   *
+   * Intended for registers such as goal_position, moving_speed and
+   * torque_limit. Servos do not send a status packet for SYNC_WRITE, so this
+   * returns as soon as the packet has been written.
+   *
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_register - Address of the register to write
+   * @param p_ids - IDs of the servos to write
+   * @param p_values - Raw register value for each servo in p_ids
+   * @throws hal::argument_out_of_domain - if p_ids and p_values differ in size
+   * or there are too many servos to fit in a single packet (83 servos).
+   */
+  static void sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                         register_byte p_register,
+                         std::span<hal::u8 const> p_ids,
+                         std::span<hal::u16 const> p_values);
 
-        auto const response = hal::read<6>(
-          *m_serial, hal::create_timeout(*m_clock, m_response_timeout));
-        if (response[0] == 0xFF && response[1] == 0xFF) {
-          // device responded
-          hal::byte received_chksm =
-            std::accumulate(&response[2], &response[4], 0);
-          received_chksm = ~received_chksm;
-          m_last_error = response[4];
-          if (received_chksm == response[5]) {
-            // checksum match
-            // TODO(#47): check for errors
-          }
-        }
-        // check if the last error had a checksum error
-      } while (m_last_error & (1 << 4));
-    } catch (hal::timed_out const&) {
-      return;
-    }
-  }
+  /**
+   * @brief Write a 1-byte register on many servos with one SYNC_WRITE packet
+   *
+   * Intended for registers such as torque_enable and led_toggle.
+   *
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_register - Address of the register to write
+   * @param p_ids - IDs of the servos to write
+   * @param p_values - Raw register value for each servo in p_ids
+   * @throws hal::argument_out_of_domain - if p_ids and p_values differ in size
+   * or there are too many servos to fit in a single packet (125 servos).
+   */
+  static void sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                         register_byte p_register,
+                         std::span<hal::u8 const> p_ids,
+                         std::span<hal::byte const> p_values);
 
-  hal::strong_ptr<hal::serial> m_serial;
-  hal::strong_ptr<hal::steady_clock> m_clock;
-  std::pair<hal::degrees, hal::degrees> m_range;
-  hal::time_duration m_response_timeout;
-  hal::byte m_id;
-  hal::byte m_last_error;
+  /**
+   * @brief Move many servos with a single SYNC_WRITE packet
+   *
+   * Angles are clamped to the full range of motion of the servo. Per servo
+   * angle limits are still enforced by the servos themselves.
+   *
+   * @param p_serial - Serial to use to communicate with the servos
+   * @param p_ids - IDs of the servos to move
+   * @param p_angles - Angle to move each servo in p_ids to
+   * @throws hal::argument_out_of_domain - if p_ids and p_angles differ in size
+   * or there are too many servos to fit in a single packet.
+   */
+  static void sync_position(hal::strong_ptr<hal::serial> const& p_serial,
+                            std::span<hal::u8 const> p_ids,
+                            std::span<hal::degrees const> p_angles);
 };
 }  // namespace hal::actuator
@@ -0,0 +1,114 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <libhal/can.hpp>
+#include <libhal/functional.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief Routes messages from one CAN transceiver to every RMD driver on it
+ *
+ * Without a dispatcher, each RMD driver scans the transceiver's receive buffer
+ * on its own, so with N motors on a bus each message is inspected N times. The
+ * dispatcher walks the receive buffer once and hands each message directly to
+ * the driver registered for its ID, using the message ID as a table index.
+ *
+ * Messages can also be fed in from a receive interrupt or a dedicated thread
+ * using `route()`. Do not mix `route()` and `poll()` for the same messages, as
+ * that will deliver each message twice.
+ */
+class rmd_can_dispatcher
+{
+public:
+  /// Signature of the function called for each message routed to a driver
+  using handler = hal::callback<void(hal::can_message const&)>;
+
+  /// Number of device IDs addressable by RMD motors (0x140 to 0x160)
+  static constexpr std::size_t max_devices = 33;
+
+  /**
+   * @brief Create a dispatcher for the bus connected to the transceiver
+   *
+   * @param p_transceiver - can transceiver connected to the bus with the RMD
+   * motors on it.
+   * @param p_filter - identifier filter to allow the responses of each
+   * registered motor to be received.
+   */
+  rmd_can_dispatcher(hal::can_transceiver& p_transceiver,
+                     hal::can_identifier_filter& p_filter);
+
+  rmd_can_dispatcher(rmd_can_dispatcher&) = delete;
+  rmd_can_dispatcher& operator=(rmd_can_dispatcher&) = delete;
+  rmd_can_dispatcher(rmd_can_dispatcher&&) noexcept = delete;
+  rmd_can_dispatcher& operator=(rmd_can_dispatcher&&) noexcept = delete;
+
+  /**
+   * @brief Register a handler for the responses of a device
+   *
+   * The identifier filter is updated to allow the response ID through.
+   *
+   * @param p_response_id - ID of the messages the device responds with. MC-X
+   * devices respond with their device ID + 0x100, DRC devices respond with
+   * their device ID.
+   * @param p_handler - function called for each message with this ID
+   * @throws hal::argument_out_of_domain - if the ID does not belong to an RMD
+   * device.
+   * @throws hal::device_or_resource_busy - if a handler is already registered
+   * for this device.
+   */
+  void attach(hal::u32 p_response_id, handler p_handler);
+
+  /**
+   * @brief Remove the handler for the responses of a device
+   *
+   * @param p_response_id - response ID passed to `attach()`
+   */
+  void detach(hal::u32 p_response_id);
+
+  /**
+   * @brief Route every message received since the last call to its handler
+   *
+   * This function does not block.
+   */
+  void poll();
+
+  /**
+   * @brief Route a single message to its handler
+   *
+   * Messages for IDs without a handler are dropped.
+   *
+   * @param p_message - message received from the bus
+   */
+  void route(hal::can_message const& p_message);
+
+  /**
+   * @brief Access the transceiver the dispatcher receives from
+   *
+   * @return hal::can_transceiver& - transceiver used by the dispatcher
+   */
+  hal::can_transceiver& transceiver();
+
+private:
+  std::array<handler, max_devices> m_handlers{};
+  hal::can_transceiver* m_transceiver;
+  hal::can_identifier_filter* m_filter;
+  std::size_t m_receive_cursor;
+};
+}  // namespace hal::actuator
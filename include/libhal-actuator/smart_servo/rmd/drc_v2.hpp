@@ -14,12 +14,23 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
-
+#include <memory_resource>
+#include <span>
+
+#include <libhal-actuator/adapter_pool.hpp>
+#include <libhal-actuator/adaptive_timeout.hpp>
+#include <libhal-actuator/retry_policy.hpp>
+#include <libhal-actuator/smart_servo/rmd/can_dispatcher.hpp>
+#include <libhal-actuator/smart_servo/rmd/feedback_store.hpp>
+#include <libhal-actuator/smart_servo/rmd/protocol.hpp>
+#include <libhal-actuator/transaction_recorder.hpp>
 #include <libhal-util/can.hpp>
 #include <libhal/angular_velocity_sensor.hpp>
 #include <libhal/can.hpp>
 #include <libhal/motor.hpp>
+#include <libhal/pointers.hpp>
 #include <libhal/rotation_sensor.hpp>
 #include <libhal/servo.hpp>
 #include <libhal/steady_clock.hpp>
@@ -94,16 +105,20 @@ public:
     running = 0x88,
   };
 
+  /// State of the requests issued through the `*_async()` APIs
+  using request_status = rmd_request_status;
+
   /// Structure containing all of the forms of feedback acquired by an RMD-X
   /// motor
   struct feedback_t
   {
-    /// Every time a message from our motor is received this number increments.
+    /// Raw multi-turn angle (0.01°/LSB), placed first so that no padding is
+    /// needed before it
+    std::int64_t raw_multi_turn_angle{ 0 };
+    /// Every time a response from our motor is decoded this number increments.
     /// This can be used to indicate if the feedback has updated since the last
     /// time it was read.
     std::uint32_t message_number = 0;
-    /// Raw multi-turn angle (0.01°/LSB)
-    std::int64_t raw_multi_turn_angle{ 0 };
     /// Current flowing through the motor windings
     /// (-2048 <-> 2048 ==> -33A <-> 33A)
     std::int16_t raw_current{ 0 };
@@ -117,6 +132,28 @@ public:
     std::int8_t raw_motor_temperature{ 0 };
     /// 8-bit value containing error flag information
     std::uint8_t raw_error_state{ 0 };
+    /// Uptime of the driver's clock when each group of fields was last
+    /// updated by a response, 0 if it has not been updated yet. Fields are
+    /// always decoded together with the rest of their group, so one time per
+    /// group is kept rather than one per field.
+    struct updated_t
+    {
+      /// raw_volts, raw_error_state and raw_motor_temperature
+      hal::u64 status_1 = 0;
+      /// raw_current, raw_speed, encoder and raw_motor_temperature, returned
+      /// by status_2 and every actuation command
+      hal::u64 status_2 = 0;
+      /// raw_multi_turn_angle
+      hal::u64 multi_turn_angle = 0;
+
+      /// @return hal::u64 - last update of raw_motor_temperature, which both
+      /// status groups carry
+      [[nodiscard]] constexpr hal::u64 motor_temperature() const noexcept
+      {
+        return std::max(status_1, status_2);
+      }
+    };
+    updated_t updated{};
 
     [[nodiscard]] hal::ampere current() const noexcept;
     [[nodiscard]] hal::rpm speed() const noexcept;
@@ -160,11 +197,26 @@ public:
     rotation_sensor& operator=(rotation_sensor&&) = default;
     ~rotation_sensor() override = default;
 
+    /**
+     * @brief Set how old the feedback may be before a read requests new data
+     *
+     * Feedback that was updated by any response within p_max_age, such as the
+     * response to a control command, is returned without a request. The
+     * default of zero sends a request on every read.
+     *
+     * @param p_max_age - oldest feedback that is returned without a request
+     */
+    void max_age(hal::time_duration p_max_age)
+    {
+      m_max_age = p_max_age;
+    }
+
   private:
     friend class rmd_drc_v2;
     rotation_sensor(rmd_drc_v2& p_drc);
     hal::rotation_sensor::read_t driver_read() override;
     rmd_drc_v2* m_drc = nullptr;
+    hal::time_duration m_max_age{};
   };
 
   /**
@@ -180,11 +232,26 @@ public:
     temperature_sensor& operator=(temperature_sensor&&) = default;
     ~temperature_sensor() override = default;
 
+    /**
+     * @brief Set how old the feedback may be before a read requests new data
+     *
+     * Feedback that was updated by any response within p_max_age, such as the
+     * response to a control command, is returned without a request. The
+     * default of zero sends a request on every read.
+     *
+     * @param p_max_age - oldest feedback that is returned without a request
+     */
+    void max_age(hal::time_duration p_max_age)
+    {
+      m_max_age = p_max_age;
+    }
+
   private:
     friend class rmd_drc_v2;
     temperature_sensor(rmd_drc_v2& p_drc);
     celsius driver_read() override;
     rmd_drc_v2* m_drc = nullptr;
+    hal::time_duration m_max_age{};
   };
 
   /**
@@ -243,11 +310,26 @@ public:
     angular_velocity_sensor& operator=(angular_velocity_sensor&&) = default;
     ~angular_velocity_sensor() override = default;
 
+    /**
+     * @brief Set how old the feedback may be before a read requests new data
+     *
+     * Feedback that was updated by any response within p_max_age, such as the
+     * response to a control command, is returned without a request. The
+     * default of zero sends a request on every read.
+     *
+     * @param p_max_age - oldest feedback that is returned without a request
+     */
+    void max_age(hal::time_duration p_max_age)
+    {
+      m_max_age = p_max_age;
+    }
+
   private:
     friend class rmd_drc_v2;
     angular_velocity_sensor(rmd_drc_v2& p_drc);
     hal::rpm driver_read() override;
     rmd_drc_v2* m_drc = nullptr;
+    hal::time_duration m_max_age{};
   };
 
   /**
@@ -263,7 +345,8 @@ public:
    * @param p_clock - clocked used to determine timeouts
    * @param p_gear_ratio - gear ratio of the motor
    * @param p_max_response_time - maximum amount of time to wait for a response
-   * from the motor.
+   * from the motor. Once responses have been measured, requests time out after
+   * the measured round trip time plus its jitter, see round_trip_statistics().
    * @throws hal::timed_out - if the p_max_response_time is exceeded
    */
   rmd_drc_v2(
@@ -274,11 +357,54 @@ public:
     hal::u32 p_device_id,
     hal::time_duration p_max_response_time = std::chrono::milliseconds(10));
 
+  /**
+   * @brief Create a new device driver drc on a shared bus
+   *
+   * Responses are routed to this driver by the dispatcher rather than the
+   * driver scanning the transceiver's receive buffer itself. This factory
+   * function will power cycle the motor.
+   *
+   * @param p_dispatcher - dispatcher for the bus the motor is on. Its lifetime
+   * must exceed the lifetime of this driver.
+   * @param p_clock - clocked used to determine timeouts
+   * @param p_gear_ratio - gear ratio of the motor
+   * @param p_device_id - The CAN ID of the motor
+   * @param p_max_response_time - maximum amount of time to wait for a response
+   * from the motor. Once responses have been measured, requests time out after
+   * the measured round trip time plus its jitter, see round_trip_statistics().
+   * @throws hal::timed_out - if the p_max_response_time is exceeded
+   * @throws hal::device_or_resource_busy - if another driver on the dispatcher
+   * already uses p_device_id.
+   */
+  rmd_drc_v2(
+    rmd_can_dispatcher& p_dispatcher,
+    hal::steady_clock& p_clock,
+    float p_gear_ratio,
+    hal::u32 p_device_id,
+    hal::time_duration p_max_response_time = std::chrono::milliseconds(10));
+
+  /**
+   * @brief Memory for the adapters returned by the acquire_*2() functions
+   *
+   * Each slot fits any one adapter, so the pool holds count adapters of any
+   * mix of types at once and reuses a slot when its adapter is released.
+   *
+   * @tparam count - most adapters alive at once
+   */
+  template<hal::usize count>
+  using adapter_pool =
+    hal::actuator::adapter_pool<adapter_slot_size<rotation_sensor,
+                                                  temperature_sensor,
+                                                  motor,
+                                                  servo,
+                                                  angular_velocity_sensor>,
+                                count>;
+
   rmd_drc_v2(rmd_drc_v2&) = delete;
   rmd_drc_v2& operator=(rmd_drc_v2&) = delete;
   rmd_drc_v2(rmd_drc_v2&&) noexcept = delete;
   rmd_drc_v2& operator=(rmd_drc_v2&&) noexcept = delete;
-  ~rmd_drc_v2() = default;
+  ~rmd_drc_v2();
 
   /**
    * @brief Create a hal::rotation_sensor driver using the drc driver
@@ -288,7 +414,17 @@ public:
    * object.
    */
   rotation_sensor acquire_rotation_sensor();
-  hal::v5::strong_ptr<hal::rotation_sensor> acquire_rotation_sensor2();
+
+  /**
+   * @brief Create a shared hal::rotation_sensor driver using the drc driver
+   *
+   * @param p_allocator - allocator for the adapter, such as an adapter_pool
+   * @return hal::v5::strong_ptr<hal::rotation_sensor> - rotation sensor
+   * implementation based on the drc driver. This object's lifetime must
+   * exceed the lifetime of the returned object.
+   */
+  hal::v5::strong_ptr<hal::rotation_sensor> acquire_rotation_sensor2(
+    std::pmr::polymorphic_allocator<> p_allocator);
 
   /**
    * @brief Create a hal::temperature_sensor driver using the drc driver
@@ -298,7 +434,17 @@ public:
    * returned object.
    */
   temperature_sensor acquire_temperature_sensor();
-  hal::v5::strong_ptr<hal::temperature_sensor> acquire_temperature_sensor2();
+
+  /**
+   * @brief Create a shared hal::temperature_sensor driver using the drc driver
+   *
+   * @param p_allocator - allocator for the adapter, such as an adapter_pool
+   * @return hal::v5::strong_ptr<hal::temperature_sensor> - temperature sensor
+   * implementation based on the drc driver. This object's lifetime must
+   * exceed the lifetime of the returned object.
+   */
+  hal::v5::strong_ptr<hal::temperature_sensor> acquire_temperature_sensor2(
+    std::pmr::polymorphic_allocator<> p_allocator);
 
   /**
    * @brief Create a hal::motor implementation from the drc driver
@@ -309,7 +455,20 @@ public:
    * This object's lifetime must exceed the lifetime of the returned object.
    */
   motor acquire_motor(hal::rpm p_max_speed);
-  hal::v5::strong_ptr<hal::motor> acquire_motor2(hal::rpm p_max_speed);
+
+  /**
+   * @brief Create a shared hal::motor implementation from the drc driver
+   *
+   * @param p_allocator - allocator for the adapter, such as an adapter_pool
+   * @param p_max_speed - maximum speed of the motor represented by +1.0 and
+   * -1.0
+   * @return hal::v5::strong_ptr<hal::motor> - motor implementation based on
+   * the drc driver. This object's lifetime must exceed the lifetime of the
+   * returned object.
+   */
+  hal::v5::strong_ptr<hal::motor> acquire_motor2(
+    std::pmr::polymorphic_allocator<> p_allocator,
+    hal::rpm p_max_speed);
 
   /**
    * @brief Create a hal::servo driver using the drc driver
@@ -319,7 +478,19 @@ public:
    * object's lifetime must exceed the lifetime of the returned object.
    */
   servo acquire_servo(hal::rpm p_max_speed);
-  hal::v5::strong_ptr<hal::servo> acquire_servo2(hal::rpm p_max_speed);
+
+  /**
+   * @brief Create a shared hal::servo driver using the drc driver
+   *
+   * @param p_allocator - allocator for the adapter, such as an adapter_pool
+   * @param p_max_speed - maximum speed of the servo when moving to an angle
+   * @return hal::v5::strong_ptr<hal::servo> - servo implementation based on
+   * the drc driver. This object's lifetime must exceed the lifetime of the
+   * returned object.
+   */
+  hal::v5::strong_ptr<hal::servo> acquire_servo2(
+    std::pmr::polymorphic_allocator<> p_allocator,
+    hal::rpm p_max_speed);
 
   /**
    * @brief Create a hal::angular_velocity_sensor driver using the drc driver
@@ -329,17 +500,29 @@ public:
    * the returned object.
    */
   angular_velocity_sensor acquire_angular_velocity_sensor();
+
+  /**
+   * @brief Create a shared hal::angular_velocity_sensor using the drc driver
+   *
+   * @param p_allocator - allocator for the adapter, such as an adapter_pool
+   * @return hal::v5::strong_ptr<hal::angular_velocity_sensor> - angular
+   * velocity sensor implementation based on the drc driver. This object's
+   * lifetime must exceed the lifetime of the returned object.
+   */
   hal::v5::strong_ptr<hal::angular_velocity_sensor>
-  acquire_angular_velocity_sensor2();
+  acquire_angular_velocity_sensor2(
+    std::pmr::polymorphic_allocator<> p_allocator);
 
   /**
    * @brief Request feedback from the motor
    *
    * @param p_command - the request to command the motor to respond with
-   * @throws hal::timed_out - if a response is not returned within the max
-   * response time set at creation.
+   * @return request_status - complete, or timed_out if the motor did not
+   * respond and the retry policy does not throw.
+   * @throws hal::timed_out - if no response is returned for any attempt of the
+   * retry policy and the policy throws on failure.
    */
-  void feedback_request(read p_command);
+  request_status feedback_request(read p_command);
 
   /**
    * @brief Rotate motor shaft at the designated speed
@@ -347,30 +530,104 @@ public:
    * @param p_speed - speed in rpm to move the motor shaft at. Positive values
    * rotate the motor shaft clockwise, negative values rotate the motor shaft
    * counter-clockwise assuming you are looking directly at the motor shaft.
-   * @throws hal::timed_out - if a response is not returned within the max
-   * response time set at creation.
+   * @return request_status - complete, or timed_out if the motor did not
+   * respond and the retry policy does not throw.
+   * @throws hal::timed_out - if no response is returned for any attempt of the
+   * retry policy and the policy throws on failure.
    */
-  void velocity_control(rpm p_speed);
+  request_status velocity_control(rpm p_speed);
 
   /**
    * @brief Move motor shaft to a specific angle
    *
    * @param p_angle - angle position in degrees to move to
    * @param p_speed - maximum speed in rpm's
-   * @throws hal::timed_out - if a response is not returned within the max
-   * response time set at creation.
+   * @return request_status - complete, or timed_out if the motor did not
+   * respond and the retry policy does not throw.
+   * @throws hal::timed_out - if no response is returned for any attempt of the
+   * retry policy and the policy throws on failure.
    */
-  void position_control(degrees p_angle, rpm p_speed);
+  request_status position_control(degrees p_angle, rpm p_speed);
 
   /**
    * @brief Send system control commands to the device
    *
    * @param p_system_command - system control command to send to the device
    * status.
-   * @throws hal::timed_out - if a response is not returned within the max
-   * response time set at creation.
+   * @return request_status - complete, or timed_out if the motor did not
+   * respond and the retry policy does not throw.
+   * @throws hal::timed_out - if no response is returned for any attempt of the
+   * retry policy and the policy throws on failure.
    */
-  void system_control(system p_system_command);
+  request_status system_control(system p_system_command);
+
+  /**
+   * @brief Request feedback from the motor without waiting for the response
+   *
+   * The response is decoded into `feedback()` when it is received by `poll()`.
+   *
+   * @param p_command - the request to command the motor to respond with
+   */
+  void feedback_request_async(read p_command);
+
+  /**
+   * @brief Non-blocking version of `velocity_control()`
+   *
+   * @param p_speed - speed in rpm to move the motor shaft at.
+   */
+  void velocity_control_async(rpm p_speed);
+
+  /**
+   * @brief Non-blocking version of `position_control()`
+   *
+   * @param p_angle - angle position in degrees to move to
+   * @param p_speed - maximum speed in rpm's
+   */
+  void position_control_async(degrees p_angle, rpm p_speed);
+
+  /**
+   * @brief Non-blocking version of `system_control()`
+   *
+   * @param p_system_command - system control command to send to the device
+   */
+  void system_control_async(system p_system_command);
+
+  /**
+   * @brief Stop every motor of a fleet without waiting for any response
+   *
+   * The command frame of every motor is handed to the transceiver back to
+   * back, before any response is waited on, so the last motor is stopped
+   * within rmd_wire_time(p_motors.size(), baud rate) of the call. At 1Mbps
+   * that is 135us per motor. A motor whose frame cannot be sent does not hold
+   * up the motors after it.
+   *
+   * Every request still waiting on a response from a motor is cancelled
+   * before its stop is sent, so no earlier command is sent again after it.
+   * Each motor's acknowledgement is collected afterwards by its `poll()`,
+   * which also sends the stop again if the motor does not answer, as set by
+   * its retry policy.
+   *
+   * @param p_motors - motors to stop
+   * @param p_command - stop to send, system::off to let the motors freewheel
+   * @return hal::usize - number of motors whose frame was sent
+   */
+  static hal::usize emergency_stop(std::span<rmd_drc_v2* const> p_motors,
+                                   system p_command = system::stop) noexcept;
+
+  /**
+   * @brief Process any received responses and report the state of requests
+   *
+   * This function never blocks. Each request sent gets its own deadline of
+   * the max response time set at creation, and is completed by the response
+   * that echoes its command. A request whose deadline passes is sent again
+   * or dropped, as set by the retry policy, without touching the other
+   * requests. Once no request is outstanding, `request_status::timed_out` is
+   * returned if any of them was dropped, until the next request is sent.
+   * dropped_requests() names the requests that were dropped.
+   *
+   * @return request_status - state of the outstanding requests
+   */
+  [[nodiscard]] request_status poll();
 
   /**
    * @brief Returns a reference to the internal feedback
@@ -379,19 +636,142 @@ public:
    */
   [[nodiscard]] feedback_t const& feedback() const;
 
+  /**
+   * @brief Round trip times measured from this motor's responses
+   *
+   * @return adaptive_timeout::statistics const& - round trip statistics
+   */
+  [[nodiscard]] adaptive_timeout::statistics const& round_trip_statistics()
+    const;
+
+  /**
+   * @brief Change how long responses from this motor are waited for
+   *
+   * The ceiling starts out as the max response time given at creation.
+   *
+   * @param p_settings - ceiling, margin and whether the timeout adapts
+   */
+  void tune_response_timeout(adaptive_timeout::settings const& p_settings);
+
+  /**
+   * @brief Set how requests that receive no response are recovered from
+   *
+   * A timed out request is sent again by `poll()`, so the async APIs and the
+   * blocking APIs both follow the policy. Each outstanding request is sent
+   * again on its own deadline. The constructor always uses the default
+   * policy.
+   *
+   * @param p_policy - number of attempts, latency budget and whether the
+   * blocking APIs throw once every attempt has failed
+   */
+  void retry(retry_policy const& p_policy);
+
+  /**
+   * @brief Get the retry policy
+   *
+   * @return retry_policy const& - the retry policy in use
+   */
+  [[nodiscard]] retry_policy const& retry() const;
+
+  /**
+   * @brief Record the timing of every request sent to this motor
+   *
+   * A request is recorded once its response arrives or its last retry times
+   * out. Byte counts are of CAN payload bytes.
+   *
+   * @param p_recorder - recorder to add transactions to, or nullptr to stop
+   * recording. Its lifetime must exceed the lifetime of this object or the
+   * next call to this function.
+   */
+  void instrument(transaction_recorder* p_recorder);
+
+  /**
+   * @brief Append every frame received from this motor to a telemetry log
+   *
+   * Frames are appended raw as they are handled, so the log must be drained
+   * faster than handle_message() is called, or frames are dropped.
+   *
+   * @param p_log - log to append frames to, or nullptr to stop logging. Its
+   * lifetime must exceed the lifetime of this object or the next call to this
+   * function.
+   */
+  void log_telemetry(telemetry_log* p_log);
+
+  /**
+   * @brief Number of messages from this motor that could not be decoded
+   *
+   * Messages that are not 8 bytes long or that start with an unknown command
+   * are dropped and counted here rather than in the feedback's
+   * message_number.
+   *
+   * @return hal::u32 - messages dropped since creation
+   */
+  [[nodiscard]] hal::u32 decode_errors() const;
+
+  /**
+   * @brief Commands of the requests that timed out on every attempt
+   *
+   * When `poll()` returns `request_status::timed_out`, this names each
+   * request that was dropped, as its command byte, for example
+   * `hal::value(read::status_2)`. Cleared by the next request sent once no
+   * request is outstanding.
+   *
+   * @return std::span<hal::byte const> - command byte of each dropped request
+   */
+  [[nodiscard]] std::span<hal::byte const> dropped_requests() const;
+
+  /**
+   * @brief Copy every response of this motor into a shared feedback store
+   *
+   * The feedback of this driver is updated as before. The store gets the
+   * same fields converted to the units of the feedback_t functions.
+   *
+   * @param p_store - store to copy responses into, or nullptr to stop. Its
+   * lifetime must exceed the lifetime of this object or the next call to
+   * this function.
+   * @param p_slot - slot of this motor in p_store
+   * @throws hal::argument_out_of_domain - if p_slot is not below the size of
+   * p_store.
+   */
+  void mirror_feedback(rmd_feedback_columns* p_store, hal::usize p_slot = 0);
+
 private:
+  template<class driver_t>
+  friend class rmd_feedback_stream;
+
   void handle_message(can_message const& p_message);
   /**
-   * @brief Send command on can bus to the motor using its device ID
+   * @brief Bring the feedback up to date for a sensor adaptor
+   *
+   * Sends p_command and waits for its response, unless the field being read
+   * was updated less than p_max_age ago. While an rmd_feedback_stream keeps
+   * the feedback up to date, fields as old as the stream's max age are also
+   * used without a request.
+   *
+   * @param p_command - request that updates the feedback being read
+   * @param p_updated - uptime when the field being read was last updated
+   * @param p_max_age - oldest feedback that does not need a request
+   */
+  void refresh_feedback(read p_command,
+                        hal::u64 p_updated = 0,
+                        hal::time_duration p_max_age = {});
+
+  /**
+   * @brief Block until all outstanding requests have been responded to
    *
-   * @param p_payload - command data to be sent to the device
+   * @return request_status - complete, or timed_out if the retry policy does
+   * not throw
+   * @throws hal::timed_out - if a response is not returned for any attempt of
+   * the retry policy and the policy throws on failure.
    */
-  void send(std::array<hal::byte, 8> p_payload);
+  request_status wait();
 
   feedback_t m_feedback{};
-  hal::can_message_finder m_can;
-  hal::steady_clock* m_clock;
   float m_gear_ratio;
-  hal::time_duration m_max_response_time;
+  rmd_protocol m_protocol;
+  /// Set while an rmd_feedback_stream keeps m_feedback up to date
+  bool m_feedback_streamed = false;
+  /// Oldest streamed field the sensor adaptors use without a request
+  hal::time_duration m_stream_max_age{};
 };
 }  // namespace hal::actuator
@@ -0,0 +1,196 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <span>
+
+#include <libhal-actuator/smart_servo/rmd/protocol.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief Feedback of a group of RMD motors, one array per field
+ *
+ * Every motor mirrored into the columns writes its slot of each column as
+ * its responses are decoded, so exporting one field of every motor for
+ * logging or a control law is a single contiguous copy rather than a gather
+ * over each driver's feedback_t. Values are in the same units as the
+ * conversion functions of feedback_t, so motors of both RMD families can
+ * share one store.
+ *
+ * This class holds no storage, create an rmd_feedback_store instead.
+ */
+class rmd_feedback_columns
+{
+public:
+  rmd_feedback_columns(rmd_feedback_columns&) = delete;
+  rmd_feedback_columns& operator=(rmd_feedback_columns&) = delete;
+  rmd_feedback_columns(rmd_feedback_columns&&) noexcept = delete;
+  rmd_feedback_columns& operator=(rmd_feedback_columns&&) noexcept = delete;
+
+  /**
+   * @brief Store the fields of a decoded response in a motor's slot
+   *
+   * Fields the response does not carry keep their previous value.
+   *
+   * @param p_slot - slot of the motor, below size()
+   * @param p_response - fields decoded by rmd_protocol::decode()
+   * @param p_scales - units per LSB of each field for the motor's family
+   */
+  void record(hal::usize p_slot,
+              rmd_response const& p_response,
+              rmd_field_scales const& p_scales);
+
+  /// @return hal::usize - number of slots in each column
+  [[nodiscard]] hal::usize size() const
+  {
+    return m_angle.size();
+  }
+
+  /// @return multi-turn angle of each motor in degrees
+  [[nodiscard]] std::span<float const> angle() const
+  {
+    return m_angle;
+  }
+
+  /// @return speed of each motor in rpm
+  [[nodiscard]] std::span<float const> speed() const
+  {
+    return m_speed;
+  }
+
+  /// @return current through the windings of each motor in amperes
+  [[nodiscard]] std::span<float const> current() const
+  {
+    return m_current;
+  }
+
+  /// @return supply voltage of each motor in volts
+  [[nodiscard]] std::span<float const> volts() const
+  {
+    return m_volts;
+  }
+
+  /// @return core temperature of each motor in celsius
+  [[nodiscard]] std::span<float const> temperature() const
+  {
+    return m_temperature;
+  }
+
+  /// @return raw error flags of each motor, whose bits depend on its family
+  [[nodiscard]] std::span<hal::u16 const> error_state() const
+  {
+    return m_error_state;
+  }
+
+  /// @return raw encoder count of each motor
+  [[nodiscard]] std::span<hal::i16 const> encoder() const
+  {
+    return m_encoder;
+  }
+
+  /// @return number of responses decoded for each motor
+  [[nodiscard]] std::span<hal::u32 const> message_number() const
+  {
+    return m_message_number;
+  }
+
+  /// @return uptime of the most recent response of each motor, 0 if none
+  [[nodiscard]] std::span<hal::u64 const> updated() const
+  {
+    return m_updated;
+  }
+
+protected:
+  struct columns
+  {
+    std::span<float> angle;
+    std::span<float> speed;
+    std::span<float> current;
+    std::span<float> volts;
+    std::span<float> temperature;
+    std::span<hal::u16> error_state;
+    std::span<hal::i16> encoder;
+    std::span<hal::u32> message_number;
+    std::span<hal::u64> updated;
+  };
+
+  rmd_feedback_columns() = default;
+  ~rmd_feedback_columns() = default;
+
+  /**
+   * @brief Point the columns at the storage of the derived class
+   *
+   * @param p_columns - one span per field, all of the same size
+   */
+  void bind(columns const& p_columns);
+
+private:
+  std::span<float> m_angle{};
+  std::span<float> m_speed{};
+  std::span<float> m_current{};
+  std::span<float> m_volts{};
+  std::span<float> m_temperature{};
+  std::span<hal::u16> m_error_state{};
+  std::span<hal::i16> m_encoder{};
+  std::span<hal::u32> m_message_number{};
+  std::span<hal::u64> m_updated{};
+};
+
+/**
+ * @brief Storage for the feedback columns of a fixed number of motors
+ *
+ *     hal::actuator::rmd_feedback_store<16> fleet;
+ *     for (hal::usize i = 0; i < motors.size(); i++) {
+ *       motors[i].mirror_feedback(&fleet, i);
+ *     }
+ *     log(fleet.angle());
+ *
+ * @tparam motor_count - number of slots in each column
+ */
+template<hal::usize motor_count>
+class rmd_feedback_store : public rmd_feedback_columns
+{
+public:
+  static_assert(motor_count > 0, "A store needs at least one slot");
+
+  rmd_feedback_store()
+  {
+    bind({
+      .angle = m_angle,
+      .speed = m_speed,
+      .current = m_current,
+      .volts = m_volts,
+      .temperature = m_temperature,
+      .error_state = m_error_state,
+      .encoder = m_encoder,
+      .message_number = m_message_number,
+      .updated = m_updated,
+    });
+  }
+
+private:
+  std::array<float, motor_count> m_angle{};
+  std::array<float, motor_count> m_speed{};
+  std::array<float, motor_count> m_current{};
+  std::array<float, motor_count> m_volts{};
+  std::array<float, motor_count> m_temperature{};
+  std::array<hal::u16, motor_count> m_error_state{};
+  std::array<hal::i16, motor_count> m_encoder{};
+  std::array<hal::u32, motor_count> m_message_number{};
+  std::array<hal::u64, motor_count> m_updated{};
+};
+}  // namespace hal::actuator
@@ -0,0 +1,147 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <span>
+
+#include <libhal/error.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief Keeps the feedback of an RMD motor fresh by rotating read requests
+ *
+ * Every period, one read request from a rotation is sent to the motor, so
+ * every field of `feedback()` is refreshed once per rotation. Requests are
+ * only sent while the motor has no outstanding request, so they interleave
+ * with actuation commands sent through the motor's `*_async()` APIs rather
+ * than queue behind them.
+ *
+ * While a stream exists, the motor's sensor adaptors return the streamed
+ * feedback instead of sending a request of their own on every read. A
+ * streamed field older than two rotations is not trusted, so when the stream
+ * is starved, because `service()` is not called or the motor always has an
+ * outstanding request, the adaptors fall back to requesting it themselves.
+ *
+ * Nothing happens in the background on its own: call `service()` from the
+ * control loop at least once per period. It never blocks.
+ *
+ *     hal::actuator::rmd_feedback_stream stream(drc, *clock, 2ms);
+ *     while (true) {
+ *       stream.service();
+ *       drc.velocity_control_async(next_speed());
+ *     }
+ *
+ * @tparam driver_t - rmd_drc_v2 or rmd_mc_x_v2
+ */
+template<class driver_t>
+class rmd_feedback_stream
+{
+public:
+  using read = typename driver_t::read;
+  using request_status = typename driver_t::request_status;
+
+  /// Requests that, between them, fill in every field of the feedback
+  static constexpr std::array default_rotation{
+    read::status_2,
+    read::multi_turns_angle,
+    read::status_1_and_error_flags,
+  };
+
+  /**
+   * @brief Start streaming feedback from a motor
+   *
+   * @param p_driver - motor to stream feedback from, must outlive the stream
+   * @param p_clock - clock used to schedule requests
+   * @param p_period - time between two requests
+   * @param p_rotation - requests to cycle through, must outlive the stream
+   * @throws hal::argument_out_of_domain - if p_rotation is empty or the
+   * motor already has a stream.
+   */
+  rmd_feedback_stream(driver_t& p_driver,
+                      hal::steady_clock& p_clock,
+                      hal::time_duration p_period,
+                      std::span<read const> p_rotation = default_rotation)
+    : m_driver(&p_driver)
+    , m_clock(&p_clock)
+    , m_rotation(p_rotation)
+    , m_period_ticks(static_cast<hal::u64>(
+        static_cast<double>(p_period.count()) *
+        static_cast<double>(p_clock.frequency()) / 1e9))
+  {
+    if (m_rotation.empty() || p_driver.m_feedback_streamed) {
+      hal::safe_throw(hal::argument_out_of_domain(this));
+    }
+    p_driver.m_feedback_streamed = true;
+    p_driver.m_stream_max_age =
+      p_period * static_cast<hal::time_duration::rep>(2 * m_rotation.size());
+    m_next_request = m_clock->uptime();
+  }
+
+  rmd_feedback_stream(rmd_feedback_stream const&) = delete;
+  rmd_feedback_stream& operator=(rmd_feedback_stream const&) = delete;
+  rmd_feedback_stream(rmd_feedback_stream&&) = delete;
+  rmd_feedback_stream& operator=(rmd_feedback_stream&&) = delete;
+
+  /**
+   * @brief Stop streaming, sensor adaptors send their own requests again
+   *
+   */
+  ~rmd_feedback_stream()
+  {
+    m_driver->m_feedback_streamed = false;
+  }
+
+  /**
+   * @brief Process responses and send the next request if it is due
+   *
+   * If the control loop falls behind by more than a period, the missed
+   * requests are dropped rather than sent back to back.
+   *
+   * @return request_status - state of the motor's outstanding requests before
+   * any request was sent by this call
+   */
+  request_status service()
+  {
+    auto const status = m_driver->poll();
+    if (status == request_status::pending) {
+      return status;
+    }
+
+    auto const now = m_clock->uptime();
+    if (now < m_next_request) {
+      return status;
+    }
+
+    m_driver->feedback_request_async(m_rotation[m_index]);
+    m_index = (m_index + 1) % m_rotation.size();
+    m_next_request += m_period_ticks;
+    if (m_next_request <= now) {
+      m_next_request = now + m_period_ticks;
+    }
+    return status;
+  }
+
+private:
+  driver_t* m_driver;
+  hal::steady_clock* m_clock;
+  std::span<read const> m_rotation;
+  hal::u64 m_period_ticks;
+  hal::u64 m_next_request = 0;
+  std::size_t m_index = 0;
+};
+}  // namespace hal::actuator
@@ -14,8 +14,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
-
+#include <span>
+
+#include <libhal-actuator/adaptive_timeout.hpp>
+#include <libhal-actuator/retry_policy.hpp>
+#include <libhal-actuator/smart_servo/rmd/can_dispatcher.hpp>
+#include <libhal-actuator/smart_servo/rmd/feedback_store.hpp>
+#include <libhal-actuator/smart_servo/rmd/protocol.hpp>
+#include <libhal-actuator/transaction_recorder.hpp>
 #include <libhal-util/can.hpp>
 #include <libhal/can.hpp>
 #include <libhal/current_sensor.hpp>
@@ -63,21 +72,52 @@ public:
     stop = 0x81,
   };
 
+  /// State of the requests issued through the `*_async()` APIs
+  using request_status = rmd_request_status;
+
+  /// Speed setpoint for one motor of a group update
+  struct velocity_setpoint
+  {
+    /// Motor to send the setpoint to
+    rmd_mc_x_v2* motor;
+    /// Speed in rpm to move the motor shaft at
+    hal::rpm speed;
+  };
+
+  /// Torque current setpoint for one motor of a group update
+  struct torque_setpoint
+  {
+    /// Motor to send the setpoint to
+    rmd_mc_x_v2* motor;
+    /// Current to drive through the motor windings
+    hal::ampere current;
+  };
+
+  /// Position setpoint for one motor of a group update
+  struct position_setpoint
+  {
+    /// Motor to send the setpoint to
+    rmd_mc_x_v2* motor;
+    /// Angle position in degrees to move to
+    hal::degrees angle;
+    /// Speed in rpm's to move at
+    hal::rpm speed;
+  };
+
   /// Structure containing all of the forms of feedback acquired by an RMD-X
   /// motor
   struct feedback_t
   {
-    /// Every time a message from our motor is received this number increments.
+    /// Every time a response from our motor is decoded this number increments.
     /// This can be used to indicate if the feedback has updated since the last
     /// time it was read.
     std::uint32_t message_number = 0;
     /// Represents the multi-turn absolute angle of the encoder relative to its
-    /// zero starting point (0.01°/LSB)
-    std::int64_t raw_multi_turn_angle{ 0 };
+    /// zero starting point (0.01°/LSB). The MC-X reports it in 32 bits.
+    std::int32_t raw_multi_turn_angle{ 0 };
     /// 16-bit value containing error flag information
     std::uint16_t raw_error_state{ 0 };
-    /// Current flowing through the motor windings
-    ///  (-2048 <-> 2048 ==> -33A <-> 33A)
+    /// Torque current flowing through the motor windings (0.01A/LSB)
     std::int16_t raw_current{ 0 };
     /// Rotational velocity of the motor (1 degrees per second (dps)/LSB)
     std::int16_t raw_speed{ 0 };
@@ -87,6 +127,28 @@ public:
     std::int16_t encoder{ 0 };
     /// Core temperature of the motor (1C/LSB)
     std::int8_t raw_motor_temperature{ 0 };
+    /// Uptime of the driver's clock when each group of fields was last
+    /// updated by a response, 0 if it has not been updated yet. Fields are
+    /// always decoded together with the rest of their group, so one time per
+    /// group is kept rather than one per field.
+    struct updated_t
+    {
+      /// raw_volts, raw_error_state and raw_motor_temperature
+      hal::u64 status_1 = 0;
+      /// raw_current, raw_speed, encoder and raw_motor_temperature, returned
+      /// by status_2 and every actuation command
+      hal::u64 status_2 = 0;
+      /// raw_multi_turn_angle
+      hal::u64 multi_turn_angle = 0;
+
+      /// @return hal::u64 - last update of raw_motor_temperature, which both
+      /// status groups carry
+      [[nodiscard]] constexpr hal::u64 motor_temperature() const noexcept
+      {
+        return std::max(status_1, status_2);
+      }
+    };
+    updated_t updated{};
 
     [[nodiscard]] hal::ampere current() const noexcept;
     [[nodiscard]] hal::rpm speed() const noexcept;
@@ -117,17 +179,50 @@ public:
     hal::rpm m_max_speed;
   };
 
+  /**
+   * @brief Control the torque of a mc_x motor driver like a hal::motor
+   *
+   * Power is mapped to the torque current of the motor rather than its speed,
+   * so the motor's speed loop is bypassed.
+   *
+   */
+  class torque_motor : public hal::motor
+  {
+  private:
+    torque_motor(rmd_mc_x_v2& p_mc_x, hal::ampere p_max_current);
+    void driver_power(float p_power) override;
+    friend class rmd_mc_x_v2;
+    rmd_mc_x_v2* m_mc_x = nullptr;
+    hal::ampere m_max_current;
+  };
+
   /**
    * @brief Reports the rotation of the DRC motor
    *
    */
   class rotation : public hal::rotation_sensor
   {
+  public:
+    /**
+     * @brief Set how old the feedback may be before a read requests new data
+     *
+     * Feedback that was updated by any response within p_max_age, such as the
+     * response to a control command, is returned without a request. The
+     * default of zero sends a request on every read.
+     *
+     * @param p_max_age - oldest feedback that is returned without a request
+     */
+    void max_age(hal::time_duration p_max_age)
+    {
+      m_max_age = p_max_age;
+    }
+
   private:
     rotation(rmd_mc_x_v2& p_mc_x);
     hal::rotation_sensor::read_t driver_read() override;
     friend class rmd_mc_x_v2;
     rmd_mc_x_v2* m_mc_x = nullptr;
+    hal::time_duration m_max_age{};
   };
 
   /**
@@ -181,10 +276,78 @@ public:
     velocity_servo& operator=(velocity_servo&&) = default;
     ~velocity_servo() override = default;
 
+    /**
+     * @brief Set how old the feedback may be before a read requests new data
+     *
+     * Applies to is_moving() and settled(). Feedback that was updated by any
+     * response within p_max_age, such as the response to the position
+     * command itself, is used without a request. The default of zero sends a
+     * request on every call.
+     *
+     * @param p_max_age - oldest feedback that is used without a request
+     */
+    void max_age(hal::time_duration p_max_age)
+    {
+      m_max_age = p_max_age;
+    }
+
+    /**
+     * @brief Set how far from the target the motor may stop and be settled
+     *
+     * @param p_tolerance - largest distance from the most recent target, in
+     * the units of feedback_t::angle(). Defaults to 1 degree.
+     */
+    void settle_tolerance(degrees p_tolerance)
+    {
+      m_tolerance = p_tolerance;
+    }
+
+    /**
+     * @brief Check if the motor has stopped at the most recent target
+     *
+     * The speed is checked first and the angle is only requested once the
+     * motor has slowed below the movement threshold, so a moving motor costs
+     * one request per call at most. Once the motor has settled the result is
+     * kept, without further requests, until the next position command.
+     * Without a position command, only the speed is checked.
+     *
+     * @return true - the motor has stopped within the settle tolerance of the
+     * target
+     * @throws hal::timed_out - if a request is not responded to and the retry
+     * policy throws on failure.
+     */
+    [[nodiscard]] bool settled();
+
+    /**
+     * @brief Block until the motor settles or a deadline passes
+     *
+     * Checks settled() with feedback no older than p_period, so the bus
+     * carries at most one request per period while waiting.
+     *
+     * @param p_timeout - longest time to wait
+     * @param p_period - oldest feedback used while waiting, and so the time
+     * between requests
+     * @return true - the motor settled before p_timeout
+     * @return false - p_timeout passed first
+     * @throws hal::timed_out - if a request is not responded to and the retry
+     * policy throws on failure.
+     */
+    bool wait_until_settled(
+      hal::time_duration p_timeout,
+      hal::time_duration p_period = std::chrono::milliseconds(5));
+
   private:
     friend class rmd_mc_x_v2;
     velocity_servo(rmd_mc_x_v2& p_drc);
 
+    /**
+     * @brief Check if the motor has settled using feedback up to p_max_age old
+     *
+     * @param p_max_age - oldest feedback that is used without a request
+     * @return true - the motor has settled at the target
+     */
+    bool settled(hal::time_duration p_max_age);
+
     void driver_enable(bool p_state) override;
     void driver_position(degrees p_target_position) override;
     position_range_t driver_position_range() override;
@@ -196,6 +359,13 @@ public:
 
     rmd_mc_x_v2* m_drc = nullptr;
     rpm m_current_velocity = 0;
+    /// Most recent position command, valid if m_has_target is set
+    degrees m_target = 0;
+    degrees m_tolerance = 1.0f;
+    hal::time_duration m_max_age{};
+    bool m_has_target = false;
+    /// The motor settled at m_target since it was commanded
+    bool m_settled = false;
   };
 
   /**
@@ -204,11 +374,27 @@ public:
    */
   class temperature : public hal::temperature_sensor
   {
+  public:
+    /**
+     * @brief Set how old the feedback may be before a read requests new data
+     *
+     * Feedback that was updated by any response within p_max_age, such as the
+     * response to a control command, is returned without a request. The
+     * default of zero sends a request on every read.
+     *
+     * @param p_max_age - oldest feedback that is returned without a request
+     */
+    void max_age(hal::time_duration p_max_age)
+    {
+      m_max_age = p_max_age;
+    }
+
   private:
     temperature(rmd_mc_x_v2& p_mc_x);
     hal::celsius driver_read() override;
     friend class rmd_mc_x_v2;
     rmd_mc_x_v2* m_mc_x = nullptr;
+    hal::time_duration m_max_age{};
   };
 
   /**
@@ -217,11 +403,27 @@ public:
    */
   class current_sensor : public hal::current_sensor
   {
+  public:
+    /**
+     * @brief Set how old the feedback may be before a read requests new data
+     *
+     * Feedback that was updated by any response within p_max_age, such as the
+     * response to a control command, is returned without a request. The
+     * default of zero sends a request on every read.
+     *
+     * @param p_max_age - oldest feedback that is returned without a request
+     */
+    void max_age(hal::time_duration p_max_age)
+    {
+      m_max_age = p_max_age;
+    }
+
   private:
     current_sensor(rmd_mc_x_v2& p_mc_x);
     hal::ampere driver_read() override;
     friend class rmd_mc_x_v2;
     rmd_mc_x_v2* m_mc_x = nullptr;
+    hal::time_duration m_max_age{};
   };
 
   /**
@@ -236,7 +438,8 @@ public:
    * 0x160. Creating two rmd_mc_x_v2 with the same ID on the same
    * can_transceiver is undefined behavior.
    * @param p_max_response_time - maximum amount of time to wait for a response
-   * from the motor.
+   * from the motor. Once responses have been measured, requests time out after
+   * the measured round trip time plus its jitter, see round_trip_statistics().
    * @throws hal::timed_out - if the p_max_response_time is exceeded
    * @throws hal::argument_out_of_domain - in two situations. If p_device_id is
    * outside of its boundary and if can transceiver's baud rate is not 1_MHz
@@ -250,10 +453,40 @@ public:
     hal::u32 p_device_id,
     hal::time_duration p_max_response_time = std::chrono::milliseconds(10));
 
+  /**
+   * @brief Create a new rmd_mc_x_v2 device driver on a shared bus
+   *
+   * Responses are routed to this driver by the dispatcher rather than the
+   * driver scanning the transceiver's receive buffer itself.
+   *
+   * @param p_dispatcher - dispatcher for the bus the motor is on. Its lifetime
+   * must exceed the lifetime of this driver.
+   * @param p_clock - clocked used to determine timeouts
+   * @param p_gear_ratio - gear ratio of the motor
+   * @param p_device_id - The message ID of the motor. Valid inputs are 0x140 to
+   * 0x160.
+   * @param p_max_response_time - maximum amount of time to wait for a response
+   * from the motor. Once responses have been measured, requests time out after
+   * the measured round trip time plus its jitter, see round_trip_statistics().
+   * @throws hal::timed_out - if the p_max_response_time is exceeded
+   * @throws hal::argument_out_of_domain - in two situations. If p_device_id is
+   * outside of its boundary and if can transceiver's baud rate is not 1_MHz
+   * which is the operating frequency of the RMD MC X devices.
+   * @throws hal::device_or_resource_busy - if another driver on the dispatcher
+   * already uses p_device_id.
+   */
+  rmd_mc_x_v2(
+    rmd_can_dispatcher& p_dispatcher,
+    hal::steady_clock& p_clock,
+    float p_gear_ratio,
+    hal::u32 p_device_id,
+    hal::time_duration p_max_response_time = std::chrono::milliseconds(10));
+
   rmd_mc_x_v2(rmd_mc_x_v2&) = delete;
   rmd_mc_x_v2& operator=(rmd_mc_x_v2&) = delete;
   rmd_mc_x_v2(rmd_mc_x_v2&&) noexcept = delete;
   rmd_mc_x_v2& operator=(rmd_mc_x_v2&&) noexcept = delete;
+  ~rmd_mc_x_v2();
 
   /**
    * @brief Create a hal::motor driver using the MC-X driver
@@ -264,6 +497,16 @@ public:
    */
   motor acquire_motor(hal::rpm p_max_speed);
 
+  /**
+   * @brief Create a hal::motor driver that controls the torque of the motor
+   *
+   * @param p_max_current - torque current of the motor represented by +1.0
+   * and -1.0
+   * @return torque_motor - motor implementation using the MC-X driver's
+   * torque control
+   */
+  torque_motor acquire_torque_motor(hal::ampere p_max_current);
+
   /**
    * @brief Create a hal::rotation_sensor driver using the MC-X driver
    *
@@ -321,20 +564,137 @@ public:
    * motor. It is updated when any of the control or feedback APIs are called.
    * This object will not update without one of those APIs being called.
    *
+   * If handle_message() is called from an interrupt, fields of the returned
+   * object can change while they are being read. Use snapshot() instead.
+   *
    * @return const feedback_t& - information about the motor
    * @throws hal::timed_out - if a response is not returned within the max
    * response time set at creation.
    */
   [[nodiscard]] feedback_t const& feedback() const;
 
+  /**
+   * @brief Get a consistent copy of the feedback
+   *
+   * Every field of the copy comes from the same update, even if
+   * handle_message() is called from an interrupt while the copy is taken.
+   * Never blocks the writer: if an update lands during the copy, the copy is
+   * taken again. Must not be called from the context that calls
+   * handle_message(), such as the interrupt that feeds it.
+   *
+   * @return feedback_t - copy of the feedback
+   */
+  [[nodiscard]] feedback_t snapshot() const;
+
+  /**
+   * @brief Round trip times measured from this motor's responses
+   *
+   * @return adaptive_timeout::statistics const& - round trip statistics
+   */
+  [[nodiscard]] adaptive_timeout::statistics const& round_trip_statistics()
+    const;
+
+  /**
+   * @brief Change how long responses from this motor are waited for
+   *
+   * The ceiling starts out as the max response time given at creation.
+   *
+   * @param p_settings - ceiling, margin and whether the timeout adapts
+   */
+  void tune_response_timeout(adaptive_timeout::settings const& p_settings);
+
+  /**
+   * @brief Set how requests that receive no response are recovered from
+   *
+   * A timed out request is sent again by `poll()`, so the async APIs and the
+   * blocking APIs both follow the policy. Each outstanding request is sent
+   * again on its own deadline. The constructor always uses the default
+   * policy.
+   *
+   * @param p_policy - number of attempts, latency budget and whether the
+   * blocking APIs throw once every attempt has failed
+   */
+  void retry(retry_policy const& p_policy);
+
+  /**
+   * @brief Get the retry policy
+   *
+   * @return retry_policy const& - the retry policy in use
+   */
+  [[nodiscard]] retry_policy const& retry() const;
+
+  /**
+   * @brief Record the timing of every request sent to this motor
+   *
+   * A request is recorded once its response arrives or its last retry times
+   * out. Byte counts are of CAN payload bytes.
+   *
+   * @param p_recorder - recorder to add transactions to, or nullptr to stop
+   * recording. Its lifetime must exceed the lifetime of this object or the
+   * next call to this function.
+   */
+  void instrument(transaction_recorder* p_recorder);
+
+  /**
+   * @brief Append every frame received from this motor to a telemetry log
+   *
+   * Frames are appended raw as they are handled, so the log must be drained
+   * faster than handle_message() is called, or frames are dropped.
+   *
+   * @param p_log - log to append frames to, or nullptr to stop logging. Its
+   * lifetime must exceed the lifetime of this object or the next call to this
+   * function.
+   */
+  void log_telemetry(telemetry_log* p_log);
+
+  /**
+   * @brief Number of messages from this motor that could not be decoded
+   *
+   * Messages that are not 8 bytes long or that start with an unknown command
+   * are dropped and counted here rather than in the feedback's
+   * message_number.
+   *
+   * @return hal::u32 - messages dropped since creation
+   */
+  [[nodiscard]] hal::u32 decode_errors() const;
+
+  /**
+   * @brief Commands of the requests that timed out on every attempt
+   *
+   * When `poll()` returns `request_status::timed_out`, this names each
+   * request that was dropped, as its command byte, for example
+   * `hal::value(read::status_2)`. Cleared by the next request sent once no
+   * request is outstanding.
+   *
+   * @return std::span<hal::byte const> - command byte of each dropped request
+   */
+  [[nodiscard]] std::span<hal::byte const> dropped_requests() const;
+
+  /**
+   * @brief Copy every response of this motor into a shared feedback store
+   *
+   * The feedback of this driver is updated as before. The store gets the
+   * same fields converted to the units of the feedback_t functions.
+   *
+   * @param p_store - store to copy responses into, or nullptr to stop. Its
+   * lifetime must exceed the lifetime of this object or the next call to
+   * this function.
+   * @param p_slot - slot of this motor in p_store
+   * @throws hal::argument_out_of_domain - if p_slot is not below the size of
+   * p_store.
+   */
+  void mirror_feedback(rmd_feedback_columns* p_store, hal::usize p_slot = 0);
+
   /**
    * @brief Request feedback from the motor
    *
    * @param p_command - the request to command the motor to respond with
-   * @throws hal::timed_out - if a response is not returned within the max
-   * response time set at creation.
+   * @return request_status - complete, or timed_out if the motor did not
+   * respond and the retry policy does not throw.
+   * @throws hal::timed_out - if no response is returned for any attempt of the
+   * retry policy and the policy throws on failure.
    */
-  void feedback_request(read p_command);
+  request_status feedback_request(read p_command);
 
   /**
    * @brief Rotate motor shaft at the designated speed
@@ -342,53 +702,249 @@ public:
    * @param p_speed - speed in rpm to move the motor shaft at. Positive values
    * rotate the motor shaft clockwise, negative values rotate the motor shaft
    * counter-clockwise assuming you are looking directly at the motor shaft.
-   * @throws hal::timed_out - if a response is not returned within the max
-   * response time set at creation.
+   * @return request_status - complete, or timed_out if the motor did not
+   * respond and the retry policy does not throw.
+   * @throws hal::timed_out - if no response is returned for any attempt of the
+   * retry policy and the policy throws on failure.
    */
-  void velocity_control(rpm p_speed);
+  request_status velocity_control(rpm p_speed);
+
+  /**
+   * @brief Drive a torque current through the motor windings
+   *
+   * The motor's speed and position loops are bypassed, which makes this the
+   * lowest latency way to actuate the motor. The current is saturated to the
+   * range the command can carry.
+   *
+   * @param p_current - torque current, positive values produce clockwise
+   * torque looking directly at the motor shaft
+   * @return request_status - complete, or timed_out if the motor did not
+   * respond and the retry policy does not throw.
+   * @throws hal::timed_out - if no response is returned for any attempt of the
+   * retry policy and the policy throws on failure.
+   */
+  request_status torque_control(hal::ampere p_current);
 
   /**
    * @brief Move motor shaft to a specific angle
    *
    * @param p_angle - angle position in degrees to move to
    * @param speed - speed in rpm's
-   * @throws hal::timed_out - if a response is not returned within the max
-   * response time set at creation.
+   * @return request_status - complete, or timed_out if the motor did not
+   * respond and the retry policy does not throw.
+   * @throws hal::timed_out - if no response is returned for any attempt of the
+   * retry policy and the policy throws on failure.
    */
-  void position_control(degrees p_angle, rpm speed);
+  request_status position_control(degrees p_angle, rpm speed);
 
   /**
    * @brief Send system control commands to the device
    *
    * @param p_system_command - system control command to send to the device
    * status
-   * @throws hal::timed_out - if a response is not returned within the max
-   * response time set at creation.
+   * @return request_status - complete, or timed_out if the motor did not
+   * respond and the retry policy does not throw.
+   * @throws hal::timed_out - if no response is returned for any attempt of the
+   * retry policy and the policy throws on failure.
+   */
+  request_status system_control(system p_system_command);
+
+  /**
+   * @brief Request feedback from the motor without waiting for the response
+   *
+   * The response is decoded into `feedback()` when it is received by `poll()`
+   * or passed to `handle_message()`.
+   *
+   * @param p_command - the request to command the motor to respond with
+   */
+  void feedback_request_async(read p_command);
+
+  /**
+   * @brief Non-blocking version of `velocity_control()`
+   *
+   * @param p_speed - speed in rpm to move the motor shaft at.
    */
-  void system_control(system p_system_command);
+  void velocity_control_async(rpm p_speed);
+
+  /**
+   * @brief Non-blocking version of `torque_control()`
+   *
+   * @param p_current - torque current to drive through the motor windings
+   */
+  void torque_control_async(hal::ampere p_current);
+
+  /**
+   * @brief Non-blocking version of `position_control()`
+   *
+   * @param p_angle - angle position in degrees to move to
+   * @param p_speed - speed in rpm's
+   */
+  void position_control_async(degrees p_angle, rpm p_speed);
+
+  /**
+   * @brief Non-blocking version of `system_control()`
+   *
+   * @param p_system_command - system control command to send to the device
+   */
+  void system_control_async(system p_system_command);
+
+  /**
+   * @brief Stop every motor of a fleet without waiting for any response
+   *
+   * The command frame of every motor is handed to the transceiver back to
+   * back, before any response is waited on, so the last motor is stopped
+   * within rmd_wire_time(p_motors.size(), baud rate) of the call. At 1Mbps
+   * that is 135us per motor. A motor whose frame cannot be sent does not hold
+   * up the motors after it.
+   *
+   * Every request still waiting on a response from a motor is cancelled
+   * before its stop is sent, so no earlier command is sent again after it.
+   * Each motor's acknowledgement is collected afterwards by its `poll()`,
+   * which also sends the stop again if the motor does not answer, as set by
+   * its retry policy.
+   *
+   * @param p_motors - motors to stop
+   * @param p_command - stop to send, system::off to let the motors freewheel
+   * @return hal::usize - number of motors whose frame was sent
+   */
+  static hal::usize emergency_stop(std::span<rmd_mc_x_v2* const> p_motors,
+                                   system p_command = system::stop) noexcept;
+
+  /**
+   * @brief Process any received responses and report the state of requests
+   *
+   * This function never blocks. Each request sent gets its own deadline of
+   * the max response time set at creation, and is completed by the response
+   * that echoes its command. A request whose deadline passes is sent again
+   * or dropped, as set by the retry policy, without touching the other
+   * requests. Once no request is outstanding, `request_status::timed_out` is
+   * returned if any of them was dropped, until the next request is sent.
+   * dropped_requests() names the requests that were dropped.
+   *
+   * @return request_status - state of the outstanding requests
+   */
+  [[nodiscard]] request_status poll();
+
+  /**
+   * @brief Update the speed of a group of motors in a single round trip
+   *
+   * Every setpoint is put on the bus back to back, then the responses of all
+   * motors are collected within one wait window. Updating N motors costs
+   * about one round trip rather than N.
+   *
+   * @param p_setpoints - motors and the speeds to set on them
+   * @return request_status - complete, or timed_out if a motor did not respond
+   * and its retry policy does not throw.
+   * @throws hal::timed_out - if any motor does not respond after every attempt
+   * of its retry policy and the first such motor's policy throws on failure.
+   * The exception's instance is the first motor that did not respond.
+   * Responses from the other motors are still decoded.
+   */
+  static request_status group_velocity_control(
+    std::span<velocity_setpoint const> p_setpoints);
+
+  /**
+   * @brief Update the torque of a group of motors in a single round trip
+   *
+   * Every setpoint is put on the bus back to back, then the responses of all
+   * motors are collected within one wait window.
+   *
+   * @param p_setpoints - motors and the torque currents to drive them with
+   * @return request_status - complete, or timed_out if a motor did not respond
+   * and its retry policy does not throw.
+   * @throws hal::timed_out - if any motor does not respond after every attempt
+   * of its retry policy and the first such motor's policy throws on failure.
+   * The exception's instance is the first motor that did not respond.
+   * Responses from the other motors are still decoded.
+   */
+  static request_status group_torque_control(
+    std::span<torque_setpoint const> p_setpoints);
+
+  /**
+   * @brief Update the position of a group of motors in a single round trip
+   *
+   * Every setpoint is put on the bus back to back, then the responses of all
+   * motors are collected within one wait window.
+   *
+   * @param p_setpoints - motors and the positions to move them to
+   * @return request_status - complete, or timed_out if a motor did not respond
+   * and its retry policy does not throw.
+   * @throws hal::timed_out - if any motor does not respond after every attempt
+   * of its retry policy and the first such motor's policy throws on failure.
+   * The exception's instance is the first motor that did not respond.
+   * Responses from the other motors are still decoded.
+   */
+  static request_status group_position_control(
+    std::span<position_setpoint const> p_setpoints);
 
   /**
    * @brief Handle messages from the can bus with this devices ID
    *
-   * Meant mostly for testing purposes.
+   * Meant mostly for testing purposes or for feeding responses received
+   * outside of this driver. Responses complete outstanding async requests.
+   * Messages with another ID return before any state is touched, and
+   * responses that cannot be decoded are counted by decode_errors().
+   *
+   * May be called from an interrupt, in which case the feedback must be read
+   * through snapshot(). Only one context may call this function.
    *
    * @param p_message - message received from the bus
    */
   void handle_message(can_message const& p_message);
 
 private:
+  template<class driver_t>
+  friend class rmd_feedback_stream;
+
+  /**
+   * @brief Replace the feedback under the seqlock read by snapshot()
+   *
+   * @param p_feedback - new feedback
+   */
+  void publish(feedback_t const& p_feedback);
+
+  /**
+   * @brief Validate the settings of the device and check that it responds
+   *
+   * @param p_baud_rate - baud rate of the transceiver
+   */
+  void initialize(hal::u32 p_baud_rate);
+
+  /**
+   * @brief Bring the feedback up to date for a sensor adaptor
+   *
+   * Sends p_command and waits for its response, unless the field being read
+   * was updated less than p_max_age ago. While an rmd_feedback_stream keeps
+   * the feedback up to date, fields as old as the stream's max age are also
+   * used without a request.
+   *
+   * @param p_command - request that updates the feedback being read
+   * @param p_updated - uptime when the field being read was last updated
+   * @param p_max_age - oldest feedback that does not need a request
+   */
+  void refresh_feedback(read p_command,
+                        hal::u64 p_updated = 0,
+                        hal::time_duration p_max_age = {});
+
   /**
-   * @brief Send command on can bus to the motor using its device ID
+   * @brief Block until all outstanding requests have been responded to
    *
-   * @param p_payload - command data to be sent to the device
+   * @return request_status - complete, or timed_out if the retry policy does
+   * not throw
+   * @throws hal::timed_out - if a response is not returned for any attempt of
+   * the retry policy and the policy throws on failure.
    */
-  void send(std::array<hal::byte, 8> p_payload);
+  request_status wait();
 
   feedback_t m_feedback{};
-  hal::steady_clock* m_clock;
-  hal::can_message_finder m_can;
+  /// Seqlock version of m_feedback, odd while an update is being written
+  std::atomic<hal::u32> m_feedback_version{ 0 };
   float m_gear_ratio;
   hal::u32 m_device_id;
-  hal::time_duration m_max_response_time;
+  rmd_protocol m_protocol;
+  /// Set while an rmd_feedback_stream keeps m_feedback up to date
+  bool m_feedback_streamed = false;
+  /// Oldest streamed field the sensor adaptors use without a request
+  hal::time_duration m_stream_max_age{};
 };
 }  // namespace hal::actuator
@@ -0,0 +1,488 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <span>
+
+#include <libhal-actuator/adaptive_timeout.hpp>
+#include <libhal-actuator/retry_policy.hpp>
+#include <libhal-actuator/smart_servo/rmd/can_dispatcher.hpp>
+#include <libhal-actuator/telemetry_log.hpp>
+#include <libhal-actuator/transaction_recorder.hpp>
+#include <libhal-util/can.hpp>
+#include <libhal/can.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+class rmd_feedback_columns;
+
+/// State of the requests issued through the `*_async()` APIs of RMD drivers
+enum class rmd_request_status : hal::byte
+{
+  /// Every request sent has received a response
+  complete,
+  /// At least one request is still waiting on a response
+  pending,
+  /// A request was dropped without a response since the requests were last
+  /// complete
+  timed_out,
+};
+
+/// Feedback fields carried by the responses of RMD motors
+enum class rmd_field : hal::u8
+{
+  motor_temperature,
+  current,
+  speed,
+  encoder,
+  volts,
+  error_state,
+  multi_turn_angle,
+};
+
+/// Number of values of rmd_field
+inline constexpr hal::usize rmd_field_count = 7;
+
+/// Units of each rmd_field per LSB, indexed by the value of the field
+using rmd_field_scales = std::array<float, rmd_field_count>;
+
+/// Where a field sits in a response payload, as a little endian integer
+struct rmd_field_layout
+{
+  rmd_field field;
+  /// Index of the field's least significant byte in the payload
+  hal::u8 offset;
+  /// Number of bytes of the field, from 1 to 8
+  hal::u8 width;
+  /// True if the top bit of the field is a sign bit
+  bool is_signed = true;
+};
+
+/// Layout of the response to one command
+struct rmd_response_layout
+{
+  /// Command byte that starts both the command and its response
+  hal::byte command = 0;
+  /// Number of entries of `fields` in use, commands without feedback use 0
+  hal::u8 field_count = 0;
+  std::array<rmd_field_layout, 4> fields{};
+};
+
+/**
+ * @brief Check at compile time that each field of a table fits in a payload
+ *
+ * @param p_layouts - response layouts of a motor family
+ * @return true - every field is 1 to 8 bytes wide and inside the payload
+ */
+constexpr bool rmd_layouts_fit(std::span<rmd_response_layout const> p_layouts)
+{
+  for (auto const& layout : p_layouts) {
+    if (layout.field_count > layout.fields.size()) {
+      return false;
+    }
+    for (hal::usize i = 0; i < layout.field_count; i++) {
+      auto const& field = layout.fields[i];
+      if (field.width == 0 || field.offset + field.width > 8) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/// Bits on the bus for a standard frame with 8 data bytes, including worst
+/// case bit stuffing
+inline constexpr hal::u32 rmd_frame_bits = 135;
+
+/**
+ * @brief Time for frames sent back to back to leave the transceiver
+ *
+ * Bounds the latency of an RMD emergency stop. The last stop frame is on the
+ * wire this long after the call at most, plus the transceiver's send time and
+ * any frame it already has in flight.
+ *
+ * @param p_frames - number of frames
+ * @param p_baud_rate - baud rate of the CAN bus
+ * @return hal::time_duration - worst case time on the wire
+ */
+constexpr hal::time_duration rmd_wire_time(hal::usize p_frames,
+                                           hal::u32 p_baud_rate)
+{
+  auto const bits = p_frames * rmd_frame_bits;
+  return std::chrono::nanoseconds((bits * 1'000'000'000ULL) / p_baud_rate);
+}
+
+/// Field values decoded from one response
+struct rmd_response
+{
+  std::array<hal::i64, rmd_field_count> values{};
+  /// Bit N is set if the response carries the field with value N
+  hal::u8 present = 0;
+  /// Uptime when the response was decoded
+  hal::u64 received_at = 0;
+
+  [[nodiscard]] constexpr bool has(rmd_field p_field) const
+  {
+    return present & (1U << static_cast<hal::u8>(p_field));
+  }
+
+  [[nodiscard]] constexpr hal::i64 value(rmd_field p_field) const
+  {
+    return values[static_cast<hal::u8>(p_field)];
+  }
+};
+
+/**
+ * @brief Request and response exchange shared by the RMD motor drivers
+ *
+ * Every RMD command is an 8 byte frame that the motor answers with a single 8
+ * byte frame. This class owns that exchange for one motor: sending commands,
+ * matching responses to them, the adaptive response timeout, retries and
+ * transaction recording. Responses are decoded with a table of the layout of
+ * each command's response, so the drivers only encode commands and store the
+ * decoded fields. Changes to the exchange apply to every RMD family at once.
+ *
+ * The families differ only in their IDs and in their layout tables, so this
+ * class is not a template and every driver shares one copy of its code.
+ */
+class rmd_protocol
+{
+public:
+  using handler = rmd_can_dispatcher::handler;
+
+  /// Most requests that can wait on a response at once. Sending another
+  /// drops the oldest of them.
+  static constexpr hal::usize max_outstanding_requests = 8;
+
+  /**
+   * @brief Exchange messages with a motor by scanning the receive buffer
+   *
+   * @param p_transceiver - transceiver connected to the bus with the motor
+   * @param p_filter - identifier filter, updated to allow p_response_id
+   * @param p_clock - clock used to determine timeouts
+   * @param p_command_id - ID commands are sent to
+   * @param p_response_id - ID the motor responds with
+   * @param p_layouts - layout of the response to each command, its lifetime
+   * must exceed the lifetime of this object
+   * @param p_max_response_time - ceiling of the adaptive response timeout
+   * @param p_handler - called with every message received with p_response_id
+   */
+  rmd_protocol(hal::can_transceiver& p_transceiver,
+               hal::can_identifier_filter& p_filter,
+               hal::steady_clock& p_clock,
+               hal::u32 p_command_id,
+               hal::u32 p_response_id,
+               std::span<rmd_response_layout const> p_layouts,
+               hal::time_duration p_max_response_time,
+               handler p_handler);
+
+  /**
+   * @brief Exchange messages with a motor through a dispatcher
+   *
+   * @param p_dispatcher - dispatcher for the bus the motor is on. Its lifetime
+   * must exceed the lifetime of this object.
+   * @param p_clock - clock used to determine timeouts
+   * @param p_command_id - ID commands are sent to
+   * @param p_response_id - ID the motor responds with
+   * @param p_layouts - layout of the response to each command, its lifetime
+   * must exceed the lifetime of this object
+   * @param p_max_response_time - ceiling of the adaptive response timeout
+   * @param p_handler - called with every message received with p_response_id
+   * @throws hal::device_or_resource_busy - if another driver on the dispatcher
+   * already uses p_response_id.
+   */
+  rmd_protocol(rmd_can_dispatcher& p_dispatcher,
+               hal::steady_clock& p_clock,
+               hal::u32 p_command_id,
+               hal::u32 p_response_id,
+               std::span<rmd_response_layout const> p_layouts,
+               hal::time_duration p_max_response_time,
+               handler p_handler);
+
+  rmd_protocol(rmd_protocol&) = delete;
+  rmd_protocol& operator=(rmd_protocol&) = delete;
+  rmd_protocol(rmd_protocol&&) noexcept = delete;
+  rmd_protocol& operator=(rmd_protocol&&) noexcept = delete;
+  ~rmd_protocol();
+
+  /**
+   * @brief Send a command to the motor
+   *
+   * Does not wait for a response. The request waits on its own deadline,
+   * alongside any requests already outstanding.
+   *
+   * @param p_payload - command data to be sent to the motor
+   */
+  void transmit(std::array<hal::byte, 8> const& p_payload);
+
+  /**
+   * @brief Decode a response from the motor
+   *
+   * May be called from an interrupt that preempts the context calling the
+   * other functions. The response only marks its request as answered, and the
+   * next poll() measures and records the request, so the timeout, the retry
+   * state and the recorder are only touched by the polling context.
+   *
+   * Only responses to requests sent once are measured for the adaptive
+   * timeout, as a response to a request sent again cannot be told apart from
+   * a late response to an earlier attempt (Karn's rule). The time the request
+   * and response spend on the wire is not counted.
+   *
+   * Messages with another ID are ignored without touching any state. An 8
+   * byte message with the motor's ID completes the oldest outstanding request
+   * that starts with the same command byte, as the motor echoes the command in
+   * its response. A late response to a dropped request completes nothing, but
+   * its fields are still decoded. Messages that are too short or that start
+   * with a command missing from the layout table count as decode errors. Call
+   * this from the handler before storing any feedback.
+   *
+   * @param p_message - message received from the bus
+   * @param p_response - receives the fields of the response
+   * @return true - p_response holds the fields of a response from the motor
+   * @return false - the message must be dropped
+   */
+  bool decode(hal::can_message const& p_message, rmd_response& p_response);
+
+  /**
+   * @brief Copy every decoded response into a slot of a feedback store
+   *
+   * @param p_store - store to copy responses into, or nullptr to stop. Its
+   * lifetime must exceed the lifetime of this object or the next call to
+   * this function.
+   * @param p_slot - slot of the motor in p_store
+   * @param p_scales - units per LSB of each field for the motor's family, its
+   * lifetime must exceed the lifetime of this object
+   * @throws hal::argument_out_of_domain - if p_slot is not below the size of
+   * p_store.
+   */
+  void mirror(rmd_feedback_columns* p_store,
+              hal::usize p_slot,
+              rmd_field_scales const& p_scales);
+
+  /**
+   * @brief Number of messages from the motor that could not be decoded
+   *
+   * @return hal::u32 - messages with the wrong length or an unknown command
+   */
+  [[nodiscard]] hal::u32 decode_errors() const;
+
+  /**
+   * @brief Commands of the requests dropped without a response
+   *
+   * Covers the requests sent since the requests were last complete, in the
+   * order they were dropped, and is cleared with the timed_out status by the
+   * next request sent. Holds the first max_outstanding_requests drops.
+   *
+   * @return std::span<hal::byte const> - command byte of each dropped request
+   */
+  [[nodiscard]] std::span<hal::byte const> dropped() const;
+
+  /**
+   * @brief Pass received messages to the handler and handle timeouts
+   *
+   * Never blocks. Each outstanding request whose deadline passes is sent
+   * again as allowed by the retry policy, or dropped once it is not.
+   *
+   * @return rmd_request_status - state of the outstanding requests
+   */
+  [[nodiscard]] rmd_request_status poll();
+
+  /**
+   * @brief Block until all outstanding requests have been responded to
+   *
+   * @param p_instance - driver reported in the exception on failure
+   * @return rmd_request_status - complete, or timed_out if the retry policy
+   * does not throw
+   * @throws hal::timed_out - if a response is not returned for any attempt of
+   * the retry policy and the policy throws on failure.
+   */
+  rmd_request_status wait(void* p_instance);
+
+  /**
+   * @brief Stop waiting on every outstanding request without sending it again
+   *
+   * Used before a stop, so that poll() cannot send a motion command again
+   * after it. Cancelled requests are recorded as failed transactions, but
+   * are not listed by dropped() as they did not time out. A late response to
+   * one of them completes nothing.
+   */
+  void cancel_all() noexcept;
+
+  /**
+   * @brief Allow the most recent request to wait behind other frames
+   *
+   * Pushes the deadline of its current attempt back by the time p_frames
+   * frames hold the bus.
+   *
+   * @param p_frames - frames that go on the bus before the motor's response
+   */
+  void queue_behind(hal::usize p_frames);
+
+  /**
+   * @brief Clock used to determine timeouts
+   *
+   * @return hal::steady_clock& - clock given at creation
+   */
+  [[nodiscard]] hal::steady_clock& clock();
+
+  /**
+   * @brief ID the motor responds with
+   *
+   * @return hal::u32 - response ID given at creation
+   */
+  [[nodiscard]] hal::u32 response_id() const;
+
+  /**
+   * @brief Measurements of the motor's response times
+   *
+   * @return adaptive_timeout::statistics const& - round trip time statistics
+   */
+  [[nodiscard]] adaptive_timeout::statistics const& round_trip_statistics()
+    const;
+
+  /**
+   * @brief Change how long responses are waited for
+   *
+   * @param p_settings - ceiling, margin and whether the timeout adapts
+   */
+  void tune_response_timeout(adaptive_timeout::settings const& p_settings);
+
+  /**
+   * @brief Set how requests that receive no response are recovered from
+   *
+   * @param p_policy - number of attempts, latency budget and whether wait()
+   * throws once every attempt has failed
+   */
+  void retry(retry_policy const& p_policy);
+
+  /**
+   * @brief Get the retry policy
+   *
+   * @return retry_policy const& - the retry policy in use
+   */
+  [[nodiscard]] retry_policy const& retry() const;
+
+  /**
+   * @brief Record the timing of every request sent to the motor
+   *
+   * @param p_recorder - recorder to add transactions to, or nullptr to stop
+   * recording
+   */
+  void instrument(transaction_recorder* p_recorder);
+
+  /**
+   * @brief Append every frame received from the motor to a telemetry log
+   *
+   * Frames are logged raw, before they are decoded, so malformed frames are
+   * logged too.
+   *
+   * @param p_log - log to append frames to, or nullptr to stop logging. Its
+   * lifetime must exceed the lifetime of this object or the next call to this
+   * function.
+   */
+  void log_telemetry(telemetry_log* p_log);
+
+private:
+  /// Progress of an entry of the request table
+  enum class request_state : hal::u8
+  {
+    /// The entry holds no request
+    free,
+    /// The request waits on a response
+    sent,
+    /// decode() received the response, poll() has yet to record it
+    answered,
+  };
+
+  /// A request sent to the motor that has not been answered or dropped
+  struct request
+  {
+    /// Only decode() moves an entry from sent to answered. Every other
+    /// change is made by the polling context.
+    std::atomic<request_state> state{ request_state::free };
+    std::array<hal::byte, 8> payload{};
+    /// Uptime when the request was first sent
+    hal::u64 begin = 0;
+    /// Uptime when the request was last sent
+    hal::u64 start = 0;
+    /// Uptime when the latest attempt times out
+    hal::u64 deadline = 0;
+    /// Timeout of the latest attempt
+    hal::time_duration timeout{};
+    /// Order the requests were sent in, used to find the oldest
+    hal::u32 sequence = 0;
+    /// Frames the latest attempt waits behind on the bus
+    hal::u32 queued = 0;
+    /// Uptime when the response was decoded, valid once answered
+    hal::u64 answered_at = 0;
+    hal::u8 attempts = 0;
+  };
+
+  /**
+   * @brief Put an attempt of a request on the bus and start its deadline
+   *
+   * @param p_request - request to send
+   */
+  void send(request& p_request);
+
+  /**
+   * @brief Measure and record the requests decode() has answered
+   *
+   */
+  void collect();
+
+  /**
+   * @brief Stop waiting on a request that has run out of attempts
+   *
+   * @param p_request - request to drop
+   */
+  void drop(request& p_request);
+
+  /**
+   * @brief Pass a finished request to the recorder, if there is one
+   *
+   * @param p_request - request that was answered or dropped
+   * @param p_completed - true if the request received a response
+   */
+  void record_transaction(request const& p_request, bool p_completed);
+
+  hal::can_message_finder m_can;
+  std::span<rmd_response_layout const> m_layouts;
+  rmd_can_dispatcher* m_dispatcher = nullptr;
+  hal::steady_clock* m_clock;
+  handler m_handler;
+  hal::u32 m_command_id;
+  hal::u32 m_baud_rate;
+  adaptive_timeout m_response_timer;
+  retry_policy m_retry{};
+  std::array<request, max_outstanding_requests> m_requests{};
+  transaction_recorder* m_recorder = nullptr;
+  telemetry_log* m_telemetry_log = nullptr;
+  rmd_feedback_columns* m_store = nullptr;
+  rmd_field_scales const* m_scales = nullptr;
+  hal::usize m_slot = 0;
+  /// Most recently sent request, target of queue_behind()
+  request* m_latest = nullptr;
+  hal::u32 m_sequence = 0;
+  std::atomic<hal::u32> m_decode_errors{ 0 };
+  /// Command bytes of the requests dropped, m_dropped_count of them in use
+  std::array<hal::byte, max_outstanding_requests> m_dropped{};
+  hal::u8 m_dropped_count = 0;
+};
+}  // namespace hal::actuator
@@ -0,0 +1,150 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <span>
+#include <type_traits>
+
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/// Bus family a telemetry record was received from
+enum class telemetry_source : hal::u8
+{
+  /// CAN frame from an RMD motor, the opcode is the command byte
+  rmd,
+  /// Status packet from a Dynamixel servo, the opcode is its error byte
+  dynamixel,
+};
+
+/**
+ * @brief One raw response, as received, in a fixed size binary record
+ *
+ * Responses longer than the payload are split over consecutive records with
+ * the same timestamp and increasing offsets.
+ */
+struct telemetry_record
+{
+  /// @brief Uptime of the driver's clock when the response was received
+  hal::u64 timestamp = 0;
+  /// @brief CAN ID or Dynamixel ID of the device that responded
+  hal::u16 device_id = 0;
+  telemetry_source source = telemetry_source::rmd;
+  /// @brief Command byte of RMD frames, error byte of Dynamixel packets
+  hal::byte opcode = 0;
+  /// @brief Position of payload[0] in the response
+  hal::u8 offset = 0;
+  /// @brief Number of bytes of payload in use
+  hal::u8 length = 0;
+  std::array<hal::byte, 8> payload{};
+};
+
+static_assert(std::is_trivially_copyable_v<telemetry_record>);
+
+/**
+ * @brief Lock-free ring of raw telemetry records in caller provided memory
+ *
+ * Drivers given a log through their `log_telemetry()` function append every
+ * response they receive, without any formatting or allocation. A separate
+ * drain task copies the records back out and writes them over serial or USB
+ * at its own pace.
+ *
+ * One context appends and one context drains: a log is a single producer,
+ * single consumer queue. Drivers that receive in different contexts, such as
+ * an RMD dispatcher polled from an interrupt and Dynamixel servos read from
+ * the main loop, need one log each. When the ring is full new records are
+ * dropped and counted, so the producer never waits on the drain task.
+ *
+ *     std::array<hal::actuator::telemetry_record, 256> storage;
+ *     hal::actuator::telemetry_log log(storage);
+ *     motor.log_telemetry(&log);
+ *     // drain task:
+ *     std::array<hal::actuator::telemetry_record, 16> batch;
+ *     auto const count = log.drain(batch);
+ *     hal::write(usb, std::as_bytes(std::span(batch).first(count)), ...);
+ */
+class telemetry_log
+{
+public:
+  /**
+   * @brief Create a log over caller provided storage
+   *
+   * @param p_storage - records of the ring, its size must be a power of two.
+   * Its lifetime must exceed the lifetime of this object.
+   * @throws hal::argument_out_of_domain - if the size of p_storage is not a
+   * power of two.
+   */
+  explicit telemetry_log(std::span<telemetry_record> p_storage);
+
+  telemetry_log(telemetry_log&) = delete;
+  telemetry_log& operator=(telemetry_log&) = delete;
+  telemetry_log(telemetry_log&&) noexcept = delete;
+  telemetry_log& operator=(telemetry_log&&) noexcept = delete;
+
+  /**
+   * @brief Append a response, split over as many records as it needs
+   *
+   * Called by the producer context only.
+   *
+   * @param p_timestamp - uptime when the response was received
+   * @param p_source - bus family of the device
+   * @param p_device_id - ID of the device
+   * @param p_opcode - command byte or error byte of the response
+   * @param p_payload - raw bytes of the response
+   * @return true - every record of the response was appended
+   * @return false - the ring was full and some records were dropped
+   */
+  bool append(hal::u64 p_timestamp,
+              telemetry_source p_source,
+              hal::u16 p_device_id,
+              hal::byte p_opcode,
+              std::span<hal::byte const> p_payload) noexcept;
+
+  /**
+   * @brief Move the oldest records out of the ring
+   *
+   * Called by the consumer context only.
+   *
+   * @param p_records - filled with records, oldest first
+   * @return hal::usize - number of records written to p_records
+   */
+  hal::usize drain(std::span<telemetry_record> p_records) noexcept;
+
+  /**
+   * @brief Number of records waiting to be drained
+   *
+   * @return hal::usize - records appended and not yet drained
+   */
+  [[nodiscard]] hal::usize size() const noexcept;
+
+  /**
+   * @brief Number of records dropped because the ring was full
+   *
+   * @return hal::u32 - records dropped since creation
+   */
+  [[nodiscard]] hal::u32 dropped() const noexcept;
+
+private:
+  std::span<telemetry_record> m_storage;
+  hal::u32 m_mask;
+  /// Number of records ever appended, written by the producer only
+  std::atomic<hal::u32> m_head{ 0 };
+  /// Number of records ever drained, written by the consumer only
+  std::atomic<hal::u32> m_tail{ 0 };
+  std::atomic<hal::u32> m_dropped{ 0 };
+};
+}  // namespace hal::actuator
@@ -0,0 +1,171 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief Trapezoidal motion profile through a queue of waypoints
+ *
+ * Each move to a waypoint accelerates, cruises and decelerates to rest at the
+ * waypoint, within the velocity and acceleration limits. The profile of a
+ * move is worked out once when it is enqueued, in whole ticks of a fixed
+ * period. After that, every call to tick() steps the profile forward by one
+ * period with three additions, so one MCU can run a trajectory per servo for
+ * dozens of servos.
+ *
+ * The trajectory does not drive a servo itself. Pass each setpoint to any
+ * position servo: a `hal::servo` such as rc_servo16, a dynamixel_servo, or,
+ * for a group of Dynamixel servos, a single sync write of every setpoint.
+ *
+ *     hal::actuator::trajectory arm(
+ *       5ms, { .velocity = 180, .acceleration = 720 });
+ *     arm.enqueue({ .position = 90.0f });
+ *     arm.enqueue({ .position = 0.0f, .duration = 2s });
+ *     while (arm.moving()) {
+ *       servo.position(arm.tick());
+ *       wait_for_next_tick();
+ *     }
+ */
+class trajectory
+{
+public:
+  /// Most moves that can be queued at once
+  static constexpr usize capacity = 8;
+
+  /// @brief Motion limits of the servo
+  struct limits
+  {
+    /// @brief Fastest the servo may move in degrees per second
+    float velocity = 90.0f;
+    /// @brief Fastest the servo may change speed in degrees per second squared
+    float acceleration = 360.0f;
+  };
+
+  /// @brief Position to move to and how to get there
+  struct waypoint
+  {
+    /// @brief Position to come to rest at
+    hal::degrees position = 0.0f;
+    /// @brief Time the move should take. If zero, or too short for the
+    /// limits, the move is as fast as the limits allow.
+    hal::time_duration duration{};
+    /// @brief Fastest this move may go in degrees per second. If zero, or
+    /// above the limits, the limits' velocity is used.
+    float velocity = 0.0f;
+  };
+
+  /**
+   * @brief Create a trajectory at rest
+   *
+   * @param p_tick - time between two calls to tick()
+   * @param p_limits - motion limits of the servo
+   * @param p_start - position the servo is at
+   * @throws hal::argument_out_of_domain - if p_tick or a limit is not above
+   * zero.
+   */
+  trajectory(hal::time_duration p_tick,
+             limits const& p_limits,
+             hal::degrees p_start = 0.0f);
+
+  /**
+   * @brief Queue a move after the moves already queued
+   *
+   * @param p_waypoint - position to move to and how to get there
+   * @throws hal::resource_unavailable_try_again - if `capacity` moves are
+   * already waiting.
+   */
+  void enqueue(waypoint const& p_waypoint);
+
+  /**
+   * @brief Step the profile forward by one tick
+   *
+   * @return hal::degrees - setpoint for the servo at this tick
+   */
+  hal::degrees tick();
+
+  /**
+   * @brief Stop and drop every queued move
+   *
+   * The setpoint stays where it is, without decelerating, so only call this
+   * while the servo is slow, or to hold position after a fault.
+   */
+  void clear();
+
+  /**
+   * @brief Setpoint of the most recent tick
+   *
+   * @return hal::degrees - latest setpoint
+   */
+  [[nodiscard]] hal::degrees position() const;
+
+  /**
+   * @brief Whether the next tick moves the setpoint
+   *
+   * @return true - a move is in progress or queued
+   * @return false - the setpoint is at rest at the last waypoint
+   */
+  [[nodiscard]] bool moving() const;
+
+  /**
+   * @brief Moves queued and not yet started
+   *
+   * @return usize - number of queued moves, at most `capacity`
+   */
+  [[nodiscard]] usize queued() const;
+
+private:
+  /// A move in whole ticks, with velocity in degrees per tick and acceleration
+  /// in degrees per tick squared
+  struct move
+  {
+    hal::degrees target = 0.0f;
+    float acceleration = 0.0f;
+    u32 ramp_ticks = 0;
+    u32 cruise_ticks = 0;
+  };
+
+  enum class phase : u8
+  {
+    idle,
+    accelerate,
+    cruise,
+    decelerate,
+  };
+
+  void start(move const& p_move);
+  void next_phase();
+
+  std::array<move, capacity> m_queue{};
+  usize m_head = 0;
+  usize m_count = 0;
+  float m_tick_seconds;
+  limits m_limits;
+  /// Where the last queued move ends
+  hal::degrees m_queue_end;
+
+  // Profile state, advanced once per tick
+  hal::degrees m_position;
+  float m_velocity = 0.0f;
+  float m_acceleration = 0.0f;
+  float m_half_acceleration = 0.0f;
+  u32 m_phase_ticks = 0;
+  phase m_phase = phase::idle;
+  move m_current{};
+};
+}  // namespace hal::actuator
@@ -0,0 +1,160 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief Timing of one request to a device and its response
+ *
+ * A transaction covers every attempt made for a request under the driver's
+ * retry policy.
+ */
+struct transaction
+{
+  /// @brief Uptime of the driver's clock when the request was first sent
+  hal::u64 sent_at = 0;
+  /// @brief Time from sending the last attempt to receiving its complete
+  /// response, zero if no response was received
+  hal::time_duration response_time = hal::time_duration::zero();
+  /// @brief Timeout of the last attempt
+  hal::time_duration timeout = hal::time_duration::zero();
+  /// @brief Number of times the request was sent
+  hal::u8 attempts = 0;
+  /// @brief Number of attempts that received no response in time
+  hal::u8 timeouts = 0;
+  /// @brief Bytes sent over every attempt
+  hal::u16 bytes_sent = 0;
+  /// @brief Bytes of the response received
+  hal::u16 bytes_received = 0;
+  /// @brief True if a response was received
+  bool completed = false;
+};
+
+/**
+ * @brief Summarizes the transactions of one driver instance
+ *
+ * Pass a recorder to a driver's `instrument()` to start recording. Drivers
+ * without a recorder only pay for a null check per transaction.
+ *
+ *     hal::actuator::transaction_recorder recorder(100us);
+ *     motor.instrument(&recorder);
+ *     // ... run the control loop ...
+ *     auto const& stats = recorder.stats();
+ *     // stats.max, stats.mean(), stats.timeouts, stats.histogram
+ */
+class transaction_recorder
+{
+public:
+  /// Number of bins of the response time histogram. The last bin also counts
+  /// every response slower than the bins before it.
+  static constexpr usize histogram_bins = 16;
+
+  /// @brief Totals of every transaction recorded
+  struct summary
+  {
+    /// @brief Number of transactions recorded
+    hal::u32 transactions = 0;
+    /// @brief Number of transactions that received a response
+    hal::u32 completed = 0;
+    /// @brief Number of attempts made after the first attempt
+    hal::u32 retries = 0;
+    /// @brief Number of attempts that timed out
+    hal::u32 timeouts = 0;
+    /// @brief Bytes sent by every transaction
+    hal::u64 bytes_sent = 0;
+    /// @brief Bytes received by every transaction
+    hal::u64 bytes_received = 0;
+    /// @brief Shortest response time of a completed transaction
+    hal::time_duration min = hal::time_duration::max();
+    /// @brief Longest response time of a completed transaction
+    hal::time_duration max = hal::time_duration::zero();
+    /// @brief Sum of the response times of every completed transaction
+    hal::time_duration total = hal::time_duration::zero();
+    /// @brief Completed transactions counted by response time, bin `i` holds
+    /// response times from `i` to `i + 1` bin widths
+    std::array<hal::u32, histogram_bins> histogram{};
+
+    /**
+     * @brief Mean response time of the completed transactions
+     *
+     * @return hal::time_duration - mean response time, zero if no transaction
+     * completed
+     */
+    [[nodiscard]] hal::time_duration mean() const;
+  };
+
+  /**
+   * @brief Construct a new transaction recorder
+   *
+   * @param p_bin_width - range of response times counted by each bin of the
+   * histogram
+   */
+  explicit transaction_recorder(
+    hal::time_duration p_bin_width = std::chrono::microseconds(100));
+
+  /**
+   * @brief Add a transaction to the summary
+   *
+   * @param p_transaction - transaction that just finished
+   */
+  void record(transaction const& p_transaction);
+
+  /**
+   * @brief Get the totals of every transaction recorded
+   *
+   * @return summary const& - totals since construction or the last reset()
+   */
+  [[nodiscard]] summary const& stats() const
+  {
+    return m_summary;
+  }
+
+  /**
+   * @brief Get the most recently recorded transaction
+   *
+   * @return transaction const& - the latest transaction
+   */
+  [[nodiscard]] transaction const& last() const
+  {
+    return m_last;
+  }
+
+  /**
+   * @brief Get the range of response times counted by each histogram bin
+   *
+   * @return hal::time_duration - width of each bin
+   */
+  [[nodiscard]] hal::time_duration bin_width() const
+  {
+    return m_bin_width;
+  }
+
+  /**
+   * @brief Forget every transaction recorded
+   *
+   */
+  void reset();
+
+private:
+  summary m_summary{};
+  transaction m_last{};
+  hal::time_duration m_bin_width;
+};
+}  // namespace hal::actuator
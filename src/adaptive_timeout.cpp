@@ -0,0 +1,90 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include <libhal-actuator/adaptive_timeout.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+namespace {
+/// Largest multiplier applied by back off, enough to reach any ceiling from
+/// the estimate within a few timeouts
+constexpr hal::u32 max_backoff = 64;
+}  // namespace
+
+adaptive_timeout::adaptive_timeout(settings const& p_settings)
+  : m_settings(p_settings)
+{
+}
+
+void adaptive_timeout::record(hal::time_duration p_round_trip)
+{
+  auto& stats = m_statistics;
+  stats.min = std::min(stats.min, p_round_trip);
+  stats.max = std::max(stats.max, p_round_trip);
+
+  if (stats.samples == 0) {
+    stats.smoothed = p_round_trip;
+    stats.deviation = p_round_trip / 2;
+  } else {
+    // RFC 6298: deviation gain of 1/4 and smoothing gain of 1/8
+    auto const error = p_round_trip - stats.smoothed;
+    auto const magnitude = error < error.zero() ? -error : error;
+    stats.deviation += (magnitude - stats.deviation) / 4;
+    stats.smoothed += error / 8;
+  }
+  stats.samples++;
+  m_backoff = 1;
+}
+
+void adaptive_timeout::record_timeout()
+{
+  m_statistics.timeouts++;
+  m_backoff = std::min(m_backoff * 2, max_backoff);
+}
+
+hal::time_duration adaptive_timeout::timeout() const
+{
+  if (not m_settings.adapt || m_statistics.samples == 0) {
+    return m_settings.ceiling;
+  }
+  auto const slack = std::max(4 * m_statistics.deviation, m_settings.margin);
+  auto const estimate = (m_statistics.smoothed + slack) * m_backoff;
+  return std::min(estimate, m_settings.ceiling);
+}
+
+void adaptive_timeout::configure(settings const& p_settings)
+{
+  m_settings = p_settings;
+}
+
+void adaptive_timeout::reset()
+{
+  m_statistics = {};
+  m_backoff = 1;
+}
+
+hal::time_duration adaptive_timeout::elapsed(hal::steady_clock& p_clock,
+                                             hal::u64 p_start_ticks)
+{
+  auto const ticks = p_clock.uptime() - p_start_ticks;
+  auto const frequency = static_cast<double>(p_clock.frequency());
+  return std::chrono::nanoseconds(
+    static_cast<std::int64_t>((static_cast<double>(ticks) * 1e9) / frequency));
+}
+}  // namespace hal::actuator
@@ -0,0 +1,127 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/closed_loop_servo.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <libhal-actuator/adaptive_timeout.hpp>
+#include <libhal/error.hpp>
+
+namespace hal::actuator {
+closed_loop_servo::closed_loop_servo(hal::servo& p_servo,
+                                     hal::steady_clock& p_clock,
+                                     settings const& p_settings,
+                                     hal::rotation_sensor* p_sensor)
+  : m_servo(&p_servo)
+  , m_clock(&p_clock)
+  , m_sensor(p_sensor)
+  , m_settings(p_settings)
+  , m_target(p_settings.min_angle)
+{
+  if (p_settings.min_angle >= p_settings.max_angle ||
+      p_settings.tolerance < 0.0f || p_settings.gain < 0.0f ||
+      p_settings.settle_rate < 0.0f || p_settings.max_correction < 0.0f) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+  m_settings.settle_updates = std::max<hal::u8>(1, p_settings.settle_updates);
+}
+
+void closed_loop_servo::driver_position(hal::degrees p_position)
+{
+  if (p_position < m_settings.min_angle || p_position > m_settings.max_angle) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+
+  m_target = p_position;
+  m_error = 0.0f;
+  m_updates_within = 0;
+  m_reached = false;
+  command();
+}
+
+bool closed_loop_servo::update()
+{
+  if (m_sensor == nullptr) {
+    m_reached = adaptive_timeout::elapsed(*m_clock, m_commanded_at) >=
+                m_settings.open_loop_settle_time;
+    return m_reached;
+  }
+
+  auto const reading = m_sensor->read().angle;
+  auto const still = m_have_reading && std::abs(reading - m_last_reading) <=
+                                         m_settings.settle_rate;
+  if (m_have_reading && not still) {
+    m_moved = true;
+  }
+  m_last_reading = reading;
+  m_have_reading = true;
+  // The shaft also reads still in the dead time before the servo starts to
+  // move, so it only counts as at rest once it has moved, or once it has had
+  // the full settling time to do so
+  auto const at_rest =
+    still && (m_moved || adaptive_timeout::elapsed(*m_clock, m_commanded_at) >=
+                           m_settings.open_loop_settle_time);
+
+  m_error = m_target - reading;
+  if (std::abs(m_error) <= m_settings.tolerance) {
+    if (m_updates_within < m_settings.settle_updates) {
+      m_updates_within++;
+    }
+    m_reached = m_updates_within >= m_settings.settle_updates;
+    return m_reached;
+  }
+
+  m_updates_within = 0;
+  m_reached = false;
+  if (not at_rest) {
+    // Part of this error is the move itself, which the servo takes out on
+    // its own, integrating it would overshoot the target
+    return false;
+  }
+  m_correction = std::clamp(m_correction + m_settings.gain * m_error,
+                            -m_settings.max_correction,
+                            m_settings.max_correction);
+  command();
+  return false;
+}
+
+void closed_loop_servo::command()
+{
+  m_commanded_at = m_clock->uptime();
+  m_have_reading = false;
+  m_moved = false;
+  // A target near the end of travel can only be corrected towards the
+  // middle, so the command is kept to what the servo accepts
+  m_servo->position(std::clamp(m_target + m_correction,
+                               m_settings.min_angle,
+                               m_settings.max_angle));
+}
+
+bool closed_loop_servo::reached() const
+{
+  return m_reached;
+}
+
+hal::degrees closed_loop_servo::error() const
+{
+  return m_error;
+}
+
+hal::degrees closed_loop_servo::correction() const
+{
+  return m_correction;
+}
+}  // namespace hal::actuator
@@ -0,0 +1,160 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/cyclic_scheduler.hpp>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include <libhal-actuator/adaptive_timeout.hpp>
+#include <libhal/error.hpp>
+
+namespace hal::actuator {
+cyclic_scheduler::cyclic_scheduler(hal::steady_clock& p_clock,
+                                   hal::time_duration p_period,
+                                   std::span<task> p_storage)
+  : m_clock(&p_clock)
+  , m_storage(p_storage)
+  , m_period_ticks(static_cast<hal::u64>(
+      (static_cast<double>(p_period.count()) * p_clock.frequency()) / 1e9))
+{
+  if (p_period <= hal::time_duration::zero() || m_period_ticks == 0) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+}
+
+void cyclic_scheduler::add(task_settings const& p_settings,
+                           start_handler p_start,
+                           poll_handler p_poll)
+{
+  if (p_settings.lane >= max_lanes || p_settings.period == 0 ||
+      p_settings.offset >= p_settings.period) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+  if (m_count == m_storage.size()) {
+    hal::safe_throw(hal::resource_unavailable_try_again(this));
+  }
+
+  // Keep the tasks ordered by lane then priority, so each lane is started in
+  // priority order by walking the storage front to back
+  auto const before = [&p_settings](task const& p_task) {
+    return p_task.settings.lane < p_settings.lane ||
+           (p_task.settings.lane == p_settings.lane &&
+            p_task.settings.priority <= p_settings.priority);
+  };
+  auto const used = m_storage.first(m_count);
+  auto const position = static_cast<hal::usize>(
+    std::ranges::find_if_not(used, before) - used.begin());
+
+  for (hal::usize i = m_count; i > position; i--) {
+    m_storage[i] = std::move(m_storage[i - 1]);
+  }
+  m_storage[position] = {
+    .start = std::move(p_start),
+    .poll = std::move(p_poll),
+    .settings = p_settings,
+  };
+  m_count++;
+}
+
+hal::usize cyclic_scheduler::next_due(hal::u8 p_lane, hal::usize p_from) const
+{
+  for (hal::usize i = p_from; i < m_count; i++) {
+    auto const& settings = m_storage[i].settings;
+    if (settings.lane == p_lane &&
+        m_cycle % settings.period == settings.offset) {
+      return i;
+    }
+  }
+  return m_count;
+}
+
+cyclic_scheduler::cycle_report cyclic_scheduler::run_cycle()
+{
+  if (not m_running) {
+    m_next_start = m_clock->uptime();
+    m_running = true;
+  }
+  while (m_clock->uptime() < m_next_start) {
+    continue;
+  }
+
+  auto const start = m_next_start;
+  auto const deadline = start + m_period_ticks;
+  cycle_report report{ .cycle = m_cycle };
+
+  struct lane_state
+  {
+    /// Task to start next, or m_count once the lane is finished
+    hal::usize next = 0;
+    /// Task started and not yet complete
+    task* in_flight = nullptr;
+  };
+  std::array<lane_state, max_lanes> lanes{};
+  for (hal::u8 lane = 0; lane < max_lanes; lane++) {
+    lanes[lane].next = next_due(lane, 0);
+  }
+
+  bool active = true;
+  while (active) {
+    active = false;
+    for (hal::u8 lane = 0; lane < max_lanes; lane++) {
+      auto& state = lanes[lane];
+      if (state.in_flight != nullptr) {
+        if (not state.in_flight->poll()) {
+          active = true;
+          continue;
+        }
+        state.in_flight = nullptr;
+        report.completed++;
+      }
+      if (state.next == m_count) {
+        continue;
+      }
+      if (m_clock->uptime() >= deadline) {
+        for (auto i = state.next; i < m_count; i = next_due(lane, i + 1)) {
+          report.skipped++;
+        }
+        state.next = m_count;
+        continue;
+      }
+
+      auto& current = m_storage[state.next];
+      state.next = next_due(lane, state.next + 1);
+      current.start();
+      if (current.poll) {
+        state.in_flight = &current;
+      } else {
+        report.completed++;
+      }
+      active = true;
+    }
+  }
+
+  auto const end = m_clock->uptime();
+  report.busy = adaptive_timeout::elapsed(*m_clock, start);
+  report.overrun = end > deadline;
+
+  m_cycle++;
+  m_next_start = report.overrun ? end : deadline;
+  m_statistics.cycles++;
+  m_statistics.skipped += report.skipped;
+  m_statistics.worst_busy = std::max(m_statistics.worst_busy, report.busy);
+  if (report.overrun) {
+    m_statistics.overruns++;
+  }
+  return report;
+}
+}  // namespace hal::actuator
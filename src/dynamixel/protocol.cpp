@@ -0,0 +1,149 @@
+// Copyright 2026 Malia Labor and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <span>
+
+#include <libhal-util/serial.hpp>
+#include <libhal-util/steady_clock.hpp>
+#include <libhal/error.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/timeout.hpp>
+#include <libhal/units.hpp>
+
+#include "protocol.hpp"
+
+namespace hal::actuator::dynamixel {
+void write_instruction(hal::serial& p_serial,
+                       hal::byte p_id,
+                       instruction p_instruction,
+                       std::span<hal::byte const> p_parameters)
+{
+  packet_stream stream(p_serial);
+  stream.start(p_id, p_parameters.size(), p_instruction);
+  for (auto const parameter : p_parameters) {
+    stream.push_counted(parameter);
+  }
+  stream.finish();
+}
+
+namespace {
+/**
+ * @brief Check the framing and checksum of a status packet
+ *
+ * @param p_header - FF FF ID LENGTH ERROR
+ * @param p_parameters - parameter bytes of the packet
+ * @param p_checksum - checksum byte of the packet
+ * @param p_id - ID of the servo expected to answer
+ * @return status - received with the error byte, or corrupted
+ */
+status check_status(std::span<hal::byte const, 5> p_header,
+                    std::span<hal::byte const> p_parameters,
+                    hal::byte p_checksum,
+                    hal::byte p_id)
+{
+  if (p_header[0] != 0xFF || p_header[1] != 0xFF || p_header[2] != p_id ||
+      p_header[3] != p_parameters.size() + 2) {
+    return { .result = reply::corrupted };
+  }
+
+  hal::byte sum = p_header[2] + p_header[3] + p_header[4];
+  for (auto const parameter : p_parameters) {
+    sum += parameter;
+  }
+  if (static_cast<hal::byte>(~sum) != p_checksum) {
+    return { .result = reply::corrupted };
+  }
+
+  return { .result = reply::received, .error = p_header[4] };
+}
+}  // namespace
+
+status read_status(hal::serial& p_serial,
+                   hal::steady_clock& p_clock,
+                   hal::time_duration p_timeout,
+                   hal::byte p_id,
+                   std::span<hal::byte> p_parameters)
+{
+  // FF FF ID LENGTH ERROR
+  std::array<hal::byte, 5> header{};
+  std::array<hal::byte, 1> received_checksum{};
+  try {
+    auto const timeout = hal::create_timeout(p_clock, p_timeout);
+    hal::read(p_serial, header, timeout);
+    hal::read(p_serial, p_parameters, timeout);
+    hal::read(p_serial, received_checksum, timeout);
+  } catch (hal::timed_out const&) {
+    return { .result = reply::timed_out };
+  }
+
+  return check_status(header, p_parameters, received_checksum[0], p_id);
+}
+
+std::optional<status> continue_status(hal::serial& p_serial,
+                                      hal::byte p_id,
+                                      std::span<hal::byte> p_packet,
+                                      std::size_t& p_received)
+{
+  if (p_received < p_packet.size()) {
+    p_received += p_serial.read(p_packet.subspan(p_received)).data.size();
+  }
+  if (p_received < p_packet.size()) {
+    return std::nullopt;
+  }
+
+  // FF FF ID LENGTH ERROR ... CHECKSUM
+  auto const packet = std::span<hal::byte const>(p_packet);
+  return check_status(packet.first<5>(),
+                      packet.subspan(5, packet.size() - 6),
+                      packet.back(),
+                      p_id);
+}
+
+bool ping(hal::serial& p_serial,
+          hal::steady_clock& p_clock,
+          hal::byte p_id,
+          hal::time_duration p_timeout)
+{
+  std::array<hal::byte, instruction_packet_size(0)> packet{};
+  hal::write(p_serial,
+             build_instruction(packet, p_id, instruction::ping, {}),
+             hal::never_timeout());
+
+  return read_status(p_serial, p_clock, p_timeout, p_id, {}).received();
+}
+
+void write_bulk_read(hal::serial& p_serial,
+                     hal::byte p_address,
+                     hal::byte p_length,
+                     std::span<hal::u8 const> p_ids)
+{
+  // Each servo gets a length, ID and address triplet
+  auto const length = (3 * p_ids.size()) + 3;
+  if (length > 0xFF) {
+    hal::safe_throw(hal::argument_out_of_domain(&p_serial));
+  }
+
+  packet_stream stream(p_serial);
+  stream.start(broadcast_id, length - 2, instruction::bulk_read);
+  stream.push_counted(0x00);
+  for (auto const id : p_ids) {
+    stream.push_counted(p_length);
+    stream.push_counted(id);
+    stream.push_counted(p_address);
+  }
+  stream.finish();
+}
+}  // namespace hal::actuator::dynamixel
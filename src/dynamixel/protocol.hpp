@@ -0,0 +1,360 @@
+// Copyright 2026 Malia Labor and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include <libhal-actuator/dynamixel_packet.hpp>
+#include <libhal-util/serial.hpp>
+#include <libhal/error.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/timeout.hpp>
+#include <libhal/units.hpp>
+
+/**
+ * Dynamixel protocol 1.0 engine shared by every Dynamixel driver.
+ *
+ * Everything here works on runtime sized spans so that one copy of the
+ * framing code exists in the binary no matter how many models or register
+ * widths are in use.
+ */
+namespace hal::actuator::dynamixel {
+/// Bits of the status packet error byte, set by the servo
+/// Input voltage is outside of min_voltage and max_voltage
+constexpr hal::byte input_voltage_error_bit = 1 << 0;
+/// Goal position is outside of cw_limit and ccw_limit
+constexpr hal::byte angle_limit_error_bit = 1 << 1;
+/// Internal temperature is above temp_limit
+constexpr hal::byte overheating_error_bit = 1 << 2;
+/// An instruction parameter is out of range
+constexpr hal::byte range_error_bit = 1 << 3;
+/// The instruction packet had a bad checksum
+constexpr hal::byte checksum_error_bit = 1 << 4;
+/// The load can not be held with the set torque_limit
+constexpr hal::byte overload_error_bit = 1 << 5;
+/// The instruction is undefined, or ACTION came without a REG_WRITE
+constexpr hal::byte instruction_error_bit = 1 << 6;
+
+/// Outcome of waiting for a status packet
+enum class reply : hal::byte
+{
+  /// A valid status packet was received
+  received,
+  /// No complete status packet arrived in time
+  timed_out,
+  /// A packet arrived with a bad header, ID, length or checksum
+  corrupted,
+};
+
+/// Outcome and error byte of a status packet
+struct status
+{
+  /// Whether a valid packet was received
+  reply result = reply::timed_out;
+  /// Error byte of the packet, only valid if result is reply::received
+  hal::byte error = 0;
+
+  /**
+   * @return true - a valid status packet was received
+   */
+  [[nodiscard]] constexpr bool received() const
+  {
+    return result == reply::received;
+  }
+};
+
+/// First address of the contiguous present_* block shared by MX and RX
+/// servos: position (2), speed (2), load (2), voltage (1), temperature (1).
+constexpr hal::byte telemetry_address = 0x24;
+/// Number of bytes in the present_* telemetry block
+constexpr hal::byte telemetry_length = 8;
+/// Most servos a single BULK_READ packet can address
+constexpr std::size_t max_bulk_read_servos = (0xFF - 3) / 3;
+
+/**
+ * @brief Compute the checksum of the bytes of a packet after the header
+ *
+ * @param p_bytes - ID, length, instruction/error and parameter bytes
+ * @return hal::byte - inverted sum of the bytes
+ */
+constexpr hal::byte checksum(std::span<hal::byte const> p_bytes)
+{
+  hal::byte sum = 0;
+  for (auto const byte : p_bytes) {
+    sum += byte;
+  }
+  return ~sum;
+}
+
+/**
+ * @brief Time to move bytes over the bus
+ *
+ * @param p_baud_rate - baud rate of the bus
+ * @param p_bytes - number of bytes, each taking 10 bits on the wire
+ * @return hal::time_duration - time on the wire
+ */
+constexpr hal::time_duration wire_time(hal::hertz p_baud_rate,
+                                       std::size_t p_bytes)
+{
+  auto const bits_on_wire = static_cast<float>(p_bytes * 10);
+  return std::chrono::nanoseconds(
+    static_cast<std::int64_t>((bits_on_wire * 1e9f) / p_baud_rate));
+}
+
+/**
+ * @brief Time to wait for the status packet of a ping
+ *
+ * Covers sending the 6 byte ping, the servo's return delay and receiving its
+ * 6 byte status packet.
+ *
+ * @param p_baud_rate - baud rate of the bus
+ * @param p_return_delay - return delay time configured in the servos
+ * @param p_margin - extra time allowed for the host's receive path
+ * @return hal::time_duration - time to wait for a response
+ */
+constexpr hal::time_duration ping_window(hal::hertz p_baud_rate,
+                                         hal::time_duration p_return_delay,
+                                         hal::time_duration p_margin)
+{
+  return wire_time(p_baud_rate, 6 + 6) + p_return_delay + p_margin;
+}
+
+/**
+ * @brief Number of bytes in a status packet
+ *
+ * @param p_parameters - number of parameter bytes of the status packet
+ * @return constexpr std::size_t - size of the packet including header and
+ * checksum
+ */
+constexpr std::size_t status_packet_size(std::size_t p_parameters)
+{
+  // FF FF ID LENGTH ERROR ... CHECKSUM
+  return p_parameters + 6;
+}
+
+/**
+ * @brief Send an instruction packet
+ *
+ * Packets of up to 58 parameter bytes are sent with a single serial write.
+ *
+ * @param p_serial - serial port connected to the servos
+ * @param p_id - ID of the servo, or broadcast_id
+ * @param p_instruction - instruction to send
+ * @param p_parameters - parameter bytes of the instruction
+ */
+void write_instruction(hal::serial& p_serial,
+                       hal::byte p_id,
+                       instruction p_instruction,
+                       std::span<hal::byte const> p_parameters);
+
+/**
+ * @brief Read one status packet from a servo
+ *
+ * @param p_serial - serial port connected to the servo
+ * @param p_clock - clock used to time out the read
+ * @param p_timeout - time to wait for the full packet
+ * @param p_id - ID of the servo expected to answer
+ * @param p_parameters - filled with the parameter bytes of the packet, its
+ * size is the number of parameter bytes expected.
+ * @return status - the error byte of the packet, or whether it did not arrive
+ * in time or arrived corrupted. A packet from another ID counts as corrupted.
+ */
+status read_status(hal::serial& p_serial,
+                   hal::steady_clock& p_clock,
+                   hal::time_duration p_timeout,
+                   hal::byte p_id,
+                   std::span<hal::byte> p_parameters);
+
+/**
+ * @brief Continue reading a status packet without blocking
+ *
+ * Reads whatever bytes the serial port has received, up to the end of the
+ * packet, and checks the packet once it is complete. Time outs are left to
+ * the caller.
+ *
+ * @param p_serial - serial port connected to the servo
+ * @param p_id - ID of the servo expected to answer
+ * @param p_packet - the whole status packet, its size is the number of bytes
+ * expected
+ * @param p_received - bytes of p_packet already received, updated with the
+ * bytes read by this call
+ * @return std::optional<status> - the status of the packet once it is
+ * complete, otherwise std::nullopt
+ */
+std::optional<status> continue_status(hal::serial& p_serial,
+                                      hal::byte p_id,
+                                      std::span<hal::byte> p_packet,
+                                      std::size_t& p_received);
+
+/**
+ * @brief Ping a single ID and wait for its status packet
+ *
+ * @param p_serial - serial port connected to the servos
+ * @param p_clock - clock used to time out the read
+ * @param p_id - ID to ping
+ * @param p_timeout - time to wait for the status packet
+ * @return true - a servo with this ID answered with a valid status packet
+ * @return false - nothing, or an invalid packet, was received in time
+ */
+bool ping(hal::serial& p_serial,
+          hal::steady_clock& p_clock,
+          hal::byte p_id,
+          hal::time_duration p_timeout);
+
+/**
+ * @brief Send a BULK_READ instruction reading the same block from many servos
+ *
+ * Each servo answers with its own status packet, in the order of p_ids, once
+ * the servo before it has answered. Only MX series servos support BULK_READ.
+ *
+ * @param p_serial - serial port connected to the servos
+ * @param p_address - control table address of the first byte to read
+ * @param p_length - number of bytes to read from each servo
+ * @param p_ids - IDs of the servos to read from
+ * @throws hal::argument_out_of_domain - if the packet does not fit in the
+ * protocol's 255 byte length field.
+ */
+void write_bulk_read(hal::serial& p_serial,
+                     hal::byte p_address,
+                     hal::byte p_length,
+                     std::span<hal::u8 const> p_ids);
+
+/**
+ * @brief Streams a packet to the serial port through a small staging buffer
+ *
+ * Keeps the number of serial writes per packet low without the stack usage
+ * growing with the size of the packet. Bytes passed to push_counted() are
+ * included in the checksum written by finish().
+ */
+class packet_stream
+{
+public:
+  /**
+   * @param p_serial - serial port to write the packet to
+   */
+  explicit packet_stream(hal::serial& p_serial)
+    : m_serial(&p_serial)
+  {
+  }
+
+  /**
+   * @brief Add a byte that is not part of the checksum
+   *
+   * @param p_byte - byte to send
+   */
+  void push(hal::byte p_byte)
+  {
+    if (m_used == m_staging.size()) {
+      hal::write(*m_serial, m_staging, hal::never_timeout());
+      m_used = 0;
+    }
+    m_staging[m_used++] = p_byte;
+  }
+
+  /**
+   * @brief Add a byte that is part of the checksum
+   *
+   * @param p_byte - byte to send
+   */
+  void push_counted(hal::byte p_byte)
+  {
+    m_sum += p_byte;
+    push(p_byte);
+  }
+
+  /**
+   * @brief Add the FF FF header, ID, length and instruction of a packet
+   *
+   * @param p_id - ID of the servo, or broadcast_id
+   * @param p_parameters - number of parameter bytes that will follow
+   * @param p_instruction - instruction to send
+   */
+  void start(hal::byte p_id, usize p_parameters, instruction p_instruction)
+  {
+    push(0xFF);
+    push(0xFF);
+    push_counted(p_id);
+    push_counted(static_cast<hal::byte>(p_parameters + 2));
+    push_counted(static_cast<hal::byte>(p_instruction));
+  }
+
+  /**
+   * @brief Add the checksum and write whatever is left in the staging buffer
+   */
+  void finish()
+  {
+    push(static_cast<hal::byte>(~m_sum));
+    hal::write(
+      *m_serial, std::span(m_staging).first(m_used), hal::never_timeout());
+    m_used = 0;
+    m_sum = 0;
+  }
+
+private:
+  hal::serial* m_serial;
+  std::array<hal::byte, 64> m_staging{};
+  usize m_used = 0;
+  hal::byte m_sum = 0;
+};
+
+/**
+ * @brief Write one register on many servos with a single SYNC_WRITE packet
+ *
+ * The packet is sent through a packet_stream so the stack usage does not
+ * depend on the number of servos. Servos do not respond to SYNC_WRITE.
+ *
+ * @param p_serial - serial port connected to the servos
+ * @param p_address - control table address of the first byte to write
+ * @param p_width - number of bytes written to each servo (1 to 4), sent
+ * least significant byte first
+ * @param p_ids - IDs of the servos to write
+ * @param p_value - callable returning the value for the servo at an index
+ * @throws hal::argument_out_of_domain - if the packet does not fit in the
+ * protocol's 255 byte length field.
+ */
+template<class value_function>
+void sync_write(hal::serial& p_serial,
+                hal::byte p_address,
+                hal::byte p_width,
+                std::span<hal::u8 const> p_ids,
+                value_function&& p_value)
+{
+  // Each servo gets its ID followed by its data
+  auto const length = ((p_width + 1) * p_ids.size()) + 4;
+  if (length > 0xFF) {
+    hal::safe_throw(hal::argument_out_of_domain(&p_serial));
+  }
+
+  packet_stream stream(p_serial);
+  stream.start(broadcast_id, length - 2, instruction::sync_write);
+  stream.push_counted(p_address);
+  stream.push_counted(p_width);
+
+  for (std::size_t i = 0; i < p_ids.size(); i++) {
+    hal::u32 const value = p_value(i);
+    stream.push_counted(p_ids[i]);
+    for (hal::byte shift = 0; shift < p_width * 8; shift += 8) {
+      stream.push_counted(static_cast<hal::byte>(value >> shift));
+    }
+  }
+
+  stream.finish();
+}
+}  // namespace hal::actuator::dynamixel
@@ -0,0 +1,1276 @@
+// Copyright 2026 Malia Labor and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <optional>
+#include <utility>
+
+#include <libhal-actuator/dynamixel_servo.hpp>
+#include <libhal-util/map.hpp>
+#include <libhal-util/serial.hpp>
+#include <libhal-util/steady_clock.hpp>
+#include <libhal/error.hpp>
+#include <libhal/pointers.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/units.hpp>
+
+#include "dynamixel/protocol.hpp"
+
+namespace hal::actuator {
+namespace {
+constexpr auto rpm_raw_range = std::make_pair<u16, u16>(0, 1023);
+constexpr auto percent_range = std::make_pair(0.0f, 100.0f);
+/// Bit set in present_speed and present_load when turning clockwise
+constexpr u16 clockwise_bit = 1 << 10;
+constexpr u16 magnitude_mask = clockwise_bit - 1;
+/// Number of times a write is sent when the servo keeps reporting a checksum
+/// error
+constexpr int write_attempts = 3;
+/// Baud rate register value of 57600, used in place of unsupported rates
+constexpr u8 default_baud_rate_code = 34;
+/// Time allowed for the servos to switch rate after the last byte of a baud
+/// rate broadcast has left the wire
+constexpr auto baud_switch_settle = std::chrono::milliseconds(2);
+/// Extra time allowed per ping when verifying a new baud rate
+constexpr auto baud_verify_margin = std::chrono::microseconds(200);
+
+std::optional<u8> baud_rate_code(hertz p_baud)
+{
+  switch (static_cast<u32>(p_baud)) {
+    case 1000000:
+      return 1;
+    case 500000:
+      return 3;
+    case 400000:
+      return 4;
+    case 250000:
+      return 7;
+    case 200000:
+      return 9;
+    case 115200:
+      return 16;
+    case 57600:
+      return default_baud_rate_code;
+    case 19200:
+      return 103;
+    case 9600:
+      return 207;
+    default:
+      return std::nullopt;
+  }
+}
+
+/// Broadcast a baud rate code and wait until the servos have switched to it
+void broadcast_baud_rate(hal::serial& p_serial,
+                         hal::steady_clock& p_clock,
+                         hertz p_current,
+                         u8 p_code)
+{
+  std::array<hal::byte, dynamixel::instruction_packet_size(2)> buffer{};
+  auto const packet = dynamixel::build_write(
+    buffer,
+    dynamixel::broadcast_id,
+    static_cast<hal::byte>(dynamixel_servo::common_register::baud_rate),
+    std::array{ p_code });
+  hal::write(p_serial, packet, hal::never_timeout());
+  hal::delay(p_clock,
+             dynamixel::wire_time(p_current, packet.size()) +
+               baud_switch_settle);
+}
+
+auto angle_range(dynamixel_model const& p_model)
+{
+  return std::make_pair(0.0f, p_model.angle_max);
+}
+
+auto position_raw_range(dynamixel_model const& p_model)
+{
+  return std::make_pair<u16, u16>(0, u16{ p_model.position_max });
+}
+
+auto rpm_range(dynamixel_model const& p_model)
+{
+  return std::make_pair(0.0f, p_model.speed_max);
+}
+
+hal::degrees clamp_to_range(dynamixel_model const& p_model,
+                            hal::degrees p_angle)
+{
+  return std::clamp(p_angle, 0.0f, p_model.angle_max);
+}
+
+u16 model_angle_to_raw(dynamixel_model const& p_model, hal::degrees p_angle)
+{
+  return static_cast<u16>(hal::map(clamp_to_range(p_model, p_angle),
+                                   angle_range(p_model),
+                                   position_raw_range(p_model)));
+}
+
+/**
+ * @brief Decode a present_speed or present_load register
+ *
+ * @param p_raw - register value, direction bit and 10 bit magnitude
+ * @param p_range - range the magnitude maps to
+ * @return float - magnitude mapped to p_range, positive when clockwise
+ */
+float signed_magnitude(u16 p_raw, std::pair<float, float> p_range)
+{
+  auto const magnitude = hal::map(
+    static_cast<u16>(p_raw & magnitude_mask), rpm_raw_range, p_range);
+  return (p_raw & clockwise_bit) ? magnitude : -magnitude;
+}
+
+dynamixel_servo::telemetry decode_telemetry(
+  dynamixel_model const& p_model,
+  std::span<hal::byte const, dynamixel::telemetry_length> p_block)
+{
+  auto const word = [&p_block](usize p_offset) -> u16 {
+    return p_block[p_offset] | (p_block[p_offset + 1] << 8);
+  };
+
+  return {
+    .position = hal::map(
+      word(0), position_raw_range(p_model), angle_range(p_model)),
+    .speed = signed_magnitude(word(2), rpm_range(p_model)),
+    .load = signed_magnitude(word(4), percent_range),
+    .voltage = static_cast<float>(p_block[6]) / 10,
+    .temperature = p_block[7],
+  };
+}
+/**
+ * @brief Count a status packet in a servo's health
+ *
+ * @return true - a valid status packet was received
+ */
+bool record(dynamixel_servo::health& p_health, dynamixel::status p_status)
+{
+  switch (p_status.result) {
+    case dynamixel::reply::received:
+      p_health.raw_error = p_status.error;
+      p_health.replies++;
+      return true;
+    case dynamixel::reply::corrupted:
+      p_health.corrupted++;
+      return false;
+    case dynamixel::reply::timed_out:
+    default:
+      p_health.timeouts++;
+      return false;
+  }
+}
+
+/**
+ * @brief Append the parameters of a valid status packet to a telemetry log
+ *
+ * @param p_log - log of the servo, may be nullptr
+ */
+void log_status(telemetry_log* p_log,
+                hal::u64 p_received_at,
+                hal::byte p_id,
+                dynamixel::status p_status,
+                std::span<hal::byte const> p_parameters)
+{
+  if (p_log && p_status.received()) {
+    p_log->append(p_received_at,
+                  telemetry_source::dynamixel,
+                  p_id,
+                  p_status.error,
+                  p_parameters);
+  }
+}
+}  // namespace
+
+bool dynamixel_servo::health::input_voltage_error() const noexcept
+{
+  return raw_error & dynamixel::input_voltage_error_bit;
+}
+
+bool dynamixel_servo::health::angle_limit_error() const noexcept
+{
+  return raw_error & dynamixel::angle_limit_error_bit;
+}
+
+bool dynamixel_servo::health::overheating_error() const noexcept
+{
+  return raw_error & dynamixel::overheating_error_bit;
+}
+
+bool dynamixel_servo::health::range_error() const noexcept
+{
+  return raw_error & dynamixel::range_error_bit;
+}
+
+bool dynamixel_servo::health::checksum_error() const noexcept
+{
+  return raw_error & dynamixel::checksum_error_bit;
+}
+
+bool dynamixel_servo::health::overload_error() const noexcept
+{
+  return raw_error & dynamixel::overload_error_bit;
+}
+
+bool dynamixel_servo::health::instruction_error() const noexcept
+{
+  return raw_error & dynamixel::instruction_error_bit;
+}
+
+bool dynamixel_servo::health::healthy() const noexcept
+{
+  return raw_error == 0;
+}
+
+dynamixel_servo::dynamixel_servo(
+  hal::strong_ptr<hal::serial> const& p_serial,
+  dynamixel_model const& p_model,
+  config const& p_settings,
+  hal::strong_ptr<hal::steady_clock> const& p_clock)
+  : m_serial(p_serial)
+  , m_clock(p_clock)
+  , m_model(&p_model)
+  , m_range(clamp_to_range(p_model, p_settings.min_angle),
+            clamp_to_range(p_model, p_settings.max_angle))
+  , m_response_timer({ .ceiling = p_settings.response_timeout,
+                        .adapt = p_settings.adapt_response_timeout })
+  , m_baud_rate(p_settings.baud_rate)
+  , m_id(p_settings.id)
+  , m_setup_torque_enable(p_settings.torque_enable)
+  , m_setup_cache_control_table(p_settings.cache_control_table)
+{
+  m_serial->configure({ .baud_rate = p_settings.baud_rate });
+  if (p_settings.deferred_setup) {
+    return;
+  }
+  // Each write waits for the servo's status packet, so no delays are needed
+  // between them.
+  baud_rate(p_settings.baud_rate);
+  torque_enable(p_settings.torque_enable);
+  angle_limits(p_settings.min_angle, p_settings.max_angle);
+  if (p_settings.cache_control_table) {
+    refresh_control_table();
+  }
+}
+
+usize dynamixel_servo::setup(std::span<dynamixel_servo* const> p_servos)
+{
+  return setup_group(p_servos.size(),
+                     [&p_servos](usize p_index) -> dynamixel_servo& {
+                       return *p_servos[p_index];
+                     });
+}
+
+usize dynamixel_servo::setup_group(usize p_count, servo_at p_servo)
+{
+  if (p_count == 0) {
+    return 0;
+  }
+  if (p_count > dynamixel::max_bulk_read_servos) {
+    hal::safe_throw(hal::argument_out_of_domain(&p_servo(0)));
+  }
+
+  auto& serial = *p_servo(0).m_serial;
+  std::array<hal::u8, dynamixel::max_bulk_read_servos> id_buffer{};
+  for (usize i = 0; i < p_count; i++) {
+    id_buffer[i] = p_servo(i).m_id;
+  }
+  auto const ids = std::span(id_buffer).first(p_count);
+
+  // cw_limit and ccw_limit are adjacent, so both go out as one 4 byte value
+  dynamixel::sync_write(serial,
+                        static_cast<hal::byte>(common_register::cw_limit),
+                        4,
+                        ids,
+                        [&p_servo](usize p_index) -> u32 {
+                          auto const& servo = p_servo(p_index);
+                          return servo.angle_to_raw(servo.m_range.first) |
+                                 (servo.angle_to_raw(servo.m_range.second)
+                                  << 16);
+                        });
+  dynamixel::sync_write(serial,
+                        static_cast<hal::byte>(common_register::torque_enable),
+                        1,
+                        ids,
+                        [&p_servo](usize p_index) -> u32 {
+                          return p_servo(p_index).m_setup_torque_enable;
+                        });
+
+  usize confirmed = 0;
+  for (usize i = 0; i < p_count; i++) {
+    if (p_servo(i).confirm_setup()) {
+      confirmed++;
+    }
+  }
+  return confirmed;
+}
+
+bool dynamixel_servo::ping_id(u8 p_id,
+                              hal::strong_ptr<hal::serial> const& p_serial,
+                              hal::strong_ptr<hal::steady_clock> const& p_clock)
+{
+  using namespace std::chrono_literals;
+  return dynamixel::ping(*p_serial, *p_clock, p_id, 500ms);
+}
+
+u8 dynamixel_servo::scan_for_id(
+  hal::strong_ptr<hal::serial> const& p_serial,
+  hal::strong_ptr<hal::steady_clock> const& p_clock)
+{
+  bool device_found = false;
+  for (u8 i = 0; i < 254; i++) {
+    device_found = dynamixel_servo::ping_id(i, p_serial, p_clock);
+    if (device_found) {
+      return i;
+    }
+  }
+  return 254;
+}
+
+std::span<u8> dynamixel_servo::scan(
+  hal::strong_ptr<hal::serial> const& p_serial,
+  hal::strong_ptr<hal::steady_clock> const& p_clock,
+  std::span<u8> p_found,
+  scan_settings const& p_settings)
+{
+  auto const window = dynamixel::ping_window(
+    p_settings.baud_rate, p_settings.return_delay, p_settings.margin);
+  auto const last_id = std::min<u8>(p_settings.last_id, 253);
+
+  usize found = 0;
+  for (unsigned id = p_settings.first_id; id <= last_id; id++) {
+    if (found == p_found.size()) {
+      break;
+    }
+    if (dynamixel::ping(*p_serial, *p_clock, id, window)) {
+      p_found[found++] = id;
+    }
+  }
+  return p_found.first(found);
+}
+
+void dynamixel_servo::led(bool p_on)
+{
+  write_u8(common_register::led_toggle, p_on);
+}
+
+bool dynamixel_servo::is_moving()
+{
+  return read_u8(common_register::moving_status) == 0x01;
+}
+
+float dynamixel_servo::speed()
+{
+  std::array<hal::byte, 2> bytes{};
+  if (not read_register(static_cast<hal::byte>(common_register::present_speed),
+                        bytes)) {
+    return m_telemetry.speed;
+  }
+  u16 const response = bytes[0] | (bytes[1] << 8);
+  m_telemetry.speed = signed_magnitude(response, rpm_range(*m_model));
+  return m_telemetry.speed;
+}
+
+float dynamixel_servo::voltage()
+{
+  std::array<hal::byte, 1> bytes{};
+  if (read_register(static_cast<hal::byte>(common_register::present_voltage),
+                    bytes)) {
+    m_telemetry.voltage = static_cast<float>(bytes[0]) / 10;
+  }
+  return m_telemetry.voltage;
+}
+
+u8 dynamixel_servo::temperature()
+{
+  std::array<hal::byte, 1> bytes{};
+  if (read_register(static_cast<hal::byte>(common_register::present_temp),
+                    bytes)) {
+    m_telemetry.temperature = bytes[0];
+  }
+  return m_telemetry.temperature;
+}
+
+dynamixel_servo::telemetry const& dynamixel_servo::read_telemetry()
+{
+  update_telemetry();
+  return m_telemetry;
+}
+
+usize dynamixel_servo::read_telemetry(
+  std::span<dynamixel_servo* const> p_servos)
+{
+  return read_telemetry_group(p_servos.size(),
+                              [&p_servos](usize p_index) -> dynamixel_servo& {
+                                return *p_servos[p_index];
+                              });
+}
+
+usize dynamixel_servo::read_telemetry_group(usize p_count, servo_at p_servo)
+{
+  if (p_count == 0) {
+    return 0;
+  }
+
+  usize updated = 0;
+  if (not p_servo(0).m_model->bulk_read) {
+    for (usize i = 0; i < p_count; i++) {
+      if (p_servo(i).update_telemetry()) {
+        updated++;
+      }
+    }
+    return updated;
+  }
+
+  if (p_count > dynamixel::max_bulk_read_servos) {
+    hal::safe_throw(hal::argument_out_of_domain(&p_servo(0)));
+  }
+
+  auto& first = p_servo(0);
+  auto const request_bytes = dynamixel::instruction_packet_size(3 * p_count);
+  std::array<hal::u8, dynamixel::max_bulk_read_servos> ids{};
+  for (usize i = 0; i < p_count; i++) {
+    ids[i] = p_servo(i).m_id;
+  }
+  dynamixel::write_bulk_read(*first.m_serial,
+                             dynamixel::telemetry_address,
+                             dynamixel::telemetry_length,
+                             std::span(ids).first(p_count));
+
+  for (usize i = 0; i < p_count; i++) {
+    auto& servo = p_servo(i);
+    std::array<hal::byte, dynamixel::telemetry_length> block{};
+    // Each servo waits for the one before it, so only the first response
+    // also waits for the request to go out
+    auto const timeout = servo.response_timeout(i == 0 ? request_bytes : 0,
+                                                dynamixel::telemetry_length);
+    auto const start = first.m_clock->uptime();
+    auto const status = dynamixel::read_status(
+      *first.m_serial, *first.m_clock, timeout, servo.m_id, block);
+    log_status(servo.m_telemetry_log,
+               first.m_clock->uptime(),
+               servo.m_id,
+               status,
+               block);
+    if (servo.m_recorder) {
+      transaction record{ .sent_at = start, .timeout = timeout, .attempts = 1 };
+      record.bytes_sent = i == 0 ? request_bytes : 0;
+      if (status.result == dynamixel::reply::timed_out) {
+        record.timeouts = 1;
+      } else if (status.received()) {
+        record.response_time = adaptive_timeout::elapsed(*first.m_clock, start);
+        record.bytes_received = dynamixel::status_packet_size(block.size());
+        record.completed = true;
+      }
+      servo.m_recorder->record(record);
+    }
+    if (not record(servo.m_health, status)) {
+      break;
+    }
+    servo.m_telemetry = decode_telemetry(*servo.m_model, block);
+    updated++;
+  }
+  return updated;
+}
+
+bool dynamixel_servo::refresh_control_table()
+{
+  auto const table = read_control_table();
+  if (not table) {
+    m_control_table_cached = false;
+    return false;
+  }
+  std::copy_n(table->begin(), m_control_table.size(), m_control_table.begin());
+  m_control_table_cached = true;
+  return true;
+}
+
+float dynamixel_servo::torque_limit()
+{
+  auto const response = read_u16(common_register::torque_limit);
+  return (static_cast<float>(response) / 1023) * 100.0f;
+}
+
+bool dynamixel_servo::torque_enable()
+{
+  return read_u8(common_register::torque_enable) == 0x01;
+}
+
+u8 dynamixel_servo::temperature_limit()
+{
+  return read_u8(common_register::temp_limit);
+}
+
+float dynamixel_servo::min_voltage()
+{
+  return static_cast<float>(read_u8(common_register::min_voltage)) / 10;
+}
+
+float dynamixel_servo::max_voltage()
+{
+  return static_cast<float>(read_u8(common_register::max_voltage)) / 10;
+}
+
+hertz dynamixel_servo::baud_rate()
+{
+  switch (read_u8(common_register::baud_rate)) {
+    case 1:
+      return 1000000;
+    case 3:
+      return 500000;
+    case 4:
+      return 400000;
+    case 7:
+      return 250000;
+    case 9:
+      return 200000;
+    case 16:
+      return 115200;
+    case 103:
+      return 19200;
+    case 207:
+      return 9600;
+    case 34:
+    default:
+      return 57600;
+  }
+}
+
+std::chrono::microseconds dynamixel_servo::return_delay_time()
+{
+  std::array<hal::byte, 1> bytes{};
+  if (read_register(static_cast<hal::byte>(common_register::return_delay),
+                    bytes)) {
+    m_return_delay = std::chrono::microseconds(bytes[0] * 2);
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(m_return_delay);
+}
+
+u8 dynamixel_servo::id()
+{
+  return m_id;
+}
+
+hal::degrees dynamixel_servo::min_angle()
+{
+  return raw_to_angle(read_u16(common_register::cw_limit));
+}
+
+hal::degrees dynamixel_servo::max_angle()
+{
+  return raw_to_angle(read_u16(common_register::ccw_limit));
+}
+
+hal::degrees dynamixel_servo::position()
+{
+  std::array<hal::byte, 2> bytes{};
+  if (read_register(static_cast<hal::byte>(common_register::present_position),
+                    bytes)) {
+    m_telemetry.position = raw_to_angle(bytes[0] | (bytes[1] << 8));
+  }
+  return m_telemetry.position;
+}
+
+u16 dynamixel_servo::punch()
+{
+  return read_u16(common_register::punch);
+}
+
+rpm dynamixel_servo::moving_speed()
+{
+  auto const response = read_u16(common_register::moving_speed);
+  return hal::map(response, rpm_raw_range, rpm_range(*m_model));
+}
+
+void dynamixel_servo::position(hal::degrees p_angle)
+{
+  auto const clamped_angle = std::clamp(p_angle, m_range.first, m_range.second);
+  write_u16(common_register::goal_position, angle_to_raw(clamped_angle));
+}
+
+void dynamixel_servo::stage_position(hal::degrees p_angle)
+{
+  auto const clamped_angle = std::clamp(p_angle, m_range.first, m_range.second);
+  auto const raw = angle_to_raw(clamped_angle);
+  stage_register(static_cast<hal::byte>(common_register::goal_position),
+                 std::array{ static_cast<hal::byte>(raw),
+                             static_cast<hal::byte>(raw >> 8) });
+}
+
+bool dynamixel_servo::instruction_registered()
+{
+  return read_u8(common_register::instruction_registered) == 0x01;
+}
+
+void dynamixel_servo::commit(std::span<dynamixel_servo* const> p_servos)
+{
+  commit_group(p_servos.size(),
+               [&p_servos](usize p_index) -> dynamixel_servo& {
+                 return *p_servos[p_index];
+               });
+}
+
+void dynamixel_servo::commit_group(usize p_count, servo_at p_servo)
+{
+  if (p_count == 0) {
+    return;
+  }
+
+  std::array<hal::byte, dynamixel::instruction_packet_size(0)> buffer{};
+  hal::write(*p_servo(0).m_serial,
+             dynamixel::build_action(buffer),
+             hal::never_timeout());
+
+  for (usize i = 0; i < p_count; i++) {
+    auto& servo = p_servo(i);
+    auto& staged = servo.m_staged;
+    if (not staged.pending) {
+      continue;
+    }
+    // Servos do not answer an ACTION, so it never counts as acknowledged
+    servo.cache_write(staged.address,
+                      std::span(staged.data).first(staged.size),
+                      false);
+    staged.pending = false;
+  }
+}
+
+bool dynamixel_servo::migrate_baud_rate(
+  std::span<dynamixel_servo* const> p_servos,
+  hertz p_baud)
+{
+  return migrate_baud_rate_group(
+    p_servos.size(),
+    [&p_servos](usize p_index) -> dynamixel_servo& {
+      return *p_servos[p_index];
+    },
+    p_baud);
+}
+
+bool dynamixel_servo::migrate_baud_rate_group(usize p_count,
+                                              servo_at p_servo,
+                                              hertz p_baud)
+{
+  auto const code = baud_rate_code(p_baud);
+  if (not code) {
+    // The first servo stands for the group, an empty group has none
+    hal::safe_throw(
+      hal::argument_out_of_domain(p_count > 0 ? &p_servo(0) : nullptr));
+  }
+  if (p_count == 0) {
+    return true;
+  }
+
+  auto& first = p_servo(0);
+  auto& serial = *first.m_serial;
+  auto& clock = *first.m_clock;
+  auto const previous = first.m_baud_rate;
+  auto const previous_code = baud_rate_code(previous);
+
+  broadcast_baud_rate(serial, clock, previous, *code);
+  serial.configure({ .baud_rate = p_baud });
+
+  bool all_answered = true;
+  for (usize i = 0; i < p_count; i++) {
+    auto const& servo = p_servo(i);
+    auto const window =
+      dynamixel::ping_window(p_baud, servo.m_return_delay, baud_verify_margin);
+    if (not dynamixel::ping(serial, clock, servo.m_id, window)) {
+      all_answered = false;
+      break;
+    }
+  }
+
+  if (not all_answered) {
+    if (previous_code) {
+      broadcast_baud_rate(serial, clock, p_baud, *previous_code);
+    }
+    serial.configure({ .baud_rate = previous });
+    return false;
+  }
+
+  for (usize i = 0; i < p_count; i++) {
+    auto& servo = p_servo(i);
+    servo.m_baud_rate = p_baud;
+    if (servo.m_control_table_cached) {
+      servo.m_control_table[static_cast<hal::byte>(
+        common_register::baud_rate)] = *code;
+    }
+  }
+  return true;
+}
+
+void dynamixel_servo::torque_enable(bool p_enable)
+{
+  write_u8(common_register::torque_enable, p_enable);
+}
+
+void dynamixel_servo::torque_limit(float p_percent)
+{
+  auto const clamped_percent = std::clamp(p_percent, 0.0f, 100.0f);
+  auto const value = static_cast<u16>(
+    hal::map(clamped_percent, percent_range, std::make_pair(0, 1023)));
+  write_u16(common_register::torque_limit, value);
+}
+
+void dynamixel_servo::temperature_limit(u8 p_temperature)
+{
+  auto const clamped_temp =
+    std::clamp(p_temperature, static_cast<u8>(0), static_cast<u8>(100));
+  write_u8(common_register::temp_limit, clamped_temp);
+}
+
+void dynamixel_servo::min_voltage(float p_voltage)
+{
+  auto const clamped_volt = std::clamp(
+    p_voltage, m_model->voltage_limit_min, m_model->voltage_limit_max);
+  write_u8(common_register::min_voltage, static_cast<u8>(clamped_volt * 10));
+}
+
+void dynamixel_servo::max_voltage(float p_voltage)
+{
+  auto const clamped_volt = std::clamp(
+    p_voltage, m_model->voltage_limit_min, m_model->voltage_limit_max);
+  write_u8(common_register::max_voltage, static_cast<u8>(clamped_volt * 10));
+}
+
+void dynamixel_servo::baud_rate(hertz p_baud)
+{
+  write_u8(common_register::baud_rate,
+           baud_rate_code(p_baud).value_or(default_baud_rate_code));
+  m_serial->configure({ .baud_rate = p_baud });
+  m_baud_rate = p_baud;
+}
+
+void dynamixel_servo::return_delay_time(
+  std::chrono::microseconds p_microseconds)
+{
+  auto const value = static_cast<int>(p_microseconds.count() / 2);
+  auto const clamped_value = static_cast<u8>(std::clamp(value, 0, 254));
+  write_u8(common_register::return_delay, clamped_value);
+  m_return_delay = std::chrono::microseconds(clamped_value * 2);
+}
+
+void dynamixel_servo::reassign_id(u8 p_id)
+{
+  m_id = std::clamp(p_id, static_cast<u8>(0), static_cast<u8>(253));
+  write_u8(common_register::id, p_id);
+}
+
+void dynamixel_servo::min_angle(hal::degrees p_angle)
+{
+  m_range.first = clamp_to_range(*m_model, p_angle);
+  write_u16(common_register::cw_limit, angle_to_raw(m_range.first));
+}
+
+void dynamixel_servo::max_angle(hal::degrees p_angle)
+{
+  m_range.second = clamp_to_range(*m_model, p_angle);
+  write_u16(common_register::ccw_limit, angle_to_raw(m_range.second));
+}
+
+void dynamixel_servo::angle_limits(hal::degrees p_min, hal::degrees p_max)
+{
+  m_range = { clamp_to_range(*m_model, p_min),
+              clamp_to_range(*m_model, p_max) };
+  auto const min_raw = angle_to_raw(m_range.first);
+  auto const max_raw = angle_to_raw(m_range.second);
+  write_register(static_cast<hal::byte>(common_register::cw_limit),
+                 std::array{ static_cast<hal::byte>(min_raw),
+                             static_cast<hal::byte>(min_raw >> 8),
+                             static_cast<hal::byte>(max_raw),
+                             static_cast<hal::byte>(max_raw >> 8) });
+}
+
+void dynamixel_servo::speed(float p_rpms)
+{
+  auto const range = rpm_range(*m_model);
+  auto const clamped_rpm = std::clamp(p_rpms, range.first, range.second);
+  write_u16(common_register::moving_speed,
+            static_cast<u16>(hal::map(clamped_rpm, range, rpm_raw_range)));
+}
+
+void dynamixel_servo::sync_position(hal::degrees p_angle,
+                                    dynamixel_servo& p_opposing_servo)
+{
+  auto const clamped_angle = std::clamp(p_angle, m_range.first, m_range.second);
+  auto const angle_byte = angle_to_raw(clamped_angle);
+  auto const reversed_angle =
+    static_cast<u16>(m_model->position_max - angle_byte);
+
+  std::array const ids{ m_id, p_opposing_servo.id() };
+  std::array const values{ angle_byte, reversed_angle };
+  sync_write(m_serial,
+             static_cast<hal::byte>(common_register::goal_position),
+             ids,
+             values);
+}
+
+void dynamixel_servo::sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                                 hal::byte p_address,
+                                 std::span<hal::u8 const> p_ids,
+                                 std::span<hal::u16 const> p_values)
+{
+  if (p_ids.size() != p_values.size()) {
+    hal::safe_throw(hal::argument_out_of_domain(p_serial.get()));
+  }
+  dynamixel::sync_write(
+    *p_serial, p_address, 2, p_ids, [&p_values](usize p_index) {
+      return p_values[p_index];
+    });
+}
+
+void dynamixel_servo::sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                                 hal::byte p_address,
+                                 std::span<hal::u8 const> p_ids,
+                                 std::span<hal::byte const> p_values)
+{
+  if (p_ids.size() != p_values.size()) {
+    hal::safe_throw(hal::argument_out_of_domain(p_serial.get()));
+  }
+  dynamixel::sync_write(
+    *p_serial, p_address, 1, p_ids, [&p_values](usize p_index) {
+      return p_values[p_index];
+    });
+}
+
+void dynamixel_servo::emergency_stop(
+  hal::strong_ptr<hal::serial> const& p_serial)
+{
+  std::array<hal::byte, dynamixel::instruction_packet_size(2)> buffer{};
+  std::array<hal::byte, 1> const torque_off{ 0x00 };
+  auto const packet = dynamixel::build_write(
+    buffer,
+    dynamixel::broadcast_id,
+    static_cast<hal::byte>(common_register::torque_enable),
+    torque_off);
+  hal::write(*p_serial, packet, hal::never_timeout());
+}
+
+void dynamixel_servo::sync_position(
+  hal::strong_ptr<hal::serial> const& p_serial,
+  dynamixel_model const& p_model,
+  std::span<hal::u8 const> p_ids,
+  std::span<hal::degrees const> p_angles)
+{
+  if (p_ids.size() != p_angles.size()) {
+    hal::safe_throw(hal::argument_out_of_domain(p_serial.get()));
+  }
+  dynamixel::sync_write(
+    *p_serial,
+    static_cast<hal::byte>(common_register::goal_position),
+    2,
+    p_ids,
+    [&p_angles, &p_model](usize p_index) {
+      return model_angle_to_raw(p_model, p_angles[p_index]);
+    });
+}
+
+bool dynamixel_servo::read_register(hal::byte p_address,
+                                    std::span<hal::byte> p_data)
+{
+  if (m_control_table_cached &&
+      p_address + p_data.size() <= m_control_table.size()) {
+    std::copy_n(
+      m_control_table.begin() + p_address, p_data.size(), p_data.begin());
+    return true;
+  }
+
+  std::array<hal::byte, dynamixel::instruction_packet_size(2)> request{};
+  dynamixel::build_read(
+    request, m_id, p_address, static_cast<hal::byte>(p_data.size()));
+  if (not transact(request, p_data)) {
+    std::ranges::fill(p_data, 0);
+    return false;
+  }
+  return true;
+}
+
+void dynamixel_servo::write_register(hal::byte p_address,
+                                     std::span<hal::byte const> p_data)
+{
+  if (p_data.size() > max_write) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+
+  // Built once, the same bytes are resent if the servo saw them corrupted
+  std::array<hal::byte, dynamixel::instruction_packet_size(8)> buffer{};
+  auto const packet = dynamixel::build_write(buffer, m_id, p_address, p_data);
+
+  bool acknowledged = false;
+  for (int attempt = 0; attempt < write_attempts; attempt++) {
+    acknowledged = transact(packet, {});
+    if (not acknowledged || not m_health.checksum_error()) {
+      break;
+    }
+  }
+  cache_write(p_address, p_data, acknowledged);
+}
+
+void dynamixel_servo::cache_write(hal::byte p_address,
+                                  std::span<hal::byte const> p_data,
+                                  bool p_acknowledged)
+{
+  if (not m_control_table_cached || p_address >= m_control_table.size()) {
+    return;
+  }
+  if (not p_acknowledged || m_health.raw_error != 0) {
+    m_control_table_cached = false;
+    return;
+  }
+  auto const cached =
+    std::min<usize>(p_data.size(), m_control_table.size() - p_address);
+  std::copy_n(p_data.begin(), cached, m_control_table.begin() + p_address);
+}
+
+void dynamixel_servo::stage_register(hal::byte p_address,
+                                     std::span<hal::byte const> p_data)
+{
+  if (p_data.size() > max_write) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+
+  std::array<hal::byte, dynamixel::instruction_packet_size(8)> buffer{};
+  auto const packet =
+    dynamixel::build_reg_write(buffer, m_id, p_address, p_data);
+
+  m_staged.pending = false;
+  for (int attempt = 0; attempt < write_attempts; attempt++) {
+    if (not transact(packet, {})) {
+      return;
+    }
+    if (not m_health.checksum_error()) {
+      std::ranges::copy(p_data, m_staged.data.begin());
+      m_staged.address = p_address;
+      m_staged.size = static_cast<hal::u8>(p_data.size());
+      m_staged.pending = true;
+      return;
+    }
+  }
+}
+
+u16 dynamixel_servo::angle_to_raw(hal::degrees p_angle) const
+{
+  return model_angle_to_raw(*m_model, p_angle);
+}
+
+hal::degrees dynamixel_servo::raw_to_angle(u16 p_raw) const
+{
+  return hal::map(p_raw, position_raw_range(*m_model), angle_range(*m_model));
+}
+
+u16 dynamixel_servo::read_u16(common_register p_register)
+{
+  std::array<hal::byte, 2> bytes{};
+  read_register(static_cast<hal::byte>(p_register), bytes);
+  return bytes[0] | (bytes[1] << 8);
+}
+
+u8 dynamixel_servo::read_u8(common_register p_register)
+{
+  std::array<hal::byte, 1> bytes{};
+  read_register(static_cast<hal::byte>(p_register), bytes);
+  return bytes[0];
+}
+
+void dynamixel_servo::write_u16(common_register p_register, u16 p_value)
+{
+  write_register(static_cast<hal::byte>(p_register),
+                 std::array{ static_cast<hal::byte>(p_value),
+                             static_cast<hal::byte>(p_value >> 8) });
+}
+
+void dynamixel_servo::write_u8(common_register p_register, u8 p_value)
+{
+  write_register(static_cast<hal::byte>(p_register), std::array{ p_value });
+}
+
+bool dynamixel_servo::update_telemetry()
+{
+  std::array<hal::byte, dynamixel::instruction_packet_size(2)> request{};
+  dynamixel::build_read(request,
+                        m_id,
+                        dynamixel::telemetry_address,
+                        dynamixel::telemetry_length);
+  std::array<hal::byte, dynamixel::telemetry_length> block{};
+  if (not transact(request, block)) {
+    return false;
+  }
+  m_telemetry = decode_telemetry(*m_model, block);
+  return true;
+}
+
+std::optional<std::array<hal::byte, 0x24>> dynamixel_servo::read_control_table()
+{
+  std::array<hal::byte, 0x24> table{};
+  std::array<hal::byte, dynamixel::instruction_packet_size(2)> request{};
+  dynamixel::build_read(request, m_id, 0x00, table.size());
+  if (not transact(request, table)) {
+    return std::nullopt;
+  }
+  m_return_delay = std::chrono::microseconds(
+    table[static_cast<hal::byte>(common_register::return_delay)] * 2);
+  return table;
+}
+
+bool dynamixel_servo::confirm_setup()
+{
+  auto const table = read_control_table();
+  if (not table) {
+    return false;
+  }
+  if (m_setup_cache_control_table) {
+    std::copy_n(
+      table->begin(), m_control_table.size(), m_control_table.begin());
+    m_control_table_cached = true;
+  }
+
+  auto const word = [&table](common_register p_register) -> u16 {
+    auto const address = static_cast<hal::byte>(p_register);
+    return (*table)[address] | ((*table)[address + 1] << 8);
+  };
+  auto const torque_address =
+    static_cast<hal::byte>(common_register::torque_enable);
+  return word(common_register::cw_limit) == angle_to_raw(m_range.first) &&
+         word(common_register::ccw_limit) == angle_to_raw(m_range.second) &&
+         (*table)[torque_address] == m_setup_torque_enable;
+}
+
+hal::time_duration dynamixel_servo::response_timeout(
+  usize p_request_bytes,
+  usize p_response_parameters) const
+{
+  auto const bytes =
+    p_request_bytes + dynamixel::status_packet_size(p_response_parameters);
+  return dynamixel::wire_time(m_baud_rate, bytes) + m_return_delay +
+         m_response_timer.timeout();
+}
+
+bool dynamixel_servo::transact(std::span<hal::byte const> p_request,
+                               std::span<hal::byte> p_response)
+{
+  auto const begin = m_clock->uptime();
+  transaction record{ .sent_at = begin };
+  bool received = false;
+  for (hal::u8 attempt = 1;; attempt++) {
+    received = exchange(p_request, p_response, record);
+    if (received) {
+      break;
+    }
+    bool const within_budget =
+      adaptive_timeout::elapsed(*m_clock, begin) < m_retry.budget;
+    if (attempt >= m_retry.attempts || not within_budget) {
+      break;
+    }
+    // Drop what is left of a corrupted reply before asking again
+    m_serial->flush();
+  }
+
+  if (m_recorder) {
+    m_recorder->record(record);
+  }
+  return received;
+}
+
+bool dynamixel_servo::exchange(std::span<hal::byte const> p_request,
+                               std::span<hal::byte> p_response,
+                               transaction& p_transaction)
+{
+  auto const timeout = response_timeout(p_request.size(), p_response.size());
+  auto const start = m_clock->uptime();
+  hal::write(*m_serial, p_request, hal::never_timeout());
+  auto const status =
+    dynamixel::read_status(*m_serial, *m_clock, timeout, m_id, p_response);
+  p_transaction.timeout = timeout;
+  return finish_exchange(
+    p_request.size(), p_response, status, start, p_transaction);
+}
+
+bool dynamixel_servo::finish_exchange(usize p_request_bytes,
+                                      std::span<hal::byte const> p_response,
+                                      dynamixel::status const& p_status,
+                                      hal::u64 p_start,
+                                      transaction& p_transaction)
+{
+  log_status(m_telemetry_log, m_clock->uptime(), m_id, p_status, p_response);
+
+  p_transaction.attempts++;
+  p_transaction.bytes_sent += p_request_bytes;
+  if (p_status.result == dynamixel::reply::timed_out) {
+    m_response_timer.record_timeout();
+    p_transaction.timeouts++;
+  } else if (p_status.received()) {
+    auto const on_wire = dynamixel::wire_time(
+      m_baud_rate,
+      p_request_bytes + dynamixel::status_packet_size(p_response.size()));
+    auto const round_trip = adaptive_timeout::elapsed(*m_clock, p_start);
+    m_response_timer.record(
+      std::max(round_trip - on_wire - m_return_delay, hal::time_duration{}));
+    p_transaction.response_time = round_trip;
+    p_transaction.bytes_received =
+      dynamixel::status_packet_size(p_response.size());
+    p_transaction.completed = true;
+  }
+  return record(m_health, p_status);
+}
+
+void dynamixel_servo::read_register_async(hal::byte p_address,
+                                          std::span<hal::byte> p_data,
+                                          completion_handler p_on_complete)
+{
+  if (m_async.pending) {
+    hal::safe_throw(hal::device_or_resource_busy(this));
+  }
+  if (p_data.size() > max_async_read) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+
+  m_async.timed_out = false;
+  if (m_control_table_cached &&
+      p_address + p_data.size() <= m_control_table.size()) {
+    std::copy_n(
+      m_control_table.begin() + p_address, p_data.size(), p_data.begin());
+    if (p_on_complete) {
+      p_on_complete(true);
+    }
+    return;
+  }
+
+  m_async.request_size =
+    dynamixel::build_read(
+      m_async.request, m_id, p_address, static_cast<hal::byte>(p_data.size()))
+      .size();
+  m_async.status_size = dynamixel::status_packet_size(p_data.size());
+  m_async.data = p_data;
+  m_async.on_complete = std::move(p_on_complete);
+  m_async.is_write = false;
+  m_async.record = { .sent_at = m_clock->uptime() };
+  m_async.pending = true;
+  send_async();
+}
+
+void dynamixel_servo::write_register_async(hal::byte p_address,
+                                           std::span<hal::byte const> p_data,
+                                           completion_handler p_on_complete)
+{
+  if (m_async.pending) {
+    hal::safe_throw(hal::device_or_resource_busy(this));
+  }
+  if (p_data.size() > max_write) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+
+  m_async.request_size =
+    dynamixel::build_write(m_async.request, m_id, p_address, p_data).size();
+  m_async.status_size = dynamixel::status_packet_size(0);
+  m_async.data = {};
+  m_async.on_complete = std::move(p_on_complete);
+  m_async.is_write = true;
+  m_async.writes = 1;
+  m_async.record = { .sent_at = m_clock->uptime() };
+  m_async.timed_out = false;
+  m_async.pending = true;
+  send_async();
+}
+
+dynamixel_servo::request_status dynamixel_servo::poll()
+{
+  if (not m_async.pending) {
+    return m_async.timed_out ? request_status::timed_out
+                             : request_status::complete;
+  }
+
+  auto status = dynamixel::continue_status(
+    *m_serial,
+    m_id,
+    std::span(m_async.status).first(m_async.status_size),
+    m_async.received);
+  if (not status) {
+    if (m_clock->uptime() < m_async.deadline) {
+      return request_status::pending;
+    }
+    status = dynamixel::status{ .result = dynamixel::reply::timed_out };
+  }
+
+  auto const parameters = std::span(m_async.status)
+                            .subspan(5, m_async.status_size - 6);
+  bool const received = finish_exchange(m_async.request_size,
+                                        parameters,
+                                        *status,
+                                        m_async.start,
+                                        m_async.record);
+  bool const resend_write = received && m_async.is_write &&
+                            m_health.checksum_error() &&
+                            m_async.writes < write_attempts;
+  bool const within_budget =
+    adaptive_timeout::elapsed(*m_clock, m_async.record.sent_at) <
+    m_retry.budget;
+  bool const retry = not received &&
+                     m_async.record.attempts < m_retry.attempts &&
+                     within_budget;
+  if (resend_write || retry) {
+    if (resend_write) {
+      m_async.writes++;
+    } else {
+      // Drop what is left of a corrupted reply before asking again
+      m_serial->flush();
+    }
+    send_async();
+    return request_status::pending;
+  }
+
+  complete_async(received);
+  return received ? request_status::complete : request_status::timed_out;
+}
+
+void dynamixel_servo::send_async()
+{
+  auto const request = std::span(m_async.request).first(m_async.request_size);
+  auto const timeout =
+    response_timeout(request.size(), m_async.status_size - 6);
+  m_async.start = m_clock->uptime();
+  m_async.deadline = hal::future_deadline(*m_clock, timeout);
+  m_async.received = 0;
+  m_async.record.timeout = timeout;
+  hal::write(*m_serial, request, hal::never_timeout());
+}
+
+void dynamixel_servo::complete_async(bool p_received)
+{
+  auto const parameters = std::span(m_async.status)
+                            .subspan(5, m_async.status_size - 6);
+  if (p_received) {
+    std::ranges::copy(parameters, m_async.data.begin());
+  } else {
+    std::ranges::fill(m_async.data, 0);
+  }
+  if (m_async.is_write) {
+    // The packet holds 0xFF 0xFF, id, length, instruction and address, then
+    // the registers written up to the checksum
+    auto const packet = std::span(m_async.request).first(m_async.request_size);
+    cache_write(packet[5], packet.subspan(6, packet.size() - 7), p_received);
+  }
+  if (m_recorder) {
+    m_recorder->record(m_async.record);
+  }
+  m_async.pending = false;
+  m_async.timed_out = not p_received;
+  // Moved out first, so the handler may start the next request
+  auto on_complete = std::move(m_async.on_complete);
+  m_async.on_complete = {};
+  if (on_complete) {
+    on_complete(p_received);
+  }
+}
+}  // namespace hal::actuator
@@ -13,384 +13,225 @@
 // limitations under the License.
 
 #include <algorithm>
-#include <bitset>
-#include <chrono>
-#include <numeric>
-#include <utility>
+#include <cmath>
+#include <span>
 
+#include <libhal-actuator/dynamixel_servo.hpp>
 #include <libhal-actuator/mx_64.hpp>
-#include <libhal-util/bit.hpp>
-#include <libhal-util/map.hpp>
-#include <libhal-util/serial.hpp>
-#include <libhal-util/steady_clock.hpp>
 #include <libhal/error.hpp>
 #include <libhal/pointers.hpp>
 #include <libhal/serial.hpp>
-#include <libhal/timeout.hpp>
 #include <libhal/units.hpp>
 
 namespace hal::actuator {
-
-constexpr auto position_raw_range = std::make_pair<u16, u16>(0, 4095);
-constexpr auto max_degree_range =
-  std::make_pair<hal::degrees, hal::degrees>(0.0f, 360.0f);
-constexpr auto rpm_range = std::make_pair<rpm, rpm>(0, 114);
-constexpr auto rpm_raw_range = std::make_pair<u16, u16>(0, 1023);
+namespace {
+/// Steps per turn with a resolution divider of 1
+constexpr hal::i32 steps_per_turn = 4096;
+/// Largest position, either way, reported in multi-turn mode
+constexpr hal::i32 multi_turn_limit = 28672;
+/// Steps between two positions the servo reports the same way
+constexpr hal::i32 window = 2 * multi_turn_limit;
+constexpr hal::i16 max_multi_turn_offset = 24576;
+constexpr hal::u8 max_resolution_divider = 4;
+/// Angle limit written to both limits to select multi-turn mode
+constexpr hal::u16 multi_turn_limits = 4095;
+/// Acceleration per LSB of goal_accel in degrees per second squared
+constexpr float acceleration_per_lsb = 8.583f;
+constexpr hal::u8 max_goal_accel = 254;
+/// Current per LSB of goal_torque and current
+constexpr float amperes_per_lsb = 0.0045f;
+constexpr hal::u16 max_goal_torque = 1023;
+/// Bit set in goal_torque for clockwise torque
+constexpr hal::u16 clockwise_torque_bit = 1 << 10;
+/// Value of the current register when no current flows
+constexpr hal::i32 zero_current = 2048;
+}  // namespace
 
 mx_64::mx_64(hal::strong_ptr<hal::serial> const& p_serial,
              config const& p_settings,
              hal::strong_ptr<hal::steady_clock> const& p_clock)
-  : m_serial(p_serial)
-  , m_clock(p_clock)
-  , m_id(p_settings.id)
-{
-  using namespace std::chrono_literals;
-  m_serial->configure({ .baud_rate = p_settings.baud_rate });
-  baud_rate(p_settings.baud_rate);
-  hal::delay(*m_clock, 5ms);
-  torque_enable(p_settings.torque_enable);
-  hal::delay(*m_clock, 5ms);
-  min_angle(p_settings.min_angle);
-  m_range.first = p_settings.min_angle;
-  hal::delay(*m_clock, 5ms);
-  max_angle(p_settings.max_angle);
-  m_range.second = p_settings.max_angle;
-  hal::delay(*m_clock, 5ms);
-};
-
-bool mx_64::ping_id(u8 p_id,
-                    hal::strong_ptr<hal::serial> const& p_serial,
-                    hal::strong_ptr<hal::steady_clock> const& p_clock)
-{
-  using namespace std::chrono_literals;
-  std::array<hal::byte, 6> send_bytes = { 0xFF, 0xFF, (hal::byte)p_id,
-                                          0x02, 0x01, 0x00 };
-  hal::byte const checksum = std::accumulate(&send_bytes[2], &send_bytes[5], 0);
-  send_bytes[5] = ~checksum;
-  hal::write(*p_serial, send_bytes, hal::never_timeout());
-
-  try {
-    auto response =
-      hal::read<6>(*p_serial, hal::create_timeout(*p_clock, 500ms));
-    if (response[0] == 0xFF && response[1] == 0xFF) {
-      // device responded, id is valid
-      return true;
-    }
-  } catch (hal::timed_out const&) {
-    return false;
-  }
-  return true;
-}
-
-u8 mx_64::scan_for_id(hal::strong_ptr<hal::serial> const& p_serial,
-                      hal::strong_ptr<hal::steady_clock> const& p_clock)
-{
-  bool device_found = false;
-  for (u8 i = 0; i < 254; i++) {
-    device_found = mx_64::ping_id(i, p_serial, p_clock);
-    if (device_found) {
-      return i;
-    }
-  }
-  return 254;
-}
-
-void mx_64::led(bool p_on)
-{
-  write_register(register_byte::led_toggle,
-                 std::array{ static_cast<byte>(p_on) });
-}
-
-bool mx_64::is_moving()
+  : dynamixel_servo(p_serial, dynamixel_mx_64, p_settings, p_clock)
 {
-  auto const response = mx_64::read_register<1>(register_byte::moving_status);
-  if (response[0] == 0x01) {
-    return true;
-  }
-  return false;
-}
-
-float mx_64::speed()
-{
-  auto const bytes = mx_64::read_register<2>(register_byte::present_speed);
-  u16 const response = (bytes[0] | (bytes[1] << 8));
-  std::bitset<16> bits{ response };
-  bool const clockwise = bits[9];  // 10th bit is direction
-  bits.set(9, false);
-  float const rpms = hal::map(response, rpm_raw_range, rpm_range);
-  if (clockwise) {
-    return rpms;
-  }
-  return -rpms;
-}
-
-float mx_64::voltage()
-{
-  auto const response =
-    mx_64::read_register<1>(register_byte::present_voltage)[0];
-  return static_cast<float>(response) / 10;
 }
 
-u8 mx_64::temperature()
+usize mx_64::setup(std::span<mx_64* const> p_servos)
 {
-  return mx_64::read_register<1>(register_byte::present_temp)[0];
+  return setup_group(p_servos.size(),
+                     [&p_servos](usize p_index) -> dynamixel_servo& {
+                       return *p_servos[p_index];
+                     });
 }
 
-float mx_64::torque_limit()
+usize mx_64::read_telemetry(std::span<mx_64* const> p_servos)
 {
-  auto const bytes = mx_64::read_register<2>(register_byte::torque_limit);
-  u16 const response = (bytes[0] | (bytes[1] << 8));
-  return (static_cast<float>(response) / 1023) * 100.0f;
+  return read_telemetry_group(p_servos.size(),
+                              [&p_servos](usize p_index) -> dynamixel_servo& {
+                                return *p_servos[p_index];
+                              });
 }
 
-bool mx_64::torque_enable()
+void mx_64::commit(std::span<mx_64* const> p_servos)
 {
-  auto const enabled_byte =
-    mx_64::read_register<1>(mx_64::register_byte::torque_enable)[0];
-  return enabled_byte == 0x01;
+  commit_group(p_servos.size(),
+               [&p_servos](usize p_index) -> dynamixel_servo& {
+                 return *p_servos[p_index];
+               });
 }
 
-u8 mx_64::temperature_limit()
+bool mx_64::migrate_baud_rate(std::span<mx_64* const> p_servos, hertz p_baud)
 {
-  return mx_64::read_register<1>(register_byte::temp_limit)[0];
+  return migrate_baud_rate_group(
+    p_servos.size(),
+    [&p_servos](usize p_index) -> dynamixel_servo& {
+      return *p_servos[p_index];
+    },
+    p_baud);
 }
 
-float mx_64::min_voltage()
+void mx_64::extended_position_mode(extended_settings const& p_settings)
 {
-  auto const response = mx_64::read_register<1>(register_byte::min_voltage)[0];
-  return (static_cast<float>(response) / 10);
-}
-
-float mx_64::max_voltage()
-{
-  auto const response = mx_64::read_register<1>(register_byte::max_voltage)[0];
-  return (static_cast<float>(response) / 10);
-}
-
-hertz mx_64::baud_rate()
-{
-  auto const response = mx_64::read_register<1>(register_byte::baud_rate)[0];
-  switch (response) {
-    case 1:
-      return 1000000;
-    case 3:
-      return 500000;
-    case 4:
-      return 400000;
-    case 7:
-      return 250000;
-    case 9:
-      return 200000;
-    case 16:
-      return 115200;
-    case 103:
-      return 19200;
-    case 207:
-      return 9600;
-    case 34:
-    default:
-      return 57600;
+  if (p_settings.resolution_divider < 1 ||
+      p_settings.resolution_divider > max_resolution_divider ||
+      p_settings.multi_turn_offset < -max_multi_turn_offset ||
+      p_settings.multi_turn_offset > max_multi_turn_offset) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
   }
-}
 
-std::chrono::microseconds mx_64::return_delay_time()
-{
-  auto const response = mx_64::read_register<1>(register_byte::return_delay)[0];
-  return std::chrono::microseconds(response * 2);
-}
-
-u8 mx_64::id()
-{
-  return m_id;
-}
-
-hal::degrees mx_64::min_angle()
-{
-  auto const bytes = mx_64::read_register<2>(register_byte::cw_limit);
-  u16 const angle_byte = (bytes[0] | (bytes[1] << 8));
-  return hal::map(angle_byte, position_raw_range, max_degree_range);
-}
-
-hal::degrees mx_64::max_angle()
-{
-  auto const bytes = mx_64::read_register<2>(register_byte::ccw_limit);
-  u16 const angle_byte = (bytes[0] | (bytes[1] << 8));
-  return hal::map(angle_byte, position_raw_range, max_degree_range);
-}
-
-hal::degrees mx_64::position()
-{
-  auto const bytes = mx_64::read_register<2>(register_byte::present_position);
-  u16 const angle_byte = (bytes[0] | (bytes[1] << 8));
-  return hal::map(angle_byte, position_raw_range, max_degree_range);
-}
-
-u16 mx_64::punch()
-{
-  auto const bytes = mx_64::read_register<2>(register_byte::punch);
-  return (bytes[0] | (bytes[1] << 8));
-}
-
-rpm mx_64::moving_speed()
-{
-  auto const bytes = mx_64::read_register<2>(register_byte::moving_speed);
-  u16 const response = (bytes[0] | (bytes[1] << 8));
-  return hal::map(response, rpm_raw_range, rpm_range);
+  auto const offset = static_cast<hal::u16>(p_settings.multi_turn_offset);
+  // multi_turn_offset and resolution_divider are contiguous
+  write_register(static_cast<hal::byte>(register_byte::multi_turn_offset),
+                 std::array{ static_cast<hal::byte>(offset),
+                             static_cast<hal::byte>(offset >> 8),
+                             p_settings.resolution_divider });
+  write_register(static_cast<hal::byte>(register_byte::cw_limit),
+                 std::array{ static_cast<hal::byte>(multi_turn_limits),
+                             static_cast<hal::byte>(multi_turn_limits >> 8),
+                             static_cast<hal::byte>(multi_turn_limits),
+                             static_cast<hal::byte>(multi_turn_limits >> 8) });
+
+  m_resolution_divider = p_settings.resolution_divider;
+  m_wraps = 0;
+  std::array<hal::byte, 2> bytes{};
+  read_register(static_cast<hal::byte>(register_byte::present_position), bytes);
+  m_last_raw = static_cast<hal::i16>(bytes[0] | (bytes[1] << 8));
+}
+
+hal::degrees mx_64::extended_position()
+{
+  std::array<hal::byte, 2> bytes{};
+  if (read_register(static_cast<hal::byte>(register_byte::present_position),
+                    bytes)) {
+    accumulate(static_cast<hal::i16>(bytes[0] | (bytes[1] << 8)));
+  }
+  auto const steps = (m_wraps * window) + m_last_raw;
+  auto const degrees_per_step =
+    360.0f * static_cast<float>(m_resolution_divider) / steps_per_turn;
+  return static_cast<float>(steps) * degrees_per_step;
 }
 
-void mx_64::position(hal::degrees p_angle)
+void mx_64::extended_position(hal::degrees p_angle)
 {
-  auto const clamped_angle = std::clamp(p_angle, m_range.first, m_range.second);
-  auto const angle_byte = static_cast<u16>(
-    hal::map(clamped_angle, max_degree_range, position_raw_range));
-  hal::byte const value_low = angle_byte;
-  hal::byte const value_hi = (angle_byte >> 8);
-  write_register(register_byte::goal_position,
-                 std::array{ value_low, value_hi });
+  auto const steps_per_degree =
+    steps_per_turn / (360.0f * static_cast<float>(m_resolution_divider));
+  auto const steps = std::lround(p_angle * steps_per_degree);
+  auto const in_window =
+    std::clamp<long>(steps - (static_cast<long>(m_wraps) * window),
+                     -multi_turn_limit,
+                     multi_turn_limit);
+  auto const raw = static_cast<hal::u16>(static_cast<hal::i16>(in_window));
+  write_register(static_cast<hal::byte>(register_byte::goal_position),
+                 std::array{ static_cast<hal::byte>(raw),
+                             static_cast<hal::byte>(raw >> 8) });
 }
 
-void mx_64::torque_enable(bool p_enable)
+hal::i32 mx_64::turns() const
 {
-  write_register(register_byte::led_toggle,
-                 std::array{ static_cast<byte>(p_enable) });
+  auto const steps = (m_wraps * window) + m_last_raw;
+  auto const per_turn = steps_per_turn / m_resolution_divider;
+  // Round toward negative infinity, unlike integer division
+  return (steps >= 0 ? steps : steps - per_turn + 1) / per_turn;
 }
 
-void mx_64::torque_limit(float p_percent)
+void mx_64::accumulate(hal::i16 p_raw)
 {
-  auto const clamped_percent = std::clamp(p_percent, 0.0f, 100.0f);
-  auto const value = static_cast<u16>(hal::map(
-    clamped_percent, std::make_pair(0.0f, 100.0f), std::make_pair(0, 1023)));
-  hal::byte const value_low = value;
-  hal::byte const value_hi = (value >> 8);
-  write_register(register_byte::torque_limit,
-                 std::array{ value_low, value_hi });
+  auto const change = static_cast<hal::i32>(p_raw) - m_last_raw;
+  if (change > multi_turn_limit) {
+    m_wraps--;
+  } else if (change < -multi_turn_limit) {
+    m_wraps++;
+  }
+  m_last_raw = p_raw;
 }
 
-void mx_64::temperature_limit(u8 p_temperature)
+void mx_64::goal_acceleration(float p_acceleration)
 {
-  auto const clamped_temp =
-    std::clamp(p_temperature, static_cast<u8>(0), static_cast<u8>(100));
-  write_register(register_byte::temp_limit, std::array{ clamped_temp });
+  auto const steps =
+    std::lround(std::max(p_acceleration, 0.0f) / acceleration_per_lsb);
+  auto const raw =
+    static_cast<hal::byte>(std::min<long>(steps, max_goal_accel));
+  write_register(static_cast<hal::byte>(register_byte::goal_accel),
+                 std::array{ raw });
 }
 
-void mx_64::min_voltage(float p_voltage)
+float mx_64::goal_acceleration()
 {
-  auto const clamped_volt = std::clamp(p_voltage, 5.0f, 16.0f);
-  auto const value = static_cast<u8>(clamped_volt * 10);
-  write_register(register_byte::min_voltage, std::array{ value });
+  std::array<hal::byte, 1> bytes{};
+  read_register(static_cast<hal::byte>(register_byte::goal_accel), bytes);
+  return static_cast<float>(bytes[0]) * acceleration_per_lsb;
 }
 
-void mx_64::max_voltage(float p_voltage)
+void mx_64::torque_mode(bool p_enable)
 {
-  auto const clamped_volt = std::clamp(p_voltage, 5.0f, 16.0f);
-  auto const value = static_cast<u8>(clamped_volt * 10);
-  write_register(register_byte::max_voltage, std::array{ value });
+  write_register(
+    static_cast<hal::byte>(register_byte::torque_ctrl_mode_enable),
+    std::array{ static_cast<hal::byte>(p_enable) });
 }
 
-void mx_64::baud_rate(hertz p_baud)
+void mx_64::goal_torque(hal::ampere p_current)
 {
-  u8 baud_byte = 0x00;
-  switch (static_cast<u32>(p_baud)) {
-    case 1000000:
-      baud_byte = 1;
-      break;
-    case 500000:
-      baud_byte = 3;
-      break;
-    case 400000:
-      baud_byte = 4;
-      break;
-    case 250000:
-      baud_byte = 7;
-      break;
-    case 200000:
-      baud_byte = 9;
-      break;
-    case 115200:
-      baud_byte = 16;
-      break;
-    case 19200:
-      baud_byte = 103;
-      break;
-    case 9600:
-      baud_byte = 207;
-      break;
-    case 57600:
-    default:
-      baud_byte = 34;
-      break;
+  auto const steps = std::lround(std::abs(p_current) / amperes_per_lsb);
+  auto raw = static_cast<hal::u16>(std::min<long>(steps, max_goal_torque));
+  if (p_current < 0.0f) {
+    raw |= clockwise_torque_bit;
   }
-  write_register(register_byte::baud_rate, std::array{ baud_byte });
-  m_serial->configure({ .baud_rate = p_baud });
+  write_register(static_cast<hal::byte>(register_byte::goal_torque),
+                 std::array{ static_cast<hal::byte>(raw),
+                             static_cast<hal::byte>(raw >> 8) });
 }
 
-void mx_64::return_delay_time(std::chrono::microseconds p_microseconds)
+hal::ampere mx_64::current()
 {
-  auto const value = static_cast<int>(p_microseconds.count() / 2);
-  auto const clamped_value = static_cast<u8>(std::clamp(value, 0, 254));
-  write_register(register_byte::return_delay, std::array{ clamped_value });
-}
-
-void mx_64::reassign_id(u8 p_id)
-{
-  m_id = std::clamp(p_id, static_cast<u8>(0), static_cast<u8>(253));
-  write_register(register_byte::id, std::array{ p_id });
-}
-
-void mx_64::min_angle(hal::degrees p_angle)
-{
-  m_range.first =
-    std::clamp(p_angle, max_degree_range.first, max_degree_range.second);
-  auto const angle_byte = static_cast<u16>(
-    hal::map(m_range.first, max_degree_range, position_raw_range));
-  hal::byte const value_low = angle_byte;
-  hal::byte const value_hi = (angle_byte >> 8);
-  write_register(register_byte::cw_limit, std::array{ value_low, value_hi });
+  std::array<hal::byte, 2> bytes{};
+  if (not read_register(static_cast<hal::byte>(register_byte::current),
+                        bytes)) {
+    return 0.0f;
+  }
+  auto const raw = static_cast<hal::i32>(bytes[0] | (bytes[1] << 8));
+  return static_cast<float>(raw - zero_current) * amperes_per_lsb;
 }
 
-void mx_64::max_angle(hal::degrees p_angle)
+void mx_64::sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                       register_byte p_register,
+                       std::span<hal::u8 const> p_ids,
+                       std::span<hal::u16 const> p_values)
 {
-  m_range.second =
-    std::clamp(p_angle, max_degree_range.first, max_degree_range.second);
-  auto const angle_byte = static_cast<u16>(
-    hal::map(m_range.second, max_degree_range, position_raw_range));
-  hal::byte const value_low = angle_byte;
-  hal::byte const value_hi = (angle_byte >> 8);
-  write_register(register_byte::ccw_limit, std::array{ value_low, value_hi });
+  dynamixel_servo::sync_write(
+    p_serial, static_cast<hal::byte>(p_register), p_ids, p_values);
 }
 
-void mx_64::speed(float p_rpms)
+void mx_64::sync_write(hal::strong_ptr<hal::serial> const& p_serial,
+                       register_byte p_register,
+                       std::span<hal::u8 const> p_ids,
+                       std::span<hal::byte const> p_values)
 {
-  auto const clamped_rpm =
-    std::clamp(p_rpms, rpm_range.first, rpm_range.second);
-  auto const speed_byte =
-    static_cast<u16>(hal::map(clamped_rpm, rpm_range, rpm_raw_range));
-  hal::byte const value_low = speed_byte;
-  hal::byte const value_hi = (speed_byte >> 8);
-  write_register(register_byte::moving_speed,
-                 std::array{ value_low, value_hi });
+  dynamixel_servo::sync_write(
+    p_serial, static_cast<hal::byte>(p_register), p_ids, p_values);
 }
 
-void mx_64::sync_position(hal::degrees p_angle, mx_64 p_opposing_servo)
+void mx_64::sync_position(hal::strong_ptr<hal::serial> const& p_serial,
+                          std::span<hal::u8 const> p_ids,
+                          std::span<hal::degrees const> p_angles)
 {
-  auto const clamped_angle = std::clamp(p_angle, m_range.first, m_range.second);
-  auto const angle_byte = static_cast<u16>(
-    hal::map(clamped_angle, max_degree_range, position_raw_range));
-  auto const reversed_angle = position_raw_range.second - angle_byte;
-
-  u8 const angle_low = angle_byte;
-  u8 const angle_hi = (angle_byte >> 8);
-  u8 const reversed_low = reversed_angle;
-  u8 const reversed_hi = (reversed_angle >> 8);
-
-  auto const servo2_id = p_opposing_servo.id();
-  std::array<hal::byte, 14> send_bytes = {
-    0xFF, 0xFF,      0xFE,     0x0A,      0x83,         0x1E,        0x02,
-    m_id, angle_low, angle_hi, servo2_id, reversed_low, reversed_hi, 0x00
-  };
-  hal::byte const checksum =
-    std::accumulate(&send_bytes[2], &send_bytes[13], 0);
-  send_bytes[13] = ~checksum;
-  hal::write(*m_serial, send_bytes, hal::never_timeout());
+  dynamixel_servo::sync_position(p_serial, dynamixel_mx_64, p_ids, p_angles);
 }
 }  // namespace hal::actuator
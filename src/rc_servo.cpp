@@ -18,6 +18,8 @@
 #include <libhal-util/map.hpp>
 #include <libhal/error.hpp>
 #include <libhal/pwm.hpp>
+
+#include <algorithm>
 #include <limits>
 
 namespace hal::actuator {
@@ -83,35 +85,59 @@ void rc_servo::driver_position(hal::degrees p_position)
   m_pwm->duty_cycle(scaled_percent);
 }
 
+rc_servo16::calibration rc_servo16::calibrate(u32 p_frequency,
+                                              settings const& p_settings)
+{
+  using namespace rc_servo_fixed_point;
+
+  // Everything below runs once, so it is free to use 64-bit math and floats.
+  // Only integer constants are kept for the position updates.
+  constexpr u64 full_duty = std::numeric_limits<hal::u16>::max();
+  constexpr u64 microseconds_per_second = std::micro::den;
+  u64 const frequency = p_frequency;
+
+  auto const duty_of = [&](u64 p_microseconds) {
+    auto const duty =
+      full_duty * p_microseconds * frequency / microseconds_per_second;
+    return static_cast<u16>(std::min(full_duty, duty));
+  };
+
+  auto const min_angle = to_angle(p_settings.min_angle);
+  auto const max_angle = to_angle(p_settings.max_angle);
+  if (min_angle >= max_angle) {
+    hal::safe_throw(hal::argument_out_of_domain(nullptr));
+  }
+
+  auto const min_duty = duty_of(p_settings.min_microseconds);
+  auto const max_duty = duty_of(p_settings.max_microseconds);
+  // Negative for servos whose pulse width shrinks as the angle grows
+  auto const duty_span = static_cast<i64>(max_duty) - min_duty;
+  auto const angle_span = static_cast<i64>(max_angle) - min_angle;
+
+  return calibration{
+    .angle = { min_angle, max_angle },
+    .microseconds = std::minmax(p_settings.min_microseconds,
+                                p_settings.max_microseconds),
+    .duty = { min_duty, max_duty },
+    .duty_per_angle =
+      duty_span * (i64{ 1 } << slope_fraction_bits) / angle_span,
+    .duty_per_microsecond = static_cast<u32>(
+      (full_duty * frequency << pulse_fraction_bits) / microseconds_per_second),
+  };
+}
+
 void rc_servo16::setup(hal::pwm16_channel& p_pwm, settings const& p_settings)
 {
-  auto frequency = static_cast<float>(p_pwm.frequency());
-  // Calculate the wavelength in microseconds.
-  auto wavelength = (1.0f / frequency) * std::micro::den;
-  // TODO(kammce): check if this works
-  // min_percent represents the minimum float to be used with the pwm
-  // signal. The float is calculated by using the minimum width of the
-  // signal in microseconds divided by the wavelength to get the decimal
-  // representation of the float.
-  auto min_percent =
-    std::numeric_limits<hal::u16>::max() *
-    (static_cast<float>(p_settings.min_microseconds) / wavelength);
-  // max_percent represents the maximum float to be used with the pwm
-  // signal. The float is calculated by using the maximum width of the
-  // signal in microseconds divided by the wavelength to get the decimal
-  // representation of the float.
-  auto max_percent =
-    std::numeric_limits<hal::u16>::max() *
-    (static_cast<float>(p_settings.max_microseconds) / wavelength);
-  // percent_range holds float value of min_percent and max_percent for use
-  // with map function used in position().
-  auto percent_range = std::make_pair(min_percent, max_percent);
-  // angle_range holds degrees values of MinAngle and MaxAngle for use with
-  // map function and range checking used in postion()
-  auto angle_range = std::make_pair(static_cast<float>(p_settings.min_angle),
-                                    static_cast<float>(p_settings.max_angle));
-  // If no errors happen, call the constructor with verified parameters
-  m_ranges = ranges{ .percent = percent_range, .angle = angle_range };
+  m_calibration = calibrate(p_pwm.frequency(), p_settings);
+}
+
+u16 rc_servo16::clamp_duty(i64 p_duty) const
+{
+  // Rounding in the fixed point math may step a tick past the calibrated
+  // duty cycles, never further.
+  auto const [low, high] =
+    std::minmax(m_calibration.duty.first, m_calibration.duty.second);
+  return static_cast<u16>(std::clamp<i64>(p_duty, low, high));
 }
 
 rc_servo16::rc_servo16(hal::strong_ptr<hal::pwm16_channel> const& p_pwm,
@@ -133,15 +159,39 @@ rc_servo16::rc_servo16(hal::pwm_group_manager& p_pwm_manager,
 // Drivers must implement functions that are listed in interface.
 void rc_servo16::driver_position(hal::degrees p_position)
 {
-  if (p_position < std::get<0>(m_ranges.angle) ||
-      p_position > std::get<1>(m_ranges.angle)) {
+  auto const angle = rc_servo_fixed_point::to_angle(p_position);
+  if (angle < m_calibration.angle.first || angle > m_calibration.angle.second) {
     hal::safe_throw(hal::argument_out_of_domain(this));
   }
 
-  auto scaled_percent_raw = map(p_position, m_ranges.angle, m_ranges.percent);
-  auto scaled_percent =
-    static_cast<decltype(m_ranges.percent.first)>(scaled_percent_raw);
+  auto const duty = rc_servo_fixed_point::duty_of(angle,
+                                                  m_calibration.angle.first,
+                                                  m_calibration.duty.first,
+                                                  m_calibration.duty_per_angle);
+  m_pwm->duty_cycle(clamp_duty(duty));
+}
 
-  m_pwm->duty_cycle(scaled_percent);
+void rc_servo16::pulse_width(std::chrono::microseconds p_width)
+{
+  auto const width = p_width.count();
+  if (width < m_calibration.microseconds.first ||
+      width > m_calibration.microseconds.second) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+
+  auto const duty =
+    (static_cast<i64>(width) * m_calibration.duty_per_microsecond) >>
+    rc_servo_fixed_point::pulse_fraction_bits;
+  m_pwm->duty_cycle(clamp_duty(duty));
+}
+
+void rc_servo16::raw_duty_cycle(u16 p_duty_cycle)
+{
+  auto const [low, high] =
+    std::minmax(m_calibration.duty.first, m_calibration.duty.second);
+  if (p_duty_cycle < low || p_duty_cycle > high) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+  m_pwm->duty_cycle(p_duty_cycle);
 }
 }  // namespace hal::actuator
@@ -0,0 +1,106 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/smart_servo/rmd/can_dispatcher.hpp>
+
+#include <cstddef>
+
+#include <libhal/can.hpp>
+#include <libhal/error.hpp>
+
+#include "mc_x_constants.hpp"
+
+namespace hal::actuator {
+namespace {
+constexpr std::size_t invalid_slot = rmd_can_dispatcher::max_devices;
+
+/**
+ * @brief Map a response ID to its slot in the handler table
+ *
+ * MC-X responses (device ID + 0x100) and DRC responses (device ID) of the same
+ * device share a slot, as only one device can use an ID on a bus.
+ *
+ * @param p_id - ID of a message on the bus
+ * @return std::size_t - slot index or `invalid_slot`
+ */
+constexpr std::size_t slot(hal::u32 p_id)
+{
+  auto const device_id = p_id >= first_device_address + response_id_offset
+                           ? p_id - response_id_offset
+                           : p_id;
+  if (device_id < first_device_address || device_id > last_device_address) {
+    return invalid_slot;
+  }
+  return device_id - first_device_address;
+}
+
+static_assert(slot(0x140) == 0);
+static_assert(slot(0x241) == 1);
+static_assert(slot(0x160) == rmd_can_dispatcher::max_devices - 1);
+static_assert(slot(0x161) == invalid_slot);
+}  // namespace
+
+rmd_can_dispatcher::rmd_can_dispatcher(hal::can_transceiver& p_transceiver,
+                                       hal::can_identifier_filter& p_filter)
+  : m_transceiver(&p_transceiver)
+  , m_filter(&p_filter)
+  , m_receive_cursor(p_transceiver.receive_cursor())
+{
+}
+
+void rmd_can_dispatcher::attach(hal::u32 p_response_id, handler p_handler)
+{
+  auto const index = slot(p_response_id);
+  if (index == invalid_slot) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+  if (m_handlers[index]) {
+    hal::safe_throw(hal::device_or_resource_busy(this));
+  }
+  m_handlers[index] = p_handler;
+  m_filter->allow(p_response_id);
+}
+
+void rmd_can_dispatcher::detach(hal::u32 p_response_id)
+{
+  auto const index = slot(p_response_id);
+  if (index != invalid_slot) {
+    m_handlers[index] = nullptr;
+  }
+}
+
+void rmd_can_dispatcher::poll()
+{
+  auto const buffer = m_transceiver->receive_buffer();
+  auto const cursor = m_transceiver->receive_cursor();
+
+  while (m_receive_cursor != cursor) {
+    route(buffer[m_receive_cursor]);
+    m_receive_cursor = (m_receive_cursor + 1) % buffer.size();
+  }
+}
+
+void rmd_can_dispatcher::route(hal::can_message const& p_message)
+{
+  auto const index = slot(p_message.id);
+  if (index != invalid_slot && m_handlers[index]) {
+    m_handlers[index](p_message);
+  }
+}
+
+hal::can_transceiver& rmd_can_dispatcher::transceiver()
+{
+  return *m_transceiver;
+}
+}  // namespace hal::actuator
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+
+#include <libhal-actuator/smart_servo/rmd/drc_v2.hpp>
+#include <libhal-actuator/smart_servo/rmd/protocol.hpp>
+#include <libhal-util/enum.hpp>
 #include <libhal/units.hpp>
 
 namespace hal::actuator {
@@ -9,4 +14,68 @@ static constexpr float dps_per_lsb_speed = 0.01f;
 static constexpr float dps_per_lsb_angle = 1.0f;
 static constexpr std::uint8_t over_voltage_protection_tripped_mask = 0b1;
 static constexpr std::uint8_t over_temperature_protection_tripped_mask = 0b100;
+
+/// Status 2 fields, also returned by every actuation command
+constexpr std::array<rmd_field_layout, 4> drc_status_2_fields{ {
+  { .field = rmd_field::motor_temperature, .offset = 1, .width = 1 },
+  { .field = rmd_field::current, .offset = 2, .width = 2 },
+  { .field = rmd_field::speed, .offset = 4, .width = 2 },
+  { .field = rmd_field::encoder, .offset = 6, .width = 2 },
+} };
+
+/// Layout of the response to every command the DRC driver sends
+constexpr std::array drc_response_layouts{
+  rmd_response_layout{
+    .command = hal::value(rmd_drc_v2::read::status_2),
+    .field_count = 4,
+    .fields = drc_status_2_fields,
+  },
+  rmd_response_layout{
+    .command = hal::value(rmd_drc_v2::actuate::speed),
+    .field_count = 4,
+    .fields = drc_status_2_fields,
+  },
+  rmd_response_layout{
+    .command = hal::value(rmd_drc_v2::actuate::position_2),
+    .field_count = 4,
+    .fields = drc_status_2_fields,
+  },
+  rmd_response_layout{
+    .command = hal::value(rmd_drc_v2::read::status_1_and_error_flags),
+    .field_count = 3,
+    .fields = { {
+      { .field = rmd_field::motor_temperature, .offset = 1, .width = 1 },
+      { .field = rmd_field::volts, .offset = 3, .width = 2 },
+      { .field = rmd_field::error_state,
+        .offset = 7,
+        .width = 1,
+        .is_signed = false },
+    } },
+  },
+  rmd_response_layout{
+    .command = hal::value(rmd_drc_v2::read::multi_turns_angle),
+    .field_count = 1,
+    .fields = { {
+      { .field = rmd_field::multi_turn_angle, .offset = 1, .width = 7 },
+    } },
+  },
+  rmd_response_layout{ .command = hal::value(rmd_drc_v2::system::off) },
+  rmd_response_layout{ .command = hal::value(rmd_drc_v2::system::stop) },
+  rmd_response_layout{ .command = hal::value(rmd_drc_v2::system::running) },
+  rmd_response_layout{
+    .command = hal::value(rmd_drc_v2::system::clear_error_flag),
+  },
+};
+static_assert(rmd_layouts_fit(drc_response_layouts));
+
+/// Units per LSB of each field, the same as the feedback_t functions
+constexpr rmd_field_scales drc_field_scales{
+  1.0f,                 // motor_temperature: celsius
+  33.0f / 2048.0f,      // current: amperes
+  1.0_deg_per_sec,      // speed: rpm
+  1.0f,                 // encoder: raw count
+  0.1f,                 // volts: volts
+  1.0f,                 // error_state: raw flags
+  dps_per_lsb_speed,    // multi_turn_angle: degrees
+};
 }  // namespace hal::actuator
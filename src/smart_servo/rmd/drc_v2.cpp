@@ -14,9 +14,9 @@
 
 #include <libhal-actuator/smart_servo/rmd/drc_v2.hpp>
 
+#include <algorithm>
 #include <cstdint>
 
-#include <libhal-util/bit.hpp>
 #include <libhal-util/can.hpp>
 #include <libhal-util/enum.hpp>
 #include <libhal-util/map.hpp>
@@ -27,6 +27,7 @@
 
 #include "common.hpp"
 #include "drc_constants.hpp"
+#include "response.hpp"
 
 namespace hal::actuator {
 namespace {
@@ -42,6 +43,9 @@ std::int32_t rpm_to_drc_speed(rpm p_rpm,
 }
 }  // namespace
 
+// Every motor keeps a feedback_t, keep it from growing unnoticed
+static_assert(sizeof(rmd_drc_v2::feedback_t) == 48);
+
 hal::ampere rmd_drc_v2::feedback_t::current() const noexcept
 {
   static constexpr float raw_current_range = 2048.0f;
@@ -76,7 +80,7 @@ hal::degrees rmd_drc_v2::feedback_t::angle() const noexcept
 
 bool rmd_drc_v2::feedback_t::over_voltage_protection_tripped() const noexcept
 {
-  return raw_error_state & over_temperature_protection_tripped_mask;
+  return raw_error_state & over_voltage_protection_tripped_mask;
 }
 
 bool rmd_drc_v2::feedback_t::over_temperature_protection_tripped()
@@ -90,6 +94,53 @@ rmd_drc_v2::feedback_t const& rmd_drc_v2::feedback() const
   return m_feedback;
 }
 
+adaptive_timeout::statistics const& rmd_drc_v2::round_trip_statistics() const
+{
+  return m_protocol.round_trip_statistics();
+}
+
+void rmd_drc_v2::tune_response_timeout(
+  adaptive_timeout::settings const& p_settings)
+{
+  m_protocol.tune_response_timeout(p_settings);
+}
+
+void rmd_drc_v2::retry(retry_policy const& p_policy)
+{
+  m_protocol.retry(p_policy);
+}
+
+retry_policy const& rmd_drc_v2::retry() const
+{
+  return m_protocol.retry();
+}
+
+void rmd_drc_v2::instrument(transaction_recorder* p_recorder)
+{
+  m_protocol.instrument(p_recorder);
+}
+
+void rmd_drc_v2::log_telemetry(telemetry_log* p_log)
+{
+  m_protocol.log_telemetry(p_log);
+}
+
+hal::u32 rmd_drc_v2::decode_errors() const
+{
+  return m_protocol.decode_errors();
+}
+
+std::span<hal::byte const> rmd_drc_v2::dropped_requests() const
+{
+  return m_protocol.dropped();
+}
+
+void rmd_drc_v2::mirror_feedback(rmd_feedback_columns* p_store,
+                                 hal::usize p_slot)
+{
+  m_protocol.mirror(p_store, p_slot, drc_field_scales);
+}
+
 rmd_drc_v2::rmd_drc_v2(hal::can_transceiver& p_can,
                        hal::can_identifier_filter& p_filter,
                        hal::steady_clock& p_clock,
@@ -97,45 +148,66 @@ rmd_drc_v2::rmd_drc_v2(hal::can_transceiver& p_can,
                        hal::u32 p_device_id,
                        hal::time_duration p_max_response_time)
   : m_feedback{}
-  , m_can(p_can, p_device_id)
-  , m_clock(&p_clock)
   , m_gear_ratio(p_gear_ratio)
-  , m_max_response_time(p_max_response_time)
+  , m_protocol(
+      p_can,
+      p_filter,
+      p_clock,
+      p_device_id,
+      p_device_id,
+      drc_response_layouts,
+      p_max_response_time,
+      [this](hal::can_message const& p_message) { handle_message(p_message); })
 {
-  p_filter.allow(p_device_id);
   rmd_drc_v2::system_control(system::off);
   rmd_drc_v2::system_control(system::running);
 }
 
-void rmd_drc_v2::send(std::array<hal::byte, 8> p_payload)
+rmd_drc_v2::rmd_drc_v2(rmd_can_dispatcher& p_dispatcher,
+                       hal::steady_clock& p_clock,
+                       float p_gear_ratio,  // NOLINT
+                       hal::u32 p_device_id,
+                       hal::time_duration p_max_response_time)
+  : m_feedback{}
+  , m_gear_ratio(p_gear_ratio)
+  , m_protocol(
+      p_dispatcher,
+      p_clock,
+      p_device_id,
+      p_device_id,
+      drc_response_layouts,
+      p_max_response_time,
+      [this](hal::can_message const& p_message) { handle_message(p_message); })
 {
-  hal::can_message const payload{
-    .id = m_can.id(),
-    .length = 8,
-    .payload = p_payload,
-  };
+  // Should this throw, m_protocol detaches from the dispatcher
+  rmd_drc_v2::system_control(system::off);
+  rmd_drc_v2::system_control(system::running);
+}
 
-  // Send payload
-  m_can.transceiver().send(payload);
+rmd_drc_v2::~rmd_drc_v2() = default;
 
-  // Wait for the message number to increment
-  auto const deadline = hal::future_deadline(*m_clock, m_max_response_time);
-  while (deadline > m_clock->uptime()) {
-    if (auto const message = m_can.find(); message.has_value()) {
-      handle_message(*message);
-      return;
-    }
-  }
+rmd_drc_v2::request_status rmd_drc_v2::poll()
+{
+  return m_protocol.poll();
+}
+
+rmd_drc_v2::request_status rmd_drc_v2::wait()
+{
+  return m_protocol.wait(this);
+}
 
-  hal::safe_throw(hal::timed_out(this));
+rmd_drc_v2::request_status rmd_drc_v2::velocity_control(rpm p_rpm)
+{
+  velocity_control_async(p_rpm);
+  return wait();
 }
 
-void rmd_drc_v2::velocity_control(rpm p_rpm)
+void rmd_drc_v2::velocity_control_async(rpm p_rpm)
 {
   auto const speed_data =
     rpm_to_drc_speed(p_rpm, m_gear_ratio, dps_per_lsb_speed);
 
-  send({
+  m_protocol.transmit({
     hal::value(actuate::speed),
     0x00,
     0x00,
@@ -147,7 +219,15 @@ void rmd_drc_v2::velocity_control(rpm p_rpm)
   });
 }
 
-void rmd_drc_v2::position_control(degrees p_angle, rpm p_rpm)  // NOLINT
+rmd_drc_v2::request_status rmd_drc_v2::position_control(
+  degrees p_angle,  // NOLINT
+  rpm p_rpm)
+{
+  position_control_async(p_angle, p_rpm);
+  return wait();
+}
+
+void rmd_drc_v2::position_control_async(degrees p_angle, rpm p_rpm)  // NOLINT
 {
   static constexpr float deg_per_lsb = 0.01f;
   auto const angle = (p_angle * m_gear_ratio) / deg_per_lsb;
@@ -155,7 +235,7 @@ void rmd_drc_v2::position_control(degrees p_angle, rpm p_rpm)  // NOLINT
   auto const speed_data =
     rpm_to_drc_speed(p_rpm, m_gear_ratio, dps_per_lsb_angle);
 
-  send({
+  m_protocol.transmit({
     hal::value(actuate::position_2),
     0x00,
     static_cast<hal::byte>((speed_data >> 0) & 0xFF),
@@ -167,9 +247,29 @@ void rmd_drc_v2::position_control(degrees p_angle, rpm p_rpm)  // NOLINT
   });
 }
 
-void rmd_drc_v2::feedback_request(read p_command)
+rmd_drc_v2::request_status rmd_drc_v2::feedback_request(read p_command)
+{
+  feedback_request_async(p_command);
+  return wait();
+}
+
+void rmd_drc_v2::refresh_feedback(read p_command,
+                                  hal::u64 p_updated,
+                                  hal::time_duration p_max_age)
+{
+  // A stream only stands in for a request while its samples are fresh
+  auto const max_age =
+    m_feedback_streamed ? std::max(p_max_age, m_stream_max_age) : p_max_age;
+  if (p_updated != 0 &&
+      adaptive_timeout::elapsed(m_protocol.clock(), p_updated) < max_age) {
+    return;
+  }
+  feedback_request(p_command);
+}
+
+void rmd_drc_v2::feedback_request_async(read p_command)
 {
-  send({
+  m_protocol.transmit({
     hal::value(p_command),
     0x00,
     0x00,
@@ -181,9 +281,15 @@ void rmd_drc_v2::feedback_request(read p_command)
   });
 }
 
-void rmd_drc_v2::system_control(system p_system_command)
+rmd_drc_v2::request_status rmd_drc_v2::system_control(system p_system_command)
+{
+  system_control_async(p_system_command);
+  return wait();
+}
+
+void rmd_drc_v2::system_control_async(system p_system_command)
 {
-  send({
+  m_protocol.transmit({
     hal::value(p_system_command),
     0x00,
     0x00,
@@ -195,49 +301,34 @@ void rmd_drc_v2::system_control(system p_system_command)
   });
 }
 
-void rmd_drc_v2::handle_message(can_message const& p_message)
+hal::usize rmd_drc_v2::emergency_stop(std::span<rmd_drc_v2* const> p_motors,
+                                      system p_command) noexcept
 {
-  m_feedback.message_number++;
-
-  switch (p_message.payload[0]) {
-    case hal::value(read::status_2):
-    case hal::value(actuate::speed):
-    case hal::value(actuate::position_2): {
-      auto& data = p_message.payload;
-      m_feedback.raw_motor_temperature = static_cast<std::int8_t>(data[1]);
-      m_feedback.raw_current =
-        static_cast<std::int16_t>((data[3] << 8) | data[2] << 0);
-      m_feedback.raw_speed =
-        static_cast<std::int16_t>((data[5] << 8) | data[4] << 0);
-      m_feedback.encoder =
-        static_cast<std::int16_t>((data[7] << 8) | data[6] << 0);
-      break;
-    }
-    case hal::value(read::status_1_and_error_flags): {
-      auto& data = p_message.payload;
-      m_feedback.raw_motor_temperature = static_cast<int8_t>(data[1]);
-      m_feedback.raw_volts =
-        static_cast<std::int16_t>((data[4] << 8) | data[3]);
-      m_feedback.raw_error_state = data[7];
-      break;
+  hal::usize sent = 0;
+  for (hal::usize i = 0; i < p_motors.size(); i++) {
+    // Requests still waiting on a response, such as a velocity command, must
+    // not be sent again after the stop
+    p_motors[i]->m_protocol.cancel_all();
+    try {
+      p_motors[i]->system_control_async(p_command);
+      p_motors[i]->m_protocol.queue_behind(p_motors.size() - 1 + i);
+      sent++;
+    } catch (...) {
+      // A failed send must not keep the rest of the fleet moving
     }
-    case hal::value(read::multi_turns_angle): {
-      auto& data = p_message.payload;
-
-      m_feedback.raw_multi_turn_angle = hal::bit_value(0U)
-                                          .insert<byte_m<0>>(data[1])
-                                          .insert<byte_m<1>>(data[2])
-                                          .insert<byte_m<2>>(data[3])
-                                          .insert<byte_m<3>>(data[4])
-                                          .insert<byte_m<4>>(data[5])
-                                          .insert<byte_m<5>>(data[6])
-                                          .insert<byte_m<6>>(data[7])
-                                          .to<std::int64_t>();
-      break;
-    }
-    default:
-      break;
   }
+  return sent;
+}
+
+void rmd_drc_v2::handle_message(can_message const& p_message)
+{
+  rmd_response response;
+  if (not m_protocol.decode(p_message, response)) {
+    return;
+  }
+
+  m_feedback.message_number++;
+  apply_response(m_feedback, response);
 }
 
 // =============================================================================
@@ -305,6 +396,45 @@ rmd_drc_v2::acquire_angular_velocity_sensor()
   return { *this };
 }
 
+hal::v5::strong_ptr<hal::rotation_sensor> rmd_drc_v2::acquire_rotation_sensor2(
+  std::pmr::polymorphic_allocator<> p_allocator)
+{
+  return hal::v5::make_strong_ptr<rotation_sensor>(p_allocator,
+                                                   acquire_rotation_sensor());
+}
+
+hal::v5::strong_ptr<hal::temperature_sensor>
+rmd_drc_v2::acquire_temperature_sensor2(
+  std::pmr::polymorphic_allocator<> p_allocator)
+{
+  return hal::v5::make_strong_ptr<temperature_sensor>(
+    p_allocator, acquire_temperature_sensor());
+}
+
+hal::v5::strong_ptr<hal::motor> rmd_drc_v2::acquire_motor2(
+  std::pmr::polymorphic_allocator<> p_allocator,
+  hal::rpm p_max_speed)
+{
+  return hal::v5::make_strong_ptr<motor>(p_allocator,
+                                         acquire_motor(p_max_speed));
+}
+
+hal::v5::strong_ptr<hal::servo> rmd_drc_v2::acquire_servo2(
+  std::pmr::polymorphic_allocator<> p_allocator,
+  hal::rpm p_max_speed)
+{
+  return hal::v5::make_strong_ptr<servo>(p_allocator,
+                                         acquire_servo(p_max_speed));
+}
+
+hal::v5::strong_ptr<hal::angular_velocity_sensor>
+rmd_drc_v2::acquire_angular_velocity_sensor2(
+  std::pmr::polymorphic_allocator<> p_allocator)
+{
+  return hal::v5::make_strong_ptr<angular_velocity_sensor>(
+    p_allocator, acquire_angular_velocity_sensor());
+}
+
 // =============================================================================
 //
 // Interface Implementations
@@ -318,13 +448,17 @@ void rmd_drc_v2::servo::driver_position(hal::degrees p_position)
 
 hal::celsius rmd_drc_v2::temperature_sensor::driver_read()
 {
-  m_drc->feedback_request(read::status_2);
+  m_drc->refresh_feedback(read::status_2,
+                          m_drc->feedback().updated.motor_temperature(),
+                          m_max_age);
   return m_drc->feedback().temperature();
 }
 
 hal::rotation_sensor::read_t rmd_drc_v2::rotation_sensor::driver_read()
 {
-  m_drc->feedback_request(read::multi_turns_angle);
+  m_drc->refresh_feedback(read::multi_turns_angle,
+                          m_drc->feedback().updated.multi_turn_angle,
+                          m_max_age);
   return { .angle = m_drc->feedback().angle() };
 }
 
@@ -335,7 +469,8 @@ void rmd_drc_v2::motor::driver_power(float p_power)
 
 hal::rpm rmd_drc_v2::angular_velocity_sensor::driver_read()
 {
-  m_drc->feedback_request(read::status_2);
+  m_drc->refresh_feedback(
+    read::status_2, m_drc->feedback().updated.status_2, m_max_age);
   return m_drc->feedback().speed();
 }
 }  // namespace hal::actuator
@@ -0,0 +1,72 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/smart_servo/rmd/feedback_store.hpp>
+
+namespace hal::actuator {
+namespace {
+void store_scaled(std::span<float> p_column,
+                  hal::usize p_slot,
+                  rmd_response const& p_response,
+                  rmd_field_scales const& p_scales,
+                  rmd_field p_field)
+{
+  if (p_response.has(p_field)) {
+    p_column[p_slot] = static_cast<float>(p_response.value(p_field)) *
+                       p_scales[static_cast<hal::u8>(p_field)];
+  }
+}
+
+template<class raw_t>
+void store_raw(std::span<raw_t> p_column,
+               hal::usize p_slot,
+               rmd_response const& p_response,
+               rmd_field p_field)
+{
+  if (p_response.has(p_field)) {
+    p_column[p_slot] = static_cast<raw_t>(p_response.value(p_field));
+  }
+}
+}  // namespace
+
+void rmd_feedback_columns::bind(columns const& p_columns)
+{
+  m_angle = p_columns.angle;
+  m_speed = p_columns.speed;
+  m_current = p_columns.current;
+  m_volts = p_columns.volts;
+  m_temperature = p_columns.temperature;
+  m_error_state = p_columns.error_state;
+  m_encoder = p_columns.encoder;
+  m_message_number = p_columns.message_number;
+  m_updated = p_columns.updated;
+}
+
+void rmd_feedback_columns::record(hal::usize p_slot,
+                                  rmd_response const& p_response,
+                                  rmd_field_scales const& p_scales)
+{
+  store_scaled(
+    m_angle, p_slot, p_response, p_scales, rmd_field::multi_turn_angle);
+  store_scaled(m_speed, p_slot, p_response, p_scales, rmd_field::speed);
+  store_scaled(m_current, p_slot, p_response, p_scales, rmd_field::current);
+  store_scaled(m_volts, p_slot, p_response, p_scales, rmd_field::volts);
+  store_scaled(
+    m_temperature, p_slot, p_response, p_scales, rmd_field::motor_temperature);
+  store_raw(m_error_state, p_slot, p_response, rmd_field::error_state);
+  store_raw(m_encoder, p_slot, p_response, rmd_field::encoder);
+  m_message_number[p_slot]++;
+  m_updated[p_slot] = p_response.received_at;
+}
+}  // namespace hal::actuator
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+
+#include <libhal-actuator/smart_servo/rmd/mc_x_v2.hpp>
+#include <libhal-actuator/smart_servo/rmd/protocol.hpp>
+#include <libhal-util/enum.hpp>
 #include <libhal/units.hpp>
 
 namespace hal::actuator {
@@ -17,6 +22,10 @@ constexpr auto max_position_degrees =
   static_cast<float>(std::numeric_limits<std::int32_t>::max()) *
   dps_per_lsb_angle;
 
+/// Torque current carried by one LSB of the torque command (iqControl) and of
+/// the iq current reported in responses
+constexpr auto amps_per_lsb_current = 0.01f;
+
 static constexpr hal::u32 first_device_address = 0x140;
 static constexpr hal::u32 last_device_address = first_device_address + 32;
 /// Messages returned from these motor drivers are the same as motor ID plus
@@ -43,4 +52,70 @@ static constexpr hal::u16 speeding_mask = 0x0100;
 static constexpr hal::u16 over_temperature_mask = 0x1000;
 /// Error state flag indicating the encoder calibration failed.
 static constexpr hal::u16 encoder_calibration_error_mask = 0x2000;
+
+/// Status 2 fields, also returned by every actuation command
+constexpr std::array<rmd_field_layout, 4> mc_x_status_2_fields{ {
+  { .field = rmd_field::motor_temperature, .offset = 1, .width = 1 },
+  { .field = rmd_field::current, .offset = 2, .width = 2 },
+  { .field = rmd_field::speed, .offset = 4, .width = 2 },
+  { .field = rmd_field::encoder, .offset = 6, .width = 2 },
+} };
+
+/// Layout of the response to every command the MC-X driver sends
+constexpr std::array mc_x_response_layouts{
+  rmd_response_layout{
+    .command = hal::value(rmd_mc_x_v2::read::status_2),
+    .field_count = 4,
+    .fields = mc_x_status_2_fields,
+  },
+  rmd_response_layout{
+    .command = hal::value(rmd_mc_x_v2::actuate::torque),
+    .field_count = 4,
+    .fields = mc_x_status_2_fields,
+  },
+  rmd_response_layout{
+    .command = hal::value(rmd_mc_x_v2::actuate::speed),
+    .field_count = 4,
+    .fields = mc_x_status_2_fields,
+  },
+  rmd_response_layout{
+    .command = hal::value(rmd_mc_x_v2::actuate::position),
+    .field_count = 4,
+    .fields = mc_x_status_2_fields,
+  },
+  // Byte 3 of status 1 is the brake release command
+  rmd_response_layout{
+    .command = hal::value(rmd_mc_x_v2::read::status_1_and_error_flags),
+    .field_count = 3,
+    .fields = { {
+      { .field = rmd_field::motor_temperature, .offset = 1, .width = 1 },
+      { .field = rmd_field::volts, .offset = 4, .width = 2 },
+      { .field = rmd_field::error_state,
+        .offset = 6,
+        .width = 2,
+        .is_signed = false },
+    } },
+  },
+  rmd_response_layout{
+    .command = hal::value(rmd_mc_x_v2::read::multi_turns_angle),
+    .field_count = 1,
+    .fields = { {
+      { .field = rmd_field::multi_turn_angle, .offset = 4, .width = 4 },
+    } },
+  },
+  rmd_response_layout{ .command = hal::value(rmd_mc_x_v2::system::off) },
+  rmd_response_layout{ .command = hal::value(rmd_mc_x_v2::system::stop) },
+};
+static_assert(rmd_layouts_fit(mc_x_response_layouts));
+
+/// Units per LSB of each field, the same as the feedback_t functions
+constexpr rmd_field_scales mc_x_field_scales{
+  1.0f,                 // motor_temperature: celsius
+  amps_per_lsb_current, // current: amperes
+  1.0_deg_per_sec,      // speed: rpm
+  1.0f,                 // encoder: raw count
+  0.1f,                 // volts: volts
+  1.0f,                 // error_state: raw flags
+  dps_per_lsb_speed,    // multi_turn_angle: degrees
+};
 }  // namespace hal::actuator
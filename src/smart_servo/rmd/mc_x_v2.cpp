@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
 
 #include <libhal-actuator/smart_servo/rmd/mc_x_v2.hpp>
@@ -25,6 +28,7 @@
 
 #include "common.hpp"
 #include "mc_x_constants.hpp"
+#include "response.hpp"
 
 namespace hal::actuator {
 namespace {
@@ -35,21 +39,57 @@ inline std::int32_t rpm_to_mc_x_speed(hal::rpm p_rpm, float p_dps_per_lsb)
   return bounds_check<std::int32_t>(dps_float);
 }
 
-inline hal::u32 motor_id(hal::can_message_finder const& p_message_finder)
-{
-  // Paranoid safety assertions, such that a change to this value in the future
-  // alerts the developer to see this function.
-  static_assert(response_id_offset == 0x100);
-  // Safe so long as the ID is bounds checked at construction to be between
-  // 0x140 and 0x160.
-  return p_message_finder.id() - response_id_offset;
+/**
+ * @brief Wait for every motor in a group update to respond
+ *
+ * @param p_setpoints - setpoints of the group update
+ * @return rmd_mc_x_v2::request_status - complete, or timed_out if a motor did
+ * not respond and its retry policy does not throw
+ * @throws hal::timed_out - with the first motor that timed out as its instance
+ */
+template<class setpoint_t>
+rmd_mc_x_v2::request_status wait_for_group(
+  std::span<setpoint_t const> p_setpoints)
+{
+  rmd_mc_x_v2* timed_out_motor = nullptr;
+  bool pending = true;
+
+  while (pending) {
+    pending = false;
+    for (auto const& setpoint : p_setpoints) {
+      switch (setpoint.motor->poll()) {
+        case rmd_mc_x_v2::request_status::pending:
+          pending = true;
+          break;
+        case rmd_mc_x_v2::request_status::timed_out:
+          if (timed_out_motor == nullptr) {
+            timed_out_motor = setpoint.motor;
+          }
+          break;
+        case rmd_mc_x_v2::request_status::complete:
+        default:
+          break;
+      }
+    }
+  }
+
+  if (timed_out_motor == nullptr) {
+    return rmd_mc_x_v2::request_status::complete;
+  }
+  if (timed_out_motor->retry().throw_on_failure) {
+    hal::safe_throw(hal::timed_out(timed_out_motor));
+  }
+  return rmd_mc_x_v2::request_status::timed_out;
 }
 }  // namespace
 
+// feedback_t is copied whole by every snapshot(), keep it from growing
+// unnoticed
+static_assert(sizeof(rmd_mc_x_v2::feedback_t) == 48);
+
 hal::ampere rmd_mc_x_v2::feedback_t::current() const noexcept
 {
-  static constexpr auto amps_per_lsb = 0.1_A;
-  return static_cast<float>(raw_current) * amps_per_lsb;
+  return static_cast<float>(raw_current) * amps_per_lsb_current;
 }
 
 hal::rpm rmd_mc_x_v2::feedback_t::speed() const noexcept
@@ -115,18 +155,50 @@ rmd_mc_x_v2::rmd_mc_x_v2(hal::can_transceiver& p_can_transceiver,
                          hal::u32 p_device_id,
                          hal::time_duration p_max_response_time)
   : m_feedback{}
-  , m_clock(&p_clock)
-  , m_can(p_can_transceiver, p_device_id + response_id_offset)
   , m_gear_ratio(p_gear_ratio)
   , m_device_id(p_device_id)
-  , m_max_response_time(p_max_response_time)
+  , m_protocol(
+      p_can_transceiver,
+      p_filter,
+      p_clock,
+      p_device_id,
+      p_device_id + response_id_offset,
+      mc_x_response_layouts,
+      p_max_response_time,
+      [this](hal::can_message const& p_message) { handle_message(p_message); })
 {
-  bool const valid_device_id =
-    first_device_address <= p_device_id && p_device_id <= last_device_address;
+  initialize(p_can_transceiver.baud_rate());
+}
+
+rmd_mc_x_v2::rmd_mc_x_v2(rmd_can_dispatcher& p_dispatcher,
+                         hal::steady_clock& p_clock,
+                         float p_gear_ratio,  // NOLINT
+                         hal::u32 p_device_id,
+                         hal::time_duration p_max_response_time)
+  : m_feedback{}
+  , m_gear_ratio(p_gear_ratio)
+  , m_device_id(p_device_id)
+  , m_protocol(
+      p_dispatcher,
+      p_clock,
+      p_device_id,
+      p_device_id + response_id_offset,
+      mc_x_response_layouts,
+      p_max_response_time,
+      [this](hal::can_message const& p_message) { handle_message(p_message); })
+{
+  // Should this throw, m_protocol detaches from the dispatcher
+  initialize(p_dispatcher.transceiver().baud_rate());
+}
+
+rmd_mc_x_v2::~rmd_mc_x_v2() = default;
 
-  p_filter.allow(p_device_id + response_id_offset);
+void rmd_mc_x_v2::initialize(hal::u32 p_baud_rate)
+{
+  bool const valid_device_id =
+    first_device_address <= m_device_id && m_device_id <= last_device_address;
 
-  bool const invalid_baud_rate = p_can_transceiver.baud_rate() != 1_MHz;
+  bool const invalid_baud_rate = p_baud_rate != 1_MHz;
 
   if (not valid_device_id || invalid_baud_rate) {
     hal::safe_throw(hal::argument_out_of_domain(this));
@@ -137,34 +209,27 @@ rmd_mc_x_v2::rmd_mc_x_v2(hal::can_transceiver& p_can_transceiver,
   feedback_request(read::status_1_and_error_flags);
 }
 
-void rmd_mc_x_v2::send(std::array<hal::byte, 8> p_payload)
+rmd_mc_x_v2::request_status rmd_mc_x_v2::poll()
 {
-  hal::can_message const payload{
-    .id = motor_id(m_can),
-    .length = 8,
-    .payload = p_payload,
-  };
-
-  // Send payload
-  m_can.transceiver().send(payload);
+  return m_protocol.poll();
+}
 
-  // Wait for the message number to increment
-  auto const deadline = hal::future_deadline(*m_clock, m_max_response_time);
-  while (deadline > m_clock->uptime()) {
-    if (auto const message = m_can.find(); message.has_value()) {
-      handle_message(*message);
-      return;
-    }
-  }
+rmd_mc_x_v2::request_status rmd_mc_x_v2::wait()
+{
+  return m_protocol.wait(this);
+}
 
-  hal::safe_throw(hal::timed_out(this));
+rmd_mc_x_v2::request_status rmd_mc_x_v2::velocity_control(rpm p_rpm)
+{
+  velocity_control_async(p_rpm);
+  return wait();
 }
 
-void rmd_mc_x_v2::velocity_control(rpm p_rpm)
+void rmd_mc_x_v2::velocity_control_async(rpm p_rpm)
 {
   auto const speed_data = rpm_to_mc_x_speed(p_rpm, dps_per_lsb_speed);
 
-  send({
+  m_protocol.transmit({
     hal::value(actuate::speed),
     0x00,
     0x00,
@@ -176,7 +241,39 @@ void rmd_mc_x_v2::velocity_control(rpm p_rpm)
   });
 }
 
-void rmd_mc_x_v2::position_control(degrees p_angle, rpm p_rpm)  // NOLINT
+rmd_mc_x_v2::request_status rmd_mc_x_v2::torque_control(hal::ampere p_current)
+{
+  torque_control_async(p_current);
+  return wait();
+}
+
+void rmd_mc_x_v2::torque_control_async(hal::ampere p_current)
+{
+  auto const current_data =
+    bounds_check<std::int16_t>(p_current / amps_per_lsb_current);
+
+  m_protocol.transmit({
+    hal::value(actuate::torque),
+    0x00,
+    0x00,
+    0x00,
+    static_cast<hal::byte>((current_data >> 0) & 0xFF),
+    static_cast<hal::byte>((current_data >> 8) & 0xFF),
+    0x00,
+    0x00,
+  });
+}
+
+rmd_mc_x_v2::request_status rmd_mc_x_v2::position_control(
+  degrees p_angle,  // NOLINT
+  rpm p_rpm)
+{
+  position_control_async(p_angle, p_rpm);
+  return wait();
+}
+
+void rmd_mc_x_v2::position_control_async(degrees p_angle,  // NOLINT
+                                         rpm p_rpm)
 {
   static constexpr float deg_per_lsb = 0.01f;
   auto const angle = p_angle / deg_per_lsb;
@@ -184,7 +281,7 @@ void rmd_mc_x_v2::position_control(degrees p_angle, rpm p_rpm)  // NOLINT
   auto const speed_data =
     rpm_to_mc_x_speed(std::abs(p_rpm * m_gear_ratio), dps_per_lsb_angle);
 
-  send({
+  m_protocol.transmit({
     hal::value(actuate::position),
     0x00,
     static_cast<hal::byte>((speed_data >> 0) & 0xFF),
@@ -196,9 +293,29 @@ void rmd_mc_x_v2::position_control(degrees p_angle, rpm p_rpm)  // NOLINT
   });
 }
 
-void rmd_mc_x_v2::feedback_request(read p_command)
+rmd_mc_x_v2::request_status rmd_mc_x_v2::feedback_request(read p_command)
+{
+  feedback_request_async(p_command);
+  return wait();
+}
+
+void rmd_mc_x_v2::refresh_feedback(read p_command,
+                                   hal::u64 p_updated,
+                                   hal::time_duration p_max_age)
 {
-  send({
+  // A stream only stands in for a request while its samples are fresh
+  auto const max_age =
+    m_feedback_streamed ? std::max(p_max_age, m_stream_max_age) : p_max_age;
+  if (p_updated != 0 &&
+      adaptive_timeout::elapsed(m_protocol.clock(), p_updated) < max_age) {
+    return;
+  }
+  feedback_request(p_command);
+}
+
+void rmd_mc_x_v2::feedback_request_async(read p_command)
+{
+  m_protocol.transmit({
     hal::value(p_command),
     0x00,
     0x00,
@@ -210,9 +327,15 @@ void rmd_mc_x_v2::feedback_request(read p_command)
   });
 }
 
-void rmd_mc_x_v2::system_control(system p_system_command)
+rmd_mc_x_v2::request_status rmd_mc_x_v2::system_control(system p_system_command)
+{
+  system_control_async(p_system_command);
+  return wait();
+}
+
+void rmd_mc_x_v2::system_control_async(system p_system_command)
 {
-  send({
+  m_protocol.transmit({
     hal::value(p_system_command),
     0x00,
     0x00,
@@ -224,49 +347,143 @@ void rmd_mc_x_v2::system_control(system p_system_command)
   });
 }
 
+hal::usize rmd_mc_x_v2::emergency_stop(std::span<rmd_mc_x_v2* const> p_motors,
+                                       system p_command) noexcept
+{
+  hal::usize sent = 0;
+  for (hal::usize i = 0; i < p_motors.size(); i++) {
+    // Requests still waiting on a response, such as a velocity command, must
+    // not be sent again after the stop
+    p_motors[i]->m_protocol.cancel_all();
+    try {
+      p_motors[i]->system_control_async(p_command);
+      p_motors[i]->m_protocol.queue_behind(p_motors.size() - 1 + i);
+      sent++;
+    } catch (...) {
+      // A failed send must not keep the rest of the fleet moving
+    }
+  }
+  return sent;
+}
+
+rmd_mc_x_v2::request_status rmd_mc_x_v2::group_velocity_control(
+  std::span<velocity_setpoint const> p_setpoints)
+{
+  for (hal::usize i = 0; i < p_setpoints.size(); i++) {
+    auto const& setpoint = p_setpoints[i];
+    setpoint.motor->velocity_control_async(setpoint.speed);
+    setpoint.motor->m_protocol.queue_behind(p_setpoints.size() - 1 + i);
+  }
+  return wait_for_group(p_setpoints);
+}
+
+rmd_mc_x_v2::request_status rmd_mc_x_v2::group_torque_control(
+  std::span<torque_setpoint const> p_setpoints)
+{
+  for (hal::usize i = 0; i < p_setpoints.size(); i++) {
+    auto const& setpoint = p_setpoints[i];
+    setpoint.motor->torque_control_async(setpoint.current);
+    setpoint.motor->m_protocol.queue_behind(p_setpoints.size() - 1 + i);
+  }
+  return wait_for_group(p_setpoints);
+}
+
+rmd_mc_x_v2::request_status rmd_mc_x_v2::group_position_control(
+  std::span<position_setpoint const> p_setpoints)
+{
+  for (hal::usize i = 0; i < p_setpoints.size(); i++) {
+    auto const& setpoint = p_setpoints[i];
+    setpoint.motor->position_control_async(setpoint.angle, setpoint.speed);
+    setpoint.motor->m_protocol.queue_behind(p_setpoints.size() - 1 + i);
+  }
+  return wait_for_group(p_setpoints);
+}
+
 rmd_mc_x_v2::feedback_t const& rmd_mc_x_v2::feedback() const
 {
   return m_feedback;
 }
 
-void rmd_mc_x_v2::handle_message(can_message const& p_message)
+adaptive_timeout::statistics const& rmd_mc_x_v2::round_trip_statistics() const
 {
-  m_feedback.message_number++;
+  return m_protocol.round_trip_statistics();
+}
 
-  if (p_message.length != 8 ||
-      p_message.id != m_device_id + response_id_offset) {
+void rmd_mc_x_v2::tune_response_timeout(
+  adaptive_timeout::settings const& p_settings)
+{
+  m_protocol.tune_response_timeout(p_settings);
+}
+
+void rmd_mc_x_v2::retry(retry_policy const& p_policy)
+{
+  m_protocol.retry(p_policy);
+}
+
+retry_policy const& rmd_mc_x_v2::retry() const
+{
+  return m_protocol.retry();
+}
+
+void rmd_mc_x_v2::instrument(transaction_recorder* p_recorder)
+{
+  m_protocol.instrument(p_recorder);
+}
+
+void rmd_mc_x_v2::log_telemetry(telemetry_log* p_log)
+{
+  m_protocol.log_telemetry(p_log);
+}
+
+hal::u32 rmd_mc_x_v2::decode_errors() const
+{
+  return m_protocol.decode_errors();
+}
+
+std::span<hal::byte const> rmd_mc_x_v2::dropped_requests() const
+{
+  return m_protocol.dropped();
+}
+
+void rmd_mc_x_v2::mirror_feedback(rmd_feedback_columns* p_store,
+                                  hal::usize p_slot)
+{
+  m_protocol.mirror(p_store, p_slot, mc_x_field_scales);
+}
+
+void rmd_mc_x_v2::handle_message(can_message const& p_message)
+{
+  rmd_response response;
+  if (not m_protocol.decode(p_message, response)) {
     return;
   }
 
-  switch (p_message.payload[0]) {
-    case hal::value(read::status_2):
-    case hal::value(actuate::torque):
-    case hal::value(actuate::speed):
-    case hal::value(actuate::position): {
-      auto& data = p_message.payload;
-      m_feedback.raw_motor_temperature = static_cast<int8_t>(data[1]);
-      m_feedback.raw_current = static_cast<int16_t>((data[3] << 8) | data[2]);
-      m_feedback.raw_speed = static_cast<int16_t>((data[5] << 8) | data[4]);
-      m_feedback.encoder = static_cast<int16_t>((data[7] << 8) | data[6]);
-      break;
-    }
-    case hal::value(read::status_1_and_error_flags): {
-      auto& data = p_message.payload;
-      m_feedback.raw_motor_temperature = static_cast<int8_t>(data[1]);
-      // data[3] = Brake release command
-      m_feedback.raw_volts = static_cast<int16_t>((data[5] << 8) | data[4]);
-      auto error_state = data[7] << 8 | data[6];
-      m_feedback.raw_error_state = static_cast<int16_t>(error_state);
-      break;
-    }
-    case hal::value(read::multi_turns_angle): {
-      auto& data = p_message.payload;
-      m_feedback.raw_multi_turn_angle = static_cast<std::int32_t>(
-        data[7] << 24 | data[6] << 16 | data[5] << 8 | data[4]);
-      break;
+  // Only this function writes m_feedback, so it can be read without the lock
+  auto next = m_feedback;
+  next.message_number++;
+  apply_response(next, response);
+  publish(next);
+}
+
+void rmd_mc_x_v2::publish(feedback_t const& p_feedback)
+{
+  auto const version = m_feedback_version.load(std::memory_order_relaxed);
+  m_feedback_version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  m_feedback = p_feedback;
+  m_feedback_version.store(version + 2, std::memory_order_release);
+}
+
+rmd_mc_x_v2::feedback_t rmd_mc_x_v2::snapshot() const
+{
+  while (true) {
+    auto const before = m_feedback_version.load(std::memory_order_acquire);
+    auto const copy = m_feedback;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto const after = m_feedback_version.load(std::memory_order_relaxed);
+    if (before == after && (before & 1U) == 0) {
+      return copy;
     }
-    default:
-      return;
   }
 }
 
@@ -286,6 +503,12 @@ rmd_mc_x_v2::motor::motor(rmd_mc_x_v2& p_mc_x, hal::rpm p_max_speed)
   , m_max_speed(p_max_speed)
 {
 }
+rmd_mc_x_v2::torque_motor::torque_motor(rmd_mc_x_v2& p_mc_x,
+                                        hal::ampere p_max_current)
+  : m_mc_x(&p_mc_x)
+  , m_max_current(p_max_current)
+{
+}
 rmd_mc_x_v2::temperature::temperature(rmd_mc_x_v2& p_mc_x)
   : m_mc_x(&p_mc_x)
 {
@@ -315,23 +538,33 @@ void rmd_mc_x_v2::motor::driver_power(float p_power)
   m_mc_x->velocity_control(m_max_speed * p_power);
 }
 
+void rmd_mc_x_v2::torque_motor::driver_power(float p_power)
+{
+  m_mc_x->torque_control(m_max_current * p_power);
+}
+
 hal::celsius rmd_mc_x_v2::temperature::driver_read()
 {
-  m_mc_x->feedback_request(read::status_2);
-  return m_mc_x->feedback().temperature();
+  m_mc_x->refresh_feedback(read::status_2,
+                           m_mc_x->snapshot().updated.motor_temperature(),
+                           m_max_age);
+  return m_mc_x->snapshot().temperature();
 }
 
 hal::rotation_sensor::read_t rmd_mc_x_v2::rotation::driver_read()
 {
-  m_mc_x->feedback_request(read::multi_turns_angle);
-  return { .angle = m_mc_x->feedback().angle() };
+  m_mc_x->refresh_feedback(read::multi_turns_angle,
+                           m_mc_x->snapshot().updated.multi_turn_angle,
+                           m_max_age);
+  return { .angle = m_mc_x->snapshot().angle() };
 }
 
 hal::ampere rmd_mc_x_v2::current_sensor::driver_read()
 {
-  m_mc_x->feedback_request(read::status_2);
+  m_mc_x->refresh_feedback(
+    read::status_2, m_mc_x->snapshot().updated.status_2, m_max_age);
 
-  return m_mc_x->feedback().current();
+  return m_mc_x->snapshot().current();
 }
 
 // =============================================================================
@@ -344,6 +577,11 @@ rmd_mc_x_v2::motor rmd_mc_x_v2::acquire_motor(hal::rpm p_max_speed)
 {
   return { *this, p_max_speed };
 }
+rmd_mc_x_v2::torque_motor rmd_mc_x_v2::acquire_torque_motor(
+  hal::ampere p_max_current)
+{
+  return { *this, p_max_current };
+}
 rmd_mc_x_v2::rotation rmd_mc_x_v2::acquire_rotation_sensor()
 {
   return { *this };
@@ -396,8 +634,8 @@ void rmd_mc_x_v2::velocity_motor::driver_drive(rpm p_velocity)
 hal::v5::velocity_motor::status_t rmd_mc_x_v2::velocity_motor::driver_status()
 {
   // Request current status
-  m_drc->feedback_request(read::status_2);
-  auto const& feedback = m_drc->feedback();
+  m_drc->refresh_feedback(read::status_2, m_drc->snapshot().updated.status_2);
+  auto const feedback = m_drc->snapshot();
 
   status_t status{};
   status.velocity = feedback.speed();
@@ -428,6 +666,9 @@ void rmd_mc_x_v2::velocity_servo::driver_enable(bool p_state)
 
 void rmd_mc_x_v2::velocity_servo::driver_position(degrees p_target_position)
 {
+  m_target = p_target_position;
+  m_has_target = true;
+  m_settled = false;
   m_drc->position_control(p_target_position, m_current_velocity);
 }
 
@@ -442,19 +683,65 @@ rmd_mc_x_v2::velocity_servo::driver_position_range()
 
 degrees rmd_mc_x_v2::velocity_servo::driver_get_position()
 {
-  m_drc->feedback_request(read::multi_turns_angle);
-  return m_drc->feedback().angle();
+  m_drc->refresh_feedback(read::multi_turns_angle,
+                          m_drc->snapshot().updated.multi_turn_angle);
+  return m_drc->snapshot().angle();
 }
 
 bool rmd_mc_x_v2::velocity_servo::driver_is_moving()
 {
-  m_drc->feedback_request(read::status_2);
-  auto const& feedback = m_drc->feedback();
+  if (m_settled) {
+    return false;
+  }
+  m_drc->refresh_feedback(
+    read::status_2, m_drc->snapshot().updated.status_2, m_max_age);
+  auto const feedback = m_drc->snapshot();
 
   // Consider the servo moving if speed is above a small threshold
   return std::abs(feedback.speed()) > movement_threshold;
 }
 
+bool rmd_mc_x_v2::velocity_servo::settled()
+{
+  return settled(m_max_age);
+}
+
+bool rmd_mc_x_v2::velocity_servo::settled(hal::time_duration p_max_age)
+{
+  if (m_settled) {
+    return true;
+  }
+
+  m_drc->refresh_feedback(
+    read::status_2, m_drc->snapshot().updated.status_2, p_max_age);
+  if (std::abs(m_drc->snapshot().speed()) > movement_threshold) {
+    return false;
+  }
+  if (not m_has_target) {
+    return true;
+  }
+
+  m_drc->refresh_feedback(read::multi_turns_angle,
+                          m_drc->snapshot().updated.multi_turn_angle,
+                          p_max_age);
+  m_settled = std::abs(m_drc->snapshot().angle() - m_target) <= m_tolerance;
+  return m_settled;
+}
+
+bool rmd_mc_x_v2::velocity_servo::wait_until_settled(
+  hal::time_duration p_timeout,
+  hal::time_duration p_period)
+{
+  auto& clock = m_drc->m_protocol.clock();
+  auto const start = clock.uptime();
+  while (not settled(p_period)) {
+    if (adaptive_timeout::elapsed(clock, start) >= p_timeout) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void rmd_mc_x_v2::velocity_servo::driver_configure(
   hal::v5::velocity_servo::settings const& p_settings)
 {
@@ -463,8 +750,8 @@ void rmd_mc_x_v2::velocity_servo::driver_configure(
 
 hal::v5::velocity_servo::status_t rmd_mc_x_v2::velocity_servo::driver_status()
 {
-  m_drc->feedback_request(read::status_2);
-  auto const& feedback = m_drc->feedback();
+  m_drc->refresh_feedback(read::status_2, m_drc->snapshot().updated.status_2);
+  auto const feedback = m_drc->snapshot();
 
   status_t status{};
   status.velocity = feedback.speed();
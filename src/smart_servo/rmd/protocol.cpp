@@ -0,0 +1,421 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/smart_servo/rmd/protocol.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+#include <libhal-actuator/smart_servo/rmd/feedback_store.hpp>
+#include <libhal-util/can.hpp>
+#include <libhal-util/steady_clock.hpp>
+#include <libhal/can.hpp>
+#include <libhal/error.hpp>
+
+namespace hal::actuator {
+namespace {
+/**
+ * @brief Time between two readings of a clock's uptime
+ *
+ * @return hal::time_duration - time from p_begin to p_end, zero if p_end is
+ * not later
+ */
+hal::time_duration between(hal::steady_clock& p_clock,
+                           hal::u64 p_begin,
+                           hal::u64 p_end)
+{
+  if (p_end <= p_begin) {
+    return hal::time_duration::zero();
+  }
+  auto const ticks = static_cast<double>(p_end - p_begin);
+  return std::chrono::nanoseconds(
+    static_cast<hal::i64>((ticks * 1e9) / p_clock.frequency()));
+}
+}  // namespace
+
+rmd_protocol::rmd_protocol(hal::can_transceiver& p_transceiver,
+                           hal::can_identifier_filter& p_filter,
+                           hal::steady_clock& p_clock,
+                           hal::u32 p_command_id,
+                           hal::u32 p_response_id,
+                           std::span<rmd_response_layout const> p_layouts,
+                           hal::time_duration p_max_response_time,
+                           handler p_handler)
+  : m_can(p_transceiver, p_response_id)
+  , m_layouts(p_layouts)
+  , m_clock(&p_clock)
+  , m_handler(std::move(p_handler))
+  , m_command_id(p_command_id)
+  , m_baud_rate(p_transceiver.baud_rate())
+  , m_response_timer({ .ceiling = p_max_response_time })
+{
+  p_filter.allow(p_response_id);
+}
+
+rmd_protocol::rmd_protocol(rmd_can_dispatcher& p_dispatcher,
+                           hal::steady_clock& p_clock,
+                           hal::u32 p_command_id,
+                           hal::u32 p_response_id,
+                           std::span<rmd_response_layout const> p_layouts,
+                           hal::time_duration p_max_response_time,
+                           handler p_handler)
+  : m_can(p_dispatcher.transceiver(), p_response_id)
+  , m_layouts(p_layouts)
+  , m_clock(&p_clock)
+  , m_handler(std::move(p_handler))
+  , m_command_id(p_command_id)
+  , m_baud_rate(p_dispatcher.transceiver().baud_rate())
+  , m_response_timer({ .ceiling = p_max_response_time })
+{
+  p_dispatcher.attach(p_response_id, m_handler);
+  m_dispatcher = &p_dispatcher;
+}
+
+rmd_protocol::~rmd_protocol()
+{
+  if (m_dispatcher) {
+    m_dispatcher->detach(m_can.id());
+  }
+}
+
+void rmd_protocol::transmit(std::array<hal::byte, 8> const& p_payload)
+{
+  collect();
+  auto const is_free = [](request const& p_request) {
+    return p_request.state.load(std::memory_order_acquire) ==
+           request_state::free;
+  };
+  if (std::ranges::all_of(m_requests, is_free)) {
+    m_dropped_count = 0;
+  }
+
+  auto slot = std::ranges::find_if(m_requests, is_free);
+  if (slot == m_requests.end()) {
+    slot = std::ranges::min_element(m_requests, {}, &request::sequence);
+    drop(*slot);
+    // Answered just before it could be dropped
+    collect();
+  }
+
+  slot->payload = p_payload;
+  slot->begin = m_clock->uptime();
+  slot->sequence = m_sequence++;
+  slot->attempts = 0;
+  send(*slot);
+  // Published last, decode() only reads entries that were sent
+  slot->state.store(request_state::sent, std::memory_order_release);
+  m_latest = &*slot;
+}
+
+void rmd_protocol::send(request& p_request)
+{
+  hal::can_message const payload{
+    .id = m_command_id,
+    .length = 8,
+    .payload = p_request.payload,
+  };
+
+  // Send payload
+  m_can.transceiver().send(payload);
+
+  // The request and its response are on the wire on top of the timeout
+  p_request.attempts++;
+  p_request.queued = 0;
+  p_request.start = m_clock->uptime();
+  p_request.timeout = m_response_timer.timeout();
+  p_request.deadline = hal::future_deadline(
+    *m_clock, p_request.timeout + rmd_wire_time(2, m_baud_rate));
+}
+
+void rmd_protocol::collect()
+{
+  for (auto& entry : m_requests) {
+    if (entry.state.load(std::memory_order_acquire) !=
+        request_state::answered) {
+      continue;
+    }
+    // Karn's rule: a response to a request sent more than once may answer any
+    // of its attempts, so it is not measured
+    if (entry.attempts == 1) {
+      auto const round_trip =
+        between(*m_clock, entry.start, entry.answered_at);
+      auto const on_wire = rmd_wire_time(2 + entry.queued, m_baud_rate);
+      m_response_timer.record(
+        std::max(round_trip - on_wire, hal::time_duration::zero()));
+    }
+    record_transaction(entry, true);
+    entry.state.store(request_state::free, std::memory_order_relaxed);
+  }
+}
+
+void rmd_protocol::drop(request& p_request)
+{
+  auto expected = request_state::sent;
+  if (not p_request.state.compare_exchange_strong(
+        expected, request_state::free, std::memory_order_acq_rel)) {
+    // decode() answered the request first, collect() records it
+    return;
+  }
+  record_transaction(p_request, false);
+  if (m_dropped_count < m_dropped.size()) {
+    m_dropped[m_dropped_count++] = p_request.payload[0];
+  }
+}
+
+void rmd_protocol::record_transaction(request const& p_request,
+                                      bool p_completed)
+{
+  if (not m_recorder) {
+    return;
+  }
+
+  auto const attempts = p_request.attempts;
+  transaction record{
+    .sent_at = p_request.begin,
+    .timeout = p_request.timeout,
+    .attempts = attempts,
+    .timeouts = static_cast<hal::u8>(p_completed ? attempts - 1 : attempts),
+    .bytes_sent = static_cast<hal::u16>(attempts * p_request.payload.size()),
+  };
+  if (p_completed) {
+    record.response_time =
+      between(*m_clock, p_request.start, p_request.answered_at);
+    record.bytes_received = p_request.payload.size();
+    record.completed = true;
+  }
+  m_recorder->record(record);
+}
+
+bool rmd_protocol::decode(hal::can_message const& p_message,
+                          rmd_response& p_response)
+{
+  if (p_message.id != m_can.id()) {
+    return false;
+  }
+
+  auto const received_at = m_clock->uptime();
+  if (m_telemetry_log) {
+    m_telemetry_log->append(
+      received_at,
+      telemetry_source::rmd,
+      static_cast<hal::u16>(p_message.id),
+      p_message.payload[0],
+      std::span(p_message.payload).first(std::min<hal::usize>(
+        p_message.length, p_message.payload.size())));
+  }
+
+  if (p_message.length != 8) {
+    m_decode_errors.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  auto const& payload = p_message.payload;
+  request* answered = nullptr;
+  for (auto& entry : m_requests) {
+    if (entry.state.load(std::memory_order_acquire) == request_state::sent &&
+        entry.payload[0] == payload[0] &&
+        (answered == nullptr || entry.sequence < answered->sequence)) {
+      answered = &entry;
+    }
+  }
+  if (answered != nullptr) {
+    answered->answered_at = received_at;
+    auto expected = request_state::sent;
+    answered->state.compare_exchange_strong(
+      expected, request_state::answered, std::memory_order_acq_rel);
+  }
+
+  auto const layout = std::ranges::find(
+    m_layouts, payload[0], &rmd_response_layout::command);
+  if (layout == m_layouts.end()) {
+    m_decode_errors.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  p_response.present = 0;
+  p_response.received_at = received_at;
+  for (hal::usize i = 0; i < layout->field_count; i++) {
+    auto const& field = layout->fields[i];
+    hal::u64 raw = 0;
+    for (hal::u8 byte = 0; byte < field.width; byte++) {
+      raw |= hal::u64{ payload[field.offset + byte] } << (byte * 8U);
+    }
+    // Shift the top byte of the field up to bit 63 and back down, which sign
+    // extends signed fields without a branch per width.
+    auto const unused_bits = 64U - (field.width * 8U);
+    auto const value =
+      field.is_signed
+        ? static_cast<hal::i64>(raw << unused_bits) >> unused_bits
+        : static_cast<hal::i64>(raw);
+    auto const index = static_cast<hal::u8>(field.field);
+    p_response.values[index] = value;
+    p_response.present |= static_cast<hal::u8>(1U << index);
+  }
+
+  if (m_store) {
+    m_store->record(m_slot, p_response, *m_scales);
+  }
+  return true;
+}
+
+void rmd_protocol::mirror(rmd_feedback_columns* p_store,
+                          hal::usize p_slot,
+                          rmd_field_scales const& p_scales)
+{
+  if (p_store && p_slot >= p_store->size()) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+  m_store = p_store;
+  m_slot = p_slot;
+  m_scales = &p_scales;
+}
+
+hal::u32 rmd_protocol::decode_errors() const
+{
+  return m_decode_errors.load(std::memory_order_relaxed);
+}
+
+std::span<hal::byte const> rmd_protocol::dropped() const
+{
+  return std::span(m_dropped).first(m_dropped_count);
+}
+
+rmd_request_status rmd_protocol::poll()
+{
+  if (m_dispatcher) {
+    m_dispatcher->poll();
+  } else {
+    for (auto message = m_can.find(); message.has_value();
+         message = m_can.find()) {
+      m_handler(*message);
+    }
+  }
+
+  collect();
+  bool pending = false;
+  for (auto& entry : m_requests) {
+    if (entry.state.load(std::memory_order_acquire) != request_state::sent) {
+      continue;
+    }
+    if (m_clock->uptime() < entry.deadline) {
+      pending = true;
+      continue;
+    }
+    m_response_timer.record_timeout();
+    bool const within_budget =
+      adaptive_timeout::elapsed(*m_clock, entry.begin) < m_retry.budget;
+    if (entry.attempts < m_retry.attempts && within_budget) {
+      send(entry);
+      pending = true;
+      continue;
+    }
+    drop(entry);
+  }
+
+  if (pending) {
+    return rmd_request_status::pending;
+  }
+  if (m_dropped_count > 0) {
+    return rmd_request_status::timed_out;
+  }
+  return rmd_request_status::complete;
+}
+
+rmd_request_status rmd_protocol::wait(void* p_instance)
+{
+  while (true) {
+    switch (poll()) {
+      case rmd_request_status::complete:
+        return rmd_request_status::complete;
+      case rmd_request_status::timed_out:
+        if (m_retry.throw_on_failure) {
+          hal::safe_throw(hal::timed_out(p_instance));
+        }
+        return rmd_request_status::timed_out;
+      case rmd_request_status::pending:
+      default:
+        break;
+    }
+  }
+}
+
+void rmd_protocol::cancel_all() noexcept
+{
+  collect();
+  for (auto& entry : m_requests) {
+    auto expected = request_state::sent;
+    if (entry.state.compare_exchange_strong(
+          expected, request_state::free, std::memory_order_acq_rel)) {
+      record_transaction(entry, false);
+    }
+  }
+  m_dropped_count = 0;
+  m_latest = nullptr;
+}
+
+void rmd_protocol::queue_behind(hal::usize p_frames)
+{
+  auto const bits = static_cast<float>(p_frames * rmd_frame_bits);
+  auto const baud_rate = static_cast<float>(m_baud_rate);
+  auto const ticks = bits * m_clock->frequency() / baud_rate;
+  if (m_latest != nullptr && m_latest->state.load(std::memory_order_acquire) ==
+                               request_state::sent) {
+    m_latest->deadline += static_cast<hal::u64>(ticks);
+    m_latest->queued += static_cast<hal::u32>(p_frames);
+  }
+}
+
+hal::steady_clock& rmd_protocol::clock()
+{
+  return *m_clock;
+}
+
+hal::u32 rmd_protocol::response_id() const
+{
+  return m_can.id();
+}
+
+adaptive_timeout::statistics const& rmd_protocol::round_trip_statistics() const
+{
+  return m_response_timer.stats();
+}
+
+void rmd_protocol::tune_response_timeout(
+  adaptive_timeout::settings const& p_settings)
+{
+  m_response_timer.configure(p_settings);
+}
+
+void rmd_protocol::retry(retry_policy const& p_policy)
+{
+  m_retry = p_policy;
+}
+
+retry_policy const& rmd_protocol::retry() const
+{
+  return m_retry;
+}
+
+void rmd_protocol::instrument(transaction_recorder* p_recorder)
+{
+  m_recorder = p_recorder;
+}
+
+void rmd_protocol::log_telemetry(telemetry_log* p_log)
+{
+  m_telemetry_log = p_log;
+}
+}  // namespace hal::actuator
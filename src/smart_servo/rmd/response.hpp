@@ -0,0 +1,63 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <libhal-actuator/smart_servo/rmd/protocol.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+template<class field_t>
+void store(field_t& p_field, rmd_response const& p_response, rmd_field p_source)
+{
+  if (p_response.has(p_source)) {
+    p_field = static_cast<field_t>(p_response.value(p_source));
+  }
+}
+
+/**
+ * @brief Store the fields of a decoded response into a driver's feedback
+ *
+ * @tparam feedback_t - feedback_t of rmd_drc_v2 or rmd_mc_x_v2
+ * @param p_feedback - feedback to update
+ * @param p_response - fields decoded by rmd_protocol::decode()
+ */
+template<class feedback_t>
+void apply_response(feedback_t& p_feedback, rmd_response const& p_response)
+{
+  store(p_feedback.raw_motor_temperature,
+        p_response,
+        rmd_field::motor_temperature);
+  store(p_feedback.raw_current, p_response, rmd_field::current);
+  store(p_feedback.raw_speed, p_response, rmd_field::speed);
+  store(p_feedback.encoder, p_response, rmd_field::encoder);
+  store(p_feedback.raw_volts, p_response, rmd_field::volts);
+  store(p_feedback.raw_error_state, p_response, rmd_field::error_state);
+  store(p_feedback.raw_multi_turn_angle,
+        p_response,
+        rmd_field::multi_turn_angle);
+
+  // Each group is decoded whole, so one of its fields marks the group
+  auto& updated = p_feedback.updated;
+  if (p_response.has(rmd_field::volts)) {
+    updated.status_1 = p_response.received_at;
+  }
+  if (p_response.has(rmd_field::current)) {
+    updated.status_2 = p_response.received_at;
+  }
+  if (p_response.has(rmd_field::multi_turn_angle)) {
+    updated.multi_turn_angle = p_response.received_at;
+  }
+}
+}  // namespace hal::actuator
@@ -0,0 +1,90 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/telemetry_log.hpp>
+
+#include <algorithm>
+#include <bit>
+
+#include <libhal/error.hpp>
+
+namespace hal::actuator {
+telemetry_log::telemetry_log(std::span<telemetry_record> p_storage)
+  : m_storage(p_storage)
+  , m_mask(static_cast<hal::u32>(p_storage.size() - 1))
+{
+  if (not std::has_single_bit(p_storage.size())) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+}
+
+bool telemetry_log::append(hal::u64 p_timestamp,
+                           telemetry_source p_source,
+                           hal::u16 p_device_id,
+                           hal::byte p_opcode,
+                           std::span<hal::byte const> p_payload) noexcept
+{
+  constexpr hal::usize chunk = telemetry_record{}.payload.size();
+  auto const records =
+    std::max<hal::usize>(1, (p_payload.size() + chunk - 1) / chunk);
+
+  auto const head = m_head.load(std::memory_order_relaxed);
+  auto const tail = m_tail.load(std::memory_order_acquire);
+  auto const free = m_storage.size() - (head - tail);
+  if (records > free) {
+    m_dropped.fetch_add(records, std::memory_order_relaxed);
+    return false;
+  }
+
+  for (hal::usize i = 0; i < records; i++) {
+    auto& record = m_storage[(head + i) & m_mask];
+    auto const part = p_payload.subspan(
+      i * chunk, std::min(chunk, p_payload.size() - (i * chunk)));
+    record.timestamp = p_timestamp;
+    record.device_id = p_device_id;
+    record.source = p_source;
+    record.opcode = p_opcode;
+    record.offset = static_cast<hal::u8>(i * chunk);
+    record.length = static_cast<hal::u8>(part.size());
+    record.payload = {};
+    std::ranges::copy(part, record.payload.begin());
+  }
+  m_head.store(head + records, std::memory_order_release);
+  return true;
+}
+
+hal::usize telemetry_log::drain(std::span<telemetry_record> p_records) noexcept
+{
+  auto const tail = m_tail.load(std::memory_order_relaxed);
+  auto const head = m_head.load(std::memory_order_acquire);
+  auto const count = std::min<hal::usize>(head - tail, p_records.size());
+
+  for (hal::usize i = 0; i < count; i++) {
+    p_records[i] = m_storage[(tail + i) & m_mask];
+  }
+  m_tail.store(tail + count, std::memory_order_release);
+  return count;
+}
+
+hal::usize telemetry_log::size() const noexcept
+{
+  return m_head.load(std::memory_order_acquire) -
+         m_tail.load(std::memory_order_acquire);
+}
+
+hal::u32 telemetry_log::dropped() const noexcept
+{
+  return m_dropped.load(std::memory_order_relaxed);
+}
+}  // namespace hal::actuator
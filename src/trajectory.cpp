@@ -0,0 +1,197 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/trajectory.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <libhal/error.hpp>
+
+namespace hal::actuator {
+namespace {
+u32 whole_ticks(float p_ticks)
+{
+  // Float noise can land a whole number of ticks just above it, which must
+  // not cost a tick
+  constexpr float tolerance = 1e-3f;
+  return static_cast<u32>(std::ceil(std::max(0.0f, p_ticks - tolerance)));
+}
+}  // namespace
+
+trajectory::trajectory(hal::time_duration p_tick,
+                       limits const& p_limits,
+                       hal::degrees p_start)
+  : m_tick_seconds(std::chrono::duration<float>(p_tick).count())
+  , m_limits(p_limits)
+  , m_queue_end(p_start)
+  , m_position(p_start)
+{
+  if (m_tick_seconds <= 0.0f || p_limits.velocity <= 0.0f ||
+      p_limits.acceleration <= 0.0f) {
+    hal::safe_throw(hal::argument_out_of_domain(this));
+  }
+}
+
+void trajectory::enqueue(waypoint const& p_waypoint)
+{
+  if (m_count == capacity) {
+    hal::safe_throw(hal::resource_unavailable_try_again(this));
+  }
+
+  auto const distance = p_waypoint.position - m_queue_end;
+  auto const magnitude = std::abs(distance);
+  auto const requested_ticks =
+    std::chrono::duration<float>(p_waypoint.duration).count() / m_tick_seconds;
+  move next{ .target = p_waypoint.position };
+
+  if (magnitude == 0.0f) {
+    // Nothing to move, so the move is a pause of the requested length
+    next.cruise_ticks = whole_ticks(requested_ticks);
+  } else {
+    auto const velocity_limit =
+      p_waypoint.velocity > 0.0f
+        ? std::min(p_waypoint.velocity, m_limits.velocity)
+        : m_limits.velocity;
+    // Work in ticks from here on: degrees per tick and per tick squared
+    auto const max_velocity = velocity_limit * m_tick_seconds;
+    auto const max_acceleration =
+      m_limits.acceleration * m_tick_seconds * m_tick_seconds;
+
+    // Fastest move: a triangle if the peak velocity is never reached
+    auto peak = std::min(max_velocity, std::sqrt(max_acceleration * magnitude));
+    if (requested_ticks > 0.0f) {
+      // Slowest peak that still covers the distance in the requested time,
+      // from distance = peak * (ticks - peak / acceleration)
+      auto const reach = max_acceleration * requested_ticks;
+      auto const discriminant =
+        reach * reach - 4 * max_acceleration * magnitude;
+      if (discriminant >= 0.0f) {
+        peak = std::min(peak, (reach - std::sqrt(discriminant)) / 2);
+      }
+    }
+
+    // Round the phases up to whole ticks, then lower the peak so the move
+    // still ends on the waypoint. Rounding up only ever lowers the velocity
+    // and acceleration, so the limits hold.
+    next.ramp_ticks = std::max(1U, whole_ticks(peak / max_acceleration));
+    next.cruise_ticks =
+      whole_ticks(magnitude / peak - static_cast<float>(next.ramp_ticks));
+    auto const ticks = static_cast<float>(next.ramp_ticks + next.cruise_ticks);
+    auto const rounded_peak = magnitude / ticks;
+    next.acceleration = std::copysign(
+      rounded_peak / static_cast<float>(next.ramp_ticks), distance);
+  }
+
+  m_queue[(m_head + m_count) % capacity] = next;
+  m_count++;
+  m_queue_end = p_waypoint.position;
+}
+
+hal::degrees trajectory::tick()
+{
+  while (m_phase == phase::idle && m_count > 0) {
+    auto const next = m_queue[m_head];
+    m_head = (m_head + 1) % capacity;
+    m_count--;
+    start(next);
+  }
+
+  if (m_phase == phase::idle) {
+    return m_position;
+  }
+
+  // Exact for constant acceleration over the tick
+  m_position += m_velocity + m_half_acceleration;
+  m_velocity += m_acceleration;
+  if (--m_phase_ticks == 0) {
+    next_phase();
+  }
+  return m_position;
+}
+
+void trajectory::start(move const& p_move)
+{
+  m_current = p_move;
+  m_velocity = 0.0f;
+  m_phase = phase::idle;
+  next_phase();
+}
+
+void trajectory::next_phase()
+{
+  while (true) {
+    switch (m_phase) {
+      case phase::idle:
+        m_phase = phase::accelerate;
+        if (m_current.ramp_ticks > 0) {
+          m_acceleration = m_current.acceleration;
+          m_phase_ticks = m_current.ramp_ticks;
+          m_half_acceleration = m_acceleration / 2;
+          return;
+        }
+        break;
+      case phase::accelerate:
+        m_phase = phase::cruise;
+        if (m_current.cruise_ticks > 0) {
+          m_acceleration = 0.0f;
+          m_phase_ticks = m_current.cruise_ticks;
+          m_half_acceleration = 0.0f;
+          return;
+        }
+        break;
+      case phase::cruise:
+        m_phase = phase::decelerate;
+        if (m_current.ramp_ticks > 0) {
+          m_acceleration = -m_current.acceleration;
+          m_phase_ticks = m_current.ramp_ticks;
+          m_half_acceleration = m_acceleration / 2;
+          return;
+        }
+        break;
+      case phase::decelerate:
+      default:
+        // Land exactly on the waypoint, whatever float rounding did
+        m_position = m_current.target;
+        m_velocity = 0.0f;
+        m_phase = phase::idle;
+        return;
+    }
+  }
+}
+
+void trajectory::clear()
+{
+  m_count = 0;
+  m_phase = phase::idle;
+  m_velocity = 0.0f;
+  m_queue_end = m_position;
+}
+
+hal::degrees trajectory::position() const
+{
+  return m_position;
+}
+
+bool trajectory::moving() const
+{
+  return m_phase != phase::idle || m_count > 0;
+}
+
+usize trajectory::queued() const
+{
+  return m_count;
+}
+}  // namespace hal::actuator
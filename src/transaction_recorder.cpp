@@ -0,0 +1,63 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+
+#include <libhal-actuator/transaction_recorder.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+hal::time_duration transaction_recorder::summary::mean() const
+{
+  if (completed == 0) {
+    return hal::time_duration::zero();
+  }
+  return total / completed;
+}
+
+transaction_recorder::transaction_recorder(hal::time_duration p_bin_width)
+  : m_bin_width(std::max(p_bin_width, hal::time_duration(1)))
+{
+}
+
+void transaction_recorder::record(transaction const& p_transaction)
+{
+  auto& stats = m_summary;
+  stats.transactions++;
+  stats.retries += p_transaction.attempts > 0 ? p_transaction.attempts - 1 : 0;
+  stats.timeouts += p_transaction.timeouts;
+  stats.bytes_sent += p_transaction.bytes_sent;
+  stats.bytes_received += p_transaction.bytes_received;
+  m_last = p_transaction;
+
+  if (not p_transaction.completed) {
+    return;
+  }
+
+  auto const response_time = p_transaction.response_time;
+  stats.completed++;
+  stats.min = std::min(stats.min, response_time);
+  stats.max = std::max(stats.max, response_time);
+  stats.total += response_time;
+
+  auto const bin = static_cast<usize>(response_time / m_bin_width);
+  stats.histogram[std::min(bin, histogram_bins - 1)]++;
+}
+
+void transaction_recorder::reset()
+{
+  m_summary = {};
+  m_last = {};
+}
+}  // namespace hal::actuator
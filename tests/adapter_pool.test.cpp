@@ -0,0 +1,140 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/adapter_pool.hpp>
+
+#include <cstddef>
+#include <memory_resource>
+
+#include <libhal-actuator/smart_servo/rmd/drc_v2.hpp>
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "fakes.hpp"
+
+namespace hal::actuator {
+namespace {
+/// Memory resource that records the size of its last allocation
+struct recording_resource : public std::pmr::memory_resource
+{
+  hal::usize last_bytes = 0;
+
+private:
+  void* do_allocate(std::size_t p_bytes, std::size_t p_alignment) override
+  {
+    last_bytes = p_bytes;
+    return std::pmr::new_delete_resource()->allocate(p_bytes, p_alignment);
+  }
+
+  void do_deallocate(void* p_block,
+                     std::size_t p_bytes,
+                     std::size_t p_alignment) override
+  {
+    std::pmr::new_delete_resource()->deallocate(p_block, p_bytes, p_alignment);
+  }
+
+  [[nodiscard]] bool do_is_equal(
+    std::pmr::memory_resource const& p_other) const noexcept override
+  {
+    return this == &p_other;
+  }
+};
+}  // namespace
+
+boost::ut::suite<"test_adapter_pool"> test_adapter_pool = [] {
+  using namespace boost::ut;
+  using namespace hal::literals;
+
+  "adapter_pool reuses released slots"_test = []() {
+    // Setup
+    adapter_pool<32, 2> pool;
+
+    // Exercise
+    auto* const first = pool.allocate(32);
+    auto* const second = pool.allocate(16);
+    auto const exhausted = pool.available();
+    pool.deallocate(first, 32);
+    auto* const third = pool.allocate(24);
+
+    // Verify
+    expect(that % 0U == exhausted);
+    expect(first == third);
+    expect(first != second);
+    expect(throws<hal::resource_unavailable_try_again>(
+      [&]() { (void)pool.allocate(8); }));
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { (void)pool.allocate(33); }));
+    pool.deallocate(second, 16);
+    pool.deallocate(third, 24);
+    expect(that % 2U == pool.available());
+  };
+
+  "adapter_pool overhead covers a strong_ptr's bookkeeping"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    can.response_offset = 0;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_drc_v2 drc(can, filter, clock, 6.0f, 0x141);
+    recording_resource resource;
+    constexpr auto overhead = detail::adapter_pool_overhead;
+    constexpr auto alignment = alignof(std::max_align_t);
+
+    // Exercise
+    auto motor = drc.acquire_motor2(&resource, 100.0_rpm);
+    auto const motor_bytes = resource.last_bytes - sizeof(rmd_drc_v2::motor);
+    auto temperature = drc.acquire_temperature_sensor2(&resource);
+    auto const temperature_bytes =
+      resource.last_bytes - sizeof(rmd_drc_v2::temperature_sensor);
+
+    // Verify
+    expect(that % 0U < motor_bytes);
+    expect(that % motor_bytes <= overhead);
+    expect(that % temperature_bytes <= overhead);
+    // The estimate must not cost more than one alignment unit per slot
+    expect(that % overhead < motor_bytes + alignment);
+  };
+
+  "hal::actuator::rmd_drc_v2::acquire_motor2()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    // DRC motors respond with the ID of the request
+    can.response_offset = 0;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_drc_v2 drc(can, filter, clock, 6.0f, 0x141);
+    rmd_drc_v2::adapter_pool<2> pool;
+
+    // Exercise
+    {
+      auto motor = drc.acquire_motor2(&pool, 100.0_rpm);
+      auto rotation = drc.acquire_rotation_sensor2(&pool);
+      expect(that % 0U == pool.available());
+      expect(throws<hal::resource_unavailable_try_again>(
+        [&]() { (void)drc.acquire_servo2(&pool, 10.0_rpm); }));
+      can.sent.clear();
+      motor->power(0.5f);
+      expect(that % 1U == can.sent.size());
+    }
+    auto const released = pool.available();
+    auto velocity = drc.acquire_angular_velocity_sensor2(&pool);
+    auto temperature = drc.acquire_temperature_sensor2(&pool);
+
+    // Verify
+    expect(that % 2U == released);
+    expect(that % 0U == pool.available());
+  };
+};
+}  // namespace hal::actuator
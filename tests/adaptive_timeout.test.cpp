@@ -0,0 +1,97 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/adaptive_timeout.hpp>
+
+#include <chrono>
+
+#include <boost/ut.hpp>
+
+#include "fakes.hpp"
+
+namespace hal::actuator {
+boost::ut::suite<"test_adaptive_timeout"> test_adaptive_timeout = [] {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "adaptive_timeout starts at the ceiling"_test = []() {
+    // Setup
+    adaptive_timeout timer({ .ceiling = 10ms });
+
+    // Exercise + Verify
+    expect(10ms == timer.timeout());
+  };
+
+  "adaptive_timeout shrinks to the measured round trip"_test = []() {
+    // Setup
+    adaptive_timeout timer({ .ceiling = 10ms, .margin = 200us });
+
+    // Exercise
+    for (int i = 0; i < 32; i++) {
+      timer.record(300us);
+    }
+
+    // Verify
+    expect(that % 32U == timer.stats().samples);
+    expect(300us == timer.stats().min);
+    expect(300us == timer.stats().max);
+    expect(300us == timer.stats().smoothed);
+    expect(timer.timeout() >= 500us);
+    expect(timer.timeout() < 600us);
+  };
+
+  "adaptive_timeout backs off to the ceiling on timeouts"_test = []() {
+    // Setup
+    adaptive_timeout timer({ .ceiling = 2ms, .margin = 200us });
+    timer.record(300us);
+    auto const before = timer.timeout();
+
+    // Exercise
+    timer.record_timeout();
+    auto const once = timer.timeout();
+    for (int i = 0; i < 10; i++) {
+      timer.record_timeout();
+    }
+
+    // Verify
+    expect(once == 2 * before);
+    expect(2ms == timer.timeout());
+    expect(that % 11U == timer.stats().timeouts);
+  };
+
+  "adaptive_timeout stays at the ceiling when not adapting"_test = []() {
+    // Setup
+    adaptive_timeout timer({ .ceiling = 10ms, .adapt = false });
+
+    // Exercise
+    timer.record(100us);
+
+    // Verify
+    expect(10ms == timer.timeout());
+    expect(that % 1U == timer.stats().samples);
+  };
+
+  "adaptive_timeout::elapsed() converts ticks to time"_test = []() {
+    // Setup
+    fake_steady_clock clock;
+    clock.ticks = 1000;
+
+    // Exercise
+    auto const elapsed = adaptive_timeout::elapsed(clock, 750);
+
+    // Verify
+    expect(250us == elapsed);
+  };
+};
+}  // namespace hal::actuator
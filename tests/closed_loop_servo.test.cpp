@@ -0,0 +1,215 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/closed_loop_servo.hpp>
+
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "fakes.hpp"
+
+namespace hal::actuator {
+boost::ut::suite<"test_closed_loop_servo"> test_closed_loop_servo = [] {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "hal::actuator::closed_loop_servo::closed_loop_servo()"_test = []() {
+    // Setup
+    fake_servo servo;
+    fake_steady_clock clock;
+
+    // Exercise + Verify
+    expect(throws<hal::argument_out_of_domain>([&]() {
+      closed_loop_servo bad(servo, clock, { .min_angle = 90, .max_angle = 0 });
+    }));
+    expect(throws<hal::argument_out_of_domain>([&]() {
+      closed_loop_servo bad(servo, clock, { .gain = -1.0f });
+    }));
+    expect(servo.positions.empty());
+  };
+
+  "hal::actuator::closed_loop_servo::position()"_test = []() {
+    // Setup
+    fake_servo servo;
+    fake_steady_clock clock;
+    fake_rotation_sensor sensor;
+    closed_loop_servo loop(servo, clock, {}, &sensor);
+
+    // Exercise
+    loop.position(45.0f);
+
+    // Verify
+    expect(that % 1U == servo.positions.size());
+    expect(that % 45.0f == servo.positions[0]);
+    expect(not loop.reached());
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { loop.position(91.0f); }));
+  };
+
+  "hal::actuator::closed_loop_servo::update() settles"_test = []() {
+    // Setup
+    fake_servo servo;
+    fake_steady_clock clock;
+    fake_rotation_sensor sensor;
+    closed_loop_servo loop(servo, clock, { .settle_updates = 3 }, &sensor);
+    loop.position(45.0f);
+    sensor.angle = 44.5f;
+
+    // Exercise
+    auto const first = loop.update();
+    auto const second = loop.update();
+    auto const third = loop.update();
+
+    // Verify
+    expect(not first);
+    expect(not second);
+    expect(third);
+    expect(loop.reached());
+    expect(that % 0.5f == loop.error());
+    // Within tolerance, so the command is left alone
+    expect(that % 1U == servo.positions.size());
+  };
+
+  "hal::actuator::closed_loop_servo::update() corrects"_test = []() {
+    // Setup
+    fake_servo servo;
+    fake_steady_clock clock;
+    fake_rotation_sensor sensor;
+    closed_loop_servo loop(servo,
+                           clock,
+                           {
+                             .gain = 0.5f,
+                             .max_correction = 3.0f,
+                           },
+                           &sensor);
+    loop.position(45.0f);
+    sensor.angle = 41.0f;
+
+    // Exercise
+    // The shaft never moves, so each correction waits out the settling time
+    for (int i = 0; i < 2; i++) {
+      loop.update();
+      clock.ticks += 400'000;
+      loop.update();
+    }
+
+    // Verify
+    // 4 degrees short: +2, then +2 again but held to 3
+    expect(that % 3U == servo.positions.size());
+    expect(that % 47.0f == servo.positions[1]);
+    expect(that % 48.0f == servo.positions[2]);
+    expect(that % 3.0f == loop.correction());
+    expect(not loop.reached());
+  };
+
+  "hal::actuator::closed_loop_servo::update() keeps in range"_test = []() {
+    // Setup
+    fake_servo servo;
+    fake_steady_clock clock;
+    fake_rotation_sensor sensor;
+    closed_loop_servo loop(servo, clock, { .gain = 1.0f }, &sensor);
+    loop.position(90.0f);
+    sensor.angle = 85.0f;
+
+    // Exercise
+    loop.update();
+    clock.ticks += 400'000;
+    loop.update();
+
+    // Verify
+    expect(that % 2U == servo.positions.size());
+    expect(that % 90.0f == servo.positions.back());
+  };
+
+  "hal::actuator::closed_loop_servo::update() waits out a slew"_test = []() {
+    // Setup
+    fake_servo servo;
+    fake_steady_clock clock;
+    fake_rotation_sensor sensor;
+    closed_loop_servo loop(servo, clock, { .gain = 0.5f }, &sensor);
+    sensor.angle = 0.0f;
+    loop.position(45.0f);
+
+    // Exercise
+    // The shaft slews 5 degrees per update and comes to rest 2 degrees short
+    bool reached_while_slewing = false;
+    for (int i = 1; i <= 8; i++) {
+      sensor.angle = 5.0f * static_cast<float>(i);
+      reached_while_slewing = reached_while_slewing or loop.update();
+    }
+    auto const correction_after_slew = loop.correction();
+    sensor.angle = 43.0f;
+    loop.update();
+    loop.update();
+
+    // Verify
+    expect(not reached_while_slewing);
+    expect(that % 0.0f == correction_after_slew);
+    // Only the 2 degrees left once at rest are integrated
+    expect(that % 1.0f == loop.correction());
+    expect(that % 2U == servo.positions.size());
+    expect(that % 46.0f == servo.positions.back());
+  };
+
+  "hal::actuator::closed_loop_servo::update() waits out dead time"_test =
+    []() {
+      // Setup
+      fake_servo servo;
+      fake_steady_clock clock;
+      fake_rotation_sensor sensor;
+      closed_loop_servo loop(servo, clock, { .gain = 0.5f }, &sensor);
+      sensor.angle = 0.0f;
+      loop.position(45.0f);
+
+      // Exercise
+      // The servo has not started to move, so the shaft still reads the old
+      // target
+      for (int i = 0; i < 5; i++) {
+        loop.update();
+      }
+      auto const correction_in_dead_time = loop.correction();
+      sensor.angle = 30.0f;
+      loop.update();
+      sensor.angle = 43.0f;
+      loop.update();
+      loop.update();
+
+      // Verify
+      expect(that % 0.0f == correction_in_dead_time);
+      expect(that % 1.0f == loop.correction());
+      expect(that % 2U == servo.positions.size());
+      expect(that % 46.0f == servo.positions.back());
+    };
+
+  "hal::actuator::closed_loop_servo::update() open loop"_test = []() {
+    // Setup
+    fake_servo servo;
+    fake_steady_clock clock;
+    closed_loop_servo loop(
+      servo, clock, { .open_loop_settle_time = 100ms });
+    loop.position(30.0f);
+
+    // Exercise
+    auto const before = loop.update();
+    clock.ticks += 100'000;
+    auto const after = loop.update();
+
+    // Verify
+    expect(not before);
+    expect(after);
+    expect(that % 1U == servo.positions.size());
+  };
+};
+}  // namespace hal::actuator
@@ -0,0 +1,146 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/cyclic_scheduler.hpp>
+
+#include <array>
+#include <chrono>
+#include <string>
+
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "fakes.hpp"
+
+namespace hal::actuator {
+boost::ut::suite<"test_cyclic_scheduler"> test_cyclic_scheduler = [] {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "cyclic_scheduler runs the tasks of a lane in priority order"_test = []() {
+    // Setup
+    fake_steady_clock clock;
+    std::array<cyclic_scheduler::task, 3> tasks;
+    cyclic_scheduler loop(clock, 1ms, tasks);
+    std::string order;
+    loop.add({ .priority = 2 }, [&order] { order += 'c'; });
+    loop.add({ .priority = 0 }, [&order] { order += 'a'; });
+    loop.add({ .priority = 0 }, [&order] { order += 'b'; });
+
+    // Exercise
+    auto const report = loop.run_cycle();
+
+    // Verify
+    expect(that % std::string("abc") == order);
+    expect(that % 3 == report.completed);
+    expect(that % 0 == report.skipped);
+    expect(not report.overrun);
+  };
+
+  "cyclic_scheduler runs a task every period cycles"_test = []() {
+    // Setup
+    fake_steady_clock clock;
+    std::array<cyclic_scheduler::task, 2> tasks;
+    cyclic_scheduler loop(clock, 1ms, tasks);
+    int every_cycle = 0;
+    int odd_cycles = 0;
+    loop.add({}, [&every_cycle] { every_cycle++; });
+    loop.add({ .period = 2, .offset = 1 }, [&odd_cycles] { odd_cycles++; });
+
+    // Exercise
+    for (int i = 0; i < 4; i++) {
+      (void)loop.run_cycle();
+    }
+
+    // Verify
+    expect(that % 4 == every_cycle);
+    expect(that % 2 == odd_cycles);
+    expect(that % 4U == loop.stats().cycles);
+    // Cycles start a period apart
+    expect(clock.ticks >= 3000U);
+  };
+
+  "cyclic_scheduler overlaps tasks of different lanes"_test = []() {
+    // Setup
+    fake_steady_clock clock;
+    std::array<cyclic_scheduler::task, 3> tasks;
+    cyclic_scheduler loop(clock, 1ms, tasks);
+    std::string events;
+    int polls = 0;
+    loop.add(
+      { .lane = 0 },
+      [&events] { events += "A"; },
+      [&events, &polls] {
+        if (++polls < 3) {
+          return false;
+        }
+        events += "a";
+        return true;
+      });
+    loop.add({ .lane = 1 }, [&events] { events += "B"; });
+    loop.add({ .lane = 1 }, [&events] { events += "C"; });
+
+    // Exercise
+    auto const report = loop.run_cycle();
+
+    // Verify
+    // Lane 1 finishes while the lane 0 request is still in flight
+    expect(that % std::string("ABCa") == events);
+    expect(that % 3 == report.completed);
+  };
+
+  "cyclic_scheduler skips tasks and reports an overrun"_test = []() {
+    // Setup
+    fake_steady_clock clock;
+    std::array<cyclic_scheduler::task, 2> tasks;
+    cyclic_scheduler loop(clock, 100us, tasks);
+    int late = 0;
+    loop.add({ .priority = 0 }, [&clock] { clock.ticks += 500; });
+    loop.add({ .priority = 1 }, [&late] { late++; });
+
+    // Exercise
+    auto const report = loop.run_cycle();
+
+    // Verify
+    expect(report.overrun);
+    expect(that % 1 == report.completed);
+    expect(that % 1 == report.skipped);
+    expect(that % 0 == late);
+    expect(report.busy >= 500us);
+    expect(that % 1U == loop.stats().overruns);
+    expect(that % 1U == loop.stats().skipped);
+  };
+
+  "cyclic_scheduler::add() rejects invalid tasks"_test = []() {
+    // Setup
+    fake_steady_clock clock;
+    std::array<cyclic_scheduler::task, 1> tasks;
+    cyclic_scheduler loop(clock, 1ms, tasks);
+
+    // Exercise + Verify
+    expect(throws<hal::argument_out_of_domain>([&] {
+      loop.add({ .lane = cyclic_scheduler::max_lanes }, [] {});
+    }));
+    expect(throws<hal::argument_out_of_domain>(
+      [&] { loop.add({ .period = 0 }, [] {}); }));
+    expect(throws<hal::argument_out_of_domain>(
+      [&] { loop.add({ .period = 2, .offset = 2 }, [] {}); }));
+    loop.add({}, [] {});
+    expect(throws<hal::resource_unavailable_try_again>(
+      [&] { loop.add({}, [] {}); }));
+    expect(that % 1U == loop.size());
+  };
+};
+}  // namespace hal::actuator
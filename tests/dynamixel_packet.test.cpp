@@ -0,0 +1,110 @@
+// Copyright 2026 Malia Labor and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/dynamixel_packet.hpp>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::actuator {
+boost::ut::suite<"test_dynamixel_packet"> test_dynamixel_packet = [] {
+  using namespace boost::ut;
+
+  "dynamixel::build_write() builds a WRITE packet"_test = []() {
+    // Setup
+    std::array<hal::byte, dynamixel::instruction_packet_size(3)> buffer{};
+    std::array<hal::byte, 2> const data{ 0x00, 0x02 };
+    // FF FF ID LEN WRITE ADDR LO HI CHK
+    std::vector<hal::byte> const expected{ 0xFF, 0xFF, 0x01, 0x05, 0x03,
+                                           0x1E, 0x00, 0x02, 0xD6 };
+
+    // Exercise
+    auto const packet = dynamixel::build_write(buffer, 0x01, 0x1E, data);
+
+    // Verify
+    expect(that % expected ==
+           std::vector<hal::byte>(packet.begin(), packet.end()));
+  };
+
+  "dynamixel::build_read() packets can be chained in one buffer"_test = []() {
+    // Setup
+    constexpr auto read_size = dynamixel::instruction_packet_size(2);
+    std::array<hal::byte, 2 * read_size> buffer{};
+
+    // Exercise
+    auto const first = dynamixel::build_read(buffer, 0x01, 0x24, 0x08);
+    auto const second = dynamixel::build_read(
+      std::span(buffer).subspan(first.size()), 0x02, 0x24, 0x08);
+
+    // Verify
+    expect(that % read_size == first.size());
+    expect(that % read_size == second.size());
+    expect(that % 0x01 == buffer[2]);
+    expect(that % 0xCC == buffer[7]);
+    expect(that % 0x02 == buffer[read_size + 2]);
+    expect(that % 0xCB == buffer[read_size + 7]);
+  };
+
+  "dynamixel::build_instruction() rejects a buffer that is too small"_test =
+    []() {
+      // Setup
+      std::array<hal::byte, dynamixel::instruction_packet_size(0)> buffer{};
+      std::array<hal::byte, 1> const parameters{ 0x00 };
+
+      // Exercise + Verify
+      expect(throws<hal::argument_out_of_domain>([&] {
+        dynamixel::build_instruction(
+          buffer, 0x01, dynamixel::instruction::action, parameters);
+      }));
+    };
+
+  "dynamixel::build_instruction() is usable at compile time"_test = []() {
+    constexpr auto packet = [] {
+      std::array<hal::byte, dynamixel::instruction_packet_size(0)> buffer{};
+      dynamixel::build_instruction(
+        buffer, 0x01, dynamixel::instruction::ping, {});
+      return buffer;
+    }();
+
+    static_assert(packet[5] == 0xFB);
+  };
+
+  "dynamixel::build_reg_write() and build_action() stage a write"_test =
+    []() {
+      // Setup
+      std::array<hal::byte, dynamixel::instruction_packet_size(3)> staged{};
+      std::array<hal::byte, dynamixel::instruction_packet_size(0)> action{};
+      std::array<hal::byte, 2> const data{ 0x00, 0x02 };
+
+      // Exercise
+      auto const stage = dynamixel::build_reg_write(staged, 0x01, 0x1E, data);
+      auto const fire = dynamixel::build_action(action);
+
+      // Verify
+      // FF FF 01 05 04 1E 00 02 CHK
+      std::array<hal::byte, 9> const expected_stage{
+        0xFF, 0xFF, 0x01, 0x05, 0x04, 0x1E, 0x00, 0x02, 0xD5
+      };
+      std::array<hal::byte, 6> const expected_fire{ 0xFF, 0xFF, 0xFE,
+                                                    0x02, 0x05, 0xFA };
+      expect(std::ranges::equal(expected_stage, stage));
+      expect(std::ranges::equal(expected_fire, fire));
+    };
+};
+}  // namespace hal::actuator
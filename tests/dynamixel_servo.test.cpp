@@ -0,0 +1,900 @@
+// Copyright 2026 Malia Labor and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/dynamixel_servo.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "fakes.hpp"
+
+namespace hal::actuator {
+namespace {
+/// Servo that exposes the register access of the model drivers
+struct register_servo : public dynamixel_servo
+{
+  using dynamixel_servo::dynamixel_servo;
+  using dynamixel_servo::stage_register;
+  using dynamixel_servo::write_register;
+};
+
+/// Control table address as the sync helpers take it
+constexpr hal::byte address(dynamixel_servo::common_register p_register)
+{
+  return static_cast<hal::byte>(p_register);
+}
+
+/// Model traits the tests shared between the model drivers run against
+struct model_case
+{
+  std::string_view name;
+  dynamixel_model const* model;
+};
+
+constexpr std::array model_cases{
+  model_case{ .name = "rx_64", .model = &dynamixel_rx_64 },
+  model_case{ .name = "mx_64", .model = &dynamixel_mx_64 },
+};
+}  // namespace
+
+boost::ut::suite<"test_dynamixel_servo"> test_dynamixel_servo = [] {
+  using namespace boost::ut;
+  using namespace std::literals;
+  using namespace hal::literals;
+
+  "dynamixel_servo clamps max_angle to the model"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo servo(serial,
+                          dynamixel_ax_12,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    serial->push_status(0x01, 0x00, {});
+
+    // Exercise
+    servo.position(350.0_deg);
+
+    // Verify
+    // FF FF ID LEN WRITE ADDR LO HI CHK
+    expect(that % 9U == serial->written.size());
+    expect(that % 0x1E == serial->written[5]);
+    expect(that % 0xFF == serial->written[6]);
+    expect(that % 0x03 == serial->written[7]);
+  };
+
+  "dynamixel_servo::position() uses the model's position range"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo servo(serial,
+                          dynamixel_ax_12,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    std::array<hal::byte, 2> const present_position{ 0xFF, 0x01 };
+    serial->push_status(0x01, 0x00, present_position);
+
+    // Exercise
+    auto const angle = servo.position();
+
+    // Verify
+    expect(std::abs(150.0f - angle) < 0.2f);
+    expect(that % 0x24 == serial->written[5]);
+    expect(that % 0x02 == serial->written[6]);
+  };
+
+  "dynamixel_servo::speed() decodes the direction bit"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo servo(serial,
+                          dynamixel_ax_12,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    // Bit 10 set with a magnitude of 1023, then bit 9 of the magnitude alone
+    serial->push_status(0x01, 0x00, std::array<hal::byte, 2>{ 0xFF, 0x07 });
+    serial->push_status(0x01, 0x00, std::array<hal::byte, 2>{ 0x00, 0x02 });
+
+    // Exercise
+    auto const clockwise = servo.speed();
+    auto const counter_clockwise = servo.speed();
+
+    // Verify
+    expect(std::abs(dynamixel_ax_12.speed_max - clockwise) < 0.01f);
+    expect(std::abs(-dynamixel_ax_12.speed_max * 512 / 1023 -
+                    counter_clockwise) < 0.01f);
+    expect(std::abs(counter_clockwise - servo.last_telemetry().speed) <
+           0.01f);
+  };
+
+  "dynamixel_servo::max_voltage() clamps to the model's limits"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo servo(serial,
+                          dynamixel_ax_12,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    serial->push_status(0x01, 0x00, {});
+
+    // Exercise
+    servo.max_voltage(30.0f);
+
+    // Verify
+    // FF FF ID LEN WRITE ADDR DATA CHK
+    expect(that % 8U == serial->written.size());
+    expect(that % 0x0D == serial->written[5]);
+    expect(that % 250 == serial->written[6]);
+  };
+
+  "dynamixel_servo::write_register() resends on a checksum error"_test =
+    []() {
+      // Setup
+      auto serial = hal::make_strong_ptr<fake_serial>(
+        std::pmr::new_delete_resource());
+      auto clock = hal::make_strong_ptr<fake_steady_clock>(
+        std::pmr::new_delete_resource());
+      dynamixel_servo servo(serial,
+                            dynamixel_mx_64,
+                            { .id = 0x01, .deferred_setup = true },
+                            clock);
+      serial->push_status(0x01, 0x10, {});
+      serial->push_status(0x01, 0x00, {});
+
+      // Exercise
+      servo.led(true);
+
+      // Verify
+      expect(that % 16U == serial->written.size());
+      expect(that % 2U == serial->write_calls);
+      expect(that % 0x00 == servo.last_error_code());
+    };
+
+  "dynamixel_servo rejects oversized register writes"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    register_servo servo(serial,
+                         dynamixel_mx_64,
+                         { .id = 0x01, .deferred_setup = true },
+                         clock);
+    std::array<hal::byte, dynamixel_servo::max_write + 1> const too_long{};
+
+    // Exercise + Verify
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { servo.write_register(0x06, too_long); }));
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { servo.stage_register(0x06, too_long); }));
+    expect(serial->written.empty());
+  };
+
+  "dynamixel_servo::scan() returns every responding ID"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    serial->on_write = [](fake_serial& p_self,
+                          std::span<hal::byte const> p_packet) {
+      bool const is_ping = p_packet.size() == 6 && p_packet[4] == 0x01;
+      if (is_ping && (p_packet[2] == 3 || p_packet[2] == 7)) {
+        p_self.push_status(p_packet[2], 0x00, {});
+      }
+    };
+    std::array<hal::u8, 8> found{};
+    std::array<hal::u8, 1> too_small{};
+
+    // Exercise
+    auto const ids = dynamixel_servo::scan(
+      serial, clock, found, { .baud_rate = 1'000'000 });
+    auto const first_id = dynamixel_servo::scan(
+      serial, clock, too_small, { .baud_rate = 1'000'000 });
+
+    // Verify
+    expect(that % 2U == ids.size());
+    expect(that % 3 == ids[0]);
+    expect(that % 7 == ids[1]);
+    expect(that % 1U == first_id.size());
+    expect(that % 3 == first_id[0]);
+  };
+
+  "dynamixel_servo::sync_write() builds one packet for every servo"_test =
+    []() {
+      // Setup
+      auto serial = hal::make_strong_ptr<fake_serial>(
+        std::pmr::new_delete_resource());
+      std::array<hal::u8, 2> const ids{ 0x01, 0x02 };
+      std::array<hal::u16, 2> const values{ 0x0010, 0x0220 };
+      // FF FF FE LEN 0x83 ADDR WIDTH [ID LO HI]... CHK
+      std::vector<hal::byte> const expected{ 0xFF, 0xFF, 0xFE, 0x0A, 0x83,
+                                             0x1E, 0x02, 0x01, 0x10, 0x00,
+                                             0x02, 0x20, 0x02, 0x1F };
+
+      auto const goal =
+        address(dynamixel_servo::common_register::goal_position);
+
+      // Exercise
+      dynamixel_servo::sync_write(serial, goal, ids, values);
+
+      // Verify
+      expect(that % expected == serial->written);
+    };
+
+  "dynamixel_servo::sync_write() rejects mismatched spans"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    std::array<hal::u8, 2> const ids{ 0x01, 0x02 };
+    std::array<hal::byte, 1> const values{ 0x01 };
+    auto const torque =
+      address(dynamixel_servo::common_register::torque_enable);
+
+    // Exercise + Verify
+    expect(throws<hal::argument_out_of_domain>(
+      [&] { dynamixel_servo::sync_write(serial, torque, ids, values); }));
+    expect(that % 0U == serial->written.size());
+  };
+
+  "dynamixel_servo::sync_write() rejects packets over 255 bytes"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    std::array<hal::u8, 84> ids{};
+    std::array<hal::u16, 84> values{};
+    auto const goal = address(dynamixel_servo::common_register::goal_position);
+
+    // Exercise + Verify
+    expect(throws<hal::argument_out_of_domain>(
+      [&] { dynamixel_servo::sync_write(serial, goal, ids, values); }));
+  };
+
+  "dynamixel_servo::sync_position() maps angles with the model"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    std::array<hal::u8, 1> const ids{ 0x01 };
+    std::array const angles{ 300.0_deg };
+
+    // Exercise
+    dynamixel_servo::sync_position(serial, dynamixel_ax_12, ids, angles);
+
+    // Verify
+    // FF FF FE LEN 0x83 ADDR WIDTH ID LO HI CHK
+    expect(that % 11U == serial->written.size());
+    expect(that % 0xFF == serial->written[8]);
+    expect(that % 0x03 == serial->written[9]);
+  };
+
+  "dynamixel_servo::last_health() decodes the error byte"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo servo(serial,
+                          dynamixel_mx_64,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    // Overheating and overload
+    serial->push_status(0x01, 0x24, {});
+
+    // Exercise
+    servo.led(true);
+    auto const& health = servo.last_health();
+
+    // Verify
+    expect(that % 1U == health.replies);
+    expect(health.overheating_error());
+    expect(health.overload_error());
+    expect(not health.checksum_error());
+    expect(not health.healthy());
+  };
+
+  "dynamixel_servo::position() keeps the last value on a corrupt reply"_test =
+    []() {
+      // Setup
+      auto serial = hal::make_strong_ptr<fake_serial>(
+        std::pmr::new_delete_resource());
+      auto clock = hal::make_strong_ptr<fake_steady_clock>(
+        std::pmr::new_delete_resource());
+      dynamixel_servo servo(serial,
+                            dynamixel_ax_12,
+                            { .id = 0x01, .deferred_setup = true },
+                            clock);
+      std::array<hal::byte, 2> const present_position{ 0xFF, 0x03 };
+      serial->push_status(0x01, 0x00, present_position);
+      serial->push_status(0x01, 0x00, present_position);
+      // Corrupt the checksum of the second reply
+      serial->rx.back() ^= 0xFF;
+
+      // Exercise
+      auto const first = servo.position();
+      auto const second = servo.position();
+
+      // Verify
+      expect(that % 300.0f == first);
+      expect(that % 300.0f == second);
+      expect(that % 1U == servo.last_health().replies);
+      expect(that % 1U == servo.last_health().corrupted);
+    };
+
+  "dynamixel_servo waits only as long as the measured round trip"_test =
+    []() {
+      // Setup
+      auto serial = hal::make_strong_ptr<fake_serial>(
+        std::pmr::new_delete_resource());
+      auto clock = hal::make_strong_ptr<fake_steady_clock>(
+        std::pmr::new_delete_resource());
+      dynamixel_servo servo(serial,
+                            dynamixel_mx_64,
+                            { .baud_rate = 1'000'000,
+                              .id = 0x01,
+                              .deferred_setup = true },
+                            clock);
+      serial->push_status(0x01, 0x00, {});
+      servo.led(true);
+      auto const start = clock->ticks;
+
+      // Exercise
+      servo.led(false);
+
+      // Verify
+      // Wire time, the 500us return delay and margin, far from the 50ms
+      // response_timeout
+      expect(clock->ticks - start < 2'000U);
+      expect(that % 1U == servo.round_trip_statistics().samples);
+      expect(that % 1U == servo.round_trip_statistics().timeouts);
+      expect(that % 1U == servo.last_health().timeouts);
+    };
+
+  "dynamixel_servo resends a request under a retry policy"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo servo(serial,
+                          dynamixel_ax_12,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    servo.retry({ .attempts = 2 });
+    int writes = 0;
+    serial->on_write = [&writes](fake_serial& p_self,
+                                 std::span<hal::byte const>) {
+      // Only answer the second attempt
+      if (++writes == 2) {
+        std::array<hal::byte, 2> const present_position{ 0xFF, 0x03 };
+        p_self.push_status(0x01, 0x00, present_position);
+      }
+    };
+
+    // Exercise
+    auto const angle = servo.position();
+
+    // Verify
+    expect(that % 2 == writes);
+    expect(that % 300.0f == angle);
+    expect(that % 1U == servo.last_health().timeouts);
+    expect(that % 1U == servo.last_health().replies);
+  };
+
+  "dynamixel_servo records transactions once instrumented"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo servo(serial,
+                          dynamixel_ax_12,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    transaction_recorder recorder;
+    servo.instrument(&recorder);
+    servo.retry({ .attempts = 2 });
+    int writes = 0;
+    serial->on_write = [&writes](fake_serial& p_self,
+                                 std::span<hal::byte const>) {
+      // Only answer the second attempt
+      if (++writes == 2) {
+        std::array<hal::byte, 2> const present_position{ 0xFF, 0x03 };
+        p_self.push_status(0x01, 0x00, present_position);
+      }
+    };
+
+    // Exercise
+    (void)servo.position();
+
+    // Verify
+    auto const& last = recorder.last();
+    expect(that % 1U == recorder.stats().transactions);
+    expect(that % 1U == recorder.stats().completed);
+    expect(that % 1U == recorder.stats().retries);
+    expect(that % 2 == last.attempts);
+    expect(that % 1 == last.timeouts);
+    expect(that % 16 == last.bytes_sent);
+    expect(that % 8 == last.bytes_received);
+    expect(last.completed);
+    expect(last.response_time > 0ns);
+  };
+
+  "dynamixel_servo::read_register_async() completes in poll()"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo servo(serial,
+                          dynamixel_ax_12,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    std::array<hal::byte, 2> data{};
+    int completions = 0;
+    bool received = false;
+
+    // Exercise
+    servo.read_register_async(0x24, data, [&](bool p_received) {
+      completions++;
+      received = p_received;
+    });
+    auto const before_reply = servo.poll();
+    std::array<hal::byte, 2> const present_position{ 0xFF, 0x01 };
+    serial->push_status(0x01, 0x00, present_position);
+    auto const after_reply = servo.poll();
+
+    // Verify
+    expect(dynamixel_servo::request_status::pending == before_reply);
+    expect(dynamixel_servo::request_status::complete == after_reply);
+    expect(that % 1 == completions);
+    expect(received);
+    expect(that % 0xFF == data[0]);
+    expect(that % 0x01 == data[1]);
+    expect(that % 1U == servo.last_health().replies);
+  };
+
+  "dynamixel_servo::write_register_async() times out and retries"_test =
+    []() {
+      // Setup
+      auto serial = hal::make_strong_ptr<fake_serial>(
+        std::pmr::new_delete_resource());
+      auto clock = hal::make_strong_ptr<fake_steady_clock>(
+        std::pmr::new_delete_resource());
+      dynamixel_servo servo(serial,
+                            dynamixel_ax_12,
+                            { .id = 0x01, .deferred_setup = true },
+                            clock);
+      servo.retry({ .attempts = 2 });
+      std::array<hal::byte, 1> const led_on{ 0x01 };
+      bool received = true;
+
+      // Exercise
+      std::array<hal::byte, dynamixel_servo::max_write + 1> const too_long{};
+      expect(throws<hal::argument_out_of_domain>(
+        [&]() { servo.write_register_async(0x19, too_long); }));
+      servo.write_register_async(
+        0x19, led_on, [&](bool p_received) { received = p_received; });
+      expect(throws<hal::device_or_resource_busy>(
+        [&]() { servo.write_register_async(0x19, led_on); }));
+      auto status = servo.poll();
+      while (status == dynamixel_servo::request_status::pending) {
+        clock->ticks += 1'000;
+        status = servo.poll();
+      }
+
+      // Verify
+      expect(dynamixel_servo::request_status::timed_out == status);
+      expect(dynamixel_servo::request_status::timed_out == servo.poll());
+      expect(not received);
+      // Two 8 byte WRITE packets, one per attempt
+      expect(that % 16U == serial->written.size());
+      expect(that % 2U == servo.last_health().timeouts);
+    };
+
+  "dynamixel_servo::commit() fires staged positions together"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo first(serial,
+                          dynamixel_ax_12,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    dynamixel_servo second(serial,
+                           dynamixel_ax_12,
+                           { .id = 0x02, .deferred_setup = true },
+                           clock);
+    serial->on_write = [](fake_serial& p_self,
+                          std::span<hal::byte const> p_packet) {
+      // Answer everything but the broadcast
+      if (p_packet[2] != 0xFE) {
+        p_self.push_status(p_packet[2], 0x00, {});
+      }
+    };
+    std::array<dynamixel_servo*, 2> const servos{ &first, &second };
+
+    // Exercise
+    first.stage_position(0.0f);
+    second.stage_position(0.0f);
+    auto const staged = first.staged() && second.staged();
+    serial->written.clear();
+    dynamixel_servo::commit(servos);
+
+    // Verify
+    expect(staged);
+    expect(not first.staged());
+    expect(not second.staged());
+    // FF FF FE 02 ACTION CHK
+    std::vector<hal::byte> const action{ 0xFF, 0xFF, 0xFE, 0x02, 0x05, 0xFA };
+    expect(that % action == serial->written);
+  };
+
+  "dynamixel_servo::migrate_baud_rate() moves the chain to 1Mbps"_test =
+    []() {
+      // Setup
+      auto serial = hal::make_strong_ptr<fake_serial>(
+        std::pmr::new_delete_resource());
+      auto clock = hal::make_strong_ptr<fake_steady_clock>(
+        std::pmr::new_delete_resource());
+      dynamixel_servo first(serial,
+                            dynamixel_ax_12,
+                            { .id = 0x01, .deferred_setup = true },
+                            clock);
+      dynamixel_servo second(serial,
+                             dynamixel_ax_12,
+                             { .id = 0x02, .deferred_setup = true },
+                             clock);
+      serial->on_write = [](fake_serial& p_self,
+                            std::span<hal::byte const> p_packet) {
+        // Servos only answer pings once the host talks at 1Mbps
+        if (p_packet[4] == 0x01 && p_self.configured.baud_rate == 1000000) {
+          p_self.push_status(p_packet[2], 0x00, {});
+        }
+      };
+      std::array<dynamixel_servo*, 2> const servos{ &first, &second };
+      serial->written.clear();
+
+      // Exercise
+      auto const migrated = dynamixel_servo::migrate_baud_rate(servos, 1e6f);
+
+      // Verify
+      expect(migrated);
+      expect(that % 1000000 == serial->configured.baud_rate);
+      // FF FF FE 04 WRITE BAUD 1 CHK
+      std::vector<hal::byte> const broadcast{
+        0xFF, 0xFF, 0xFE, 0x04, 0x03, 0x04, 0x01, 0xF5
+      };
+      expect(std::ranges::equal(
+        broadcast, std::span(serial->written).first(broadcast.size())));
+      void* source = nullptr;
+      try {
+        dynamixel_servo::migrate_baud_rate(servos, 3e6f);
+      } catch (hal::argument_out_of_domain const& p_error) {
+        source = p_error.instance();
+      }
+      expect(source == &first);
+    };
+
+  "dynamixel_servo::migrate_baud_rate() falls back if a servo is lost"_test =
+    []() {
+      // Setup
+      auto serial = hal::make_strong_ptr<fake_serial>(
+        std::pmr::new_delete_resource());
+      auto clock = hal::make_strong_ptr<fake_steady_clock>(
+        std::pmr::new_delete_resource());
+      dynamixel_servo first(serial,
+                            dynamixel_ax_12,
+                            { .id = 0x01, .deferred_setup = true },
+                            clock);
+      dynamixel_servo second(serial,
+                             dynamixel_ax_12,
+                             { .id = 0x02, .deferred_setup = true },
+                             clock);
+      serial->on_write = [](fake_serial& p_self,
+                            std::span<hal::byte const> p_packet) {
+        // Servo 2 missed the broadcast and stays at 57600
+        if (p_packet[4] == 0x01 && p_packet[2] == 0x01) {
+          p_self.push_status(p_packet[2], 0x00, {});
+        }
+      };
+      std::array<dynamixel_servo*, 2> const servos{ &first, &second };
+      serial->written.clear();
+
+      // Exercise
+      auto const migrated = dynamixel_servo::migrate_baud_rate(servos, 1e6f);
+
+      // Verify
+      expect(not migrated);
+      expect(that % 57600 == serial->configured.baud_rate);
+      // FF FF FE 04 WRITE BAUD 34 CHK, sent last to move servo 1 back
+      std::vector<hal::byte> const restore{
+        0xFF, 0xFF, 0xFE, 0x04, 0x03, 0x04, 0x22, 0xD4
+      };
+      expect(std::ranges::equal(
+        restore, std::span(serial->written).last(restore.size())));
+    };
+
+  "dynamixel_servo::emergency_stop() broadcasts torque off"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+
+    // Exercise
+    dynamixel_servo::emergency_stop(serial);
+
+    // Verify
+    // FF FF FE 04 WRITE TORQUE_ENABLE 0 CHK
+    std::vector<hal::byte> const expected{ 0xFF, 0xFF, 0xFE, 0x04,
+                                           0x03, 0x18, 0x00, 0xE2 };
+    expect(that % expected == serial->written);
+    expect(that % 1U == serial->write_calls);
+  };
+
+  for (auto const& entry : model_cases) {
+    auto const& model = *entry.model;
+    auto const name = std::string(entry.name);
+
+    test(name + "::read_telemetry() decodes the present_* block") =
+      [&model]() {
+        // Setup
+        auto serial = hal::make_strong_ptr<fake_serial>(
+          std::pmr::new_delete_resource());
+        auto clock = hal::make_strong_ptr<fake_steady_clock>(
+          std::pmr::new_delete_resource());
+        dynamixel_servo servo(serial, model, { .id = 0x01 }, clock);
+        serial->written.clear();
+        // Middle of the range, clockwise speed of 100, counter clockwise load
+        // of 100, 12.0V and 40C
+        hal::u16 const position = (model.position_max + 1) / 2;
+        std::array<hal::byte, 8> const block{
+          static_cast<hal::byte>(position & 0xFF),
+          static_cast<hal::byte>(position >> 8),
+          0x64,
+          0x04,
+          0x64,
+          0x00,
+          120,
+          40
+        };
+        serial->push_status(0x01, 0x00, block);
+        std::vector<hal::byte> const expected_request{ 0xFF, 0xFF, 0x01, 0x04,
+                                                       0x02, 0x24, 0x08, 0xCC };
+        auto const expected_position =
+          position * model.angle_max / model.position_max;
+        auto const expected_speed = 100.0f * model.speed_max / 1023.0f;
+
+        // Exercise
+        auto const& telemetry = servo.read_telemetry();
+
+        // Verify
+        expect(that % expected_request == serial->written);
+        expect(std::abs(expected_position - telemetry.position) < 0.01f);
+        expect(std::abs(expected_speed - telemetry.speed) < 0.01f);
+        expect(std::abs(-9.77f - telemetry.load) < 0.01f);
+        expect(std::abs(12.0f - telemetry.voltage) < 0.01f);
+        expect(that % 40 == telemetry.temperature);
+        expect(&telemetry == &servo.last_telemetry());
+      };
+
+    test(name + "::read_telemetry() keeps the cache when the checksum is bad") =
+      [&model]() {
+        // Setup
+        auto serial = hal::make_strong_ptr<fake_serial>(
+          std::pmr::new_delete_resource());
+        auto clock = hal::make_strong_ptr<fake_steady_clock>(
+          std::pmr::new_delete_resource());
+        dynamixel_servo servo(serial, model, { .id = 0x01 }, clock);
+        std::array<hal::byte, 8> const block{ 0x10, 0x00, 0, 0, 0, 0, 120, 40 };
+        serial->push_status(0x01, 0x00, block);
+        serial->rx.back() ^= 0xFF;
+
+        // Exercise
+        auto const& telemetry = servo.read_telemetry();
+
+        // Verify
+        expect(std::abs(0.0f - telemetry.position) < 0.01f);
+        expect(that % 0 == telemetry.temperature);
+      };
+
+    test(name + "::config::cache_control_table serves getters from the cache") =
+      [&model]() {
+        // Setup
+        auto serial = hal::make_strong_ptr<fake_serial>(
+          std::pmr::new_delete_resource());
+        auto clock = hal::make_strong_ptr<fake_steady_clock>(
+          std::pmr::new_delete_resource());
+        // Acknowledge the three writes made by the constructor
+        for (int i = 0; i < 3; i++) {
+          serial->push_status(0x01, 0x00, {});
+        }
+        std::array<hal::byte, 0x24> table{};
+        table[0x03] = 0x01;  // id
+        table[0x05] = 0xFA;  // return_delay, 500us
+        table[0x0C] = 60;    // min_voltage, 6.0V
+        serial->push_status(0x01, 0x00, table);
+        dynamixel_servo servo(
+          serial, model, { .id = 0x01, .cache_control_table = true }, clock);
+        serial->written.clear();
+
+        // Exercise
+        auto const return_delay = servo.return_delay_time();
+        auto const min_voltage = servo.min_voltage();
+        auto const reads_written = serial->written.size();
+        serial->push_status(0x01, 0x00, {});
+        servo.min_voltage(9.0f);
+        auto const updated_min_voltage = servo.min_voltage();
+
+        // Verify
+        expect(servo.control_table_cached());
+        expect(that % 0U == reads_written);
+        expect(500us == return_delay);
+        expect(std::abs(6.0f - min_voltage) < 0.01f);
+        expect(std::abs(9.0f - updated_min_voltage) < 0.01f);
+        expect(that % 8U == serial->written.size());
+      };
+
+    test(name +
+         "::config::cache_control_table leaves RAM and unacked writes out") =
+      [&model]() {
+        // Setup
+        auto serial = hal::make_strong_ptr<fake_serial>(
+          std::pmr::new_delete_resource());
+        auto clock = hal::make_strong_ptr<fake_steady_clock>(
+          std::pmr::new_delete_resource());
+        for (int i = 0; i < 3; i++) {
+          serial->push_status(0x01, 0x00, {});
+        }
+        std::array<hal::byte, 0x24> table{};
+        table[0x03] = 0x01;  // id
+        table[0x22] = 0xFF;  // torque_limit, cleared below by an alarm
+        table[0x23] = 0x03;
+        serial->push_status(0x01, 0x00, table);
+        dynamixel_servo servo(
+          serial, model, { .id = 0x01, .cache_control_table = true }, clock);
+        serial->written.clear();
+
+        // Exercise
+        // The servo cleared torque_limit on an alarm shutdown
+        serial->push_status(
+          0x01, 0x00, std::array<hal::byte, 2>{ 0x00, 0x00 });
+        auto const torque_limit = servo.torque_limit();
+        auto const reads_written = serial->written.size();
+        // The write to min_voltage goes unanswered
+        servo.min_voltage(9.0f);
+
+        // Verify
+        expect(that % 8U == reads_written);
+        expect(that % 0.0f == torque_limit);
+        expect(not servo.control_table_cached());
+      };
+
+    test(name +
+         "::refresh_control_table() turns caching off without a response") =
+      [&model]() {
+        // Setup
+        auto serial = hal::make_strong_ptr<fake_serial>(
+          std::pmr::new_delete_resource());
+        auto clock = hal::make_strong_ptr<fake_steady_clock>(
+          std::pmr::new_delete_resource());
+        dynamixel_servo servo(
+          serial, model, { .id = 0x01, .cache_control_table = true }, clock);
+
+        // Exercise
+        auto const refreshed = servo.refresh_control_table();
+
+        // Verify
+        expect(not refreshed);
+        expect(not servo.control_table_cached());
+      };
+
+    test(name + "::" + name + "() sends settings without fixed delays") =
+      [&model]() {
+        // Setup
+        auto serial = hal::make_strong_ptr<fake_serial>(
+          std::pmr::new_delete_resource());
+        auto clock = hal::make_strong_ptr<fake_steady_clock>(
+          std::pmr::new_delete_resource());
+        for (int i = 0; i < 3; i++) {
+          serial->push_status(0x01, 0x00, {});
+        }
+        auto const ccw_low = static_cast<hal::byte>(model.position_max & 0xFF);
+        auto const ccw_high = static_cast<hal::byte>(model.position_max >> 8);
+        auto const checksum = static_cast<hal::byte>(
+          ~(0x01 + 0x07 + 0x03 + 0x06 + ccw_low + ccw_high));
+        std::vector<hal::byte> const expected_limits{
+          0xFF, 0xFF, 0x01, 0x07, 0x03, 0x06, 0x00, 0x00, ccw_low, ccw_high,
+          checksum
+        };
+
+        // Exercise
+        dynamixel_servo servo(
+          serial,
+          model,
+          { .id = 0x01, .min_angle = 0, .max_angle = model.angle_max },
+          clock);
+
+        // Verify
+        // baud rate (8 bytes) + torque enable (8 bytes) + angle limits
+        // (11 bytes)
+        expect(that % 27U == serial->written.size());
+        expect(that % 0x18 == serial->written[13]);
+        expect(that % expected_limits ==
+               std::vector<hal::byte>(serial->written.begin() + 16,
+                                      serial->written.end()));
+        expect(that % 3000U > clock->ticks);
+      };
+
+    test(name + "::setup() configures deferred servos with sync writes") =
+      [&model]() {
+        // Setup
+        auto serial = hal::make_strong_ptr<fake_serial>(
+          std::pmr::new_delete_resource());
+        auto clock = hal::make_strong_ptr<fake_steady_clock>(
+          std::pmr::new_delete_resource());
+        dynamixel_servo first(serial,
+                              model,
+                              { .id = 0x01,
+                                .max_angle = model.angle_max,
+                                .deferred_setup = true },
+                              clock);
+        dynamixel_servo second(serial,
+                               model,
+                               { .id = 0x02,
+                                 .max_angle = model.angle_max,
+                                 .torque_enable = false,
+                                 .deferred_setup = true },
+                               clock);
+        auto const constructor_bytes = serial->written.size();
+        std::array<hal::byte, 0x24> table{};
+        table[0x08] = static_cast<hal::byte>(model.position_max & 0xFF);
+        table[0x09] = static_cast<hal::byte>(model.position_max >> 8);
+        table[0x18] = 0x01;
+        serial->push_status(0x01, 0x00, table);
+        table[0x18] = 0x00;
+        serial->push_status(0x02, 0x00, table);
+        std::array const servos{ &first, &second };
+
+        // Exercise
+        auto const confirmed = dynamixel_servo::setup(servos);
+
+        // Verify
+        expect(that % 0U == constructor_bytes);
+        expect(that % 2U == confirmed);
+        // SYNC_WRITE of the 4 byte angle limits for two servos
+        expect(that % 0x0E == serial->written[3]);
+        expect(that % 0x83 == serial->written[4]);
+        expect(that % 0x06 == serial->written[5]);
+        expect(that % 0x04 == serial->written[6]);
+      };
+  }
+};
+}  // namespace hal::actuator
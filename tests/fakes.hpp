@@ -0,0 +1,247 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <libhal/can.hpp>
+#include <libhal/error.hpp>
+#include <libhal/pwm.hpp>
+#include <libhal/rotation_sensor.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/servo.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::actuator {
+/**
+ * @brief CAN transceiver that records sent frames and can echo them back
+ *
+ * When `respond` is true, every frame sent is placed in the receive buffer
+ * with `response_offset` added to its ID, which is how RMD motors respond.
+ */
+struct fake_can_transceiver : public hal::can_transceiver
+{
+  void push(hal::can_message const& p_message)
+  {
+    buffer[cursor] = p_message;
+    cursor = (cursor + 1) % buffer.size();
+  }
+
+  std::array<hal::can_message, 32> buffer{};
+  std::size_t cursor = 0;
+  std::vector<hal::can_message> sent{};
+  hal::u32 response_offset = 0x100;
+  bool respond = true;
+  /// Sends to this ID throw hal::io_error, as on a full transmit queue
+  std::optional<hal::u32> reject_id{};
+
+private:
+  hal::u32 driver_baud_rate() override
+  {
+    return 1'000'000;
+  }
+
+  void driver_send(hal::can_message const& p_message) override
+  {
+    if (reject_id == p_message.id) {
+      hal::safe_throw(hal::io_error(this));
+    }
+    sent.push_back(p_message);
+    if (respond) {
+      auto response = p_message;
+      response.id += response_offset;
+      push(response);
+    }
+  }
+
+  std::span<hal::can_message const> driver_receive_buffer() override
+  {
+    return buffer;
+  }
+
+  std::size_t driver_receive_cursor() override
+  {
+    return cursor;
+  }
+};
+
+struct fake_can_filter : public hal::can_identifier_filter
+{
+  std::vector<std::optional<hal::u16>> allowed{};
+
+private:
+  void driver_allow(std::optional<hal::u16> p_id) override
+  {
+    allowed.push_back(p_id);
+  }
+};
+
+/**
+ * @brief 16-bit PWM channel that records every duty cycle written to it
+ */
+struct fake_pwm16_channel : public hal::pwm16_channel
+{
+  hal::u32 frequency_hz = 100;
+  std::vector<hal::u16> duty_cycles{};
+
+private:
+  hal::u32 driver_frequency() override
+  {
+    return frequency_hz;
+  }
+
+  void driver_duty_cycle(hal::u16 p_duty_cycle) override
+  {
+    duty_cycles.push_back(p_duty_cycle);
+  }
+};
+
+/**
+ * @brief PWM group manager that records every frequency set
+ */
+struct fake_pwm_group_manager : public hal::pwm_group_manager
+{
+  std::vector<hal::u32> frequencies{};
+
+private:
+  void driver_frequency(hal::u32 p_frequency) override
+  {
+    frequencies.push_back(p_frequency);
+  }
+};
+
+/**
+ * @brief Position servo that records every position commanded
+ */
+struct fake_servo : public hal::servo
+{
+  std::vector<hal::degrees> positions{};
+
+private:
+  void driver_position(hal::degrees p_position) override
+  {
+    positions.push_back(p_position);
+  }
+};
+
+/**
+ * @brief Rotation sensor that reads back `angle`
+ */
+struct fake_rotation_sensor : public hal::rotation_sensor
+{
+  hal::degrees angle = 0.0f;
+
+private:
+  read_t driver_read() override
+  {
+    return { .angle = angle };
+  }
+};
+
+/**
+ * @brief 1MHz steady clock that advances by `step` ticks every time it is read
+ */
+struct fake_steady_clock : public hal::steady_clock
+{
+  hal::u64 ticks = 0;
+  hal::u64 step = 1;
+
+private:
+  hal::hertz driver_frequency() override
+  {
+    return 1'000'000.0f;
+  }
+
+  hal::u64 driver_uptime() override
+  {
+    auto const now = ticks;
+    ticks += step;
+    return now;
+  }
+};
+
+/**
+ * @brief Serial port that records every byte written and reads back `rx`
+ */
+struct fake_serial : public hal::serial
+{
+  /**
+   * @brief Queue a Dynamixel protocol 1.0 status packet to be read back
+   */
+  void push_status(hal::byte p_id,
+                   hal::byte p_error,
+                   std::span<hal::byte const> p_parameters)
+  {
+    auto const length = static_cast<hal::byte>(p_parameters.size() + 2);
+    hal::byte sum = p_id + length + p_error;
+    rx.insert(rx.end(), { 0xFF, 0xFF, p_id, length, p_error });
+    for (auto const parameter : p_parameters) {
+      sum += parameter;
+      rx.push_back(parameter);
+    }
+    rx.push_back(static_cast<hal::byte>(~sum));
+  }
+
+  std::vector<hal::byte> written{};
+  /// Number of calls to write(), one per transfer on real hardware
+  std::size_t write_calls = 0;
+  std::vector<hal::byte> rx{};
+  std::size_t rx_position = 0;
+  /// Called with each packet written, to queue a response for it
+  std::function<void(fake_serial&, std::span<hal::byte const>)> on_write{};
+  /// Settings of the most recent call to configure()
+  settings configured{};
+
+private:
+  void driver_configure(settings const& p_settings) override
+  {
+    configured = p_settings;
+  }
+
+  write_t driver_write(std::span<hal::byte const> p_data) override
+  {
+    written.insert(written.end(), p_data.begin(), p_data.end());
+    write_calls++;
+    if (on_write) {
+      on_write(*this, p_data);
+    }
+    return { .data = p_data };
+  }
+
+  read_t driver_read(std::span<hal::byte> p_data) override
+  {
+    std::size_t count = 0;
+    while (count < p_data.size() && rx_position < rx.size()) {
+      p_data[count++] = rx[rx_position++];
+    }
+    return {
+      .data = p_data.first(count),
+      .available = rx.size() - rx_position,
+      .capacity = rx.size(),
+    };
+  }
+
+  void driver_flush() override
+  {
+    rx.clear();
+    rx_position = 0;
+  }
+};
+}  // namespace hal::actuator
@@ -14,8 +14,17 @@
 
 #include <libhal-actuator/mx_64.hpp>
 
+#include <array>
+#include <cmath>
+#include <memory_resource>
+#include <vector>
+
+#include <libhal/error.hpp>
+
 #include <boost/ut.hpp>
 
+#include "fakes.hpp"
+
 namespace hal::actuator {
 boost::ut::suite<"test_mx_64"> test_mx_64 = [] {
   using namespace boost::ut;
@@ -23,5 +32,147 @@ boost::ut::suite<"test_mx_64"> test_mx_64 = [] {
   using namespace hal::literals;
 
   "hal::actuator::mx_64()"_test = []() {};
+
+  "mx_64::read_telemetry(servos) uses one BULK_READ"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    mx_64 first(serial, { .id = 0x01 }, clock);
+    mx_64 second(serial, { .id = 0x02 }, clock);
+    mx_64 third(serial, { .id = 0x03 }, clock);
+    std::array const servos{ &first, &second, &third };
+    serial->written.clear();
+    std::array<hal::byte, 8> const block{ 0, 0, 0, 0, 0, 0, 120, 40 };
+    serial->push_status(0x01, 0x00, block);
+    serial->push_status(0x02, 0x00, block);
+    // FF FF FE LEN 0x92 0x00 [LEN ID ADDR]... CHK
+    std::vector<hal::byte> const expected_request{
+      0xFF, 0xFF, 0xFE, 0x0C, 0x92, 0x00, 0x08, 0x01, 0x24,
+      0x08, 0x02, 0x24, 0x08, 0x03, 0x24, 0xD9
+    };
+
+    // Exercise
+    auto const updated = mx_64::read_telemetry(servos);
+
+    // Verify
+    expect(that % expected_request == serial->written);
+    expect(that % 2U == updated);
+    expect(that % 40 == first.last_telemetry().temperature);
+    expect(that % 40 == second.last_telemetry().temperature);
+    expect(that % 0 == third.last_telemetry().temperature);
+  };
+  "mx_64::extended_position() counts turns across wraps"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    mx_64 servo(serial, { .id = 0x01, .deferred_setup = true }, clock);
+    std::vector<hal::i16> positions{ 28000, -28000, 28000, 0, -5000 };
+    hal::usize next = 0;
+    serial->on_write = [&](fake_serial& p_self,
+                           std::span<hal::byte const> p_packet) {
+      // FF FF ID LEN INSTRUCTION: answer reads with the next position
+      if (p_packet[4] != 0x02) {
+        p_self.push_status(0x01, 0x00, {});
+        return;
+      }
+      auto const raw = static_cast<hal::u16>(positions[next++]);
+      std::array<hal::byte, 2> const position{
+        static_cast<hal::byte>(raw), static_cast<hal::byte>(raw >> 8)
+      };
+      p_self.push_status(0x01, 0x00, position);
+    };
+
+    // Exercise
+    servo.extended_position_mode({});
+    auto const wrapped = servo.extended_position();
+    auto const wrapped_turns = servo.turns();
+    (void)servo.extended_position();
+    auto const unwrapped_turns = servo.turns();
+    (void)servo.extended_position();
+    (void)servo.extended_position();
+    auto const back_turns = servo.turns();
+
+    // Verify
+    // 57344 - 28000 steps of 360 / 4096 degrees
+    expect(std::abs(2579.06f - wrapped) < 0.01f);
+    expect(that % 7 == wrapped_turns);
+    expect(that % 6 == unwrapped_turns);
+    // -5000 steps rounds down to -2 turns
+    expect(that % -2 == back_turns);
+    // Offset and divider, then both limits set to 4095
+    expect(that % 0x14 == serial->written[5]);
+    expect(that % 0x06 == serial->written[5 + 10]);
+    expect(that % 0xFF == serial->written[6 + 10]);
+    expect(that % 0x0F == serial->written[7 + 10]);
+  };
+
+  "mx_64::extended_position_mode() rejects a bad divider"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    mx_64 servo(serial, { .id = 0x01, .deferred_setup = true }, clock);
+
+    // Exercise + Verify
+    expect(throws<hal::argument_out_of_domain>(
+      [&] { servo.extended_position_mode({ .resolution_divider = 5 }); }));
+    expect(that % 0U == serial->written.size());
+  };
+
+  "mx_64::goal_acceleration() and goal_torque() encode the goal"_test =
+    []() {
+      // Setup
+      auto serial = hal::make_strong_ptr<fake_serial>(
+        std::pmr::new_delete_resource());
+      auto clock = hal::make_strong_ptr<fake_steady_clock>(
+        std::pmr::new_delete_resource());
+      mx_64 servo(serial, { .id = 0x01, .deferred_setup = true }, clock);
+      serial->on_write = [](fake_serial& p_self, std::span<hal::byte const>) {
+        p_self.push_status(0x01, 0x00, {});
+      };
+
+      // Exercise
+      servo.goal_acceleration(85.83f);
+      auto const acceleration = serial->written;
+      serial->written.clear();
+      servo.goal_acceleration(10'000.0f);
+      auto const clamped = serial->written;
+      serial->written.clear();
+      servo.goal_torque(-0.45f);
+      auto const torque = serial->written;
+
+      // Verify
+      // FF FF ID LEN WRITE ADDR DATA... CHK
+      expect(that % 0x49 == acceleration[5]);
+      expect(that % 10 == acceleration[6]);
+      expect(that % 254 == clamped[6]);
+      expect(that % 0x47 == torque[5]);
+      expect(that % 100 == torque[6]);
+      expect(that % 0x04 == torque[7]);
+    };
+
+  "mx_64::current() is signed around 2048"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    mx_64 servo(serial, { .id = 0x01, .deferred_setup = true }, clock);
+    // 1948 = 2048 - 100
+    std::array<hal::byte, 2> const current{ 0x9C, 0x07 };
+    serial->push_status(0x01, 0x00, current);
+
+    // Exercise
+    auto const amperes = servo.current();
+
+    // Verify
+    expect(that % 0x44 == serial->written[5]);
+    expect(std::abs(-0.45f - amperes) < 0.001f);
+  };
 };
 }  // namespace hal::actuator
@@ -14,11 +14,15 @@
 
 #include <libhal-actuator/rc_servo.hpp>
 
+#include <cmath>
+
 #include <libhal-mock/pwm.hpp>
 #include <libhal-mock/testing.hpp>
 
 #include <boost/ut.hpp>
 
+#include "fakes.hpp"
+
 namespace hal::actuator {
 boost::ut::suite test_rc_servo = [] {
   using namespace boost::ut;
@@ -155,5 +159,133 @@ boost::ut::suite test_rc_servo = [] {
     expect(throws<hal::argument_out_of_domain>(
       [&]() { test.position(max_angle + 45.0f); }));
   };
+
+  "hal::actuator::static_rc_servo::position"_test = []() {
+    // Setup
+    using servo_t = static_rc_servo<{
+      .frequency = 100,
+      .min_angle = -90,
+      .max_angle = 90,
+      .min_microseconds = 500,
+      .max_microseconds = 2500,
+    }>;
+    constexpr auto min_duty_cycle = servo_t::duty_cycle(-90.0f);
+    static_assert(0.05f - 1e-6f < min_duty_cycle &&
+                  min_duty_cycle < 0.05f + 1e-6f);
+    hal::mock::pwm pwm;
+    servo_t servo(pwm);
+
+    // Exercise
+    servo.position(-90.0f);
+    servo.position(0.0f);
+    servo.position(90.0f);
+
+    // Verify
+    auto const& frequencies = pwm.spy_frequency.call_history();
+    auto const& duty_cycles = pwm.spy_duty_cycle.call_history();
+    expect(that % 100.0f == std::get<0>(frequencies.at(0)));
+    expect(std::abs(0.05f - std::get<0>(duty_cycles.at(0))) < 1e-6f);
+    expect(std::abs(0.15f - std::get<0>(duty_cycles.at(1))) < 1e-6f);
+    expect(std::abs(0.25f - std::get<0>(duty_cycles.at(2))) < 1e-6f);
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { servo.position(90.5f); }));
+  };
+
+  "hal::actuator::rc_servo16::position"_test = []() {
+    // Setup
+    // 100Hz: 500us is 5% and 2500us is 25% of 65535, truncated
+    auto pwm = hal::make_strong_ptr<fake_pwm16_channel>(
+      std::pmr::new_delete_resource());
+    rc_servo16 servo(pwm,
+                     {
+                       .min_angle = -90,
+                       .max_angle = 90,
+                       .min_microseconds = 500,
+                       .max_microseconds = 2500,
+                     });
+
+    // Exercise
+    servo.position(-90.0f);
+    servo.position(-45.0f);
+    servo.position(90.0f);
+
+    // Verify
+    expect(that % 3U == pwm->duty_cycles.size());
+    expect(that % 3276 == pwm->duty_cycles[0]);
+    expect(that % 6553 == pwm->duty_cycles[1]);
+    expect(that % 16383 == pwm->duty_cycles[2]);
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { servo.position(90.5f); }));
+  };
+
+  "hal::actuator::rc_servo16::position reversed"_test = []() {
+    // Setup
+    auto pwm = hal::make_strong_ptr<fake_pwm16_channel>(
+      std::pmr::new_delete_resource());
+    rc_servo16 servo(pwm,
+                     {
+                       .min_angle = 0,
+                       .max_angle = 180,
+                       .min_microseconds = 2500,
+                       .max_microseconds = 500,
+                     });
+
+    // Exercise
+    servo.position(0.0f);
+    servo.position(180.0f);
+
+    // Verify
+    expect(that % 16383 == pwm->duty_cycles[0]);
+    expect(that % 3276 == pwm->duty_cycles[1]);
+  };
+
+  "hal::actuator::rc_servo16::pulse_width"_test = []() {
+    // Setup
+    using std::chrono::microseconds;
+    auto pwm = hal::make_strong_ptr<fake_pwm16_channel>(
+      std::pmr::new_delete_resource());
+    rc_servo16 servo(pwm,
+                     {
+                       .min_microseconds = 500,
+                       .max_microseconds = 2500,
+                     });
+
+    // Exercise
+    servo.pulse_width(microseconds(500));
+    servo.pulse_width(microseconds(1500));
+    servo.pulse_width(microseconds(2500));
+
+    // Verify
+    expect(that % 3U == pwm->duty_cycles.size());
+    expect(that % 3276 == pwm->duty_cycles[0]);
+    expect(that % 9830 == pwm->duty_cycles[1]);
+    expect(that % 16383 == pwm->duty_cycles[2]);
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { servo.pulse_width(microseconds(499)); }));
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { servo.pulse_width(microseconds(2501)); }));
+  };
+
+  "hal::actuator::rc_servo16::raw_duty_cycle"_test = []() {
+    // Setup
+    auto pwm = hal::make_strong_ptr<fake_pwm16_channel>(
+      std::pmr::new_delete_resource());
+    rc_servo16 servo(pwm,
+                     {
+                       .min_microseconds = 500,
+                       .max_microseconds = 2500,
+                     });
+
+    // Exercise
+    servo.raw_duty_cycle(5000);
+
+    // Verify
+    expect(that % 1U == pwm->duty_cycles.size());
+    expect(that % 5000 == pwm->duty_cycles[0]);
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { servo.raw_duty_cycle(3275); }));
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { servo.raw_duty_cycle(16384); }));
+  };
 };
 }  // namespace hal::actuator
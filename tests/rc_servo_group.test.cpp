@@ -0,0 +1,157 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/rc_servo_group.hpp>
+
+#include <memory_resource>
+
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "fakes.hpp"
+
+namespace hal::actuator {
+boost::ut::suite<"test_rc_servo_group"> test_rc_servo_group = [] {
+  using namespace boost::ut;
+  using std::chrono::microseconds;
+
+  struct group_fixture
+  {
+    hal::strong_ptr<fake_pwm16_channel> first =
+      hal::make_strong_ptr<fake_pwm16_channel>(std::pmr::new_delete_resource());
+    hal::strong_ptr<fake_pwm16_channel> second =
+      hal::make_strong_ptr<fake_pwm16_channel>(std::pmr::new_delete_resource());
+    // At the fakes' 100Hz, 500us is a duty cycle of 3276 and 2500us of 16383
+    std::array<rc_servo16::settings, 2> settings{
+      rc_servo16::settings{
+        .min_angle = -90,
+        .max_angle = 90,
+        .min_microseconds = 500,
+        .max_microseconds = 2500,
+      },
+      rc_servo16::settings{
+        .min_angle = 0,
+        .max_angle = 180,
+        .min_microseconds = 2500,
+        .max_microseconds = 500,
+      },
+    };
+    rc_servo_group<2>::channels channels{ first, second };
+  };
+
+  "hal::actuator::rc_servo_group::rc_servo_group()"_test = []() {
+    // Setup
+    group_fixture fixture;
+    fake_pwm_group_manager manager;
+
+    // Exercise
+    rc_servo_group<2> group(manager, 100, fixture.channels, fixture.settings);
+
+    // Verify
+    expect(that % 1U == manager.frequencies.size());
+    expect(that % 100U == manager.frequencies[0]);
+    expect(fixture.first->duty_cycles.empty());
+  };
+
+  "hal::actuator::rc_servo_group::position()"_test = []() {
+    // Setup
+    group_fixture fixture;
+    rc_servo_group<2> group(fixture.channels, fixture.settings);
+    std::array<hal::degrees, 2> const frame{ -45.0f, 180.0f };
+
+    // Exercise
+    group.position(frame);
+
+    // Verify
+    expect(that % 1U == fixture.first->duty_cycles.size());
+    expect(that % 1U == fixture.second->duty_cycles.size());
+    expect(that % 6553 == fixture.first->duty_cycles[0]);
+    expect(that % 3276 == fixture.second->duty_cycles[0]);
+    expect(that % 6553 == group.frame()[0]);
+    expect(that % 3276 == group.frame()[1]);
+  };
+
+  "hal::actuator::rc_servo_group::position() matches rc_servo16"_test = []() {
+    // Setup
+    group_fixture fixture;
+    rc_servo_group<2> group(fixture.channels, fixture.settings);
+    auto single_pwm =
+      hal::make_strong_ptr<fake_pwm16_channel>(std::pmr::new_delete_resource());
+    rc_servo16 single(single_pwm, fixture.settings[0]);
+
+    // Exercise
+    for (auto angle = -90.0f; angle <= 90.0f; angle += 7.5f) {
+      std::array<hal::degrees, 2> const frame{ angle, 0.0f };
+      group.position(frame);
+      single.position(angle);
+    }
+
+    // Verify
+    expect(fixture.first->duty_cycles == single_pwm->duty_cycles);
+  };
+
+  "hal::actuator::rc_servo_group::position() bad frame"_test = []() {
+    // Setup
+    group_fixture fixture;
+    rc_servo_group<2> group(fixture.channels, fixture.settings);
+    std::array<hal::degrees, 2> const frame{ 0.0f, -1.0f };
+
+    // Exercise + Verify
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { group.position(frame); }));
+    expect(fixture.first->duty_cycles.empty());
+    expect(fixture.second->duty_cycles.empty());
+  };
+
+  "hal::actuator::rc_servo_group::pulse_width()"_test = []() {
+    // Setup
+    group_fixture fixture;
+    rc_servo_group<2> group(fixture.channels, fixture.settings);
+    std::array const frame{ microseconds(1500), microseconds(2500) };
+    std::array const bad_frame{ microseconds(2000), microseconds(2501) };
+
+    // Exercise
+    group.pulse_width(frame);
+
+    // Verify
+    expect(that % 9830 == fixture.first->duty_cycles[0]);
+    expect(that % 16383 == fixture.second->duty_cycles[0]);
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { group.pulse_width(bad_frame); }));
+    expect(that % 1U == fixture.first->duty_cycles.size());
+    // The channel checked before the bad one keeps its previous duty cycle
+    expect(that % 9830 == group.frame()[0]);
+    expect(that % 16383 == group.frame()[1]);
+  };
+
+  "hal::actuator::rc_servo_group::raw_duty_cycle()"_test = []() {
+    // Setup
+    group_fixture fixture;
+    rc_servo_group<2> group(fixture.channels, fixture.settings);
+    std::array<hal::u16, 2> const frame{ 4000, 16000 };
+    std::array<hal::u16, 2> const bad_frame{ 3000, 16000 };
+
+    // Exercise
+    group.raw_duty_cycle(frame);
+
+    // Verify
+    expect(that % 4000 == fixture.first->duty_cycles[0]);
+    expect(that % 16000 == fixture.second->duty_cycles[0]);
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { group.raw_duty_cycle(bad_frame); }));
+    expect(that % 1U == fixture.first->duty_cycles.size());
+  };
+};
+}  // namespace hal::actuator
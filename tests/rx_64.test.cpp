@@ -14,8 +14,13 @@
 
 #include <libhal-actuator/rx_64.hpp>
 
+#include <array>
+#include <memory_resource>
+
 #include <boost/ut.hpp>
 
+#include "fakes.hpp"
+
 namespace hal::actuator {
 boost::ut::suite<"test_rx_64"> test_rx_64 = [] {
   using namespace boost::ut;
@@ -23,5 +28,27 @@ boost::ut::suite<"test_rx_64"> test_rx_64 = [] {
   using namespace hal::literals;
 
   "hal::actuator::rx_64()"_test = []() {};
+
+  "rx_64::read_telemetry(servos) reads every servo"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    rx_64 first(serial, { .id = 0x01 }, clock);
+    rx_64 second(serial, { .id = 0x02 }, clock);
+    std::array const servos{ &first, &second };
+    std::array<hal::byte, 8> const block{ 0, 0, 0, 0, 0, 0, 120, 40 };
+    serial->push_status(0x01, 0x00, block);
+    serial->push_status(0x02, 0x00, block);
+
+    // Exercise
+    auto const updated = rx_64::read_telemetry(servos);
+
+    // Verify
+    expect(that % 2U == updated);
+    expect(that % 40 == first.last_telemetry().temperature);
+    expect(that % 40 == second.last_telemetry().temperature);
+  };
 };
 }  // namespace hal::actuator
@@ -0,0 +1,81 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/smart_servo/rmd/can_dispatcher.hpp>
+#include <libhal-actuator/smart_servo/rmd/mc_x_v2.hpp>
+
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "../../fakes.hpp"
+
+namespace hal::actuator {
+boost::ut::suite<"test_rmd_can_dispatcher"> test_rmd_can_dispatcher = [] {
+  using namespace boost::ut;
+  using namespace std::literals;
+  using namespace hal::literals;
+
+  "hal::actuator::rmd_can_dispatcher::poll()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    rmd_can_dispatcher dispatcher(can, filter);
+    unsigned first_count = 0;
+    unsigned second_count = 0;
+    dispatcher.attach(0x241, [&](hal::can_message const&) { first_count++; });
+    dispatcher.attach(0x148, [&](hal::can_message const&) { second_count++; });
+
+    // Exercise
+    can.push({ .id = 0x241, .length = 8 });
+    can.push({ .id = 0x148, .length = 8 });
+    can.push({ .id = 0x241, .length = 8 });
+    can.push({ .id = 0x500, .length = 8 });
+    dispatcher.poll();
+    dispatcher.poll();
+
+    // Verify
+    expect(that % 2U == first_count);
+    expect(that % 1U == second_count);
+    expect(that % 2U == filter.allowed.size());
+    expect(throws<hal::device_or_resource_busy>(
+      [&]() { dispatcher.attach(0x141, [](hal::can_message const&) {}); }));
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { dispatcher.attach(0x170, [](hal::can_message const&) {}); }));
+  };
+
+  "hal::actuator::rmd_can_dispatcher with rmd_mc_x_v2"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    rmd_can_dispatcher dispatcher(can, filter);
+    fake_steady_clock clock;
+
+    // Exercise
+    {
+      rmd_mc_x_v2 first(dispatcher, clock, 36.0f, 0x141);
+      rmd_mc_x_v2 second(dispatcher, clock, 36.0f, 0x142);
+      first.velocity_control(10.0_rpm);
+      second.velocity_control(10.0_rpm);
+
+      // Verify
+      expect(that % 2U == first.feedback().message_number);
+      expect(that % 2U == second.feedback().message_number);
+    }
+    // Drivers detach on destruction, so the ID can be reused
+    rmd_mc_x_v2 reused(dispatcher, clock, 36.0f, 0x141);
+    expect(that % 1U == reused.feedback().message_number);
+  };
+};
+}  // namespace hal::actuator
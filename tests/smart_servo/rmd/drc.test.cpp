@@ -14,14 +14,178 @@
 
 #include <libhal-actuator/smart_servo/rmd/drc_v2.hpp>
 
+#include <cmath>
+
 #include <boost/ut.hpp>
 
+#include "../../fakes.hpp"
+
 namespace hal::actuator {
 boost::ut::suite<"test_rmd_drc_v2"> test_rmd_drc_v2 = [] {
   using namespace boost::ut;
   using namespace std::literals;
   using namespace hal::literals;
 
-  "hal::actuator::rmd_drc::rmd_drc()"_test = []() {};
+  "hal::actuator::rmd_drc::rmd_drc()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    // DRC motors respond with the ID they were sent to
+    can.response_offset = 0;
+
+    // Exercise
+    rmd_drc_v2 drc(can, filter, clock, 6.0f, 0x141);
+
+    // Verify
+    expect(that % 2U == can.sent.size());
+    expect(that % 0x80 == can.sent[0].payload[0]);
+    expect(that % 0x88 == can.sent[1].payload[0]);
+    expect(that % 0x141 == filter.allowed.back().value());
+    expect(that % 2U == drc.feedback().message_number);
+  };
+
+  "hal::actuator::rmd_drc::feedback() negative multi-turn angle"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      can.response_offset = 0;
+      rmd_drc_v2 drc(can, filter, clock, 6.0f, 0x141);
+      can.respond = false;
+
+      // Exercise
+      drc.feedback_request_async(rmd_drc_v2::read::multi_turns_angle);
+      auto response = can.sent.back();
+      // -36000 (-360.00 degrees) in the 7 bytes after the command
+      response.payload = { 0x92, 0x60, 0x73, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+      can.push(response);
+      auto const status = drc.poll();
+
+      // Verify
+      expect(rmd_drc_v2::request_status::complete == status);
+      expect(that % -36000 == drc.feedback().raw_multi_turn_angle);
+      expect(that % -360.0f == drc.feedback().angle());
+    };
+
+  "hal::actuator::rmd_drc::feedback() status_1 scales"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    can.response_offset = 0;
+    rmd_drc_v2 drc(can, filter, clock, 6.0f, 0x141);
+    can.respond = false;
+
+    // Exercise
+    drc.feedback_request_async(rmd_drc_v2::read::status_1_and_error_flags);
+    auto response = can.sent.back();
+    // 50C, 24.0V and the over voltage flag
+    response.payload = { 0x9A, 0x32, 0x00, 0xF0, 0x00, 0x00, 0x00, 0x01 };
+    can.push(response);
+    auto const status = drc.poll();
+
+    // Verify
+    auto const& feedback = drc.feedback();
+    expect(rmd_drc_v2::request_status::complete == status);
+    expect(that % 50 == feedback.raw_motor_temperature);
+    expect(that % 50.0f == feedback.temperature());
+    expect(that % 240 == feedback.raw_volts);
+    expect(std::abs(feedback.volts() - 24.0f) < 0.001f);
+    expect(feedback.over_voltage_protection_tripped());
+    expect(not feedback.over_temperature_protection_tripped());
+    // Only the status_1 group, and the temperature it carries, is updated
+    expect(that % 0U != feedback.updated.status_1);
+    expect(that % feedback.updated.status_1 ==
+           feedback.updated.motor_temperature());
+    expect(that % 0U == feedback.updated.multi_turn_angle);
+  };
+
+  "hal::actuator::rmd_drc::feedback() status_2 scales"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    can.response_offset = 0;
+    rmd_drc_v2 drc(can, filter, clock, 6.0f, 0x141);
+    can.respond = false;
+
+    // Exercise
+    drc.feedback_request_async(rmd_drc_v2::read::status_2);
+    auto response = can.sent.back();
+    // 30C, 1024 (16.5A), -120dps and encoder count 0x1234
+    response.payload = { 0x9C, 0x1E, 0x00, 0x04, 0x88, 0xFF, 0x34, 0x12 };
+    can.push(response);
+    auto const status = drc.poll();
+
+    // Verify
+    auto const& feedback = drc.feedback();
+    expect(rmd_drc_v2::request_status::complete == status);
+    expect(that % 30.0f == feedback.temperature());
+    expect(that % 1024 == feedback.raw_current);
+    expect(std::abs(feedback.current() - 16.5f) < 0.001f);
+    expect(that % -120 == feedback.raw_speed);
+    // 120dps is 20rpm
+    expect(std::abs(feedback.speed() + 20.0f) < 0.001f);
+    expect(that % 0x1234 == feedback.encoder);
+  };
+
+  "hal::actuator::rmd_drc::emergency_stop()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    can.response_offset = 0;
+    rmd_drc_v2 first(can, filter, clock, 6.0f, 0x141);
+    rmd_drc_v2 second(can, filter, clock, 6.0f, 0x142);
+    rmd_drc_v2 third(can, filter, clock, 6.0f, 0x143);
+    std::array const motors{ &first, &second, &third };
+    can.sent.clear();
+    can.respond = false;
+    can.reject_id = 0x142;
+
+    // Exercise
+    auto const sent = rmd_drc_v2::emergency_stop(motors);
+
+    // Verify
+    // The failed send of the second motor does not stop the third
+    expect(that % 2U == sent);
+    expect(that % 2U == can.sent.size());
+    expect(that % 0x141U == can.sent[0].id);
+    expect(that % 0x143U == can.sent[1].id);
+    expect(that % 0x81 == can.sent[0].payload[0]);
+    expect(that % 0x81 == can.sent[1].payload[0]);
+    expect(rmd_drc_v2::request_status::pending == third.poll());
+  };
+
+  "hal::actuator::rmd_drc::emergency_stop() cancels motion"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    can.response_offset = 0;
+    rmd_drc_v2 drc(can, filter, clock, 6.0f, 0x141);
+    drc.retry({ .attempts = 2, .throw_on_failure = false });
+    std::array const motors{ &drc };
+    can.respond = false;
+    drc.position_control_async(90.0f, 10.0_rpm);
+    can.sent.clear();
+
+    // Exercise
+    (void)rmd_drc_v2::emergency_stop(motors);
+    clock.ticks += 1'000'000;
+    can.respond = true;
+    auto const after_timeout = drc.poll();
+    auto const after_resend = drc.poll();
+
+    // Verify
+    // The stop is sent again, the position command is not
+    expect(rmd_drc_v2::request_status::pending == after_timeout);
+    expect(rmd_drc_v2::request_status::complete == after_resend);
+    expect(that % 2U == can.sent.size());
+    expect(that % 0x81 == can.sent[0].payload[0]);
+    expect(that % 0x81 == can.sent[1].payload[0]);
+  };
 };
 }  // namespace hal::actuator
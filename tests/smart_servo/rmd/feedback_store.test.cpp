@@ -0,0 +1,84 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/smart_servo/rmd/feedback_store.hpp>
+#include <libhal-actuator/smart_servo/rmd/mc_x_v2.hpp>
+
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "../../fakes.hpp"
+
+namespace hal::actuator {
+boost::ut::suite<"test_rmd_feedback_store"> test_rmd_feedback_store = [] {
+  using namespace boost::ut;
+  using namespace std::literals;
+
+  "hal::actuator::rmd_feedback_store::record()"_test = []() {
+    // Setup
+    rmd_feedback_store<2> store;
+    rmd_field_scales scales{};
+    scales.fill(0.5f);
+    rmd_response response{};
+    response.values[static_cast<hal::u8>(rmd_field::current)] = -10;
+    response.values[static_cast<hal::u8>(rmd_field::error_state)] = 0x1000;
+    response.present = (1U << static_cast<hal::u8>(rmd_field::current)) |
+                       (1U << static_cast<hal::u8>(rmd_field::error_state));
+    response.received_at = 42;
+
+    // Exercise
+    store.record(1, response, scales);
+
+    // Verify
+    expect(that % 2U == store.size());
+    expect(that % 0.0f == store.current()[0]);
+    expect(that % -5.0f == store.current()[1]);
+    expect(that % 0x1000 == store.error_state()[1]);
+    expect(that % 0.0f == store.speed()[1]);
+    expect(that % 0U == store.message_number()[0]);
+    expect(that % 1U == store.message_number()[1]);
+    expect(that % 42U == store.updated()[1]);
+  };
+
+  "hal::actuator::rmd_mc_x_v2::mirror_feedback()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 first(can, filter, clock, 36.0f, 0x141);
+    rmd_mc_x_v2 second(can, filter, clock, 36.0f, 0x142);
+    rmd_feedback_store<2> store;
+
+    // Exercise
+    first.mirror_feedback(&store, 0);
+    second.mirror_feedback(&store, 1);
+    second.handle_message({
+      .id = 0x242,
+      .length = 8,
+      .payload = { 0x9C, 30, 0x64, 0x00, 0x06, 0x00, 0x00, 0x00 },
+    });
+
+    // Verify
+    expect(that % 0U == store.message_number()[0]);
+    expect(that % 1U == store.message_number()[1]);
+    expect(that % 30.0f == store.temperature()[1]);
+    expect(that % 1.0f == store.current()[1]);
+    expect(that % second.feedback().speed() == store.speed()[1]);
+    expect(that % second.feedback().current() == store.current()[1]);
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { first.mirror_feedback(&store, 2); }));
+  };
+};
+}  // namespace hal::actuator
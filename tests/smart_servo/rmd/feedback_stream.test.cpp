@@ -0,0 +1,171 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/smart_servo/rmd/feedback_stream.hpp>
+
+#include <array>
+
+#include <libhal-actuator/smart_servo/rmd/drc_v2.hpp>
+#include <libhal-actuator/smart_servo/rmd/mc_x_v2.hpp>
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "../../fakes.hpp"
+
+namespace hal::actuator {
+boost::ut::suite<"test_rmd_feedback_stream"> test_rmd_feedback_stream = [] {
+  using namespace boost::ut;
+  using namespace std::literals;
+  using namespace hal::literals;
+
+  "hal::actuator::rmd_feedback_stream::service() rotates requests"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+      rmd_feedback_stream stream(mc_x, clock, 1ms);
+      can.sent.clear();
+
+      // Exercise
+      for (int i = 0; i < 4; i++) {
+        (void)stream.service();
+        clock.ticks += 1'000;
+      }
+
+      // Verify
+      expect(that % 4U == can.sent.size());
+      expect(that % 0x9C == can.sent[0].payload[0]);
+      expect(that % 0x92 == can.sent[1].payload[0]);
+      expect(that % 0x9A == can.sent[2].payload[0]);
+      expect(that % 0x9C == can.sent[3].payload[0]);
+    };
+
+  "hal::actuator::rmd_feedback_stream::service() waits for the period"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      can.response_offset = 0;
+      rmd_drc_v2 drc(can, filter, clock, 36.0f, 0x141);
+      rmd_feedback_stream stream(drc, clock, 1ms);
+      can.sent.clear();
+
+      // Exercise
+      (void)stream.service();
+      (void)stream.service();
+      auto const sent_within_period = can.sent.size();
+      clock.ticks += 1'000;
+      (void)stream.service();
+
+      // Verify
+      expect(that % 1U == sent_within_period);
+      expect(that % 2U == can.sent.size());
+    };
+
+  "hal::actuator::rmd_feedback_stream::service() yields to requests"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+      rmd_feedback_stream stream(mc_x, clock, 0ms);
+      can.respond = false;
+      can.sent.clear();
+
+      // Exercise
+      mc_x.velocity_control_async(10.0_rpm);
+      auto const status = stream.service();
+
+      // Verify
+      expect(rmd_mc_x_v2::request_status::pending == status);
+      expect(that % 1U == can.sent.size());
+    };
+
+  "hal::actuator::rmd_feedback_stream serves the sensor adaptors"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      can.response_offset = 0;
+      rmd_drc_v2 drc(can, filter, clock, 36.0f, 0x141);
+      auto rotation = drc.acquire_rotation_sensor();
+      std::array const requests{ rmd_drc_v2::read::multi_turns_angle };
+
+      // Exercise
+      std::size_t sent_while_streamed = 0;
+      {
+        rmd_feedback_stream stream(drc, clock, 1ms, requests);
+        (void)stream.service();
+        (void)drc.poll();
+        can.sent.clear();
+        (void)rotation.read();
+        sent_while_streamed = can.sent.size();
+      }
+      (void)rotation.read();
+
+      // Verify
+      expect(that % 0U == sent_while_streamed);
+      expect(that % 1U == can.sent.size());
+    };
+
+  "hal::actuator::rmd_feedback_stream falls back when starved"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    can.response_offset = 0;
+    rmd_drc_v2 drc(can, filter, clock, 36.0f, 0x141);
+    auto rotation = drc.acquire_rotation_sensor();
+    std::array const requests{ rmd_drc_v2::read::multi_turns_angle };
+    rmd_feedback_stream stream(drc, clock, 1ms, requests);
+    (void)stream.service();
+    (void)drc.poll();
+
+    // Exercise
+    // A command is outstanding at every service() for two rotations
+    clock.ticks += 3'000;
+    can.respond = false;
+    drc.velocity_control_async(10.0_rpm);
+    auto const starved = stream.service();
+    can.push(can.sent.back());
+    can.respond = true;
+    can.sent.clear();
+    (void)rotation.read();
+
+    // Verify
+    expect(rmd_drc_v2::request_status::pending == starved);
+    expect(that % 1U == can.sent.size());
+    expect(that % 0x92 == can.sent[0].payload[0]);
+  };
+
+  "hal::actuator::rmd_feedback_stream rejects a second stream"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    rmd_feedback_stream stream(mc_x, clock, 1ms);
+
+    // Exercise + Verify
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { rmd_feedback_stream second(mc_x, clock, 1ms); }));
+  };
+};
+}  // namespace hal::actuator
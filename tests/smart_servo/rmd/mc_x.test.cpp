@@ -14,14 +14,520 @@
 
 #include <libhal-actuator/smart_servo/rmd/mc_x_v2.hpp>
 
+#include <cmath>
+
+#include <libhal/error.hpp>
+
 #include <boost/ut.hpp>
 
+#include "../../fakes.hpp"
+
 namespace hal::actuator {
 boost::ut::suite<"test_rmd_mc_x"> test_rmd_mc_x_v2 = [] {
   using namespace boost::ut;
   using namespace std::literals;
   using namespace hal::literals;
 
-  "hal::actuator::rmd_mc_x::rmd_mc_x()"_test = []() {};
+  "hal::actuator::rmd_mc_x::rmd_mc_x()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+
+    // Exercise
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+
+    // Verify
+    expect(that % 1U == can.sent.size());
+    expect(that % 0x141U == can.sent[0].id);
+    expect(that % 0x241 == filter.allowed.back().value());
+    expect(that % 1U == mc_x.feedback().message_number);
+  };
+
+  "hal::actuator::rmd_mc_x::velocity_control_async()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    can.respond = false;
+
+    // Exercise
+    mc_x.velocity_control_async(10.0_rpm);
+    auto const before_response = mc_x.poll();
+    auto response = can.sent.back();
+    response.id += 0x100;
+    response.payload[4] = 0x05;
+    response.payload[5] = 0x00;
+    can.push(response);
+    auto const after_response = mc_x.poll();
+
+    // Verify
+    expect(rmd_mc_x_v2::request_status::pending == before_response);
+    expect(rmd_mc_x_v2::request_status::complete == after_response);
+    expect(that % 5 == mc_x.feedback().raw_speed);
+  };
+
+  "hal::actuator::rmd_mc_x::group_velocity_control()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 first(can, filter, clock, 36.0f, 0x141);
+    rmd_mc_x_v2 second(can, filter, clock, 36.0f, 0x142);
+    std::array const setpoints{
+      rmd_mc_x_v2::velocity_setpoint{ .motor = &first, .speed = 10.0_rpm },
+      rmd_mc_x_v2::velocity_setpoint{ .motor = &second, .speed = -10.0_rpm },
+    };
+    can.sent.clear();
+
+    // Exercise
+    rmd_mc_x_v2::group_velocity_control(setpoints);
+
+    // Verify
+    expect(that % 2U == can.sent.size());
+    expect(that % 0x141U == can.sent[0].id);
+    expect(that % 0x142U == can.sent[1].id);
+    expect(that % 2U == first.feedback().message_number);
+    expect(that % 2U == second.feedback().message_number);
+  };
+
+  "hal::actuator::rmd_mc_x::emergency_stop()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 first(can, filter, clock, 36.0f, 0x141);
+    rmd_mc_x_v2 second(can, filter, clock, 36.0f, 0x142);
+    rmd_mc_x_v2 third(can, filter, clock, 36.0f, 0x143);
+    std::array const motors{ &first, &second, &third };
+    can.sent.clear();
+    can.respond = false;
+    can.reject_id = 0x141;
+
+    // Exercise
+    auto const sent = rmd_mc_x_v2::emergency_stop(motors);
+    auto const before_response = third.poll();
+
+    // Verify
+    // The failed send of the first motor does not stop the others
+    expect(that % 2U == sent);
+    expect(that % 2U == can.sent.size());
+    expect(that % 0x142U == can.sent[0].id);
+    expect(that % 0x143U == can.sent[1].id);
+    expect(that % 0x81 == can.sent[0].payload[0]);
+    expect(that % 0x81 == can.sent[1].payload[0]);
+    expect(rmd_mc_x_v2::request_status::pending == before_response);
+    expect(std::chrono::microseconds(405) == rmd_wire_time(3, 1'000'000));
+  };
+
+  "hal::actuator::rmd_mc_x::emergency_stop() cancels motion"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    mc_x.retry({ .attempts = 3, .throw_on_failure = false });
+    std::array const motors{ &mc_x };
+    can.respond = false;
+    mc_x.velocity_control_async(10.0_rpm);
+    can.sent.clear();
+
+    // Exercise
+    // The velocity command's reply is lost, the stop's retries go unanswered
+    auto const sent = rmd_mc_x_v2::emergency_stop(motors);
+    rmd_mc_x_v2::request_status status = rmd_mc_x_v2::request_status::pending;
+    while (status == rmd_mc_x_v2::request_status::pending) {
+      clock.ticks += 1'000'000;
+      status = mc_x.poll();
+    }
+
+    // Verify
+    expect(that % 1U == sent);
+    expect(rmd_mc_x_v2::request_status::timed_out == status);
+    // Only the stop and its retries went out, never the velocity command
+    expect(that % 3U == can.sent.size());
+    for (auto const& frame : can.sent) {
+      expect(that % 0x81 == frame.payload[0]);
+    }
+    expect(that % 1U == mc_x.dropped_requests().size());
+    expect(that % 0x81 == mc_x.dropped_requests()[0]);
+  };
+
+  "hal::actuator::rmd_mc_x::group_velocity_control() timeout"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 first(can, filter, clock, 36.0f, 0x141);
+    rmd_mc_x_v2 second(can, filter, clock, 36.0f, 0x142);
+    can.respond = false;
+    std::array const setpoints{
+      rmd_mc_x_v2::velocity_setpoint{ .motor = &first, .speed = 10.0_rpm },
+      rmd_mc_x_v2::velocity_setpoint{ .motor = &second, .speed = -10.0_rpm },
+    };
+
+    // Exercise + Verify
+    expect(throws<hal::timed_out>(
+      [&]() { rmd_mc_x_v2::group_velocity_control(setpoints); }));
+  };
+
+  "hal::actuator::rmd_mc_x::group_velocity_control() waits for the bus"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      rmd_mc_x_v2 first(can, filter, clock, 36.0f, 0x141);
+      rmd_mc_x_v2 second(can, filter, clock, 36.0f, 0x142);
+      can.respond = false;
+      std::array const setpoints{
+        rmd_mc_x_v2::velocity_setpoint{ .motor = &first, .speed = 10.0_rpm },
+        rmd_mc_x_v2::velocity_setpoint{ .motor = &second, .speed = -10.0_rpm },
+      };
+      auto const sent_at = clock.ticks;
+
+      // Exercise
+      expect(throws<hal::timed_out>(
+        [&]() { rmd_mc_x_v2::group_velocity_control(setpoints); }));
+
+      // Verify
+      // The constructor's fast response leaves a timeout of about the 200us
+      // margin. The second response also waits for the first response and
+      // for the second command to leave behind the first: two more 135us
+      // frames at 1 Mbit/s.
+      expect(that % clock.ticks - sent_at >= 200U + 270U);
+    };
+
+  "hal::actuator::rmd_mc_x::poll() timeout"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    can.respond = false;
+
+    // Exercise
+    mc_x.feedback_request_async(rmd_mc_x_v2::read::status_2);
+    clock.ticks += 1'000'000;
+    auto const status = mc_x.poll();
+
+    // Verify
+    expect(rmd_mc_x_v2::request_status::timed_out == status);
+    expect(throws<hal::timed_out>(
+      [&]() { mc_x.feedback_request(rmd_mc_x_v2::read::status_2); }));
+  };
+
+  "hal::actuator::rmd_mc_x::poll() adapts the response timeout"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    can.respond = false;
+
+    // Exercise
+    // The constructor's request measured a round trip of a few ticks, so a
+    // missing response times out long before the 10ms max response time.
+    mc_x.feedback_request_async(rmd_mc_x_v2::read::status_2);
+    clock.ticks += 1'000;
+    auto const status = mc_x.poll();
+
+    // Verify
+    expect(rmd_mc_x_v2::request_status::timed_out == status);
+    expect(that % 1U == mc_x.round_trip_statistics().samples);
+    expect(that % 1U == mc_x.round_trip_statistics().timeouts);
+  };
+
+  "hal::actuator::rmd_mc_x::poll() resends under a retry policy"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    mc_x.retry({ .attempts = 2 });
+    can.respond = false;
+    can.sent.clear();
+
+    // Exercise
+    mc_x.velocity_control_async(10.0_rpm);
+    clock.ticks += 1'000'000;
+    can.respond = true;
+    auto const after_timeout = mc_x.poll();
+    auto const after_resend = mc_x.poll();
+
+    // Verify
+    expect(rmd_mc_x_v2::request_status::pending == after_timeout);
+    expect(rmd_mc_x_v2::request_status::complete == after_resend);
+    expect(that % 2U == can.sent.size());
+    expect(can.sent[0].payload == can.sent[1].payload);
+  };
+
+  "hal::actuator::rmd_mc_x::velocity_control() returns a status"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+      mc_x.retry({ .attempts = 3, .throw_on_failure = false });
+      can.respond = false;
+      can.sent.clear();
+
+      // Exercise
+      auto const status = mc_x.velocity_control(10.0_rpm);
+
+      // Verify
+      expect(rmd_mc_x_v2::request_status::timed_out == status);
+      expect(that % 3U == can.sent.size());
+    };
+
+  "hal::actuator::rmd_mc_x::current_sensor reuses fresh feedback"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+      auto current = mc_x.acquire_current_sensor();
+      current.max_age(1ms);
+      (void)mc_x.velocity_control(10.0_rpm);
+      can.sent.clear();
+
+      // Exercise
+      (void)current.read();
+      auto const sent_while_fresh = can.sent.size();
+      clock.ticks += 1'000;
+      (void)current.read();
+
+      // Verify
+      expect(that % 0U == sent_while_fresh);
+      expect(that % 1U == can.sent.size());
+      expect(that % 0x9C == can.sent[0].payload[0]);
+    };
+
+  "hal::actuator::rmd_mc_x::rotation ignores unrelated responses"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+      auto rotation = mc_x.acquire_rotation_sensor();
+      rotation.max_age(1ms);
+      (void)mc_x.velocity_control(10.0_rpm);
+      can.sent.clear();
+
+      // Exercise
+      (void)rotation.read();
+
+      // Verify
+      expect(that % 1U == can.sent.size());
+      expect(that % 0x92 == can.sent[0].payload[0]);
+      expect(that % 0U != mc_x.feedback().updated.multi_turn_angle);
+    };
+
+  "hal::actuator::rmd_mc_x::velocity_servo::settled()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    auto servo = mc_x.acquire_velocity_servo();
+    servo.position(0.0_deg);
+    can.sent.clear();
+
+    // Exercise
+    auto const first = servo.settled();
+    auto const sent_to_settle = can.sent.size();
+    auto const moving = servo.is_moving();
+    auto const second = servo.settled();
+
+    // Verify
+    expect(first);
+    expect(not moving);
+    expect(second);
+    expect(that % 2U == sent_to_settle);
+    expect(that % 0x9C == can.sent[0].payload[0]);
+    expect(that % 0x92 == can.sent[1].payload[0]);
+    expect(that % 2U == can.sent.size());
+  };
+
+  "hal::actuator::rmd_mc_x::velocity_servo::wait_until_settled()"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+      auto servo = mc_x.acquire_velocity_servo();
+      // The fake echoes the command, so the response reports the low bytes
+      // of the target angle as a speed far above the movement threshold
+      servo.position(90.0_deg);
+      can.sent.clear();
+
+      // Exercise
+      auto const settled = servo.wait_until_settled(2ms, 5ms);
+
+      // Verify
+      expect(not settled);
+      expect(that % 0U == can.sent.size());
+    };
+
+  "hal::actuator::rmd_mc_x::snapshot()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    hal::can_message response{
+      .id = 0x241,
+      .length = 8,
+      .payload = { 0x9C, 30, 0x10, 0x00, 0x20, 0x00, 0x30, 0x00 },
+    };
+
+    // Exercise
+    mc_x.handle_message(response);
+    auto const copy = mc_x.snapshot();
+
+    // Verify
+    expect(that % mc_x.feedback().message_number == copy.message_number);
+    expect(that % 30 == copy.raw_motor_temperature);
+    expect(that % 0x10 == copy.raw_current);
+    expect(that % 0x20 == copy.raw_speed);
+    expect(that % 0x30 == copy.encoder);
+  };
+
+  "hal::actuator::rmd_mc_x::handle_message() drops bad frames"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    auto const before = mc_x.feedback();
+    hal::can_message response{
+      .id = 0x242,
+      .length = 8,
+      .payload = { 0x9C, 30, 0x10, 0x00, 0x20, 0x00, 0x30, 0x00 },
+    };
+
+    // Exercise
+    mc_x.handle_message(response);
+    auto const errors_after_foreign_id = mc_x.decode_errors();
+    response.id = 0x241;
+    response.length = 7;
+    mc_x.handle_message(response);
+    response.length = 8;
+    response.payload[0] = 0x33;
+    mc_x.handle_message(response);
+
+    // Verify
+    expect(that % 0U == errors_after_foreign_id);
+    expect(that % 2U == mc_x.decode_errors());
+    expect(that % before.message_number == mc_x.feedback().message_number);
+    expect(that % before.raw_speed == mc_x.feedback().raw_speed);
+  };
+
+  "hal::actuator::rmd_mc_x::torque_control()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    can.sent.clear();
+
+    // Exercise
+    auto const status = mc_x.torque_control(-1.5_A);
+    mc_x.torque_control_async(1'000'000.0_A);
+    (void)mc_x.poll();
+    // iq of 300, 3A at 0.01A/LSB
+    mc_x.handle_message({
+      .id = 0x241,
+      .length = 8,
+      .payload = { 0xA1, 30, 0x2C, 0x01, 0x00, 0x00, 0x00, 0x00 },
+    });
+
+    // Verify
+    expect(rmd_mc_x_v2::request_status::complete == status);
+    expect(that % 2U == can.sent.size());
+    expect(that % 0xA1 == can.sent[0].payload[0]);
+    // iqControl of -150, -1.5A at 0.01A/LSB
+    expect(that % 0x6A == can.sent[0].payload[4]);
+    expect(that % 0xFF == can.sent[0].payload[5]);
+    expect(that % 0xFF == can.sent[1].payload[4]);
+    expect(that % 0x7F == can.sent[1].payload[5]);
+    expect(that % 300 == mc_x.feedback().raw_current);
+    expect(std::abs(3.0f - mc_x.feedback().current()) < 0.001f);
+  };
+
+  "hal::actuator::rmd_mc_x::group_torque_control()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 first(can, filter, clock, 36.0f, 0x141);
+    rmd_mc_x_v2 second(can, filter, clock, 36.0f, 0x142);
+    std::array const setpoints{
+      rmd_mc_x_v2::torque_setpoint{ .motor = &first, .current = 1.0_A },
+      rmd_mc_x_v2::torque_setpoint{ .motor = &second, .current = -1.0_A },
+    };
+    can.sent.clear();
+
+    // Exercise
+    auto const status = rmd_mc_x_v2::group_torque_control(setpoints);
+
+    // Verify
+    expect(rmd_mc_x_v2::request_status::complete == status);
+    expect(that % 2U == can.sent.size());
+    expect(that % 0x141U == can.sent[0].id);
+    expect(that % 0x142U == can.sent[1].id);
+    expect(that % 0x64 == can.sent[0].payload[4]);
+    expect(that % 0x9C == can.sent[1].payload[4]);
+    expect(that % 0xFF == can.sent[1].payload[5]);
+  };
+
+  "hal::actuator::rmd_mc_x::torque_motor"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    auto motor = mc_x.acquire_torque_motor(2.0_A);
+    can.sent.clear();
+
+    // Exercise
+    motor.power(0.5f);
+
+    // Verify
+    expect(that % 1U == can.sent.size());
+    expect(that % 0xA1 == can.sent[0].payload[0]);
+    expect(that % 0x64 == can.sent[0].payload[4]);
+    expect(that % 0x00 == can.sent[0].payload[5]);
+  };
+
+  "hal::actuator::rmd_mc_x::instrument()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 mc_x(can, filter, clock, 36.0f, 0x141);
+    transaction_recorder recorder;
+    mc_x.instrument(&recorder);
+    mc_x.retry({ .attempts = 2, .throw_on_failure = false });
+
+    // Exercise
+    (void)mc_x.velocity_control(10.0_rpm);
+    can.respond = false;
+    (void)mc_x.velocity_control(10.0_rpm);
+
+    // Verify
+    auto const& stats = recorder.stats();
+    expect(that % 2U == stats.transactions);
+    expect(that % 1U == stats.completed);
+    expect(that % 2U == stats.timeouts);
+    expect(that % 24U == stats.bytes_sent);
+    expect(that % 8U == stats.bytes_received);
+    expect(not recorder.last().completed);
+  };
 };
 }  // namespace hal::actuator
@@ -0,0 +1,434 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/smart_servo/rmd/protocol.hpp>
+
+#include <vector>
+
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "../../fakes.hpp"
+
+namespace hal::actuator {
+namespace {
+constexpr std::array test_layouts{
+  rmd_response_layout{
+    .command = 0x9C,
+    .field_count = 2,
+    .fields = { {
+      { .field = rmd_field::current, .offset = 2, .width = 2 },
+      { .field = rmd_field::error_state,
+        .offset = 4,
+        .width = 1,
+        .is_signed = false },
+    } },
+  },
+  rmd_response_layout{
+    .command = 0x92,
+    .field_count = 1,
+    .fields = { {
+      { .field = rmd_field::multi_turn_angle, .offset = 1, .width = 7 },
+    } },
+  },
+  rmd_response_layout{ .command = 0x80 },
+};
+static_assert(rmd_layouts_fit(test_layouts));
+static_assert(not rmd_layouts_fit(std::array{ rmd_response_layout{
+  .command = 0x92,
+  .field_count = 1,
+  .fields = { {
+    { .field = rmd_field::multi_turn_angle, .offset = 4, .width = 5 },
+  } },
+} }));
+}  // namespace
+
+boost::ut::suite<"test_rmd_protocol"> test_rmd_protocol = [] {
+  using namespace boost::ut;
+  using namespace std::literals;
+
+  "hal::actuator::rmd_protocol::transmit()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    int handled = 0;
+    rmd_protocol protocol(can,
+                          filter,
+                          clock,
+                          0x141,
+                          0x241,
+                          test_layouts,
+                          10ms,
+                          [&](hal::can_message const& p_message) {
+                            rmd_response response;
+                            if (protocol.decode(p_message, response)) {
+                              handled++;
+                            }
+                          });
+
+    // Exercise
+    protocol.transmit({ 0x9C });
+    auto const status = protocol.poll();
+
+    // Verify
+    expect(that % 0x241 == filter.allowed.back().value());
+    expect(that % 1U == can.sent.size());
+    expect(that % 0x141U == can.sent[0].id);
+    expect(that % 0x9C == can.sent[0].payload[0]);
+    expect(that % 1 == handled);
+    expect(rmd_request_status::complete == status);
+  };
+
+  "hal::actuator::rmd_protocol::decode()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_protocol protocol(can,
+                          filter,
+                          clock,
+                          0x141,
+                          0x241,
+                          test_layouts,
+                          10ms,
+                          [](hal::can_message const&) {});
+    rmd_response status;
+    rmd_response angle;
+    rmd_response off;
+
+    // Exercise
+    auto const decoded_status = protocol.decode(
+      { .id = 0x241,
+        .length = 8,
+        .payload = { 0x9C, 0x00, 0x38, 0xFF, 0xF0, 0x00, 0x00, 0x00 } },
+      status);
+    auto const decoded_angle = protocol.decode(
+      { .id = 0x241,
+        .length = 8,
+        .payload = { 0x92, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } },
+      angle);
+    auto const decoded_off = protocol.decode(
+      { .id = 0x241, .length = 8, .payload = { 0x80 } }, off);
+
+    // Verify
+    expect(decoded_status);
+    expect(status.has(rmd_field::current));
+    expect(status.has(rmd_field::error_state));
+    expect(not status.has(rmd_field::speed));
+    expect(that % -200 == status.value(rmd_field::current));
+    expect(that % 0xF0 == status.value(rmd_field::error_state));
+    expect(decoded_angle);
+    expect(that % -2 == angle.value(rmd_field::multi_turn_angle));
+    expect(decoded_off);
+    expect(that % 0 == off.present);
+    expect(that % 0U == protocol.decode_errors());
+  };
+
+  "hal::actuator::rmd_protocol::decode() rejects bad frames"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    can.respond = false;
+    rmd_protocol protocol(can,
+                          filter,
+                          clock,
+                          0x141,
+                          0x241,
+                          test_layouts,
+                          10ms,
+                          [](hal::can_message const&) {});
+    protocol.transmit({ 0x9C });
+    rmd_response response;
+
+    // Exercise
+    auto const wrong_id =
+      protocol.decode({ .id = 0x242, .length = 8 }, response);
+    auto const errors_after_wrong_id = protocol.decode_errors();
+    auto const short_frame =
+      protocol.decode({ .id = 0x241, .length = 4 }, response);
+    auto const pending = protocol.poll();
+    auto const unknown = protocol.decode(
+      { .id = 0x241, .length = 8, .payload = { 0x33 } }, response);
+    auto const still_pending = protocol.poll();
+    auto const answer = protocol.decode(
+      { .id = 0x241, .length = 8, .payload = { 0x9C } }, response);
+    auto const complete = protocol.poll();
+
+    // Verify
+    expect(not wrong_id);
+    expect(that % 0U == errors_after_wrong_id);
+    expect(not short_frame);
+    expect(rmd_request_status::pending == pending);
+    // A frame that does not echo the request's command does not answer it
+    expect(not unknown);
+    expect(rmd_request_status::pending == still_pending);
+    expect(answer);
+    expect(rmd_request_status::complete == complete);
+    expect(that % 2U == protocol.decode_errors());
+  };
+
+  "hal::actuator::rmd_protocol::poll() times out each request alone"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      can.respond = false;
+      rmd_protocol protocol(can,
+                            filter,
+                            clock,
+                            0x141,
+                            0x241,
+                            test_layouts,
+                            1ms,
+                            [&](hal::can_message const& p_message) {
+                              rmd_response response;
+                              (void)protocol.decode(p_message, response);
+                            });
+      protocol.retry({ .throw_on_failure = false });
+
+      // Exercise
+      protocol.transmit({ 0x9C });
+      clock.ticks += 700;
+      protocol.transmit({ 0x92 });
+      clock.ticks += 700;
+      auto const first_dropped = protocol.poll();
+      can.push({ .id = 0x241, .length = 8, .payload = { 0x92 } });
+      auto const answered = protocol.poll();
+      can.push({ .id = 0x241, .length = 8, .payload = { 0x9C } });
+      auto const late = protocol.poll();
+      protocol.transmit({ 0x80 });
+      can.push({ .id = 0x241, .length = 8, .payload = { 0x80 } });
+      auto const next = protocol.poll();
+
+      // Verify
+      // The 0x9C request times out on its own deadline while the 0x92
+      // request, sent later, still waits on its own
+      expect(rmd_request_status::pending == first_dropped);
+      // The drop is reported once the 0x92 request is answered
+      expect(rmd_request_status::timed_out == answered);
+      // A late response to a dropped request is not mistaken for a new one
+      expect(rmd_request_status::timed_out == late);
+      expect(rmd_request_status::complete == next);
+      expect(that % 3U == can.sent.size());
+      expect(that % 0U == protocol.decode_errors());
+    };
+
+  "hal::actuator::rmd_protocol::wait() retries then times out"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    can.respond = false;
+    rmd_protocol protocol(can,
+                          filter,
+                          clock,
+                          0x141,
+                          0x241,
+                          test_layouts,
+                          1ms,
+                          [](hal::can_message const&) {});
+    protocol.retry({ .attempts = 3, .throw_on_failure = false });
+
+    // Exercise
+    protocol.transmit({ 0x9C });
+    auto const status = protocol.wait(&protocol);
+
+    // Verify
+    expect(rmd_request_status::timed_out == status);
+    expect(that % 3U == can.sent.size());
+    expect(throws<hal::timed_out>([&]() {
+      protocol.retry({ .attempts = 1 });
+      protocol.transmit({ 0x9C });
+      protocol.wait(&protocol);
+    }));
+  };
+
+  "hal::actuator::rmd_protocol::poll() resends the late request"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      can.respond = false;
+      rmd_protocol protocol(can,
+                            filter,
+                            clock,
+                            0x141,
+                            0x241,
+                            test_layouts,
+                            1ms,
+                            [&](hal::can_message const& p_message) {
+                              rmd_response response;
+                              (void)protocol.decode(p_message, response);
+                            });
+      protocol.retry({ .attempts = 2, .throw_on_failure = false });
+
+      // Exercise
+      protocol.transmit({ 0x9C });
+      clock.ticks += 700;
+      protocol.transmit({ 0x92 });
+      clock.ticks += 700;
+      auto const resent = protocol.poll();
+      can.push({ .id = 0x241, .length = 8, .payload = { 0x92 } });
+      auto const second_answered = protocol.poll();
+      clock.ticks += 1500;
+      auto const dropped = protocol.wait(&protocol);
+      auto const commands = protocol.dropped();
+      std::vector<hal::byte> const dropped_commands(commands.begin(),
+                                                    commands.end());
+      protocol.transmit({ 0x80 });
+      auto const cleared = protocol.dropped().size();
+
+      // Verify
+      expect(rmd_request_status::pending == resent);
+      expect(that % 0x9C == can.sent[2].payload[0]);
+      // The 0x92 request is not lost to the retry of the 0x9C request
+      expect(rmd_request_status::pending == second_answered);
+      expect(rmd_request_status::timed_out == dropped);
+      expect(that % 1U == dropped_commands.size());
+      expect(that % 0x9C == dropped_commands[0]);
+      expect(that % 4U == can.sent.size());
+      expect(that % 0U == cleared);
+    };
+
+  "hal::actuator::rmd_protocol measures only requests sent once"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      can.respond = false;
+      rmd_protocol protocol(can,
+                            filter,
+                            clock,
+                            0x141,
+                            0x241,
+                            test_layouts,
+                            1ms,
+                            [&](hal::can_message const& p_message) {
+                              rmd_response response;
+                              (void)protocol.decode(p_message, response);
+                            });
+      protocol.retry({ .attempts = 2 });
+
+      // Exercise
+      protocol.transmit({ 0x9C });
+      clock.ticks += 400;
+      can.push({ .id = 0x241, .length = 8, .payload = { 0x9C } });
+      auto const measured = protocol.poll();
+      auto const once = protocol.round_trip_statistics();
+      protocol.transmit({ 0x92 });
+      clock.ticks += 1500;
+      auto const resent = protocol.poll();
+      can.push({ .id = 0x241, .length = 8, .payload = { 0x92 } });
+      auto const answered = protocol.poll();
+
+      // Verify
+      expect(rmd_request_status::complete == measured);
+      expect(that % 1U == once.samples);
+      // Two frames at 1Mbps spend 270us on the wire
+      expect(once.max > 120us && once.max < 140us);
+      expect(rmd_request_status::pending == resent);
+      expect(rmd_request_status::complete == answered);
+      expect(that % 3U == can.sent.size());
+      // The response to the resent request is not measured
+      expect(that % 1U == protocol.round_trip_statistics().samples);
+    };
+
+  "hal::actuator::rmd_protocol::decode() leaves the records to poll()"_test =
+    []() {
+      // Setup
+      fake_can_transceiver can;
+      fake_can_filter filter;
+      fake_steady_clock clock;
+      transaction_recorder recorder;
+      can.respond = false;
+      rmd_protocol protocol(can,
+                            filter,
+                            clock,
+                            0x141,
+                            0x241,
+                            test_layouts,
+                            10ms,
+                            [](hal::can_message const&) {});
+      protocol.instrument(&recorder);
+      protocol.transmit({ 0x9C });
+      rmd_response response;
+
+      // Exercise
+      // As if from the receive interrupt
+      (void)protocol.decode(
+        { .id = 0x241, .length = 8, .payload = { 0x9C } }, response);
+      auto const samples_in_decode = protocol.round_trip_statistics().samples;
+      auto const recorded_in_decode = recorder.stats().transactions;
+      auto const status = protocol.poll();
+
+      // Verify
+      expect(that % 0U == samples_in_decode);
+      expect(that % 0U == recorded_in_decode);
+      expect(rmd_request_status::complete == status);
+      expect(that % 1U == protocol.round_trip_statistics().samples);
+      expect(that % 1U == recorder.stats().completed);
+    };
+
+  "hal::actuator::rmd_protocol::rmd_protocol() with a dispatcher"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_can_dispatcher dispatcher(can, filter);
+    int handled = 0;
+
+    {
+      rmd_protocol protocol(dispatcher,
+                            clock,
+                            0x141,
+                            0x241,
+                            test_layouts,
+                            10ms,
+                            [&](hal::can_message const& p_message) {
+                              rmd_response response;
+                              if (protocol.decode(p_message, response)) {
+                                handled++;
+                              }
+                            });
+
+      // Exercise
+      auto const status = protocol.wait(&protocol);
+      protocol.transmit({ 0x9C });
+      auto const response = protocol.wait(&protocol);
+
+      // Verify
+      expect(rmd_request_status::complete == status);
+      expect(rmd_request_status::complete == response);
+      expect(that % 1 == handled);
+    }
+
+    // The handler is detached with the protocol
+    expect(nothrow([&]() {
+      rmd_protocol again(dispatcher,
+                         clock,
+                         0x141,
+                         0x241,
+                         test_layouts,
+                         10ms,
+                         [](hal::can_message const&) {});
+    }));
+  };
+};
+}  // namespace hal::actuator
@@ -0,0 +1,152 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/telemetry_log.hpp>
+
+#include <array>
+#include <memory_resource>
+
+#include <libhal-actuator/dynamixel_servo.hpp>
+#include <libhal-actuator/smart_servo/rmd/mc_x_v2.hpp>
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+#include "fakes.hpp"
+
+namespace hal::actuator {
+boost::ut::suite<"test_telemetry_log"> test_telemetry_log = [] {
+  using namespace boost::ut;
+  using namespace std::literals;
+  using namespace hal::literals;
+
+  "telemetry_log splits packets and drops when full"_test = []() {
+    // Setup
+    std::array<telemetry_record, 4> storage{};
+    telemetry_log log(storage);
+    std::array<hal::byte, 10> const packet{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+    // Exercise
+    auto const first = log.append(
+      5, telemetry_source::dynamixel, 0x01, 0x20, packet);
+    auto const second = log.append(6, telemetry_source::rmd, 0x241, 0x9C, {});
+    auto const third = log.append(
+      7, telemetry_source::dynamixel, 0x02, 0x00, packet);
+    std::array<telemetry_record, 8> drained{};
+    auto const count = log.drain(drained);
+
+    // Verify
+    expect(first);
+    expect(second);
+    expect(not third);
+    expect(that % 2U == log.dropped());
+    expect(that % 3U == count);
+    expect(that % 0U == log.size());
+    expect(that % 5U == drained[0].timestamp);
+    expect(that % 0x20 == drained[0].opcode);
+    expect(that % 8U == drained[0].length);
+    expect(that % 0U == drained[0].offset);
+    expect(that % 8U == drained[1].offset);
+    expect(that % 2U == drained[1].length);
+    expect(that % 9 == drained[1].payload[1]);
+    expect(that % 0x241 == drained[2].device_id);
+    expect(that % 0U == drained[2].length);
+  };
+
+  "telemetry_log wraps around its storage"_test = []() {
+    // Setup
+    std::array<telemetry_record, 2> storage{};
+    telemetry_log log(storage);
+    std::array<telemetry_record, 1> drained{};
+
+    // Exercise & Verify
+    for (hal::byte i = 0; i < 5; i++) {
+      std::array<hal::byte, 1> const payload{ i };
+      expect(log.append(i, telemetry_source::rmd, 0x241, i, payload));
+      expect(that % 1U == log.drain(drained));
+      expect(that % i == drained[0].payload[0]);
+    }
+    expect(that % 0U == log.dropped());
+  };
+
+  "telemetry_log rejects storage that is not a power of two"_test = []() {
+    std::array<telemetry_record, 3> storage{};
+    expect(throws<hal::argument_out_of_domain>(
+      [&]() { telemetry_log log(storage); }));
+  };
+
+  "hal::actuator::rmd_mc_x_v2::log_telemetry()"_test = []() {
+    // Setup
+    fake_can_transceiver can;
+    fake_can_filter filter;
+    fake_steady_clock clock;
+    rmd_mc_x_v2 motor(can, filter, clock, 36.0f, 0x141);
+    std::array<telemetry_record, 4> storage{};
+    telemetry_log log(storage);
+    motor.log_telemetry(&log);
+
+    // Exercise
+    motor.handle_message({
+      .id = 0x241,
+      .length = 8,
+      .payload = { 0x9C, 30, 0x0A, 0x00, 0x06, 0x00, 0x00, 0x00 },
+    });
+    motor.handle_message({ .id = 0x241, .length = 3, .payload = { 0x9C } });
+    motor.handle_message({ .id = 0x242, .length = 8, .payload = { 0x9C } });
+    std::array<telemetry_record, 4> drained{};
+    auto const count = log.drain(drained);
+
+    // Verify
+    expect(that % 2U == count);
+    expect(telemetry_source::rmd == drained[0].source);
+    expect(that % 0x241 == drained[0].device_id);
+    expect(that % 0x9C == drained[0].opcode);
+    expect(that % 8U == drained[0].length);
+    expect(that % 30 == drained[0].payload[1]);
+    expect(that % motor.feedback().updated.status_2 == drained[0].timestamp);
+    expect(that % 3U == drained[1].length);
+  };
+
+  "hal::actuator::dynamixel_servo::log_telemetry()"_test = []() {
+    // Setup
+    auto serial = hal::make_strong_ptr<fake_serial>(
+      std::pmr::new_delete_resource());
+    auto clock = hal::make_strong_ptr<fake_steady_clock>(
+      std::pmr::new_delete_resource());
+    dynamixel_servo servo(serial,
+                          dynamixel_ax_12,
+                          { .id = 0x01, .deferred_setup = true },
+                          clock);
+    std::array<telemetry_record, 4> storage{};
+    telemetry_log log(storage);
+    servo.log_telemetry(&log);
+    std::array<hal::byte, 2> const present_position{ 0xFF, 0x01 };
+    serial->push_status(0x01, 0x04, present_position);
+
+    // Exercise
+    (void)servo.position();
+    std::array<telemetry_record, 4> drained{};
+    auto const count = log.drain(drained);
+
+    // Verify
+    expect(that % 1U == count);
+    expect(telemetry_source::dynamixel == drained[0].source);
+    expect(that % 0x01 == drained[0].device_id);
+    expect(that % 0x04 == drained[0].opcode);
+    expect(that % 2U == drained[0].length);
+    expect(that % 0xFF == drained[0].payload[0]);
+    expect(that % 0x01 == drained[0].payload[1]);
+  };
+};
+}  // namespace hal::actuator
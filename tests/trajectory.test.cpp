@@ -0,0 +1,199 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/trajectory.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include <libhal/error.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::actuator {
+namespace {
+// At a 10ms tick: 0.9 degrees per tick and 0.036 degrees per tick squared
+constexpr trajectory::limits limits{ .velocity = 90.0f,
+                                     .acceleration = 360.0f };
+constexpr float tolerance = 1e-4f;
+
+std::vector<hal::degrees> run(trajectory& p_trajectory)
+{
+  std::vector<hal::degrees> setpoints;
+  while (p_trajectory.moving() && setpoints.size() < 10'000) {
+    setpoints.push_back(p_trajectory.tick());
+  }
+  return setpoints;
+}
+
+/// Largest change of velocity between two ticks, in degrees per tick squared
+float peak_acceleration(std::vector<hal::degrees> const& p_setpoints,
+                        hal::degrees p_start)
+{
+  float peak = 0.0f;
+  float previous_velocity = 0.0f;
+  auto previous = p_start;
+  for (auto const setpoint : p_setpoints) {
+    auto const velocity = setpoint - previous;
+    peak = std::max(peak, std::abs(velocity - previous_velocity));
+    previous_velocity = velocity;
+    previous = setpoint;
+  }
+  return peak;
+}
+
+float peak_velocity(std::vector<hal::degrees> const& p_setpoints,
+                    hal::degrees p_start)
+{
+  float peak = 0.0f;
+  auto previous = p_start;
+  for (auto const setpoint : p_setpoints) {
+    peak = std::max(peak, std::abs(setpoint - previous));
+    previous = setpoint;
+  }
+  return peak;
+}
+}  // namespace
+
+boost::ut::suite<"test_trajectory"> test_trajectory = [] {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "hal::actuator::trajectory::trajectory()"_test = []() {
+    // Setup + Exercise
+    trajectory at_rest(10ms, limits, 15.0f);
+
+    // Verify
+    expect(not at_rest.moving());
+    expect(that % 15.0f == at_rest.tick());
+    expect(throws<hal::argument_out_of_domain>(
+      []() { trajectory bad_tick(0ms, limits); }));
+    expect(throws<hal::argument_out_of_domain>(
+      []() { trajectory bad_limits(10ms, { .velocity = 0.0f }); }));
+  };
+
+  "hal::actuator::trajectory trapezoid"_test = []() {
+    // Setup
+    trajectory move(10ms, limits);
+
+    // Exercise
+    move.enqueue({ .position = 90.0f });
+    auto const setpoints = run(move);
+
+    // Verify
+    // 0.25s to reach 90 deg/s, 0.75s at it and 0.25s to stop
+    expect(that % 125U == setpoints.size());
+    expect(that % 90.0f == setpoints.back());
+    expect(peak_velocity(setpoints, 0.0f) <= 0.9f + tolerance);
+    expect(peak_acceleration(setpoints, 0.0f) <= 0.036f + tolerance);
+    expect(std::ranges::is_sorted(setpoints));
+  };
+
+  "hal::actuator::trajectory triangle"_test = []() {
+    // Setup
+    trajectory move(10ms, limits, 1.0f);
+
+    // Exercise
+    move.enqueue({ .position = 0.0f });
+    auto const setpoints = run(move);
+
+    // Verify
+    // Never reaches the velocity limit: sqrt(0.036 * 1) per tick at the peak
+    expect(that % 12U == setpoints.size());
+    expect(that % 0.0f == setpoints.back());
+    expect(peak_acceleration(setpoints, 1.0f) <= 0.036f + tolerance);
+    expect(std::ranges::is_sorted(setpoints, std::greater{}));
+  };
+
+  "hal::actuator::trajectory duration"_test = []() {
+    // Setup
+    trajectory move(10ms, limits);
+
+    // Exercise
+    move.enqueue({ .position = 90.0f, .duration = 2s });
+    auto const setpoints = run(move);
+
+    // Verify
+    // Rounding each phase up to whole ticks may add a tick or two
+    expect(setpoints.size() >= 200U);
+    expect(setpoints.size() <= 202U);
+    expect(that % 90.0f == setpoints.back());
+    expect(peak_acceleration(setpoints, 0.0f) <= 0.036f + tolerance);
+  };
+
+  "hal::actuator::trajectory velocity"_test = []() {
+    // Setup
+    trajectory move(10ms, limits);
+
+    // Exercise
+    move.enqueue({ .position = 45.0f, .velocity = 45.0f });
+    auto const setpoints = run(move);
+
+    // Verify
+    expect(peak_velocity(setpoints, 0.0f) <= 0.45f + tolerance);
+    expect(that % 45.0f == setpoints.back());
+  };
+
+  "hal::actuator::trajectory waypoints"_test = []() {
+    // Setup
+    trajectory move(10ms, limits);
+
+    // Exercise
+    move.enqueue({ .position = 10.0f });
+    move.enqueue({ .position = 10.0f, .duration = 100ms });
+    move.enqueue({ .position = -10.0f });
+    auto const queued = move.queued();
+    auto const setpoints = run(move);
+
+    // Verify
+    expect(that % 3U == queued);
+    expect(that % -10.0f == setpoints.back());
+    auto const at_first =
+      std::ranges::count_if(setpoints, [](auto p) { return p == 10.0f; });
+    // Lands on the first waypoint, then pauses there for 10 ticks
+    expect(that % 11 == at_first);
+  };
+
+  "hal::actuator::trajectory::enqueue() full"_test = []() {
+    // Setup
+    trajectory move(10ms, limits);
+    for (usize i = 0; i < trajectory::capacity; i++) {
+      move.enqueue({ .position = static_cast<float>(i) });
+    }
+
+    // Exercise + Verify
+    expect(throws<hal::resource_unavailable_try_again>(
+      [&]() { move.enqueue({ .position = 100.0f }); }));
+  };
+
+  "hal::actuator::trajectory::clear()"_test = []() {
+    // Setup
+    trajectory move(10ms, limits);
+    move.enqueue({ .position = 90.0f });
+    move.enqueue({ .position = 0.0f });
+    for (int i = 0; i < 10; i++) {
+      move.tick();
+    }
+    auto const stopped_at = move.position();
+
+    // Exercise
+    move.clear();
+
+    // Verify
+    expect(not move.moving());
+    expect(that % 0U == move.queued());
+    expect(that % stopped_at == move.tick());
+  };
+};
+}  // namespace hal::actuator
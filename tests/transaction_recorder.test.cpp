@@ -0,0 +1,84 @@
+// Copyright 2024 - 2025 Khalil Estell and the libhal contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-actuator/transaction_recorder.hpp>
+
+#include <chrono>
+
+#include <boost/ut.hpp>
+
+namespace hal::actuator {
+boost::ut::suite<"test_transaction_recorder"> test_transaction_recorder = [] {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "transaction_recorder summarizes response times"_test = []() {
+    // Setup
+    transaction_recorder recorder(100us);
+    auto const response = [](hal::time_duration p_time) {
+      return transaction{ .response_time = p_time,
+                          .attempts = 1,
+                          .completed = true };
+    };
+
+    // Exercise
+    recorder.record(response(150us));
+    recorder.record(response(250us));
+    recorder.record(response(1s));
+
+    // Verify
+    auto const& stats = recorder.stats();
+    expect(that % 3U == stats.completed);
+    expect(150us == stats.min);
+    expect(1s == stats.max);
+    expect(std::chrono::nanoseconds(1s + 400us) / 3 == stats.mean());
+    expect(that % 1U == stats.histogram[1]);
+    expect(that % 1U == stats.histogram[2]);
+    expect(that % 1U == stats.histogram.back());
+  };
+
+  "transaction_recorder counts failed transactions"_test = []() {
+    // Setup
+    transaction_recorder recorder;
+
+    // Exercise
+    recorder.record({ .attempts = 3, .timeouts = 3, .bytes_sent = 24 });
+
+    // Verify
+    auto const& stats = recorder.stats();
+    expect(that % 1U == stats.transactions);
+    expect(that % 0U == stats.completed);
+    expect(that % 2U == stats.retries);
+    expect(that % 3U == stats.timeouts);
+    expect(that % 24U == stats.bytes_sent);
+    expect(0ns == stats.mean());
+    expect(hal::time_duration::max() == stats.min);
+  };
+
+  "transaction_recorder::reset()"_test = []() {
+    // Setup
+    transaction_recorder recorder;
+    recorder.record(
+      { .response_time = 150us, .attempts = 1, .completed = true });
+
+    // Exercise
+    recorder.reset();
+
+    // Verify
+    expect(that % 0U == recorder.stats().transactions);
+    expect(that % 0U == recorder.stats().histogram[1]);
+    expect(not recorder.last().completed);
+  };
+};
+}  // namespace hal::actuator